@@ -0,0 +1,334 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include <QtTest>
+
+#include "testfitsbenchmark.h"
+#include "fitsviewer/stretch.h"
+
+#include <cmath>
+#include <memory>
+
+namespace
+{
+struct ImageSize
+{
+    const char *name;
+    int width;
+    int height;
+};
+
+// From a guide camera frame up to a full frame mosaic
+const ImageSize imageSizes[] =
+{
+    { "1MP", 1024, 1024 },
+    { "4MP", 2048, 2048 },
+    { "16MP", 4656, 3520 },
+    { "26MP", 6248, 4176 },
+    { "62MP", 9576, 6388 },
+    { "100MP", 11648, 8742 },
+};
+
+struct ImageType
+{
+    const char *name;
+    int bitpix;
+    double range;
+};
+
+const ImageType imageTypes[] =
+{
+    { "BYTE", BYTE_IMG, 255 },
+    { "SHORT", SHORT_IMG, 32767 },
+    { "USHORT", USHORT_IMG, 65535 },
+    { "LONG", LONG_IMG, 1048575 },
+    { "ULONG", ULONG_IMG, 1048575 },
+    { "LONGLONG", LONGLONG_IMG, 1048575 },
+    { "FLOAT", FLOAT_IMG, 1 },
+    { "DOUBLE", DOUBLE_IMG, 1 },
+};
+
+int maxMegapixels()
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue("KSTARS_FITS_BENCHMARK_MAX_MP", &ok);
+    return ok && value > 0 ? value : 4;
+}
+
+// Background, noise and a grid of Gaussian stars of varying brightness, as a fraction of the range
+void syntheticRow(QVector<float> &row, int y, double range)
+{
+    constexpr int cell = 64;
+    constexpr double sigma = 1.5;
+    uint32_t seed = 2463534242u ^ static_cast<uint32_t>(y * 2654435761u);
+
+    for (int x = 0; x < row.size(); x++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        double value = 0.05 + 0.01 * (seed & 0xffff) / 65535.0;
+
+        const int cx = (x / cell) * cell + cell / 2;
+        const int cy = (y / cell) * cell + cell / 2;
+        const double d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        if (d2 < 64)
+        {
+            const double amplitude = 0.2 + 0.7 * ((cx * 7 + cy * 13) % 97) / 96.0;
+            value += amplitude * std::exp(-d2 / (2 * sigma * sigma));
+        }
+
+        row[x] = std::min(1.0, value) * range;
+    }
+}
+}
+
+TestFitsBenchmark::TestFitsBenchmark(QObject *parent) : QObject(parent)
+{
+}
+
+void TestFitsBenchmark::initTestCase()
+{
+    QVERIFY(m_Directory.isValid());
+}
+
+void TestFitsBenchmark::addImageRows(const QList<QPair<QString, int>> &variants, bool bayerOnly)
+{
+    QTest::addColumn<int>("variant");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("bitpix");
+
+    const int limit = maxMegapixels();
+    for (const auto &variant : variants)
+    {
+        for (const ImageSize &size : imageSizes)
+        {
+            if (static_cast<double>(size.width) * size.height > limit * 1024.0 * 1024.0)
+                break;
+
+            for (const ImageType &type : imageTypes)
+            {
+                // Debayering is implemented for 8 and 16 bit data only
+                if (bayerOnly && type.bitpix != BYTE_IMG && type.bitpix != USHORT_IMG)
+                    continue;
+                const QString tag = QString("%1 %2 %3").arg(variant.first, size.name, type.name).trimmed();
+                QTest::newRow(tag.toLatin1().constData()) << variant.second << size.width << size.height << type.bitpix;
+            }
+        }
+    }
+}
+
+QString TestFitsBenchmark::fixture(int width, int height, int bitpix)
+{
+    const QString filename = m_Directory.filePath(QString("synthetic_%1x%2_%3.fits").arg(width).arg(height).arg(bitpix));
+    if (filename == m_Fixture)
+        return m_Fixture;
+
+    // Only the fixture of the current row is kept, large frames of every type would not fit in a temporary folder
+    if (!m_Fixture.isEmpty())
+        QFile::remove(m_Fixture);
+    m_Fixture.clear();
+
+    double range = 1;
+    for (const ImageType &type : imageTypes)
+        if (type.bitpix == bitpix)
+            range = type.range;
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long naxes[2] = { width, height };
+    if (fits_create_file(&fptr, QString("!" + filename).toLatin1().constData(), &status) ||
+            fits_create_img(fptr, bitpix, 2, naxes, &status))
+        return QString();
+
+    QVector<float> row(width);
+    for (int y = 0; y < height && status == 0; y++)
+    {
+        syntheticRow(row, y, range);
+        long firstPixel[2] = { 1, y + 1 };
+        fits_write_pix(fptr, TFLOAT, firstPixel, width, row.data(), &status);
+    }
+    fits_close_file(fptr, &status);
+
+    if (status == 0)
+        m_Fixture = filename;
+    return m_Fixture;
+}
+
+FITSData *TestFitsBenchmark::loadFixture()
+{
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, bitpix);
+
+    const QString filename = fixture(width, height, bitpix);
+    if (filename.isEmpty())
+        return nullptr;
+
+    FITSData *data = new FITSData();
+    QFuture<bool> worker = data->loadFITS(filename);
+    worker.waitForFinished();
+    if (!worker.result())
+    {
+        delete data;
+        return nullptr;
+    }
+    return data;
+}
+
+void TestFitsBenchmark::benchmarkLoad_data()
+{
+    addImageRows({ { QString(), 0 } });
+}
+
+void TestFitsBenchmark::benchmarkLoad()
+{
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, bitpix);
+
+    const QString filename = fixture(width, height, bitpix);
+    QVERIFY(!filename.isEmpty());
+
+    QBENCHMARK
+    {
+        FITSData data;
+        QFuture<bool> worker = data.loadFITS(filename);
+        QVERIFY(worker.result());
+    }
+}
+
+void TestFitsBenchmark::benchmarkStatistics_data()
+{
+    addImageRows({ { QString(), 0 } });
+}
+
+void TestFitsBenchmark::benchmarkStatistics()
+{
+    std::unique_ptr<FITSData> data(loadFixture());
+    QVERIFY(data);
+
+    QBENCHMARK { data->calculateStats(true); }
+}
+
+void TestFitsBenchmark::benchmarkFilter_data()
+{
+    // FITS_EQUALIZE is left out, it needs the histogram of a FITS viewer tab and does nothing without one
+    addImageRows(
+    {
+        { "AUTO_STRETCH", FITS_AUTO_STRETCH },
+        { "HIGH_CONTRAST", FITS_HIGH_CONTRAST },
+        { "HIGH_PASS", FITS_HIGH_PASS },
+        { "MEDIAN", FITS_MEDIAN },
+        { "GAUSSIAN", FITS_GAUSSIAN },
+        { "AUTO", FITS_AUTO },
+        { "LINEAR", FITS_LINEAR },
+        { "LOG", FITS_LOG },
+        { "SQRT", FITS_SQRT }
+    });
+}
+
+void TestFitsBenchmark::benchmarkFilter()
+{
+    QFETCH(int, variant);
+
+    std::unique_ptr<FITSData> data(loadFixture());
+    QVERIFY(data);
+
+    // Filters change the pixels they run on, so a single run is measured on the frame freshly loaded for the row
+    QBENCHMARK_ONCE { data->applyFilter(static_cast<FITSScale>(variant)); }
+}
+
+void TestFitsBenchmark::benchmarkStretch_data()
+{
+    addImageRows({ { QString(), 0 } });
+}
+
+void TestFitsBenchmark::benchmarkStretch()
+{
+    std::unique_ptr<FITSData> data(loadFixture());
+    QVERIFY(data);
+
+    Stretch stretch(data->width(), data->height(), data->channels(), data->property("dataType").toInt());
+    stretch.setParams(stretch.computeParams(data->getImageBuffer()));
+
+    QImage image(data->width(), data->height(), QImage::Format_Indexed8);
+    QBENCHMARK { stretch.run(data->getImageBuffer(), &image); }
+}
+
+void TestFitsBenchmark::benchmarkDebayer_data()
+{
+    addImageRows({ { QString(), 0 } }, true);
+}
+
+void TestFitsBenchmark::benchmarkDebayer()
+{
+    std::unique_ptr<FITSData> data(loadFixture());
+    QVERIFY(data);
+
+    BayerParams params;
+    params.method = DC1394_BAYER_METHOD_NEAREST;
+    params.filter = DC1394_COLOR_FILTER_RGGB;
+    params.offsetX = params.offsetY = 0;
+    data->setBayerParams(&params);
+
+    // Debayering replaces the frame with its three channels, so a single run is measured on the frame freshly loaded
+    QBENCHMARK_ONCE { QVERIFY(data->debayer()); }
+}
+
+void TestFitsBenchmark::benchmarkRotate_data()
+{
+    addImageRows(
+    {
+        { "ROTATE_CW", FITS_ROTATE_CW },
+        { "ROTATE_CCW", FITS_ROTATE_CCW },
+        { "FLIP_H", FITS_FLIP_H },
+        { "FLIP_V", FITS_FLIP_V }
+    });
+}
+
+void TestFitsBenchmark::benchmarkRotate()
+{
+    QFETCH(int, variant);
+
+    std::unique_ptr<FITSData> data(loadFixture());
+    QVERIFY(data);
+
+    // Rotations change the geometry of the frame, so a single run is measured on the frame freshly loaded for the row
+    QBENCHMARK_ONCE { data->applyFilter(static_cast<FITSScale>(variant)); }
+}
+
+void TestFitsBenchmark::benchmarkFindStars_data()
+{
+    addImageRows(
+    {
+        { "GRADIENT", ALGORITHM_GRADIENT },
+        { "CENTROID", ALGORITHM_CENTROID },
+        { "THRESHOLD", ALGORITHM_THRESHOLD },
+        { "SEP", ALGORITHM_SEP },
+        { "BAHTINOV", ALGORITHM_BAHTINOV }
+    });
+}
+
+void TestFitsBenchmark::benchmarkFindStars()
+{
+    QFETCH(int, variant);
+
+    std::unique_ptr<FITSData> data(loadFixture());
+    QVERIFY(data);
+
+    // The Bahtinov detector only works in a tracking box, use the one around the star nearest to the center
+    QRect trackingBox;
+    if (variant == ALGORITHM_BAHTINOV)
+        trackingBox = QRect((data->width() / 2 / 64) * 64, (data->height() / 2 / 64) * 64, 64, 64);
+
+    QBENCHMARK { data->findStars(static_cast<StarAlgorithm>(variant), trackingBox); }
+}
+
+QTEST_GUILESS_MAIN(TestFitsBenchmark)
@@ -0,0 +1,56 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTFITSBENCHMARK_H
+#define TESTFITSBENCHMARK_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+#include "fitsviewer/fitsdata.h"
+
+/**
+ * @class TestFitsBenchmark
+ * Times the FITS processing steps of the capture loop on synthetic star fields of every BITPIX type.
+ * Sizes up to KSTARS_FITS_BENCHMARK_MAX_MP megapixels (4 by default, 100 at most) are exercised.
+ * Use "-o results.csv,csv" or "-o results.xml,xml" for machine readable results.
+ */
+class TestFitsBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestFitsBenchmark(QObject *parent = nullptr);
+
+private:
+    void addImageRows(const QList<QPair<QString, int>> &variants, bool bayerOnly = false);
+    QString fixture(int width, int height, int bitpix);
+    FITSData *loadFixture();
+
+    QTemporaryDir m_Directory;
+    QString m_Fixture;
+
+private slots:
+    void initTestCase();
+
+    void benchmarkLoad_data();
+    void benchmarkLoad();
+    void benchmarkStatistics_data();
+    void benchmarkStatistics();
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+    void benchmarkStretch_data();
+    void benchmarkStretch();
+    void benchmarkDebayer_data();
+    void benchmarkDebayer();
+    void benchmarkRotate_data();
+    void benchmarkRotate();
+    void benchmarkFindStars_data();
+    void benchmarkFindStars();
+};
+
+#endif // TESTFITSBENCHMARK_H
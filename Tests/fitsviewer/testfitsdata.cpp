@@ -109,15 +109,16 @@ void TestFitsData::testLoadFits()
     // Statistics computation
     QVERIFY(abs(fd->getADU() - 41.08) < 0.01);
     QVERIFY(abs(fd->getMean() - 41.08) < 0.01);
-    QVERIFY(abs(fd->getStdDev() - 360.18) < 0.01);
+    QVERIFY(abs(fd->getStdDev() - 360.29) < 0.01);
     QVERIFY(abs(fd->getSNR() - 0.114) < 0.001);
 
     // Minmax
     QCOMPARE((int)fd->getMax(), 57832);
     QCOMPARE((int)fd->getMin(), 21);
 
-    QWARN("No median calculation in the current implementation");
-    QCOMPARE((int)fd->getMedian(), 0);
+    // Median and MAD are exact for 16-bit data
+    QCOMPARE((int)fd->getMedian(), 31);
+    QCOMPARE((int)fd->getMAD(), 3);
 
     // Without searching for stars, there are no stars found
     QCOMPARE(fd->getStarCenters().count(), 0);
@@ -0,0 +1,121 @@
+/*  GuideFrameBuffer class test.
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "ekos/guide/internalguide/guideframebuffer.h"
+
+#include <QtTest>
+
+#include <QObject>
+
+#include <fitsio.h>
+
+class TestGuideFrameBuffer : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestGuideFrameBuffer();
+
+        /** @short Destructor */
+        ~TestGuideFrameBuffer() override = default;
+
+    private slots:
+        void convertTest();
+        void areaTest();
+        void partitionTest();
+};
+
+#include "testguideframebuffer.moc"
+
+TestGuideFrameBuffer::TestGuideFrameBuffer() : QObject()
+{
+}
+
+namespace
+{
+const int width = 10, height = 6;
+
+// Each pixel holds its index in the image
+QVector<uint16_t> makeImage()
+{
+    QVector<uint16_t> image(width * height);
+    for (int i = 0; i < image.size(); i++)
+        image[i] = i;
+    return image;
+}
+}
+
+void TestGuideFrameBuffer::convertTest()
+{
+    GuideFrameBuffer buffer;
+    const QVector<uint16_t> image = makeImage();
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(image.constData());
+
+    QVERIFY(buffer.convert(data, TUSHORT, width, height));
+    QCOMPARE(buffer.area(), QRect(0, 0, width, height));
+    QCOMPARE(reinterpret_cast<uintptr_t>(buffer.data()) % 32, uintptr_t(0));
+    for (int i = 0; i < image.size(); i++)
+        QCOMPARE(buffer.data()[i], static_cast<float>(i));
+
+    // A smaller frame reuses the storage
+    const float *storage = buffer.data();
+    QVERIFY(buffer.convert(data, TUSHORT, width, height, QRect(2, 2, 4, 4)));
+    QVERIFY(buffer.data() == storage);
+
+    // Unsupported types leave the buffer empty
+    QVERIFY(!buffer.convert(data, TSTRING, width, height));
+    QVERIFY(buffer.area().isEmpty());
+
+    QVector<double> doubles(width * height, 1.5);
+    QVERIFY(buffer.convert(reinterpret_cast<const uint8_t *>(doubles.constData()), TDOUBLE, width, height));
+    QCOMPARE(buffer.data()[width * height - 1], 1.5f);
+}
+
+void TestGuideFrameBuffer::areaTest()
+{
+    GuideFrameBuffer buffer;
+    const QVector<uint16_t> image = makeImage();
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(image.constData());
+
+    // Only the area is converted, rows follow each other
+    QVERIFY(buffer.convert(data, TUSHORT, width, height, QRect(3, 1, 4, 2)));
+    QCOMPARE(buffer.area(), QRect(3, 1, 4, 2));
+    QCOMPARE(buffer.data()[0], 13.0f);
+    QCOMPARE(buffer.data()[3], 16.0f);
+    QCOMPARE(buffer.data()[4], 23.0f);
+
+    // The area is clipped to the image
+    QVERIFY(buffer.convert(data, TUSHORT, width, height, QRect(8, 4, 5, 5)));
+    QCOMPARE(buffer.area(), QRect(8, 4, 2, 2));
+    QCOMPARE(buffer.data()[3], 59.0f);
+
+    QVERIFY(!buffer.convert(data, TUSHORT, width, height, QRect(20, 20, 5, 5)));
+}
+
+void TestGuideFrameBuffer::partitionTest()
+{
+    GuideFrameBuffer buffer;
+    const QVector<uint16_t> image = makeImage();
+    QVERIFY(buffer.convert(reinterpret_cast<const uint8_t *>(image.constData()), TUSHORT, width, height));
+
+    // Regions are views of whole squares, row by row
+    const QVector<GuideFrameBuffer::View> regions = buffer.partition(3);
+    QCOMPARE(regions.size(), 6);
+    QCOMPARE(regions[1].stride, width);
+    QCOMPARE(regions[1].row(0)[0], 3.0f);
+    QCOMPARE(regions[1].row(2)[2], 25.0f);
+    QCOMPARE(regions[3].row(0)[0], 30.0f);
+    QCOMPARE(regions[5].row(2)[2], 58.0f);
+
+    // Views outside of the converted area are empty
+    QVERIFY(buffer.view(QRect(8, 0, 3, 3)).data == nullptr);
+    QVERIFY(buffer.partition(0).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestGuideFrameBuffer)
@@ -0,0 +1,125 @@
+/*  GuideLatency class test.
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "ekos/guide/internalguide/guidelatency.h"
+#include "fitsviewer/fitsdata.h"
+
+#include <QtTest>
+
+#include <QObject>
+
+class TestGuideLatency : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestGuideLatency();
+
+        /** @short Destructor */
+        ~TestGuideLatency() override = default;
+
+    private slots:
+        void frameTest();
+        void percentileTest();
+};
+
+#include "testguidelatency.moc"
+
+TestGuideLatency::TestGuideLatency() : QObject()
+{
+}
+
+namespace
+{
+// Runs a frame through all stages, received totalMS milliseconds before its pulse was sent, with fixed stamps so
+// that the durations do not depend on the time the test takes
+bool runFrame(GuideLatency &latency, FITSData &data, double totalMS)
+{
+    // Frames a second apart, each taken for a new frame
+    static qint64 received = 0;
+    received += 1000000;
+    const qint64 total = static_cast<qint64>(totalMS * 1000);
+
+    data.setProperty("blobReceived", received);
+    data.setProperty("fitsLoaded", received + total / 2);
+    latency.startFrame(&data);
+    latency.mark(GuideLatency::GUIDING_STARTED, received + total / 2);
+    latency.mark(GuideLatency::STAR_DETECTED, received + total * 3 / 4);
+    latency.mark(GuideLatency::GUIDING_PROCESSED, received + total * 3 / 4);
+    latency.mark(GuideLatency::PULSE_SENT, received + total);
+    return latency.endFrame();
+}
+}
+
+void TestGuideLatency::frameTest()
+{
+    GuideLatency latency;
+    FITSData data(FITS_GUIDE);
+
+    // Frames without the stamps of the CCD are not kept
+    latency.startFrame(nullptr);
+    latency.mark(GuideLatency::STAR_DETECTED);
+    latency.mark(GuideLatency::GUIDING_PROCESSED);
+    latency.mark(GuideLatency::PULSE_SENT);
+    QVERIFY(!latency.endFrame());
+    QCOMPARE(latency.frameCount(), 0);
+    QCOMPARE(latency.percentile(GuideLatency::TOTAL, 50), -1.0);
+
+    // Nor frames missing a stage
+    data.setProperty("blobReceived", GuideLatency::now());
+    data.setProperty("fitsLoaded", GuideLatency::now());
+    latency.startFrame(&data);
+    latency.mark(GuideLatency::PULSE_SENT);
+    QVERIFY(!latency.endFrame());
+
+    QVERIFY(runFrame(latency, data, 20));
+    QCOMPARE(latency.frameCount(), 1);
+    QCOMPARE(latency.lastFrame()[GuideLatency::TOTAL], 20.0);
+    QCOMPARE(latency.lastFrame()[GuideLatency::LOAD], 10.0);
+    QCOMPARE(latency.lastFrame()[GuideLatency::DELIVERY], 0.0);
+    QCOMPARE(latency.lastFrame()[GuideLatency::DETECTION], 5.0);
+
+    // The stages of a frame are only counted once
+    latency.startFrame(&data);
+    latency.mark(GuideLatency::STAR_DETECTED);
+    latency.mark(GuideLatency::GUIDING_PROCESSED);
+    latency.mark(GuideLatency::PULSE_SENT);
+    QVERIFY(!latency.endFrame());
+    QCOMPARE(latency.frameCount(), 1);
+
+    latency.clear();
+    QCOMPARE(latency.frameCount(), 0);
+    QVERIFY(latency.lastFrame().isEmpty());
+}
+
+void TestGuideLatency::percentileTest()
+{
+    GuideLatency latency;
+    FITSData data(FITS_GUIDE);
+
+    for (int i = 1; i <= 100; i++)
+        QVERIFY(runFrame(latency, data, 1000 + i));
+
+    // Nearest rank
+    QCOMPARE(latency.percentile(GuideLatency::TOTAL, 50), 1050.0);
+    QCOMPARE(latency.percentile(GuideLatency::TOTAL, 99), 1099.0);
+    QCOMPARE(latency.percentile(GuideLatency::TOTAL, 100), 1100.0);
+
+    // Only the last frames are kept
+    for (int i = 1; i <= 50; i++)
+        QVERIFY(runFrame(latency, data, 2000));
+    QCOMPARE(latency.frameCount(), 100);
+    QCOMPARE(latency.percentile(GuideLatency::TOTAL, 50), 1100.0);
+
+    const QJsonObject json = latency.toJson();
+    QCOMPARE(json["frames"].toInt(), 100);
+    QVERIFY(json["intervals"].toObject().contains("total"));
+}
+
+QTEST_GUILESS_MAIN(TestGuideLatency)
@@ -0,0 +1,195 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QtConcurrent>
+
+#include "testschedulerbenchmark.h"
+#include "ksutils.h"
+#include "kstarsdata.h"
+#include "ekos/scheduler/schedulerengine.h"
+#include "ekos/scheduler/schedulerephemeris.h"
+#include "ekos/scheduler/schedulerjob.h"
+
+#include <QLoggingCategory>
+
+namespace
+{
+// Scheduler test vectors, relative to the source folder of the test
+const char *const schedulerFiles[] =
+{
+    "simple_test.esl",
+    "simple_test_no_twilight.esl",
+    "culmination_no_twilight.esl",
+    "distant_jobs_no_twilight.esl",
+    "duplicated_scheduler_jobs_no_twilight.esl",
+    "duplicated_scheduler_jobs_duplicated_sequence_jobs_no_twilight.esl",
+    "repeated_jobs_no_twilight.esl",
+    "repeating_scheduler_job_no_twilight_30s_leadtime.esl",
+    "start_at_finish_at_test.esl",
+    "complex_job/complex_jobs.esl",
+};
+
+// Folders the test vectors expect their sequence files in
+const char *const sequenceFolders[] = { "/tmp/kstars_tests/", "/var/tmp/" };
+
+// Files KStarsData cannot initialize without, it would ask the user about them otherwise
+const char *const dataFiles[] = { "TZrules.dat", "citydb.sqlite", "image_url.dat", "info_url.dat" };
+
+QDate benchmarkDate()
+{
+    const QDate date = QDate::fromString(QString::fromLocal8Bit(qgetenv("KSTARS_SCHEDULER_BENCHMARK_DATE")), Qt::ISODate);
+    return date.isValid() ? date : QDate(2018, 5, 7);
+}
+
+void addFileRows()
+{
+    QTest::addColumn<QString>("file");
+    for (const char *file : schedulerFiles)
+        QTest::newRow(file) << QString(file);
+}
+
+// Put jobs back in the state they were loaded in
+void resetJobs(const QList<SchedulerJob *> &jobs)
+{
+    for (SchedulerJob *job : jobs)
+        job->reset();
+}
+}
+
+TestSchedulerBenchmark::TestSchedulerBenchmark(QObject *parent) : QObject(parent)
+{
+}
+
+void TestSchedulerBenchmark::initTestCase()
+{
+    // The score of every job at every step would drown the results
+    QLoggingCategory::setFilterRules("org.kde.kstars.ekos.scheduler.debug=false\norg.kde.kstars.ekos.scheduler.info=false");
+
+    for (const char *name : dataFiles)
+    {
+        QFile file;
+        if (!KSUtils::openDataFile(file, name))
+            QSKIP(qPrintable(QString("KStars data file %1 is not installed.").arg(name)));
+    }
+
+    KStarsData *data = KStarsData::Create();
+    QVERIFY(data->initialize());
+
+    // Evening of the date the test vectors were written for, they have fixed startup times on that night
+    GeoLocation *geo = data->geo();
+    data->changeDateTime(geo->LTtoUT(KStarsDateTime(benchmarkDate(), QTime(18, 0), Qt::LocalTime)));
+
+    // Copy the test vectors, pointing them to the copies of their sequence files
+    QVERIFY(m_Directory.isValid());
+    QDir const source(KSTARS_SCHEDULER_TESTS_DIR);
+    for (const QString &folder : { QString("."), QString("complex_job") })
+    {
+        for (const QFileInfo &info : QDir(source.filePath(folder)).entryInfoList({ "*.esl", "*.esq" }, QDir::Files))
+        {
+            QFile file(info.filePath());
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            QString content = QString::fromUtf8(file.readAll());
+            for (const char *sequenceFolder : sequenceFolders)
+                content.replace(sequenceFolder, m_Directory.path() + '/');
+
+            QFile copy(m_Directory.path() + '/' + info.fileName());
+            QVERIFY(copy.open(QIODevice::WriteOnly));
+            copy.write(content.toUtf8());
+        }
+    }
+}
+
+QList<SchedulerJob *> TestSchedulerBenchmark::loadJobs(const QString &file)
+{
+    QList<SchedulerJob *> jobs;
+    Ekos::SchedulerEngine engine;
+    engine.loadJobs(m_Directory.path() + '/' + QFileInfo(file).fileName(), jobs);
+    return jobs;
+}
+
+void TestSchedulerBenchmark::benchmarkEvaluate_data()
+{
+    addFileRows();
+}
+
+void TestSchedulerBenchmark::benchmarkEvaluate()
+{
+    QFETCH(QString, file);
+
+    QList<SchedulerJob *> jobs = loadJobs(file);
+    QVERIFY(!jobs.isEmpty());
+
+    Ekos::SchedulerEngine engine;
+    engine.calculateDawnDusk();
+    QDateTime const now = KStarsData::Instance()->lt();
+
+    QBENCHMARK
+    {
+        // Evaluating from scratch, as when the queue is started
+        SchedulerEphemeris::Instance()->clear();
+        resetJobs(jobs);
+
+        QList<SchedulerJob *> sortedJobs = jobs;
+        engine.prepareJobs(sortedJobs, now, false);
+        engine.scheduleJobs(sortedJobs, now);
+    }
+
+    qDeleteAll(jobs);
+}
+
+void TestSchedulerBenchmark::benchmarkSimulateNight_data()
+{
+    addFileRows();
+}
+
+void TestSchedulerBenchmark::benchmarkSimulateNight()
+{
+    QFETCH(QString, file);
+
+    QList<SchedulerJob *> jobs = loadJobs(file);
+    QVERIFY(!jobs.isEmpty());
+
+    Ekos::SchedulerEngine engine;
+    engine.calculateDawnDusk();
+    QDateTime const from  = KStarsData::Instance()->lt();
+    QDateTime const until = from.addDays(1);
+
+    QList<Ekos::SchedulerEngine::PlanEntry> plan;
+    QBENCHMARK
+    {
+        SchedulerEphemeris::Instance()->clear();
+        resetJobs(jobs);
+
+        // The engine is meant to run away from the user interface
+        plan = QtConcurrent::run([&]()
+        {
+            return engine.simulateNight(jobs, from, until);
+        }).result();
+    }
+
+    // Jobs run one after the other, within the simulated night
+    for (int i = 0; i < plan.size(); i++)
+    {
+        Ekos::SchedulerEngine::PlanEntry const &entry = plan.at(i);
+        qInfo("%-12s %s - %s score %+5d %s", qPrintable(entry.name),
+              qPrintable(entry.startup.toString("yyyy-MM-dd hh:mm:ss")),
+              qPrintable(entry.completion.toString("yyyy-MM-dd hh:mm:ss")), entry.score,
+              entry.complete ? "complete" : "interrupted");
+
+        QVERIFY(from <= entry.startup);
+        QVERIFY(entry.startup <= entry.completion);
+        QVERIFY(entry.completion <= until);
+        if (0 < i)
+            QVERIFY(plan.at(i - 1).completion <= entry.startup);
+    }
+
+    qDeleteAll(jobs);
+}
+
+QTEST_MAIN(TestSchedulerBenchmark)
@@ -0,0 +1,45 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTSCHEDULERBENCHMARK_H
+#define TESTSCHEDULERBENCHMARK_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class SchedulerJob;
+
+/**
+ * @class TestSchedulerBenchmark
+ * Replays the scheduler test vectors through the scheduler engine, timing the evaluation of the queue and the
+ * simulation of a whole night, and printing the resulting plan.
+ * The night simulated starts on the evening of KSTARS_SCHEDULER_BENCHMARK_DATE (2018-05-07 by default, the date the
+ * test vectors were written for), at the location configured in KStars.
+ * Use "-o results.csv,csv" or "-o results.xml,xml" for machine readable results.
+ */
+class TestSchedulerBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestSchedulerBenchmark(QObject *parent = nullptr);
+
+private:
+    QList<SchedulerJob *> loadJobs(const QString &file);
+
+    QTemporaryDir m_Directory;
+
+private slots:
+    void initTestCase();
+
+    void benchmarkEvaluate_data();
+    void benchmarkEvaluate();
+    void benchmarkSimulateNight_data();
+    void benchmarkSimulateNight();
+};
+
+#endif // TESTSCHEDULERBENCHMARK_H
@@ -0,0 +1,161 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testskymapprofiler.h"
+
+#include "auxiliary/dms.h"
+#include "skycomponents/skymapprofiler.h"
+
+#include <QJsonArray>
+#include <QtTest>
+
+void TestSkyMapProfiler::init()
+{
+    SkyMapProfiler::Instance()->setEnabled(true);
+    SkyMapProfiler::Instance()->clear();
+}
+
+void TestSkyMapProfiler::cleanupTestCase()
+{
+    SkyMapProfiler::Instance()->setEnabled(false);
+}
+
+void TestSkyMapProfiler::disabled()
+{
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    profiler->setEnabled(false);
+
+    profiler->begin(SkyMapProfiler::DRAW);
+    profiler->section("Stars");
+    profiler->addObjects(10);
+    profiler->end();
+
+    QVERIFY(profiler->frames().isEmpty());
+    QVERIFY(!dms::isTrigCounting());
+}
+
+void TestSkyMapProfiler::sections()
+{
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+
+    profiler->begin(SkyMapProfiler::UPDATE);
+    profiler->section("Solar system");
+    profiler->section("Satellites");
+    profiler->addCacheLookups(1, 2);
+    profiler->end();
+
+    profiler->begin(SkyMapProfiler::DRAW);
+    profiler->section("Stars");
+    profiler->addObjects(10);
+    profiler->addCacheLookups(3, 1);
+    profiler->section("Solar system");
+    profiler->addObjects(2);
+    // Drawing a component again adds to its first section
+    profiler->section("Stars");
+    profiler->addObjects(5);
+    profiler->end();
+
+    // Nothing is counted outside of a section
+    profiler->addObjects(100);
+
+    const QVector<SkyMapProfiler::Frame> frames = profiler->frames();
+    QCOMPARE(frames.size(), 1);
+
+    // Drawn components come first, in order, then the ones only updated
+    const QVector<SkyMapProfiler::Component> &components = frames.first().components;
+    QCOMPARE(components.size(), 3);
+    QCOMPARE(components[0].name, QString("Stars"));
+    QCOMPARE(components[0].objects, quint64(15));
+    QCOMPARE(components[0].cacheHits, quint64(3));
+    QCOMPARE(components[0].cacheMisses, quint64(1));
+    QCOMPARE(components[1].name, QString("Solar system"));
+    QCOMPARE(components[1].objects, quint64(2));
+    QCOMPARE(components[2].name, QString("Satellites"));
+    QCOMPARE(components[2].objects, quint64(0));
+    QCOMPARE(components[2].cacheHits, quint64(1));
+    QCOMPARE(components[2].cacheMisses, quint64(2));
+    QCOMPARE(components[2].drawTime, 0.0);
+
+    // Updates are reported with the next frame only
+    profiler->begin(SkyMapProfiler::DRAW);
+    profiler->section("Stars");
+    profiler->end();
+    QCOMPARE(profiler->frames(1).first().components.size(), 1);
+}
+
+void TestSkyMapProfiler::trigCalls()
+{
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    const dms angle(30.0);
+    double s = 0, c = 0;
+
+    profiler->begin(SkyMapProfiler::DRAW);
+    QVERIFY(dms::isTrigCounting());
+    profiler->section("Grid");
+    angle.SinCos(s, c);
+    s = angle.sin();
+    profiler->end();
+
+    QCOMPARE(profiler->frames().first().components.first().trigCalls, quint64(3));
+    QCOMPARE(s, std::sin(30.0 * dms::DegToRad));
+}
+
+void TestSkyMapProfiler::ringBuffer()
+{
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+
+    // Far more frames than kept, each one telling its number by its objects
+    for (int i = 0; i < 1000; ++i)
+    {
+        profiler->begin(SkyMapProfiler::DRAW);
+        profiler->section("Stars");
+        profiler->addObjects(i);
+        profiler->end();
+    }
+
+    const QVector<SkyMapProfiler::Frame> all = profiler->frames();
+    QVERIFY(all.size() > 0 && all.size() < 1000);
+    for (int i = 0; i < all.size(); ++i)
+        QCOMPARE(all[i].components.first().objects, quint64(1000 - all.size() + i));
+
+    const QVector<SkyMapProfiler::Frame> last = profiler->frames(3);
+    QCOMPARE(last.size(), 3);
+    QCOMPARE(last.last().components.first().objects, quint64(999));
+
+    QCOMPARE(profiler->average(3).components.first().objects, quint64(998));
+}
+
+void TestSkyMapProfiler::json()
+{
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+
+    for (int i = 0; i < 4; ++i)
+    {
+        profiler->begin(SkyMapProfiler::DRAW);
+        profiler->section("Deep sky");
+        profiler->addObjects(7);
+        profiler->end();
+    }
+
+    const QJsonObject profile = profiler->toJson(2);
+    QVERIFY(profile["enabled"].toBool());
+
+    const QJsonArray frames = profile["frames"].toArray();
+    QCOMPARE(frames.size(), 2);
+
+    const QJsonObject component = frames.first().toObject()["components"].toArray().first().toObject();
+    QCOMPARE(component["name"].toString(), QString("Deep sky"));
+    QCOMPARE(component["objects"].toInt(), 7);
+    QVERIFY(component.contains("drawMs"));
+    QVERIFY(component.contains("updateMs"));
+    QVERIFY(component.contains("trigCalls"));
+    QVERIFY(component.contains("cacheHits"));
+    QVERIFY(component.contains("cacheMisses"));
+}
+
+QTEST_GUILESS_MAIN(TestSkyMapProfiler)
@@ -0,0 +1,34 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestSkyMapProfiler
+ * @short Tests for SkyMapProfiler, the sections of a frame, its ring buffer and JSON export
+ */
+class TestSkyMapProfiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestSkyMapProfiler() = default;
+    ~TestSkyMapProfiler() override = default;
+
+  private slots:
+    void init();
+    void cleanupTestCase();
+
+    void disabled();
+    void sections();
+    void trigCalls();
+    void ringBuffer();
+    void json();
+};
@@ -0,0 +1,137 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testskyobjectnameindex.h"
+
+#include <QtTest>
+
+void TestSkyObjectNameIndex::add(int type, const QString &name)
+{
+    m_Objects.emplace_back(new SkyObject(type, 0.0, 0.0, 0.0, name));
+    m_Lists[type].append(qMakePair(name, static_cast<const SkyObject *>(m_Objects.back().get())));
+}
+
+QStringList TestSkyObjectNameIndex::names(const SkyObjectNameIndex::NameList &found) const
+{
+    QStringList result;
+    for (const auto &name : found)
+        result.append(name.first);
+    return result;
+}
+
+void TestSkyObjectNameIndex::init()
+{
+    m_Lists.clear();
+    m_Objects.clear();
+
+    add(SkyObject::GALAXY, "M 31");
+    add(SkyObject::GALAXY, "Andromeda Galaxy");
+    add(SkyObject::GALAXY, "M 33");
+    add(SkyObject::STAR, "Aldebaran");
+    add(SkyObject::STAR, "Altair");
+    add(SkyObject::ASTEROID, "Aaltje");
+    add(SkyObject::ASTEROID, "andromache");
+}
+
+void TestSkyObjectNameIndex::findExact()
+{
+    SkyObjectNameIndex index(m_Lists);
+
+    const SkyObjectNameIndex::NameList found = index.find("Altair");
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found.first().second->name(), QString("Altair"));
+    QCOMPARE(found.first().second->type(), int(SkyObject::STAR));
+
+    // Lookups by name are exact, only prefix lookups ignore case
+    QVERIFY(index.find("altair").isEmpty());
+    QVERIFY(index.find("Alta").isEmpty());
+}
+
+void TestSkyObjectNameIndex::findPrefix()
+{
+    SkyObjectNameIndex index(m_Lists);
+
+    QCOMPARE(names(index.findPrefix("m 3")), QStringList({ "M 31", "M 33" }));
+    QCOMPARE(names(index.findPrefix("AND")), QStringList({ "andromache", "Andromeda Galaxy" }));
+    QCOMPARE(names(index.findPrefix("al")), QStringList({ "Aldebaran", "Altair" }));
+    QVERIFY(index.findPrefix("x").isEmpty());
+    QCOMPARE(index.findPrefix(QString()).size(), 7);
+}
+
+void TestSkyObjectNameIndex::findPrefixByType()
+{
+    SkyObjectNameIndex index(m_Lists);
+
+    QCOMPARE(names(index.findPrefix("a", { SkyObject::STAR })), QStringList({ "Aldebaran", "Altair" }));
+    QCOMPARE(names(index.findPrefix("a", { SkyObject::ASTEROID, SkyObject::GALAXY })),
+             QStringList({ "Aaltje", "andromache", "Andromeda Galaxy" }));
+    QVERIFY(index.findPrefix("a", { SkyObject::COMET }).isEmpty());
+}
+
+void TestSkyObjectNameIndex::findPrefixLimit()
+{
+    SkyObjectNameIndex index(m_Lists);
+
+    QCOMPARE(names(index.findPrefix("a", QList<int>(), 2)), QStringList({ "Aaltje", "Aldebaran" }));
+    QVERIFY(index.findPrefix("a", QList<int>(), 0).isEmpty());
+}
+
+void TestSkyObjectNameIndex::followAppends()
+{
+    SkyObjectNameIndex index(m_Lists);
+    QCOMPARE(index.findPrefix("m").size(), 2);
+
+    add(SkyObject::GALAXY, "M 32");
+    add(SkyObject::COMET, "Machholz");
+
+    QCOMPARE(names(index.findPrefix("m")), QStringList({ "M 31", "M 32", "M 33", "Machholz" }));
+    QCOMPARE(index.find("M 32").size(), 1);
+}
+
+void TestSkyObjectNameIndex::followRemovals()
+{
+    SkyObjectNameIndex index(m_Lists);
+    QCOMPARE(index.find("M 33").size(), 1);
+
+    m_Lists[SkyObject::GALAXY].removeLast();
+    QVERIFY(index.find("M 33").isEmpty());
+
+    // Same size as before, but not the same names, which the owner of the list reports
+    m_Lists[SkyObject::GALAXY].removeFirst();
+    add(SkyObject::GALAXY, "M 110");
+    add(SkyObject::GALAXY, "M 101");
+    index.invalidate(SkyObject::GALAXY);
+    QVERIFY(index.find("M 31").isEmpty());
+    QCOMPARE(names(index.findPrefix("m 1")), QStringList({ "M 101", "M 110" }));
+
+    m_Lists[SkyObject::STAR].clear();
+    QVERIFY(index.findPrefix("al").isEmpty());
+}
+
+void TestSkyObjectNameIndex::followChanges()
+{
+    SkyObjectNameIndex index(m_Lists);
+    add(SkyObject::GALAXY, "M 101");
+    QCOMPARE(index.find("M 33").size(), 1);
+
+    // Renamed in the middle of the list, first and last names unchanged
+    m_Lists[SkyObject::GALAXY][1].first = "NGC 224";
+    index.invalidate(SkyObject::GALAXY);
+    QVERIFY(index.find("Andromeda Galaxy").isEmpty());
+    QCOMPARE(index.find("NGC 224").size(), 1);
+
+    // Swapped in the middle of the list, the names must still lead to their objects
+    std::swap(m_Lists[SkyObject::GALAXY][1], m_Lists[SkyObject::GALAXY][2]);
+    index.invalidate(SkyObject::GALAXY);
+    const SkyObjectNameIndex::NameList found = index.find("M 33");
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found.first().second->name(), QString("M 33"));
+    QCOMPARE(names(index.findPrefix("n")), QStringList({ "NGC 224" }));
+}
+
+QTEST_GUILESS_MAIN(TestSkyObjectNameIndex)
@@ -0,0 +1,48 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include "skycomponents/skyobjectnameindex.h"
+#include "skyobjects/skyobject.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * @class TestSkyObjectNameIndex
+ * @short Tests for SkyObjectNameIndex, also as the name lists change under it
+ */
+class TestSkyObjectNameIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestSkyObjectNameIndex() = default;
+    ~TestSkyObjectNameIndex() override = default;
+
+  private:
+    void add(int type, const QString &name);
+    QStringList names(const SkyObjectNameIndex::NameList &found) const;
+
+    QHash<int, SkyObjectNameIndex::NameList> m_Lists;
+    std::vector<std::unique_ptr<SkyObject>> m_Objects;
+
+  private slots:
+    void init();
+
+    void findExact();
+    void findPrefix();
+    void findPrefixByType();
+    void findPrefixLimit();
+    void followAppends();
+    void followRemovals();
+    void followChanges();
+};
@@ -0,0 +1,120 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "teststarblock.h"
+
+#include "ksnumbers.h"
+#include "kstarsdatetime.h"
+#include "skycomponents/starblock.h"
+#include "skyobjects/stardata.h"
+#include "skyobjects/starobject.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+namespace
+{
+struct Star
+{
+    double ra;    // hours
+    double dec;   // degrees
+    double pmRA;  // mas/yr
+    double pmDec; // mas/yr
+};
+
+// From a star without proper motion to Barnard's star, close to the pole and across RA 0h
+const Star stars[] =
+{
+    { 5.9195, 7.4071, 0, 0 },
+    { 17.9634, 4.6934, -798.6, 10328.1 },
+    { 2.5303, 89.2641, 44.2, -11.7 },
+    { 23.9950, -45.0, 5000.0, -3000.0 },
+    { 0.0050, -89.5, -1200.0, 800.0 },
+};
+
+StarData starData(const Star &star)
+{
+    StarData data;
+    data.RA   = static_cast<qint32>(std::lround(star.ra * 1000000.0));
+    data.Dec  = static_cast<qint32>(std::lround(star.dec * 100000.0));
+    data.dRA  = static_cast<qint32>(std::lround(star.pmRA * 10.0));
+    data.dDec = static_cast<qint32>(std::lround(star.pmDec * 10.0));
+    data.mag  = 500;
+    data.spec_type[0] = 'G';
+    data.spec_type[1] = '2';
+    return data;
+}
+}
+
+void TestStarBlock::precessStars_data()
+{
+    QTest::addColumn<double>("years");
+
+    QTest::newRow("J2000") << 0.0;
+    QTest::newRow("J2025") << 25.0;
+    QTest::newRow("J1900") << -100.0;
+    QTest::newRow("J4000") << 2000.0;
+    QTest::newRow("-8000") << -10000.0;
+}
+
+void TestStarBlock::precessStars()
+{
+    QFETCH(double, years);
+
+    const int count = sizeof(stars) / sizeof(stars[0]);
+    StarBlock block(count);
+    for (const Star &star : stars)
+        QVERIFY(block.addStar(starData(star)) != nullptr);
+
+    const KSNumbers num(J2000 + years * 365.25);
+    double x[count], y[count], z[count];
+    block.precessStars(&num, 0, count, x, y, z);
+
+    for (int i = 0; i < count; ++i)
+    {
+        // Single star path: proper motion, then precession from J2000
+        double ra, dec;
+        block.star(i)->getIndexCoords(&num, &ra, &dec);
+        SkyPoint expected;
+        expected.setRA0(ra / 15.0);
+        expected.setDec0(dec);
+        expected.precessFromAnyEpoch(J2000, num.julianDay());
+
+        QVERIFY(std::abs(std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) - 1) < 1e-12);
+
+        // Compare positions as an angle, RA is meaningless at the poles
+        const SkyPoint batch(dms(atan2(y[i], x[i]) / dms::DegToRad), dms(asin(z[i]) / dms::DegToRad));
+        const double separation = batch.angularDistanceTo(&expected).Degrees() * 3600.0;
+        QVERIFY2(separation < 1e-4, qPrintable(QString("Star %1 is %2\" away").arg(i).arg(separation)));
+    }
+}
+
+void TestStarBlock::precessRange()
+{
+    const int count = sizeof(stars) / sizeof(stars[0]);
+    StarBlock block(count);
+    for (const Star &star : stars)
+        block.addStar(starData(star));
+
+    const KSNumbers num(J2000 + 500 * 365.25);
+    double x[count], y[count], z[count];
+    block.precessStars(&num, 0, count, x, y, z);
+
+    // A range writes its first star at index 0
+    double xr[2], yr[2], zr[2];
+    block.precessStars(&num, 2, 4, xr, yr, zr);
+    for (int i = 0; i < 2; ++i)
+    {
+        QCOMPARE(xr[i], x[i + 2]);
+        QCOMPARE(yr[i], y[i + 2]);
+        QCOMPARE(zr[i], z[i + 2]);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestStarBlock)
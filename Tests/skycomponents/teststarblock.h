@@ -0,0 +1,29 @@
+/*  KStars tests
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestStarBlock
+ * @short Tests for the batched proper motion and precession of StarBlock against the single star path
+ */
+class TestStarBlock : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestStarBlock() = default;
+    ~TestStarBlock() override = default;
+
+  private slots:
+    void precessStars_data();
+    void precessStars();
+    void precessRange();
+};
@@ -41,7 +41,7 @@ BinFileHelper::~BinFileHelper()
 void BinFileHelper::init()
 {
     if (fileHandle)
-        fclose(fileHandle);
+        closeFile();
 
     fileHandle      = nullptr;
     indexUpdated    = false;
@@ -85,6 +85,7 @@ FILE *BinFileHelper::openFile(const QString &fileName)
 {
     QString FilePath = KSPaths::locate(QStandardPaths::GenericDataLocation, fileName);
     init();
+    filePath             = FilePath;
     QByteArray b         = FilePath.toLatin1();
     const char *filepath = b.data();
 
@@ -287,10 +288,40 @@ bool BinFileHelper::readHeader()
 
 void BinFileHelper::closeFile()
 {
+    if (mappedData)
+    {
+        mappedFile.unmap(mappedData);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+    mappedFile.close();
+
     fclose(fileHandle);
     fileHandle = nullptr;
 }
 
+bool BinFileHelper::mapFile()
+{
+    if (mappedData)
+        return true;
+    if (!fileHandle)
+        return false;
+
+    mappedFile.setFileName(filePath);
+    if (!mappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    mappedSize = mappedFile.size();
+    mappedData = mappedFile.map(0, mappedSize);
+    if (!mappedData)
+    {
+        mappedSize = 0;
+        mappedFile.close();
+        return false;
+    }
+    return true;
+}
+
 int BinFileHelper::getErrorNumber()
 {
     int err = errnum;
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <QFile>
 #include <QString>
 #include <QVector>
 
@@ -81,6 +82,30 @@ class BinFileHelper
      */
     void closeFile();
 
+    /**
+     * @short  Map the open file into memory, so that records can be read in place instead of with fread
+     * @note   The file handle stays open; callers fall back to it when mapping is not possible
+     * @return True if the whole file is mapped, false otherwise
+     */
+    bool mapFile();
+
+    /**
+     * @short  Check whether the open file is mapped into memory
+     * @return True if mapFile() succeeded and the file has not been closed since
+     */
+    inline bool isMapped() const { return mappedData != nullptr; }
+
+    /**
+     * @short  Returns a pointer to the mapped bytes at the given offset
+     * @param  offset Offset in the file in bytes
+     * @param  length Number of bytes the caller is going to read
+     * @return Pointer into the mapping, nullptr if the file is not mapped or the range lies past its end
+     */
+    inline const uchar *mappedAt(quint64 offset, quint64 length) const
+    {
+        return (mappedData && offset + length <= mappedSize) ? mappedData + offset : nullptr;
+    }
+
     /**
      * @short   Get error number
      * @return  A number corresponding to the error
@@ -241,6 +266,14 @@ class BinFileHelper
 
     /// Handle to the file.
     FILE *fileHandle { nullptr};
+    /// Full path of the open file
+    QString filePath;
+    /// File backing the memory mapping
+    QFile mappedFile;
+    /// Start of the memory mapped file, nullptr if the file is not mapped
+    uchar *mappedData { nullptr };
+    /// Size of the memory mapped file in bytes
+    quint64 mappedSize { 0 };
     /// Stores offsets corresponding to each index table entry
     QVector<unsigned long> indexOffset;
     /// Stores number of records under each index table entry
@@ -21,6 +21,9 @@
 
 #include <QRegExp>
 
+std::atomic<bool> dms::trig_counting { false };
+std::atomic<unsigned long> dms::trig_call_count { 0 };
+
 #ifdef COUNT_DMS_SINCOS_CALLS
 long unsigned dms::dms_constructor_calls         = 0;
 long unsigned dms::dms_with_sincos_called        = 0;
@@ -22,6 +22,7 @@
 #include <QString>
 #include <QDataStream>
 
+#include <atomic>
 #include <cmath>
 
 //#define COUNT_DMS_SINCOS_CALLS true
@@ -268,6 +269,7 @@ class dms
          */
     double sin() const
     {
+        countTrigCalls(1);
 #ifdef COUNT_DMS_SINCOS_CALLS
         if (!m_sinCosCalled)
         {
@@ -300,6 +302,7 @@ class dms
          */
     double cos() const
     {
+        countTrigCalls(1);
 #ifdef COUNT_DMS_SINCOS_CALLS
         if (!m_sinCosCalled)
         {
@@ -412,6 +415,17 @@ class dms
     static dms fromString(const QString &s, bool deg);
 
     inline dms operator-() { return dms(-D); }
+
+    /** @short Start or stop counting the trig functions computed, for profiling at runtime.
+         *
+         * Unlike COUNT_DMS_SINCOS_CALLS this needs no rebuild, but every sin(), cos() and SinCos()
+         * call costs an atomic increment while counting, so leave it off otherwise.
+         */
+    static void setTrigCounting(bool enabled) { trig_counting.store(enabled, std::memory_order_relaxed); }
+    static bool isTrigCounting() { return trig_counting.load(std::memory_order_relaxed); }
+    /** @return the number of trig functions computed by all threads while counting was on */
+    static unsigned long trigCallCount() { return trig_call_count.load(std::memory_order_relaxed); }
+
 #ifdef COUNT_DMS_SINCOS_CALLS
     static long unsigned dms_constructor_calls; // counts number of DMS constructor calls
     static long unsigned dms_with_sincos_called;
@@ -424,6 +438,15 @@ class dms
     double D;
 
   private:
+    static inline void countTrigCalls(unsigned long count)
+    {
+        if (trig_counting.load(std::memory_order_relaxed))
+            trig_call_count.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static std::atomic<bool> trig_counting;
+    static std::atomic<unsigned long> trig_call_count;
+
 #ifdef COUNT_DMS_SINCOS_CALLS
     mutable bool m_sinDirty, m_cosDirty, m_sinCosCalled;
 #endif
@@ -449,6 +472,8 @@ inline dms operator-(dms a, dms b)
 // Inline sincos
 inline void dms::SinCos(double &s, double &c) const
 {
+    countTrigCalls(2);
+
 #ifdef PROFILE_SINCOS
     std::clock_t start, stop;
     start = std::clock();
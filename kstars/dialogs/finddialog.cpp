@@ -39,6 +39,8 @@
 #include <QComboBox>
 #include <QLineEdit>
 
+#include <algorithm>
+
 FindDialog * FindDialog::m_Instance = nullptr;
 
 FindDialogUI::FindDialogUI(QWidget *parent) : QFrame(parent)
@@ -227,107 +229,91 @@ void FindDialog::initSelection()
     listFiltered = true;
 }
 
-void FindDialog::filterByType()
+QList<int> FindDialog::selectedTypes() const
 {
-    KStarsData *data = KStarsData::Instance();
-
     switch (ui->FilterType->currentIndex())
     {
-        case 0: // All object types
-        {
-            QVector<QPair<QString, const SkyObject *>> allObjects;
-            foreach (int type, data->skyComposite()->objectLists().keys())
-            {
-                allObjects.append(data->skyComposite()->objectLists(SkyObject::TYPE(type)));
-            }
-            fModel->setSkyObjectsList(allObjects);
-            break;
-        }
         case 1: //Stars
-        {
-            QVector<QPair<QString, const SkyObject *>> starObjects;
-            starObjects.append(data->skyComposite()->objectLists(SkyObject::STAR));
-            starObjects.append(data->skyComposite()->objectLists(SkyObject::CATALOG_STAR));
-            fModel->setSkyObjectsList(starObjects);
-            break;
-        }
+            return { SkyObject::STAR, SkyObject::CATALOG_STAR };
         case 2: //Solar system
-        {
-            QVector<QPair<QString, const SkyObject *>> ssObjects;
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::PLANET));
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::COMET));
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::ASTEROID));
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::MOON));
-
-            fModel->setSkyObjectsList(ssObjects);
-            break;
-        }
+            return { SkyObject::PLANET, SkyObject::COMET, SkyObject::ASTEROID, SkyObject::MOON };
         case 3: //Open Clusters
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::OPEN_CLUSTER));
-            break;
+            return { SkyObject::OPEN_CLUSTER };
         case 4: //Globular Clusters
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::GLOBULAR_CLUSTER));
-            break;
+            return { SkyObject::GLOBULAR_CLUSTER };
         case 5: //Gaseous nebulae
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::GASEOUS_NEBULA));
-            break;
+            return { SkyObject::GASEOUS_NEBULA };
         case 6: //Planetary nebula
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::PLANETARY_NEBULA));
-            break;
+            return { SkyObject::PLANETARY_NEBULA };
         case 7: //Galaxies
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::GALAXY));
-            break;
+            return { SkyObject::GALAXY };
         case 8: //Comets
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::COMET));
-            break;
+            return { SkyObject::COMET };
         case 9: //Asteroids
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::ASTEROID));
-            break;
+            return { SkyObject::ASTEROID };
         case 10: //Constellations
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::CONSTELLATION));
-            break;
+            return { SkyObject::CONSTELLATION };
         case 11: //Supernovae
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::SUPERNOVA));
-            break;
+            return { SkyObject::SUPERNOVA };
         case 12: //Satellites
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::SATELLITE));
-            break;
+            return { SkyObject::SATELLITE };
+        default: // All object types
+            return QList<int>();
     }
 }
 
+void FindDialog::filterByType()
+{
+    KStarsData *data = KStarsData::Instance();
+
+    QList<int> types = selectedTypes();
+    if (types.isEmpty())
+        types = data->skyComposite()->objectLists().keys();
+
+    QVector<QPair<QString, const SkyObject *>> objects;
+    for (int type : types)
+        objects.append(data->skyComposite()->objectLists(SkyObject::TYPE(type)));
+    fModel->setSkyObjectsList(objects);
+}
+
 void FindDialog::filterList()
 {
     QString SearchText = processSearchText();
-    sortModel->setFilterFixedString(SearchText);
     ui->InternetSearchButton->setText(i18n("or search the Internet for %1", SearchText));
-    filterByType();
-    initSelection();
 
-    //Select the first item in the list that begins with the filter string
-    if (!SearchText.isEmpty())
+    if (SearchText.isEmpty())
     {
-        QStringList mItems = fModel->filter(QRegExp('^' + SearchText, Qt::CaseInsensitive));
-        mItems.sort();
+        filterByType();
+        initSelection();
+        ui->InternetSearchButton->setEnabled(false);
+        listFiltered = true;
+        return;
+    }
 
-        if (mItems.size())
-        {
-            QModelIndex qmi        = fModel->index(fModel->indexOf(mItems[0]));
-            QModelIndex selectItem = sortModel->mapFromSource(qmi);
+    // Only the objects whose names begin with the search text, from the name index
+    const QVector<QPair<QString, const SkyObject *>> matches =
+        KStarsData::Instance()->skyComposite()->findByNamePrefix(SearchText, selectedTypes());
+    fModel->setSkyObjectsList(matches);
+    initSelection();
 
-            if (selectItem.isValid())
-            {
-                ui->SearchList->selectionModel()->select(selectItem, QItemSelectionModel::ClearAndSelect);
-                ui->SearchList->scrollTo(selectItem);
-                ui->SearchList->setCurrentIndex(selectItem);
+    //Select the first item in the list, which begins with the filter string as all of them do
+    QModelIndex selectItem = sortModel->index(0, 0);
+    if (selectItem.isValid())
+    {
+        ui->SearchList->selectionModel()->select(selectItem, QItemSelectionModel::ClearAndSelect);
+        ui->SearchList->scrollTo(selectItem);
+        ui->SearchList->setCurrentIndex(selectItem);
 
-                okB->setEnabled(true);
-            }
-        }
-        ui->InternetSearchButton->setEnabled(!mItems.contains(
-                SearchText)); // Disable searching the internet when an exact match for SearchText exists in KStars
+        okB->setEnabled(true);
     }
-    else
-        ui->InternetSearchButton->setEnabled(false);
+
+    // Disable searching the internet when an exact match for SearchText exists in KStars
+    const bool exactMatch = std::any_of(matches.constBegin(), matches.constEnd(),
+                                        [&SearchText](const QPair<QString, const SkyObject *> &match)
+    {
+        return match.first == SearchText;
+    });
+    ui->InternetSearchButton->setEnabled(!exactMatch);
 
     listFiltered = true;
 }
@@ -353,7 +339,8 @@ void FindDialog::enqueueSearch()
         timer->setSingleShot(true);
         connect(timer, SIGNAL(timeout()), this, SLOT(filterList()));
     }
-    timer->start(500);
+    // Lookups go through the name index and are quick, just wait for a pause in typing
+    timer->start(150);
 }
 
 // Process the search box text to replace equivalent names like "m93" with "m 93"
@@ -65,6 +65,7 @@ class FindDialog : public QDialog
     /**
      * When Text is entered in the QLineEdit, filter the List of objects
      * so that only objects which start with the filter text are shown.
+     * The matching names are looked up in the name index of SkyMapComposite.
      */
     void filterList();
 
@@ -127,6 +128,9 @@ class FindDialog : public QDialog
     /** @short pre-filter the list of objects according to the selected object type. */
     void filterByType();
 
+    /** @return the object types selected in the type filter, or an empty list for all of them. */
+    QList<int> selectedTypes() const;
+
     FindDialogUI *ui { nullptr };
     SkyObjectListModel *fModel { nullptr };
     QSortFilterProxyModel *sortModel { nullptr };
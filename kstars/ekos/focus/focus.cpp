@@ -3066,6 +3066,13 @@ void Focus::showFITSViewer()
     FITSData *data = focusView->getImageData();
     if (data)
     {
+        // Frames are loaded straight from the camera buffer, their file is only written when it is asked for
+        if (!QFile::exists(data->filename()) && !data->saveImage(data->filename()))
+        {
+            appendLogText(i18n("Failed to save %1 for the FITS Viewer.", data->filename()));
+            return;
+        }
+
         QUrl url = QUrl::fromLocalFile(data->filename());
 
         if (fv.isNull())
@@ -29,6 +29,8 @@
 
 #include <KConfigDialog>
 
+#include <QJsonDocument>
+
 #include <basedevice.h>
 #include <ekos_guide_debug.h>
 
@@ -2082,6 +2084,7 @@ bool Guide::setGuiderType(int type)
                     SLOT(sendPulse(GuideDirection, int, GuideDirection, int)));
             connect(internalGuider, SIGNAL(DESwapChanged(bool)), swapCheck, SLOT(setChecked(bool)));
             connect(internalGuider, SIGNAL(newStarPixmap(QPixmap &)), this, SIGNAL(newStarPixmap(QPixmap &)));
+            connect(internalGuider, SIGNAL(newLatency()), this, SLOT(updateLatency()));
 
             guider = internalGuider;
 
@@ -2650,6 +2653,43 @@ QList<double> Guide::axisSigma()
     return sigma;
 }
 
+QString Guide::getLatency()
+{
+    if (guiderType != GUIDE_INTERNAL || internalGuider.isNull())
+        return QString("{}");
+
+    return QJsonDocument(internalGuider->getLatency().toJson()).toJson(QJsonDocument::Compact);
+}
+
+void Guide::updateLatency()
+{
+    GuideLatency const &latency = internalGuider->getLatency();
+
+    // Nothing measured yet in this guiding session
+    if (latency.frameCount() == 0)
+    {
+        l_Latency->setText("-");
+        l_Latency->setToolTip(QString());
+        return;
+    }
+
+    // Median and worst case of the whole loop, details per stage in the tooltip
+    l_Latency->setText(QString("%1 / %2").arg(QString::number(latency.percentile(GuideLatency::TOTAL, 50), 'f', 0),
+                       QString::number(latency.percentile(GuideLatency::TOTAL, 99), 'f', 0)));
+
+    QStringList lines;
+    lines << i18n("Guide loop latency over the last %1 frames, in milliseconds (median / 90% / 99%):", latency.frameCount());
+    for (int i = 0; i < GuideLatency::INTERVAL_COUNT; i++)
+    {
+        GuideLatency::Interval const interval = static_cast<GuideLatency::Interval>(i);
+        lines << QString("%1: %2 / %3 / %4").arg(GuideLatency::intervalName(interval),
+                QString::number(latency.percentile(interval, 50), 'f', 1),
+                QString::number(latency.percentile(interval, 90), 'f', 1),
+                QString::number(latency.percentile(interval, 99), 'f', 1));
+    }
+    l_Latency->setToolTip(lines.join('\n'));
+}
+
 void Guide::setAxisPulse(double ra, double de)
 {
     l_PulseRA->setText(QString::number(static_cast<int>(ra)));
@@ -3086,6 +3126,13 @@ void Guide::showFITSViewer()
     FITSData *data = guideView->getImageData();
     if (data)
     {
+        // Frames are loaded straight from the camera buffer, their file is only written when it is asked for
+        if (!QFile::exists(data->filename()) && !data->saveImage(data->filename()))
+        {
+            appendLogText(i18n("Failed to save %1 for the FITS Viewer.", data->filename()));
+            return;
+        }
+
         QUrl url = QUrl::fromLocalFile(data->filename());
 
         if (fv.isNull())
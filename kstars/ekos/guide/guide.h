@@ -320,6 +320,13 @@ class Guide : public QWidget, public Ui::Guide
          */
         Q_SCRIPTABLE QList<double> axisSigma();
 
+        /** DBUS interface function.
+         * @brief getLatency returns the latency of the stages of the guide loop, from the guide frame being received to
+         * the guide pulse being sent, over the last guide frames. Only the internal guider is measured.
+         * @return JSON with the number of frames, and for each stage the last duration and percentiles in milliseconds.
+         */
+        Q_SCRIPTABLE QString getLatency();
+
         /**
               * @brief checkCCD Check all CCD parameters and ensure all variables are updated to reflect the selected CCD
               * @param ccdNum CCD index number in the CCD selection combo box
@@ -461,6 +468,7 @@ class Guide : public QWidget, public Ui::Guide
         void setAxisDelta(double ra, double de);
         void setAxisSigma(double ra, double de);
         void setAxisPulse(double ra, double de);
+        void updateLatency();
         void calibrationUpdate(GuideInterface::CalibrationUpdateType type, const QString &message = QString(""), double dx = 0,
                                double dy = 0);
 
@@ -99,11 +99,6 @@ cgmath::~cgmath()
 {
     delete[] drift[GUIDE_RA];
     delete[] drift[GUIDE_DEC];
-
-    foreach (float *region, referenceRegions)
-        delete[] region;
-
-    referenceRegions.clear();
 }
 
 bool cgmath::setVideoParameters(int vid_wd, int vid_ht, int binX, int binY)
@@ -544,12 +539,7 @@ void cgmath::start(void)
     // Create reference Image
     if (imageGuideEnabled)
     {
-        foreach (float *region, referenceRegions)
-            delete[] region;
-
-        referenceRegions.clear();
-
-        referenceRegions = partitionImage();
+        referenceRegions = partitionImage(referenceFrame);
 
         reticle_pos = Vector(0, 0, 0);
     }
@@ -580,146 +570,18 @@ void cgmath::setLostStar(bool is_lost)
     lost_star = is_lost;
 }
 
-float *cgmath::createFloatImage(FITSData *target) const
-{
-    FITSData *imageData = target;
-    if (imageData == nullptr)
-        imageData = guideView->getImageData();
-
-    // #1 Convert to float array
-    // We only process 1st plane if it is a color image
-    uint32_t imgSize = imageData->width() * imageData->height();
-    float *imgFloat  = new float[imgSize];
-
-    if (imgFloat == nullptr)
-    {
-        qCritical() << "Not enough memory for float image array!";
-        return nullptr;
-    }
-
-    switch (imageData->property("dataType").toInt())
-    {
-        case TBYTE:
-        {
-            uint8_t const *buffer = imageData->getImageBuffer();
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TSHORT:
-        {
-            int16_t const *buffer = reinterpret_cast<int16_t const *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TUSHORT:
-        {
-            uint16_t const *buffer = reinterpret_cast<uint16_t const*>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TLONG:
-        {
-            int32_t const *buffer = reinterpret_cast<int32_t const*>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TULONG:
-        {
-            uint32_t const *buffer = reinterpret_cast<uint32_t const*>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TFLOAT:
-        {
-            float const *buffer = reinterpret_cast<float const*>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TLONGLONG:
-        {
-            int64_t const *buffer = reinterpret_cast<int64_t const*>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        case TDOUBLE:
-        {
-            double const *buffer = reinterpret_cast<double const*>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
-
-        default:
-            delete[] imgFloat;
-            return nullptr;
-    }
-
-    return imgFloat;
-}
-
-QVector<float *> cgmath::partitionImage() const
+QVector<GuideFrameBuffer::View> cgmath::partitionImage(GuideFrameBuffer &buffer) const
 {
-    QVector<float *> regions;
-
     FITSData *imageData = guideView->getImageData();
 
-    float *imgFloat = createFloatImage();
-
-    if (imgFloat == nullptr)
-        return regions;
-
-    const uint16_t width  = imageData->width();
-    const uint16_t height = imageData->height();
-
-    uint8_t xRegions = floor(width / regionAxis);
-    uint8_t yRegions = floor(height / regionAxis);
-    // Find number of regions to divide the image
-    //uint8_t regions =  xRegions * yRegions;
-
-    float *regionPtr = imgFloat;
+    // Only the part of the image covered by whole regions is converted
+    const int width  = imageData->width() / regionAxis * regionAxis;
+    const int height = imageData->height() / regionAxis * regionAxis;
 
-    for (uint8_t i = 0; i < yRegions; i++)
-    {
-        for (uint8_t j = 0; j < xRegions; j++)
-        {
-            // Allocate space for one region
-            float *oneRegion = new float[regionAxis * regionAxis];
-            // Create points to region and current location of the source image in the desired region
-            float *oneRegionPtr = oneRegion, *imgFloatPtr = regionPtr + j * regionAxis;
-
-            // copy from image to region line by line
-            for (uint32_t line = 0; line < regionAxis; line++)
-            {
-                memcpy(oneRegionPtr, imgFloatPtr, regionAxis);
-                oneRegionPtr += regionAxis;
-                imgFloatPtr += width;
-            }
+    if (width == 0 || height == 0 || !buffer.convert(imageData, QRect(0, 0, width, height)))
+        return QVector<GuideFrameBuffer::View>();
 
-            regions.append(oneRegion);
-        }
-
-        // Move regionPtr block by (width * regionAxis) elements
-        regionPtr += width * regionAxis;
-    }
-
-    // We're done with imgFloat
-    delete[] imgFloat;
-
-    return regions;
+    return buffer.partition(regionAxis);
 }
 
 void cgmath::setRegionAxis(const uint32_t &value)
@@ -749,7 +611,7 @@ Vector cgmath::findLocalStarPosition(void)
         QVector<Vector> shifts;
         float xsum = 0, ysum = 0;
 
-        QVector<float *> imagePartition = partitionImage();
+        QVector<GuideFrameBuffer::View> imagePartition = partitionImage(guideFrame);
 
         if (imagePartition.isEmpty())
         {
@@ -761,18 +623,13 @@ Vector cgmath::findLocalStarPosition(void)
         {
             qWarning() << "Mismatch between reference regions #" << referenceRegions.count()
                        << "and image partition regions #" << imagePartition.count();
-            // Clear memory in case of mis-match
-            foreach (float *region, imagePartition)
-            {
-                delete[] region;
-            }
-
             return Vector(-1, -1, -1);
         }
 
         for (uint8_t i = 0; i < imagePartition.count(); i++)
         {
-            ImageAutoGuiding::ImageAutoGuiding1(referenceRegions[i], imagePartition[i], regionAxis, &xshift, &yshift);
+            ImageAutoGuiding::ImageAutoGuiding1(referenceRegions[i].data, referenceRegions[i].stride, imagePartition[i].data,
+                                                imagePartition[i].stride, regionAxis, &xshift, &yshift);
             Vector shift(xshift, yshift, -1);
             qCDebug(KSTARS_EKOS_GUIDE) << "Region #" << i << ": X-Shift=" << xshift << "Y-Shift=" << yshift;
 
@@ -781,13 +638,6 @@ Vector cgmath::findLocalStarPosition(void)
             shifts.append(shift);
         }
 
-        // Delete partitions
-        foreach (float *region, imagePartition)
-        {
-            delete[] region;
-        }
-        imagePartition.clear();
-
         float average_x = xsum / referenceRegions.count();
         float average_y = ysum / referenceRegions.count();
 
@@ -1315,7 +1165,7 @@ void cgmath::process_axes(void)
     }
 }
 
-void cgmath::performProcessing(GuideLog *logger, bool guiding)
+void cgmath::performProcessing(GuideLog *logger, bool guiding, GuideLatency *latency)
 {
     Vector arc_star_pos, arc_reticle_pos;
 
@@ -1326,6 +1176,9 @@ void cgmath::performProcessing(GuideLog *logger, bool guiding)
     // find guiding star location in
     scr_star_pos = star_pos = findLocalStarPosition();
 
+    if (latency != nullptr)
+        latency->mark(GuideLatency::STAR_DETECTED);
+
     if (star_pos.x == -1 || std::isnan(star_pos.x))
     {
         lost_star = true;
@@ -1680,18 +1533,18 @@ QList<Edge*> cgmath::PSFAutoFind(int extraEdgeAllowance)
     int size = subW * subH;
 
     // convert to floating point
-    float *conv = createFloatImage(smoothed);
-
-    // run the PSF convolution
+    GuideFrameBuffer frame;
+    if (!frame.convert(smoothed))
     {
-        float *tmp = new float[size];
-        memset(tmp, 0, size * sizeof(float));
-        psf_conv(tmp, conv, subW, subH);
-        delete [] conv;
-        // Swap
-        conv = tmp;
+        delete (smoothed);
+        return QList<Edge*>();
     }
 
+    // run the PSF convolution
+    float *conv = new float[size];
+    memset(conv, 0, size * sizeof(float));
+    psf_conv(conv, frame.data(), subW, subH);
+
     enum { CONV_RADIUS = 4 };
     int dw = subW;      // width of the downsampled image
     int dh = subH;     // height of the downsampled image
@@ -24,6 +24,8 @@
 #include <cstdint>
 #include <sys/types.h>
 #include "guidelog.h"
+#include "guidelatency.h"
+#include "guideframebuffer.h"
 #include "starcorrespondence.h"
 #include "fitsviewer/fitssepdetector.h"
 #include "guidestars.h"
@@ -177,7 +179,7 @@ class cgmath : public QObject
         void setLostStar(bool is_lost);
 
         // Main processing function
-        void performProcessing(GuideLog *logger = nullptr, bool guiding = false);
+        void performProcessing(GuideLog *logger = nullptr, bool guiding = false, GuideLatency *latency = nullptr);
 
         // Math
         bool calculateAndSetReticle1D(double start_x, double start_y, double end_x, double end_y, int RATotalPulse = -1);
@@ -206,9 +208,6 @@ class cgmath : public QObject
         template <typename T>
         Vector findLocalStarPosition(void) const;
 
-        // Creates a new float image from the guideView image data. The returned image MUST be deleted later or memory will leak.
-        float *createFloatImage(FITSData *target = nullptr) const;
-
         void do_ticks(void);
         Vector point2arcsec(const Vector &p) const;
         void process_axes(void);
@@ -271,11 +270,15 @@ class cgmath : public QObject
 
         // Image Guide
         bool imageGuideEnabled { false };
-        // Partition guideView image into NxN square regions each of size axis*axis. The returned vector contains pointers to
-        // the newly allocated square images. It MUST be deleted later by delete[] or memory will leak.
-        QVector<float *> partitionImage() const;
+        // Partition guideView image into NxN square regions each of size axis*axis. The image is converted into buffer, and the
+        // returned vector contains views of the square regions in it, valid until the buffer converts another image.
+        QVector<GuideFrameBuffer::View> partitionImage(GuideFrameBuffer &buffer) const;
         uint32_t regionAxis { 64 };
-        QVector<float *> referenceRegions;
+        // Reference image and its regions, the regions of each guide image are compared to
+        GuideFrameBuffer referenceFrame;
+        QVector<GuideFrameBuffer::View> referenceRegions;
+        // Guide image, converted again for each frame into the same storage
+        GuideFrameBuffer guideFrame;
 
         // dithering
         double ditherRate[2];
@@ -0,0 +1,131 @@
+/*  GuideFrameBuffer class.
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "guideframebuffer.h"
+
+#include "fitsviewer/fitsdata.h"
+
+namespace
+{
+// Bytes the storage is aligned to, wide enough for AVX registers
+constexpr uintptr_t ALIGNMENT = 32;
+}
+
+bool GuideFrameBuffer::convert(FITSData *imageData, const QRect &area)
+{
+    if (imageData == nullptr)
+        return false;
+
+    return convert(imageData->getImageBuffer(), imageData->property("dataType").toInt(), imageData->width(),
+                   imageData->height(), area);
+}
+
+bool GuideFrameBuffer::convert(const uint8_t *buffer, int dataType, int imageWidth, int imageHeight, const QRect &area)
+{
+    const QRect image(0, 0, imageWidth, imageHeight);
+    m_Area = area.isEmpty() ? image : area.intersected(image);
+
+    if (buffer == nullptr || m_Area.isEmpty())
+    {
+        m_Area = QRect();
+        return false;
+    }
+
+    // Grow the storage if needed, leaving room to align its start
+    const size_t size = static_cast<size_t>(m_Area.width()) * m_Area.height() + ALIGNMENT / sizeof(float);
+    if (m_Storage.size() < size)
+        m_Storage.resize(size);
+    m_Data = reinterpret_cast<float *>((reinterpret_cast<uintptr_t>(m_Storage.data()) + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+
+    // We only process 1st plane if it is a color image
+    switch (dataType)
+    {
+        case TBYTE:
+            convertRows(buffer, imageWidth);
+            break;
+
+        case TSHORT:
+            convertRows(reinterpret_cast<int16_t const *>(buffer), imageWidth);
+            break;
+
+        case TUSHORT:
+            convertRows(reinterpret_cast<uint16_t const *>(buffer), imageWidth);
+            break;
+
+        case TLONG:
+            convertRows(reinterpret_cast<int32_t const *>(buffer), imageWidth);
+            break;
+
+        case TULONG:
+            convertRows(reinterpret_cast<uint32_t const *>(buffer), imageWidth);
+            break;
+
+        case TFLOAT:
+            convertRows(reinterpret_cast<float const *>(buffer), imageWidth);
+            break;
+
+        case TLONGLONG:
+            convertRows(reinterpret_cast<int64_t const *>(buffer), imageWidth);
+            break;
+
+        case TDOUBLE:
+            convertRows(reinterpret_cast<double const *>(buffer), imageWidth);
+            break;
+
+        default:
+            m_Area = QRect();
+            return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+void GuideFrameBuffer::convertRows(const T *source, int imageWidth)
+{
+    const int width = m_Area.width();
+
+    // Plain loops over contiguous rows, which compilers turn into vector conversions
+    for (int y = 0; y < m_Area.height(); y++)
+    {
+        const T *src = source + static_cast<size_t>(m_Area.top() + y) * imageWidth + m_Area.left();
+        float *dst   = m_Data + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++)
+            dst[x] = src[x];
+    }
+}
+
+GuideFrameBuffer::View GuideFrameBuffer::view(const QRect &rect) const
+{
+    View result;
+    if (rect.isEmpty() || !QRect(QPoint(0, 0), m_Area.size()).contains(rect))
+        return result;
+
+    result.stride = m_Area.width();
+    result.data   = m_Data + rect.top() * result.stride + rect.left();
+    result.width  = rect.width();
+    result.height = rect.height();
+    return result;
+}
+
+QVector<GuideFrameBuffer::View> GuideFrameBuffer::partition(int axis) const
+{
+    QVector<View> regions;
+    if (axis <= 0)
+        return regions;
+
+    const int xRegions = m_Area.width() / axis;
+    const int yRegions = m_Area.height() / axis;
+    regions.reserve(xRegions * yRegions);
+
+    for (int i = 0; i < yRegions; i++)
+        for (int j = 0; j < xRegions; j++)
+            regions.append(view(QRect(j * axis, i * axis, axis, axis)));
+
+    return regions;
+}
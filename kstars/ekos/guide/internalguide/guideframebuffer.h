@@ -0,0 +1,79 @@
+/*  GuideFrameBuffer class.
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QRect>
+#include <QVector>
+
+#include <cstdint>
+#include <vector>
+
+class FITSData;
+
+// Float copy of a guide frame, or of the area of it being processed, kept from one frame to the next.
+// The storage only grows, so that frames of the same subframe never allocate, and starts aligned for the
+// conversion and processing loops to vectorize. Regions are handed out as views into the storage.
+
+class GuideFrameBuffer
+{
+    public:
+        // A square or rectangular part of the converted area, rows are stride floats apart.
+        class View
+        {
+            public:
+                const float *data = nullptr;
+                int width = 0;
+                int height = 0;
+                int stride = 0;
+
+                const float *row(int y) const
+                {
+                    return data + y * stride;
+                }
+        };
+
+        GuideFrameBuffer() = default;
+        // Views point into the storage, which a copy would not share
+        GuideFrameBuffer(const GuideFrameBuffer &) = delete;
+        GuideFrameBuffer &operator=(const GuideFrameBuffer &) = delete;
+
+        // Converts the area of the first plane of the image to float. An empty area converts the whole image.
+        // The area is clipped to the image. Returns false if the data type is not supported.
+        bool convert(FITSData *imageData, const QRect &area = QRect());
+        bool convert(const uint8_t *buffer, int dataType, int imageWidth, int imageHeight, const QRect &area = QRect());
+
+        // Area of the image held by the buffer, in image coordinates.
+        const QRect &area() const
+        {
+            return m_Area;
+        }
+        // Converted pixels, area().width() floats per row.
+        const float *data() const
+        {
+            return m_Data;
+        }
+        float *data()
+        {
+            return m_Data;
+        }
+
+        // Part of the converted area, in coordinates relative to area(). Returns an empty view if it does not fit.
+        View view(const QRect &rect) const;
+
+        // Splits the converted area into as many square regions of axis*axis pixels as it holds, row by row.
+        QVector<View> partition(int axis) const;
+
+    private:
+        template <typename T>
+        void convertRows(const T *source, int imageWidth);
+
+        std::vector<float> m_Storage;
+        float *m_Data = nullptr;
+        QRect m_Area;
+};
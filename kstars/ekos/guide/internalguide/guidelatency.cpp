@@ -0,0 +1,161 @@
+/*  GuideLatency class.
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "guidelatency.h"
+
+#include "fitsviewer/fitsdata.h"
+
+#include <QJsonArray>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+// Frames kept for the percentiles, a minute or two of guiding at usual cadences
+constexpr int MAX_FRAMES = 100;
+
+// Percentiles reported in JSON
+constexpr double PERCENTILES[] = { 50, 90, 99 };
+}
+
+GuideLatency::GuideLatency()
+{
+    std::fill(stamps, stamps + STAGE_COUNT, -1);
+}
+
+qint64 GuideLatency::now()
+{
+    // Same clock as the one CCD stamps guide frames with
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString GuideLatency::intervalName(Interval interval)
+{
+    switch (interval)
+    {
+        case LOAD:
+            return "load";
+        case DELIVERY:
+            return "delivery";
+        case DETECTION:
+            return "detection";
+        case PROCESSING:
+            return "processing";
+        case PULSE:
+            return "pulse";
+        case TOTAL:
+            return "total";
+        default:
+            return QString();
+    }
+}
+
+void GuideLatency::startFrame(const FITSData *imageData)
+{
+    std::fill(stamps, stamps + STAGE_COUNT, -1);
+
+    if (imageData != nullptr)
+    {
+        const QVariant received = imageData->property("blobReceived");
+        const QVariant loaded   = imageData->property("fitsLoaded");
+        // The same frame may be processed again, its stamps only count once
+        if (received.isValid() && loaded.isValid() && received.toLongLong() != lastReceived)
+        {
+            stamps[BLOB_RECEIVED] = received.toLongLong();
+            stamps[FITS_LOADED]   = loaded.toLongLong();
+            lastReceived          = stamps[BLOB_RECEIVED];
+        }
+    }
+
+    stamps[GUIDING_STARTED] = now();
+}
+
+void GuideLatency::mark(Stage stage)
+{
+    mark(stage, now());
+}
+
+void GuideLatency::mark(Stage stage, qint64 time)
+{
+    stamps[stage] = time;
+}
+
+bool GuideLatency::endFrame()
+{
+    // Frames not received from the CCD, or not leading to a pulse, are not kept
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        if (stamps[i] < 0 || (i > 0 && stamps[i] < stamps[i - 1]))
+        {
+            std::fill(stamps, stamps + STAGE_COUNT, -1);
+            return false;
+        }
+    }
+
+    QVector<double> durations(INTERVAL_COUNT);
+    for (int i = LOAD; i < TOTAL; i++)
+        durations[i] = (stamps[i + 1] - stamps[i]) / 1000.0;
+    durations[TOTAL] = (stamps[PULSE_SENT] - stamps[BLOB_RECEIVED]) / 1000.0;
+
+    if (frames.size() < MAX_FRAMES)
+        frames.append(durations);
+    else
+        frames[nextFrame] = durations;
+    nextFrame = (nextFrame + 1) % MAX_FRAMES;
+
+    last = durations;
+    std::fill(stamps, stamps + STAGE_COUNT, -1);
+    return true;
+}
+
+double GuideLatency::percentile(Interval interval, double p) const
+{
+    if (frames.isEmpty())
+        return -1;
+
+    QVector<double> values;
+    values.reserve(frames.size());
+    for (const QVector<double> &frame : frames)
+        values.append(frame[interval]);
+
+    // Nearest rank
+    const int rank = qBound(0, static_cast<int>(std::ceil(p / 100.0 * values.size())) - 1, values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+QJsonObject GuideLatency::toJson() const
+{
+    QJsonObject intervals;
+    for (int i = 0; i < INTERVAL_COUNT; i++)
+    {
+        const Interval interval = static_cast<Interval>(i);
+        QJsonObject stats;
+        if (!last.isEmpty())
+            stats.insert("last", last[i]);
+        for (double p : PERCENTILES)
+            stats.insert(QString("p%1").arg(p), percentile(interval, p));
+        intervals.insert(intervalName(interval), stats);
+    }
+
+    QJsonObject result;
+    result.insert("frames", frames.size());
+    result.insert("intervals", intervals);
+    return result;
+}
+
+void GuideLatency::clear()
+{
+    frames.clear();
+    last.clear();
+    nextFrame = 0;
+    std::fill(stamps, stamps + STAGE_COUNT, -1);
+}
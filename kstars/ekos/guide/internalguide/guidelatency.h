@@ -0,0 +1,94 @@
+/*  GuideLatency class.
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+class FITSData;
+
+// Times the stages of the guide loop, from a guide frame being received to the guide pulse it leads to being sent,
+// and keeps the last frames to report percentiles of each stage.
+//
+// The frame is received and loaded by the CCD, which stamps the FITSData of guide frames with the times, taken with
+// now(), in its "blobReceived" and "fitsLoaded" properties. The guider marks the other stages as it reaches them.
+
+class GuideLatency
+{
+    public:
+        // Points in time of a guide frame, in the order they are reached.
+        enum Stage
+        {
+            BLOB_RECEIVED,
+            FITS_LOADED,
+            GUIDING_STARTED,
+            STAR_DETECTED,
+            GUIDING_PROCESSED,
+            PULSE_SENT,
+            STAGE_COUNT
+        };
+
+        // Durations between consecutive stages, then from the first stage to the last one.
+        enum Interval
+        {
+            LOAD,
+            DELIVERY,
+            DETECTION,
+            PROCESSING,
+            PULSE,
+            TOTAL,
+            INTERVAL_COUNT
+        };
+
+        GuideLatency();
+
+        // Microseconds on the monotonic clock the stages are timed with.
+        static qint64 now();
+
+        // Name of an interval, as used in the guide log and in JSON.
+        static QString intervalName(Interval interval);
+
+        // Starts timing a frame at GUIDING_STARTED, with the times the CCD stamped on its data.
+        void startFrame(const FITSData *imageData);
+        // Records the time the current frame reached a stage.
+        void mark(Stage stage);
+        // Records the time, in microseconds on the clock of now(), the current frame reached a stage.
+        void mark(Stage stage, qint64 time);
+        // Ends the current frame. Returns false, and forgets the frame, if one of its stages was not reached.
+        bool endFrame();
+
+        // Durations of the last frame ended, in milliseconds, indexed by Interval.
+        const QVector<double> &lastFrame() const
+        {
+            return last;
+        }
+        // Number of frames kept.
+        int frameCount() const
+        {
+            return frames.size();
+        }
+        // Percentile p, between 0 and 100, of an interval over the frames kept, in milliseconds. -1 if there are none.
+        double percentile(Interval interval, double p) const;
+
+        // Last frame and percentiles of each interval, as JSON.
+        QJsonObject toJson() const;
+
+        // Forgets the frames kept.
+        void clear();
+
+    private:
+        qint64 stamps[STAGE_COUNT];
+        QVector<double> last;
+        // Ring buffer of the durations of the last frames
+        QVector<QVector<double>> frames;
+        int nextFrame = 0;
+        // Time the last frame started was received at
+        qint64 lastReceived = -1;
+};
@@ -8,12 +8,14 @@
  */
 
 #include "guidelog.h"
+#include "guidelatency.h"
 
 #include <math.h>
 #include <cstdint>
 
 #include <QDateTime>
 #include <QStandardPaths>
+#include <QStringList>
 #include <QTextStream>
 
 #include "auxiliary/kspaths.h"
@@ -306,3 +308,21 @@ void GuideLog::settleCompletedInfo()
 {
     appendToLog("INFO: SETTLING STATE CHANGE, Settling complete\n");
 }
+
+// Prints a line that looks like:
+//   INFO: LATENCY load = 4.102 ms, delivery = 12.840 ms, detection = 3.271 ms, processing = 0.412 ms, pulse = 0.095 ms, total = 20.720 ms
+// phdlogview ignores INFO lines it does not know about.
+void GuideLog::latencyInfo(const GuideLatency &latency)
+{
+    const QVector<double> &durations = latency.lastFrame();
+    if (durations.isEmpty())
+        return;
+
+    QStringList intervals;
+    for (int i = 0; i < GuideLatency::INTERVAL_COUNT; i++)
+        intervals << QString("%1 = %2 ms")
+                  .arg(GuideLatency::intervalName(static_cast<GuideLatency::Interval>(i)))
+                  .arg(QString::number(durations[i], 'f', 3));
+
+    appendToLog(QString("INFO: LATENCY %1\n").arg(intervals.join(", ")));
+}
@@ -15,6 +15,8 @@
 #include "indi/indicommon.h"
 #include "indi/inditelescope.h"
 
+class GuideLatency;
+
 // This class will help write guide log files, using the PHD2 guide log format.
 
 class GuideLog
@@ -90,6 +92,8 @@ class GuideLog
         void resumeInfo();
         void settleStartedInfo();
         void settleCompletedInfo();
+        // Durations of the stages of the last guide frame.
+        void latencyInfo(const GuideLatency &latency);
 
         // Deal with suspend, resume, dither, ...
     private:
@@ -42,9 +42,15 @@ void ShiftEST(float ***testimage, float ***refimage, int n, float *xshift, float
 namespace ImageAutoGuiding
 {
 void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshift)
+{
+    ImageAutoGuiding1(ref, n, im, n, n, xshift, yshift);
+}
+
+void ImageAutoGuiding1(const float *ref, int refStride, const float *im, int imStride, int n, float *xshift,
+                       float *yshift)
 {
     float ***RefImage, ***TestImage;
-    int i, j, k;
+    int i, j;
     float x, y;
 
     /* Allocate memory */
@@ -54,16 +60,15 @@ void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshif
 
     /* Load Data */
 
-    k = 0;
-
     for (j = 1; j <= n; ++j)
     {
+        const float *refRow = ref + (j - 1) * refStride;
+        const float *imRow  = im + (j - 1) * imStride;
+
         for (i = 1; i <= n; ++i)
         {
-            RefImage[1][j][i]  = ref[k];
-            TestImage[1][j][i] = im[k];
-
-            k += 1;
+            RefImage[1][j][i]  = refRow[i - 1];
+            TestImage[1][j][i] = imRow[i - 1];
         }
     }
 
@@ -25,4 +25,9 @@
 namespace ImageAutoGuiding
 {
 void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshift);
+
+// Same, with the rows of ref and im respectively refStride and imStride floats apart
+// This allows passing square portions of larger images without copying them first
+void ImageAutoGuiding1(const float *ref, int refStride, const float *im, int imStride, int n, float *xshift,
+                       float *yshift);
 }
@@ -67,6 +67,8 @@ bool InternalGuider::guide()
         GuideLog::GuideInfo info;
         fillGuideInfo(&info);
         guideLog.startGuiding(info);
+        latency.clear();
+        emit newLatency();
     }
 
     state = GUIDE_GUIDING;
@@ -1092,6 +1094,8 @@ bool InternalGuider::processGuiding()
     const cproc_out_params *out;
     uint32_t tick = 0;
 
+    latency.startFrame(guideFrame->getImageData());
+
     // On first frame, center the box (reticle) around the star so we do not start with an offset the results in
     // unnecessary guiding pulses.
     if (m_isFirstFrame)
@@ -1105,7 +1109,7 @@ bool InternalGuider::processGuiding()
     }
 
     // calc math. it tracks square
-    pmath->performProcessing(&guideLog, state == GUIDE_GUIDING);
+    pmath->performProcessing(&guideLog, state == GUIDE_GUIDING, &latency);
 
     if (pmath->isStarLost())
         m_starLostCounter++;
@@ -1166,8 +1170,16 @@ bool InternalGuider::processGuiding()
 
     if (sendPulses)
     {
+        latency.mark(GuideLatency::GUIDING_PROCESSED);
         emit newPulse(out->pulse_dir[GUIDE_RA], out->pulse_length[GUIDE_RA],
                       out->pulse_dir[GUIDE_DEC], out->pulse_length[GUIDE_DEC]);
+        // The pulse is sent to the driver by the time the signal returns
+        latency.mark(GuideLatency::PULSE_SENT);
+        if (latency.endFrame())
+        {
+            guideLog.latencyInfo(latency);
+            emit newLatency();
+        }
 
         // Wait until pulse is over before capturing an image
         const int waitMS = qMax(out->pulse_length[GUIDE_RA], out->pulse_length[GUIDE_DEC]);
@@ -1221,8 +1233,10 @@ bool InternalGuider::processImageGuiding()
     const cproc_out_params *out;
     uint32_t tick = 0;
 
+    latency.startFrame(guideFrame->getImageData());
+
     // calc math. it tracks square
-    pmath->performProcessing();
+    pmath->performProcessing(nullptr, false, &latency);
 
     if (pmath->isStarLost() && ++m_starLostCounter > 2)
     {
@@ -1251,8 +1265,15 @@ bool InternalGuider::processImageGuiding()
         return false;
     }
 
+    latency.mark(GuideLatency::GUIDING_PROCESSED);
     emit newPulse(out->pulse_dir[GUIDE_RA], out->pulse_length[GUIDE_RA], out->pulse_dir[GUIDE_DEC],
                   out->pulse_length[GUIDE_DEC]);
+    latency.mark(GuideLatency::PULSE_SENT);
+    if (latency.endFrame())
+    {
+        guideLog.latencyInfo(latency);
+        emit newLatency();
+    }
 
     emit frameCaptureRequested();
 
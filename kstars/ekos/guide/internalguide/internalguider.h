@@ -15,6 +15,7 @@
 #include "indi/indicommon.h"
 #include "../guideinterface.h"
 #include "guidelog.h"
+#include "guidelatency.h"
 
 #include <QFile>
 #include <QPointer>
@@ -146,6 +147,12 @@ class InternalGuider : public GuideInterface
         // Manual Dither
         bool processManualDithering();
 
+        // Latency of the stages of the guide loop, over the last guide frames
+        const GuideLatency &getLatency() const
+        {
+            return latency;
+        }
+
     public slots:
         void setDECSwap(bool enable);
 
@@ -158,6 +165,8 @@ class InternalGuider : public GuideInterface
         void newPulse(GuideDirection dir, int msecs);
         //void newStarPosition(QVector3D, bool);
         void DESwapChanged(bool enable);
+        // A guide frame led to a pulse, and its latency was recorded
+        void newLatency();
 
     private:
         // Calibration
@@ -249,5 +258,6 @@ class InternalGuider : public GuideInterface
 
         QPair<double, double> accumulator;
         GuideLog guideLog;
+        GuideLatency latency;
 };
 }
@@ -0,0 +1,147 @@
+/*  Ekos Capture Storage Index
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "capturestorageindex.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <ekos_scheduler_debug.h>
+
+#include <algorithm>
+
+namespace
+{
+// Time for the notifications of a capture being written to settle, and for Capture to report the file
+constexpr int REFRESH_DELAY_MS = 5000;
+}
+
+namespace Ekos
+{
+CaptureStorageIndex::CaptureStorageIndex(QObject *parent) : QObject(parent)
+{
+    m_RefreshTimer.setSingleShot(true);
+    m_RefreshTimer.setInterval(REFRESH_DELAY_MS);
+
+    connect(&m_Watcher, &QFileSystemWatcher::directoryChanged, this, &CaptureStorageIndex::directoryChanged);
+    connect(&m_RefreshTimer, &QTimer::timeout, this, &CaptureStorageIndex::refreshDirectories);
+}
+
+int CaptureStorageIndex::count(const QString &directory, const QString &prefix)
+{
+    QString const path = QDir::cleanPath(directory);
+    if (!m_Directories.contains(path) && !QFileInfo(path).isDir())
+        return 0;
+
+    QStringList const &names = this->directory(path).names;
+
+    /* FIXME: this counts all files with prefix in the storage location, not just captures. DSS analysis files are counted in, for instance. */
+    int result = 0;
+    for (auto it = std::lower_bound(names.begin(), names.end(), prefix); it != names.end() && it->startsWith(prefix); ++it)
+        result++;
+
+    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Found %1 files in path '%2' for prefix '%3'.").arg(result).arg(path, prefix);
+    return result;
+}
+
+void CaptureStorageIndex::addFile(const QString &filename)
+{
+    QFileInfo const info(filename);
+    auto it = m_Directories.find(QDir::cleanPath(info.absolutePath()));
+    if (it == m_Directories.end())
+        return;
+
+    QStringList &names = it->names;
+    QString const name = info.completeBaseName();
+    auto const position = std::lower_bound(names.begin(), names.end(), name);
+    if (position == names.end() || *position != name)
+        names.insert(position, name);
+
+    it->added++;
+}
+
+void CaptureStorageIndex::clear()
+{
+    if (!m_Watcher.directories().isEmpty())
+        m_Watcher.removePaths(m_Watcher.directories());
+    m_Directories.clear();
+    m_RefreshTimer.stop();
+}
+
+void CaptureStorageIndex::directoryChanged(const QString &path)
+{
+    auto it = m_Directories.find(path);
+    if (it == m_Directories.end())
+        return;
+
+    it->changed = true;
+    m_RefreshTimer.start();
+}
+
+void CaptureStorageIndex::refreshDirectories()
+{
+    bool relisted = false;
+    for (auto it = m_Directories.begin(); it != m_Directories.end();)
+    {
+        if (!it->changed)
+        {
+            ++it;
+            continue;
+        }
+
+        /* A removed directory is watched again if it is queried after being created again */
+        if (!QFileInfo(it.key()).isDir())
+        {
+            m_Watcher.removePath(it.key());
+            it = m_Directories.erase(it);
+            relisted = true;
+            continue;
+        }
+
+        /* Files reported by Capture already explain the change, anything else requires listing the directory again */
+        if (it->added == 0)
+        {
+            qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Capture storage '%1' changed, listing it again.").arg(it.key());
+            it->names = list(it.key());
+            relisted = true;
+        }
+
+        it->changed = false;
+        it->added   = 0;
+        ++it;
+    }
+
+    if (relisted)
+        emit refreshed();
+}
+
+CaptureStorageIndex::Directory &CaptureStorageIndex::directory(const QString &path)
+{
+    auto it = m_Directories.find(path);
+    if (it != m_Directories.end())
+        return it.value();
+
+    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Indexing capture storage '%1'...").arg(path);
+
+    Directory entry;
+    entry.names = list(path);
+    m_Watcher.addPath(path);
+    return m_Directories.insert(path, entry).value();
+}
+
+QStringList CaptureStorageIndex::list(const QString &path)
+{
+    // Only the names are needed, which spares querying the details of each file on slow storage
+    QStringList names;
+    for (const QString &file : QDir(path).entryList(QDir::Files, QDir::Unsorted))
+        names.append(QFileInfo(file).completeBaseName());
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+}
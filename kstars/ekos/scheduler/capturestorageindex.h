@@ -0,0 +1,75 @@
+/*  Ekos Capture Storage Index
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+namespace Ekos
+{
+/**
+ * @class CaptureStorageIndex
+ * Names of the files found in the capture storage directories, so that counting the captures of a sequence job
+ * does not list its directory every time.
+ *
+ * A directory is listed the first time it is queried, then watched. Files reported by Capture are added as they
+ * are written. Other changes, such as files removed by the end-user, have the directory listed again once the
+ * notifications settle.
+ */
+class CaptureStorageIndex : public QObject
+{
+        Q_OBJECT
+
+    public:
+        explicit CaptureStorageIndex(QObject *parent = nullptr);
+
+        /**
+         * @brief count Count the files of a directory whose base name starts with a prefix.
+         * @param directory storage directory, listed and watched if not indexed yet.
+         * @param prefix prefix of the base name of the files, without extension.
+         * @return the number of files with that prefix.
+         */
+        int count(const QString &directory, const QString &prefix);
+
+        /** @brief Add a file just written to the index of its directory, if that directory is indexed. */
+        void addFile(const QString &filename);
+
+        /** @brief Forget all directories, they are listed again when next queried. */
+        void clear();
+
+    signals:
+        /** @brief Directories were listed again or dropped after changes not explained by the files added. */
+        void refreshed();
+
+    private slots:
+        void directoryChanged(const QString &path);
+        void refreshDirectories();
+
+    private:
+        struct Directory
+        {
+            /// Base names of the files, sorted so that names sharing a prefix are adjacent
+            QStringList names;
+            /// Whether a change was notified for the directory since it was last listed
+            bool changed { false };
+            /// Files added since the last change notification, explaining it if non-zero
+            int added { 0 };
+        };
+
+        Directory &directory(const QString &path);
+        static QStringList list(const QString &path);
+
+        QMap<QString, Directory> m_Directories;
+        QFileSystemWatcher m_Watcher;
+        QTimer m_RefreshTimer;
+};
+}
@@ -11,7 +11,6 @@
 
 #include "scheduler.h"
 
-#include "ksalmanac.h"
 #include "ksnotification.h"
 #include "kstars.h"
 #include "kstarsdata.h"
@@ -21,6 +20,8 @@
 #include "Options.h"
 #include "scheduleradaptor.h"
 #include "schedulerjob.h"
+#include "schedulerengine.h"
+#include "schedulerephemeris.h"
 #include "skymapcomposite.h"
 #include "auxiliary/QProgressIndicator.h"
 #include "dialogs/finddialog.h"
@@ -31,6 +32,9 @@
 #include <KNotifications/KNotification>
 #include <KConfigDialog>
 
+#include <QCompleter>
+#include <QStringListModel>
+
 #include <fitsio.h>
 #include <ekos_scheduler_debug.h>
 
@@ -38,6 +42,7 @@
 #define MAX_FAILURE_ATTEMPTS      5
 #define UPDATE_PERIOD_MS          1000
 #define RESTART_GUIDING_DELAY_MS  5000
+#define MAX_NAME_COMPLETIONS      50
 
 #define DEFAULT_CULMINATION_TIME    -60
 #define DEFAULT_MIN_ALTITUDE        15
@@ -57,6 +62,11 @@ Scheduler::Scheduler()
 
     dirPath = QUrl::fromLocalFile(QDir::homePath());
 
+    m_Engine.setLogger([this](const QString &text)
+    {
+        appendLogText(text);
+    });
+
     // Get current KStars time and set seconds to zero
     QDateTime currentDateTime = KStarsData::Instance()->lt();
     QTime currentTime         = currentDateTime.time();
@@ -94,6 +104,18 @@ Scheduler::Scheduler()
     connect(&schedulerTimer, &QTimer::timeout, this, &Scheduler::checkStatus);
     connect(&jobTimer, &QTimer::timeout, this, &Scheduler::checkJobStage);
 
+    // Captures added or removed in storage behind the back of Capture change the progress of the jobs
+    connect(&m_CaptureStorage, &CaptureStorageIndex::refreshed, this, [this]()
+    {
+        if (!Options::rememberJobProgress())
+            return;
+
+        updateCompletedJobsCount();
+
+        for (SchedulerJob * job : jobs)
+            m_Engine.estimateJobTime(job, KStarsData::Instance()->lt());
+    });
+
     restartGuidingTimer.setSingleShot(true);
     restartGuidingTimer.setInterval(RESTART_GUIDING_DELAY_MS);
     connect(&restartGuidingTimer, &QTimer::timeout, this, [this]()
@@ -173,6 +195,19 @@ Scheduler::Scheduler()
     connect(shutdownB, &QPushButton::clicked, this, &Scheduler::runShutdownProcedure);
 
     connect(selectObjectB, &QPushButton::clicked, this, &Scheduler::selectObject);
+
+    // Complete target names with the objects known to KStars, picking one fills in its coordinates
+    QCompleter *nameCompleter = new QCompleter(this);
+    nameCompletionModel       = new QStringListModel(nameCompleter);
+    nameCompleter->setModel(nameCompletionModel);
+    nameCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+    nameEdit->setCompleter(nameCompleter);
+    connect(nameEdit, &QLineEdit::textEdited, this, &Scheduler::updateNameCompletions);
+    connect(nameCompleter, static_cast<void (QCompleter::*)(const QString &)>(&QCompleter::activated), this,
+            [this](const QString & name)
+    {
+        addObject(KStarsData::Instance()->skyComposite()->findByName(name));
+    });
     connect(selectFITSB, &QPushButton::clicked, this, &Scheduler::selectFITS);
     connect(loadSequenceB, &QPushButton::clicked, this, &Scheduler::selectSequence);
     connect(selectStartupScriptB, &QPushButton::clicked, this, &Scheduler::selectStartupScript);
@@ -426,6 +461,24 @@ void Scheduler::selectObject()
     }
 }
 
+void Scheduler::updateNameCompletions(const QString &text)
+{
+    QStringList names;
+    if (!text.isEmpty())
+    {
+        for (const auto &name : KStarsData::Instance()->skyComposite()->findByNamePrefix(text, QList<int>(),
+                MAX_NAME_COMPLETIONS))
+            names.append(name.first);
+        names.removeDuplicates();
+    }
+    nameCompletionModel->setStringList(names);
+
+    QCompleter *completer = nameEdit->completer();
+    completer->setCompletionPrefix(text);
+    if (!names.isEmpty())
+        completer->complete();
+}
+
 void Scheduler::addObject(SkyObject *object)
 {
     if (object != nullptr)
@@ -747,7 +800,7 @@ void Scheduler::saveJob()
     if (SchedulerJob::START_AT == job->getFileStartupCondition())
     {
         /* Warn if appending a job which startup time doesn't allow proper score */
-        if (calculateJobScore(job, job->getStartupTime()) < 0)
+        if (m_Engine.calculateJobScore(job, job->getStartupTime()) < 0)
             appendLogText(
                 i18n("Warning: job '%1' has startup time %2 resulting in a negative score, and will be marked invalid when processed.",
                      job->getName(), job->getStartupTime().toString(job->getDateTimeDisplayFormat())));
@@ -1549,99 +1602,15 @@ void Scheduler::evaluateJobs()
     /* Update dawn and dusk astronomical times - unconditionally in case date changed */
     calculateDawnDusk();
 
+    /* Build the tables of the Moon and targets again for this evaluation, shared by all jobs */
+    SchedulerEphemeris::Instance()->clear();
+
     /* First, filter out non-schedulable jobs */
     /* FIXME: jobs in state JOB_ERROR should not be in the list, reorder states */
     QList<SchedulerJob *> sortedJobs = jobs;
 
     /* Then enumerate SchedulerJobs to consolidate imaging time */
-    foreach (SchedulerJob *job, sortedJobs)
-    {
-        /* Let aborted jobs be rescheduled later instead of forgetting them */
-        switch (job->getState())
-        {
-            case SchedulerJob::JOB_SCHEDULED:
-                /* If job is scheduled, keep it for evaluation against others */
-                break;
-
-            case SchedulerJob::JOB_INVALID:
-            case SchedulerJob::JOB_COMPLETE:
-                /* If job is invalid or complete, bypass evaluation */
-                continue;
-
-            case SchedulerJob::JOB_BUSY:
-                /* If job is busy, edge case, bypass evaluation */
-                continue;
-
-            case SchedulerJob::JOB_ERROR:
-            case SchedulerJob::JOB_ABORTED:
-                /* If job is in error or aborted and we're running, keep its evaluation until there is nothing else to do */
-                if (state == SCHEDULER_RUNNING)
-                    continue;
-            /* Fall through */
-            case SchedulerJob::JOB_IDLE:
-            case SchedulerJob::JOB_EVALUATION:
-            default:
-                /* If job is idle, re-evaluate completely */
-                job->setEstimatedTime(-1);
-                break;
-        }
-
-        switch (job->getCompletionCondition())
-        {
-            case SchedulerJob::FINISH_AT:
-                /* If planned finishing time has passed, the job is set to IDLE waiting for a next chance to run */
-                if (job->getCompletionTime().isValid() && job->getCompletionTime() < now)
-                {
-                    job->setState(SchedulerJob::JOB_IDLE);
-                    continue;
-                }
-                break;
-
-            case SchedulerJob::FINISH_REPEAT:
-                // In case of a repeating jobs, let's make sure we have more runs left to go
-                // If we don't, re-estimate imaging time for the scheduler job before concluding
-                if (job->getRepeatsRemaining() == 0)
-                {
-                    appendLogText(i18n("Job '%1' has no more batches remaining.", job->getName()));
-                    if (Options::rememberJobProgress())
-                    {
-                        job->setEstimatedTime(-1);
-                    }
-                    else
-                    {
-                        job->setState(SchedulerJob::JOB_COMPLETE);
-                        job->setEstimatedTime(0);
-                        continue;
-                    }
-                }
-                break;
-
-            default:
-                break;
-        }
-
-        // -1 = Job is not estimated yet
-        // -2 = Job is estimated but time is unknown
-        // > 0  Job is estimated and time is known
-        if (job->getEstimatedTime() == -1)
-        {
-            if (estimateJobTime(job) == false)
-            {
-                job->setState(SchedulerJob::JOB_INVALID);
-                continue;
-            }
-        }
-
-        if (job->getEstimatedTime() == 0)
-        {
-            job->setRepeatsRemaining(0);
-            job->setState(SchedulerJob::JOB_COMPLETE);
-            continue;
-        }
-
-        // In any other case, evaluate
-        job->setState(SchedulerJob::JOB_EVALUATION);
-    }
+    m_Engine.prepareJobs(sortedJobs, now, state == SCHEDULER_RUNNING);
 
     /*
      * At this step, we prepare scheduling of jobs.
@@ -1717,484 +1686,9 @@ void Scheduler::evaluateJobs()
         }
     }
 
-    /* If option says so, reorder by altitude and priority before sequencing */
-    /* FIXME: refactor so all sorts are using the same predicates */
-    /* FIXME: use std::stable_sort as qStableSort is deprecated */
-    /* FIXME: dissociate altitude and priority, it's difficult to choose which predicate to use first */
-    qCInfo(KSTARS_EKOS_SCHEDULER) << "Option to sort jobs based on priority and altitude is" << Options::sortSchedulerJobs();
-    if (Options::sortSchedulerJobs())
-    {
-        using namespace std::placeholders;
-        std::stable_sort(sortedJobs.begin(), sortedJobs.end(),
-                         std::bind(SchedulerJob::decreasingAltitudeOrder, _1, _2, KStarsData::Instance()->lt()));
-        std::stable_sort(sortedJobs.begin(), sortedJobs.end(), SchedulerJob::increasingPriorityOrder);
-    }
-
-    /* The first reordered job has no lead time - this could also be the delay from now to startup */
-    sortedJobs.first()->setLeadTime(0);
-
-    /* The objective of the following block is to make sure jobs are sequential in the list filtered previously.
-     *
-     * The algorithm manages overlap between jobs by stating that scheduled jobs that start sooner are non-movable.
-     * If the completion time of the previous job overlaps the current job, we offset the startup of the current job.
-     * Jobs that have no valid startup time when evaluated (ASAP jobs) are assigned an immediate startup time.
-     * The lead time from the Options registry is used as a buffer between jobs.
-     *
-     * Note about the situation where the current job overlaps the next job, and the next job is not movable:
-     * - If we mark the current job invalid, it will not be processed at all. Dropping is not satisfactory.
-     * - If we move the current job after the fixed job, we need to restart evaluation with a new list, and risk an
-     *   infinite loop eventually. This means swapping schedules, and is incompatible with altitude/priority sort.
-     * - If we mark the current job aborted, it will be re-evaluated each time a job is complete to see if it can fit.
-     *   Although puzzling for the end-user, this solution is dynamic: the aborted job might or might not be scheduled
-     *   at the planned time slot. But as the end-user did not enforce the start time, this is acceptable. Moreover, the
-     *   schedule will be altered by external events during the execution.
-     *
-     * Here are the constraints that have an effect on the job being examined, and indirectly on all subsequent jobs:
-     * - Twilight constraint moves jobs to the next dark sky interval.
-     * - Altitude constraint, currently linked with Moon separation, moves jobs to the next acceptable altitude time.
-     * - Culmination constraint moves jobs to the next transit time, with arbitrary offset.
-     * - Fixed startup time moves jobs to a fixed time, essentially making them non-movable, or invalid if in the past.
-     *
-     * Here are the constraints that have an effect on jobs following the job being examined:
-     * - Repeats requirement increases the duration of the current job, pushing subsequent jobs.
-     * - Looping requirement causes subsequent jobs to become invalid (until dynamic priority is implemented).
-     * - Fixed completion makes subsequent jobs start after that boundary time.
-     *
-     * However, we need a way to inform the end-user about failed schedules clearly in the UI.
-     * The message to get through is that if jobs are not sorted by altitude/priority, the aborted or invalid jobs
-     * should be modified or manually moved to a better position. If jobs are sorted automatically, aborted jobs will
-     * be processed when possible, probably not at the expected moment.
-     */
-
-    // Make sure no two jobs have the same scheduled time or overlap with other jobs
-    for (int index = 0; index < sortedJobs.size(); index++)
-    {
-        SchedulerJob * const currentJob = sortedJobs.at(index);
-
-        // Bypass jobs that are not marked for evaluation - we did not remove them to preserve schedule order
-        if (SchedulerJob::JOB_EVALUATION != currentJob->getState())
-            continue;
-
-        // At this point, a job with no valid start date is a problem, so consider invalid startup time is now
-        if (!currentJob->getStartupTime().isValid())
-            currentJob->setStartupTime(now);
-
-        // Locate the previous scheduled job, so that a full schedule plan may be actually consolidated
-        SchedulerJob const * previousJob = nullptr;
-        for (int i = index - 1; 0 <= i; i--)
-        {
-            SchedulerJob const * const a_job = sortedJobs.at(i);
-
-            if (SchedulerJob::JOB_SCHEDULED == a_job->getState())
-            {
-                previousJob = a_job;
-                break;
-            }
-        }
-
-        Q_ASSERT_X(nullptr == previousJob
-                   || previousJob != currentJob, __FUNCTION__,
-                   "Previous job considered for schedule is either undefined or not equal to current.");
-
-        // Locate the next job - nothing special required except end of list check
-        SchedulerJob const * const nextJob = index + 1 < sortedJobs.size() ? sortedJobs.at(index + 1) : nullptr;
-
-        Q_ASSERT_X(nullptr == nextJob
-                   || nextJob != currentJob, __FUNCTION__, "Next job considered for schedule is either undefined or not equal to current.");
-
-        // We're attempting to schedule the job 10 times before making it invalid
-        for (int attempt = 1; attempt < 11; attempt++)
-        {
-            qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                           QString("Schedule attempt #%1 for %2-second job '%3' on row #%4 starting at %5, completing at %6.")
-                                           .arg(attempt)
-                                           .arg(static_cast<int>(currentJob->getEstimatedTime()))
-                                           .arg(currentJob->getName())
-                                           .arg(index + 1)
-                                           .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()))
-                                           .arg(currentJob->getCompletionTime().toString(currentJob->getDateTimeDisplayFormat()));
-
-
-            // ----- #1 Should we reject the current job because of its fixed startup time?
-            //
-            // A job with fixed startup time must be processed at the time of startup, and may be late up to leadTime.
-            // When such a job repeats, its startup time is reinitialized to prevent abort - see completion algorithm.
-            // If such a job requires night time, minimum altitude or Moon separation, the consolidated startup time is checked for errors.
-            // If all restrictions are complied with, we bypass the rest of the verifications as the job cannot be moved.
-
-            if (SchedulerJob::START_AT == currentJob->getFileStartupCondition())
-            {
-                // Check whether the current job is too far in the past to be processed - if job is repeating, its startup time is already now
-                if (currentJob->getStartupTime().addSecs(static_cast <int> (ceil(Options::leadTime() * 60))) < now)
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-
-                    appendLogText(i18n("Warning: job '%1' has fixed startup time %2 set in the past, marking invalid.",
-                                       currentJob->getName(), currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat())));
-
-                    break;
-                }
-                // Check whether the current job has a positive dark sky score at the time of startup
-                else if (true == currentJob->getEnforceTwilight() && getDarkSkyScore(currentJob->getStartupTime()) < 0)
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    appendLogText(i18n("Warning: job '%1' has a fixed start time incompatible with its twilight restriction, marking invalid.",
-                                       currentJob->getName()));
-
-                    break;
-                }
-                // Check whether the current job has a positive altitude score at the time of startup
-                else if (-90 < currentJob->getMinAltitude() && currentJob->getAltitudeScore(currentJob->getStartupTime()) < 0)
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    appendLogText(i18n("Warning: job '%1' has a fixed start time incompatible with its altitude restriction, marking invalid.",
-                                       currentJob->getName()));
-
-                    break;
-                }
-                // Check whether the current job has a positive Moon separation score at the time of startup
-                else if (0 < currentJob->getMinMoonSeparation() && currentJob->getMoonSeparationScore(currentJob->getStartupTime()) < 0)
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    appendLogText(
-                        i18n("Warning: job '%1' has a fixed start time incompatible with its Moon separation restriction, marking invalid.",
-                             currentJob->getName()));
-
-                    break;
-                }
-
-                // Check whether a previous job overlaps the current job
-                if (nullptr != previousJob && previousJob->getCompletionTime().isValid())
-                {
-                    // Calculate time we should be at after finishing the previous job
-                    QDateTime const previousCompletionTime = previousJob->getCompletionTime().addSecs(static_cast <int> (ceil(
-                                Options::leadTime() * 60.0)));
-
-                    // Make this job invalid if startup time is not achievable because a START_AT job is non-movable
-                    if (currentJob->getStartupTime() < previousCompletionTime)
-                    {
-                        currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                        appendLogText(
-                            i18n("Warning: job '%1' has fixed startup time %2 unachievable due to the completion time of its previous sibling, marking invalid.",
-                                 currentJob->getName(), currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat())));
-
-                        break;
-                    }
-
-                    currentJob->setLeadTime(previousJob->getCompletionTime().secsTo(currentJob->getStartupTime()));
-                }
-
-                // This job is non-movable, we're done
-                currentJob->setScore(calculateJobScore(currentJob, now));
-                currentJob->setState(SchedulerJob::JOB_SCHEDULED);
-                qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                               QString("Job '%1' is scheduled to start at %2, in compliance with fixed startup time requirement.")
-                                               .arg(currentJob->getName())
-                                               .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
-
-                break;
-            }
-
-            // ----- #2 Should we delay the current job because it overlaps the previous job?
-            //
-            // The previous job is considered non-movable, and its completion, plus lead time, is the origin for the current job.
-            // If no previous job exists, or if all prior jobs in the list are rejected, there is no overlap.
-            // If there is a previous job, the current job is simply delayed to avoid an eventual overlap.
-            // IF there is a previous job but it never finishes, the current job is rejected.
-            // This scheduling obviously relies on imaging time estimation: because errors stack up, future startup times are less and less reliable.
-
-            if (nullptr != previousJob)
-            {
-                if (previousJob->getCompletionTime().isValid())
-                {
-                    // Calculate time we should be at after finishing the previous job
-                    QDateTime const previousCompletionTime = previousJob->getCompletionTime().addSecs(static_cast <int> (ceil(
-                                Options::leadTime() * 60.0)));
-
-                    // Delay the current job to completion of its previous sibling if needed - this updates the completion time automatically
-                    if (currentJob->getStartupTime() < previousCompletionTime)
-                    {
-                        currentJob->setStartupTime(previousCompletionTime);
-
-                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                                       QString("Job '%1' is scheduled to start at %2, %3 seconds after %4, in compliance with previous job completion requirement.")
-                                                       .arg(currentJob->getName())
-                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()))
-                                                       .arg(previousJob->getCompletionTime().secsTo(currentJob->getStartupTime()))
-                                                       .arg(previousJob->getCompletionTime().toString(previousJob->getDateTimeDisplayFormat()));
-
-                        // If the job is repeating or looping, re-estimate imaging duration - error case may be a bug
-                        if (SchedulerJob::FINISH_SEQUENCE != currentJob->getCompletionCondition())
-                            if (false == estimateJobTime(currentJob))
-                                currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                        continue;
-                    }
-                }
-                else
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    appendLogText(i18n("Warning: Job '%1' cannot start because its previous sibling has no completion time, marking invalid.",
-                                       currentJob->getName()));
-
-                    break;
-                }
-
-                currentJob->setLeadTime(previousJob->getCompletionTime().secsTo(currentJob->getStartupTime()));
-
-                // Lead time can be zero, so completion may equal startup
-                Q_ASSERT_X(previousJob->getCompletionTime() <= currentJob->getStartupTime(), __FUNCTION__,
-                           "Previous and current jobs do not overlap.");
-            }
-
-
-            // ----- #3 Should we delay the current job because it overlaps daylight?
-            //
-            // Pre-dawn time rules whether a job may be started before dawn, or delayed to next night.
-            // Note that the case of START_AT jobs is considered earlier in the algorithm, thus may be omitted here.
-            // In addition to be hardcoded currently, the imaging duration is not reliable enough to start a short job during pre-dawn.
-            // However, completion time during daylight only causes a warning, as this case will be processed as the job runs.
-
-            if (currentJob->getEnforceTwilight())
-            {
-                // During that check, we don't verify the current job can actually complete before dawn.
-                // If the job is interrupted while running, it will be aborted and rescheduled at a later time.
-
-                // We wouldn't start observation 30 mins (default) before dawn.
-                // FIXME: Refactor duplicated dawn/dusk calculations
-                double const earlyDawn = Dawn - Options::preDawnTime() / (60.0 * 24.0);
-
-                // Compute dawn time for the startup date of the job
-                // FIXME: Use KAlmanac to find the real dawn/dusk time for the day the job is supposed to be processed
-                QDateTime const dawnDateTime(currentJob->getStartupTime().date(), QTime(0, 0).addSecs(earlyDawn * 24 * 3600));
-
-                // Check if the job starts after dawn
-                if (dawnDateTime < currentJob->getStartupTime())
-                {
-                    // Compute dusk time for the startup date of the job - no lead time on dusk
-                    QDateTime duskDateTime(currentJob->getStartupTime().date(), QTime(0, 0).addSecs(Dusk * 24 * 3600));
-
-                    // Near summer solstice, dusk may happen before dawn on the same day, shift dusk by one day in that case
-                    if (duskDateTime < dawnDateTime)
-                        duskDateTime = duskDateTime.addDays(1);
-
-                    // Check if the job starts before dusk
-                    if (currentJob->getStartupTime() < duskDateTime)
-                    {
-                        // Delay job to next dusk - we will check other requirements later on
-                        currentJob->setStartupTime(duskDateTime);
-
-                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                                       QString("Job '%1' is scheduled to start at %2, in compliance with night time requirement.")
-                                                       .arg(currentJob->getName())
-                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
-
-                        continue;
-                    }
-                }
-
-                // Compute dawn time for the day following the startup time, but disregard the pre-dawn offset as we'll consider completion
-                // FIXME: Use KAlmanac to find the real dawn/dusk time for the day next to the day the job is supposed to be processed
-                QDateTime const nextDawnDateTime(currentJob->getStartupTime().date().addDays(1), QTime(0, 0).addSecs(Dawn * 24 * 3600));
-
-                // Check if the completion date overlaps the next dawn, and issue a warning if so
-                if (nextDawnDateTime < currentJob->getCompletionTime())
-                {
-                    appendLogText(
-                        i18n("Warning: job '%1' execution overlaps daylight, it will be interrupted at dawn and rescheduled on next night time.",
-                             currentJob->getName()));
-                }
-
-
-                Q_ASSERT_X(0 <= getDarkSkyScore(currentJob->getStartupTime()), __FUNCTION__,
-                           "Consolidated startup time results in a positive dark sky score.");
-            }
-
-
-            // ----- #4 Should we delay the current job because of its target culmination?
-            //
-            // Culmination uses the transit time, and fixes the startup time of the job to a particular offset around this transit time.
-            // This restriction may be used to start a job at the least air mass, or after a meridian flip.
-            // Culmination is scheduled before altitude restriction because it is normally more restrictive for the resulting startup time.
-            // It may happen that a target cannot rise enough to comply with the altitude restriction, but a culmination time is always valid.
-
-            if (SchedulerJob::START_CULMINATION == currentJob->getFileStartupCondition())
-            {
-                // Consolidate the culmination time, with offset, of the current job
-                QDateTime const nextCulminationTime = currentJob->calculateCulmination(currentJob->getStartupTime());
-
-                if (nextCulminationTime.isValid()) // Guaranteed
-                {
-                    if (currentJob->getStartupTime() < nextCulminationTime)
-                    {
-                        currentJob->setStartupTime(nextCulminationTime);
-
-                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                                       QString("Job '%1' is scheduled to start at %2, in compliance with culmination requirements.")
-                                                       .arg(currentJob->getName())
-                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
-
-                        continue;
-                    }
-                }
-                else
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    appendLogText(i18n("Warning: job '%1' requires culmination offset of %2 minutes, not achievable, marking invalid.",
-                                       currentJob->getName(),
-                                       QString("%L1").arg(currentJob->getCulminationOffset())));
-
-                    break;
-                }
-
-                // Don't test altitude here, because we will push the job during the next check step
-                // Q_ASSERT_X(0 <= getAltitudeScore(currentJob, currentJob->getStartupTime()), __FUNCTION__, "Consolidated altitude time results in a positive altitude score.");
-            }
-
-
-            // ----- #5 Should we delay the current job because its altitude is incorrect?
-            //
-            // Altitude time ensures the job is assigned a startup time when its target is high enough.
-            // As other restrictions, the altitude is only considered for startup time, completion time is managed while the job is running.
-            // Because a target setting down is a problem for the schedule, a cutoff altitude is added in the case the job target is past the meridian at startup time.
-            // FIXME: though arguable, Moon separation is also considered in that restriction check - move it to a separate case.
-
-            if (-90 < currentJob->getMinAltitude())
-            {
-                // Consolidate a new altitude time from the startup time of the current job
-                QDateTime const nextAltitudeTime = currentJob->calculateAltitudeTime(currentJob->getStartupTime());
-
-                if (nextAltitudeTime.isValid())
-                {
-                    if (currentJob->getStartupTime() < nextAltitudeTime)
-                    {
-                        currentJob->setStartupTime(nextAltitudeTime);
-
-                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                                       QString("Job '%1' is scheduled to start at %2, in compliance with altitude and Moon separation requirements.")
-                                                       .arg(currentJob->getName())
-                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
-
-                        continue;
-                    }
-                }
-                else
-                {
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    appendLogText(
-                        i18n("Warning: job '%1' requires minimum altitude %2 and Moon separation %3, not achievable, marking invalid.",
-                             currentJob->getName(),
-                             QString("%L1").arg(static_cast<double>(currentJob->getMinAltitude()), 0, 'f', minAltitude->decimals()),
-                             0.0 < currentJob->getMinMoonSeparation() ?
-                             QString("%L1").arg(static_cast<double>(currentJob->getMinMoonSeparation()), 0, 'f', minMoonSeparation->decimals()) :
-                             QString("-")));
-
-                    break;
-                }
-
-                Q_ASSERT_X(0 <= currentJob->getAltitudeScore(currentJob->getStartupTime()), __FUNCTION__,
-                           "Consolidated altitude time results in a positive altitude score.");
-            }
-
-
-            // ----- #6 Should we reject the current job because it overlaps the next job and that next job is not movable?
-            //
-            // If we have a blocker next to the current job, we compare the completion time of the current job and the startup time of this next job, taking lead time into account.
-            // This verification obviously relies on the imaging time to be reliable, but there's not much we can do at this stage of the implementation.
-
-            if (nullptr != nextJob && SchedulerJob::START_AT == nextJob->getFileStartupCondition())
-            {
-                // In the current implementation, it is not possible to abort a running job when the next job is supposed to start.
-                // Movable jobs after this one will be delayed, but non-movable jobs are considered blockers.
-
-                // Calculate time we have between the end of the current job and the next job
-                double const timeToNext = static_cast<double> (currentJob->getCompletionTime().secsTo(nextJob->getStartupTime()));
-
-                // If that time is overlapping the next job, abort the current job
-                if (timeToNext < Options::leadTime() * 60)
-                {
-                    currentJob->setState(SchedulerJob::JOB_ABORTED);
-
-                    appendLogText(
-                        i18n("Warning: job '%1' is constrained by the start time of the next job, and cannot finish in time, marking aborted.",
-                             currentJob->getName()));
-
-                    break;
-                }
-
-                Q_ASSERT_X(currentJob->getCompletionTime().addSecs(Options::leadTime() * 60) < nextJob->getStartupTime(), __FUNCTION__,
-                           "No overlap ");
-            }
-
-
-            // ----- #7 Should we reject the current job because it exceeded its fixed completion time?
-            //
-            // This verification simply checks that because of previous jobs, the startup time of the current job doesn't exceed its fixed completion time.
-            // Its main objective is to catch wrong dates in the FINISH_AT configuration.
-
-            if (SchedulerJob::FINISH_AT == currentJob->getCompletionCondition())
-            {
-                if (currentJob->getCompletionTime() < currentJob->getStartupTime())
-                {
-                    appendLogText(i18n("Job '%1' completion time (%2) could not be achieved before start up time (%3)",
-                                       currentJob->getName(),
-                                       currentJob->getCompletionTime().toString(currentJob->getDateTimeDisplayFormat()),
-                                       currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat())));
-
-                    currentJob->setState(SchedulerJob::JOB_INVALID);
-
-                    break;
-                }
-            }
-
-
-            // ----- #8 Should we reject the current job because of weather?
-            //
-            // That verification is left for runtime
-            //
-            // if (false == isWeatherOK(currentJob))
-            //{
-            //    currentJob->setState(SchedulerJob::JOB_ABORTED);
-            //
-            //    appendLogText(i18n("Job '%1' cannot run now because of bad weather, marking aborted.", currentJob->getName()));
-            //}
-
-
-            // ----- #9 Update score for current time and mark evaluating jobs as scheduled
-
-            currentJob->setScore(calculateJobScore(currentJob, now));
-            currentJob->setState(SchedulerJob::JOB_SCHEDULED);
-
-            qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                           QString("Job '%1' on row #%2 passed all checks after %3 attempts, will proceed at %4 for approximately %5 seconds, marking scheduled")
-                                           .arg(currentJob->getName())
-                                           .arg(index + 1)
-                                           .arg(attempt)
-                                           .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()))
-                                           .arg(currentJob->getEstimatedTime());
-
-            break;
-        }
-
-        // Check if job was successfully scheduled, else reject it
-        if (SchedulerJob::JOB_EVALUATION == currentJob->getState())
-        {
-            currentJob->setState(SchedulerJob::JOB_INVALID);
-
-            //appendLogText(i18n("Warning: job '%1' on row #%2 could not be scheduled during evaluation and is marked invalid, please review your plan.",
-            //            currentJob->getName(),
-            //            index + 1));
-
-        }
-    }
+    /* Sort jobs if option says so, and consolidate their startup times */
+    m_Engine.setRescheduleErrors(errorHandlingRescheduleErrorsCB->isChecked());
+    m_Engine.scheduleJobs(sortedJobs, now);
 
     /* Apply sorting to queue table, and mark it for saving if it changes */
     mDirty = reorderJobs(sortedJobs) | mDirty;
@@ -2260,7 +1754,7 @@ void Scheduler::evaluateJobs()
     /* Check if job can be processed right now */
     SchedulerJob * const job_to_execute = *job_to_execute_iterator;
     if (job_to_execute->getFileStartupCondition() == SchedulerJob::START_ASAP)
-        if( 0 <= calculateJobScore(job_to_execute, now))
+        if( 0 <= m_Engine.calculateJobScore(job_to_execute, now))
             job_to_execute->setStartupTime(now);
 
     qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' is selected for next observation with priority #%2 and score %3.")
@@ -2307,136 +1801,12 @@ int16_t Scheduler::getWeatherScore() const
     return 0;
 }
 
-int16_t Scheduler::getDarkSkyScore(QDateTime const &when) const
-{
-    double const secsPerDay = 24.0 * 3600.0;
-    double const minsPerDay = 24.0 * 60.0;
-
-    // Dark sky score is calculated based on distance to today's dawn and next dusk.
-    // Option "Pre-dawn Time" avoids executing a job when dawn is approaching, and is a value in minutes.
-    // - If observation is between option "Pre-dawn Time" and dawn, score is BAD_SCORE/50.
-    // - If observation is before dawn today, score is fraction of the day from beginning of observation to dawn time, as percentage.
-    // - If observation is after dusk, score is fraction of the day from dusk to beginning of observation, as percentage.
-    // - If observation is between dawn and dusk, score is BAD_SCORE.
-    //
-    // If observation time is invalid, the score is calculated for the current day time.
-    // Note exact dusk time is considered valid in terms of night time, and will return a positive, albeit null, score.
-
-    // FIXME: Dark sky score should consider the middle of the local night as best value.
-    // FIXME: Current algorithm uses the dawn and dusk of today, instead of the day of the observation.
-
-    int const earlyDawnSecs = static_cast <int> ((Dawn - static_cast <double> (Options::preDawnTime()) / minsPerDay) *
-                              secsPerDay);
-    int const dawnSecs = static_cast <int> (Dawn * secsPerDay);
-    int const duskSecs = static_cast <int> (Dusk * secsPerDay);
-    int const obsSecs = (when.isValid() ? when : KStarsData::Instance()->lt()).time().msecsSinceStartOfDay() / 1000;
-
-    int16_t score = 0;
-
-    if (earlyDawnSecs <= obsSecs && obsSecs < dawnSecs)
-    {
-        score = BAD_SCORE / 50;
-
-        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (between pre-dawn and dawn).")
-        //    .arg(observationDateTime.toString())
-        //    .arg(QString::asprintf("%+d", score));
-    }
-    else if (obsSecs < dawnSecs)
-    {
-        score = static_cast <int16_t> ((dawnSecs - obsSecs) / secsPerDay) * 100;
-
-        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (before dawn).")
-        //    .arg(observationDateTime.toString())
-        //    .arg(QString::asprintf("%+d", score));
-    }
-    else if (duskSecs <= obsSecs)
-    {
-        score = static_cast <int16_t> ((obsSecs - duskSecs) / secsPerDay) * 100;
-
-        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (after dusk).")
-        //    .arg(observationDateTime.toString())
-        //    .arg(QString::asprintf("%+d", score));
-    }
-    else
-    {
-        score = BAD_SCORE;
-
-        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (during daylight).")
-        //    .arg(observationDateTime.toString())
-        //    .arg(QString::asprintf("%+d", score));
-    }
-
-    return score;
-}
-
-int16_t Scheduler::calculateJobScore(SchedulerJob const *job, QDateTime const &when) const
-{
-    if (nullptr == job)
-        return BAD_SCORE;
-
-    /* Only consolidate the score if light frames are required, calibration frames can run whenever needed */
-    if (!job->getLightFramesRequired())
-        return 1000;
-
-    int16_t total = 0;
-
-    /* As soon as one score is negative, it's a no-go and other scores are unneeded */
-
-    if (job->getEnforceTwilight())
-    {
-        int16_t const darkSkyScore = getDarkSkyScore(when);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' dark sky score is %2 at %3")
-                                       .arg(job->getName())
-                                       .arg(QString::asprintf("%+d", darkSkyScore))
-                                       .arg(when.toString(job->getDateTimeDisplayFormat()));
-
-        total += darkSkyScore;
-    }
-
-    /* We still enforce altitude if the job is neither required to track nor guide, because this is too confusing for the end-user.
-     * If we bypass calculation here, it must also be bypassed when checking job constraints in checkJobStage.
-     */
-    if (0 <= total /*&& ((job->getStepPipeline() & SchedulerJob::USE_TRACK) || (job->getStepPipeline() & SchedulerJob::USE_GUIDE))*/)
-    {
-        int16_t const altitudeScore = job->getAltitudeScore(when);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' altitude score is %2 at %3")
-                                       .arg(job->getName())
-                                       .arg(QString::asprintf("%+d", altitudeScore))
-                                       .arg(when.toString(job->getDateTimeDisplayFormat()));
-
-        total += altitudeScore;
-    }
-
-    if (0 <= total)
-    {
-        int16_t const moonSeparationScore = job->getMoonSeparationScore(when);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' Moon separation score is %2 at %3")
-                                       .arg(job->getName())
-                                       .arg(QString::asprintf("%+d", moonSeparationScore))
-                                       .arg(when.toString(job->getDateTimeDisplayFormat()));
-
-        total += moonSeparationScore;
-    }
-
-    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' has a total score of %2 at %3.")
-                                  .arg(job->getName())
-                                  .arg(QString::asprintf("%+d", total))
-                                  .arg(when.toString(job->getDateTimeDisplayFormat()));
-
-    return total;
-}
-
 void Scheduler::calculateDawnDusk()
 {
-    KSAlmanac ksal;
-    Dawn = ksal.getDawnAstronomicalTwilight() + Options::dawnOffset() / 24.0;
-    Dusk = ksal.getDuskAstronomicalTwilight() + Options::duskOffset() / 24.0;
+    m_Engine.calculateDawnDusk();
 
-    QTime const dawn = QTime(0, 0, 0).addSecs(Dawn * 24 * 3600);
-    QTime const dusk = QTime(0, 0, 0).addSecs(Dusk * 24 * 3600);
+    QTime const dawn = QTime(0, 0, 0).addSecs(m_Engine.getDawn() * 24 * 3600);
+    QTime const dusk = QTime(0, 0, 0).addSecs(m_Engine.getDusk() * 24 * 3600);
 
     duskDateTime.setDate(KStars::Instance()->data()->lt().date());
     duskDateTime.setTime(dusk);
@@ -3740,262 +3110,120 @@ bool Scheduler::loadScheduler(const QString &fileURL)
         resetJobEdit();
 
     while (queueTable->rowCount() > 0)
-        queueTable->removeRow(0);
-
-    qDeleteAll(jobs);
-    jobs.clear();
-
-    LilXML *xmlParser = newLilXML();
-    char errmsg[MAXRBUF];
-    XMLEle *root = nullptr;
-    XMLEle *ep   = nullptr;
-    XMLEle *subEP = nullptr;
-    char c;
-
-    // We expect all data read from the XML to be in the C locale - QLocale::c()
-    QLocale cLocale = QLocale::c();
-
-    while (sFile.getChar(&c))
-    {
-        root = readXMLEle(xmlParser, c, errmsg);
-
-        if (root)
-        {
-            for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
-            {
-                const char *tag = tagXMLEle(ep);
-                if (!strcmp(tag, "Job"))
-                    processJobInfo(ep);
-                else if (!strcmp(tag, "Profile"))
-                {
-                    schedulerProfileCombo->setCurrentText(pcdataXMLEle(ep));
-                }
-                else if (!strcmp(tag, "ErrorHandlingStrategy"))
-                {
-                    setErrorHandlingStrategy(static_cast<ErrorHandlingStrategy>(cLocale.toInt(findXMLAttValu(ep, "value"))));
-
-                    subEP = findXMLEle(ep, "delay");
-                    if (subEP)
-                    {
-                        errorHandlingDelaySB->setValue(cLocale.toInt(pcdataXMLEle(subEP)));
-                    }
-                    subEP = findXMLEle(ep, "RescheduleErrors");
-                    errorHandlingRescheduleErrorsCB->setChecked(subEP != nullptr);
-                }
-                else if (!strcmp(tag, "StartupProcedure"))
-                {
-                    XMLEle *procedure;
-                    startupScript->clear();
-                    unparkDomeCheck->setChecked(false);
-                    unparkMountCheck->setChecked(false);
-                    uncapCheck->setChecked(false);
-
-                    for (procedure = nextXMLEle(ep, 1); procedure != nullptr; procedure = nextXMLEle(ep, 0))
-                    {
-                        const char *proc = pcdataXMLEle(procedure);
-
-                        if (!strcmp(proc, "StartupScript"))
-                        {
-                            startupScript->setText(findXMLAttValu(procedure, "value"));
-                            startupScriptURL = QUrl::fromUserInput(startupScript->text());
-                        }
-                        else if (!strcmp(proc, "UnparkDome"))
-                            unparkDomeCheck->setChecked(true);
-                        else if (!strcmp(proc, "UnparkMount"))
-                            unparkMountCheck->setChecked(true);
-                        else if (!strcmp(proc, "UnparkCap"))
-                            uncapCheck->setChecked(true);
-                    }
-                }
-                else if (!strcmp(tag, "ShutdownProcedure"))
-                {
-                    XMLEle *procedure;
-                    shutdownScript->clear();
-                    warmCCDCheck->setChecked(false);
-                    parkDomeCheck->setChecked(false);
-                    parkMountCheck->setChecked(false);
-                    capCheck->setChecked(false);
-
-                    for (procedure = nextXMLEle(ep, 1); procedure != nullptr; procedure = nextXMLEle(ep, 0))
-                    {
-                        const char *proc = pcdataXMLEle(procedure);
-
-                        if (!strcmp(proc, "ShutdownScript"))
-                        {
-                            shutdownScript->setText(findXMLAttValu(procedure, "value"));
-                            shutdownScriptURL = QUrl::fromUserInput(shutdownScript->text());
-                        }
-                        else if (!strcmp(proc, "ParkDome"))
-                            parkDomeCheck->setChecked(true);
-                        else if (!strcmp(proc, "ParkMount"))
-                            parkMountCheck->setChecked(true);
-                        else if (!strcmp(proc, "ParkCap"))
-                            capCheck->setChecked(true);
-                        else if (!strcmp(proc, "WarmCCD"))
-                            warmCCDCheck->setChecked(true);
-                    }
-                }
-            }
-            delXMLEle(root);
-        }
-        else if (errmsg[0])
-        {
-            appendLogText(QString(errmsg));
-            delLilXML(xmlParser);
-            state = old_state;
-            return false;
-        }
-    }
-
-    schedulerURL = QUrl::fromLocalFile(fileURL);
-    mosaicB->setEnabled(true);
-    mDirty = false;
-    delLilXML(xmlParser);
-    // update save button tool tip
-    queueSaveB->setToolTip("Save schedule to " + schedulerURL.fileName());
-
-
-    state = old_state;
-    return true;
-}
-
-bool Scheduler::processJobInfo(XMLEle *root)
-{
-    XMLEle *ep;
-    XMLEle *subEP;
-
-    altConstraintCheck->setChecked(false);
-    moonSeparationCheck->setChecked(false);
-    weatherCheck->setChecked(false);
+        queueTable->removeRow(0);
 
-    twilightCheck->blockSignals(true);
-    twilightCheck->setChecked(false);
-    twilightCheck->blockSignals(false);
+    qDeleteAll(jobs);
+    jobs.clear();
 
-    minAltitude->setValue(minAltitude->minimum());
-    minMoonSeparation->setValue(minMoonSeparation->minimum());
+    sFile.close();
 
     // We expect all data read from the XML to be in the C locale - QLocale::c()
     QLocale cLocale = QLocale::c();
 
-    for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
+    // The engine parses the jobs, the settings of the module are shown as they come
+    auto const processElement = [&](XMLEle * ep)
     {
-        if (!strcmp(tagXMLEle(ep), "Name"))
-            nameEdit->setText(pcdataXMLEle(ep));
-        else if (!strcmp(tagXMLEle(ep), "Priority"))
-            prioritySpin->setValue(atoi(pcdataXMLEle(ep)));
-        else if (!strcmp(tagXMLEle(ep), "Coordinates"))
-        {
-            subEP = findXMLEle(ep, "J2000RA");
-            if (subEP)
-            {
-                dms ra;
-                ra.setH(cLocale.toDouble(pcdataXMLEle(subEP)));
-                raBox->showInHours(ra);
-            }
-            subEP = findXMLEle(ep, "J2000DE");
-            if (subEP)
-            {
-                dms de;
-                de.setD(cLocale.toDouble(pcdataXMLEle(subEP)));
-                decBox->showInDegrees(de);
-            }
-        }
-        else if (!strcmp(tagXMLEle(ep), "Sequence"))
-        {
-            sequenceEdit->setText(pcdataXMLEle(ep));
-            sequenceURL = QUrl::fromUserInput(sequenceEdit->text());
-        }
-        else if (!strcmp(tagXMLEle(ep), "FITS"))
+        XMLEle *subEP = nullptr;
+        const char *tag = tagXMLEle(ep);
+        if (!strcmp(tag, "Profile"))
         {
-            fitsEdit->setText(pcdataXMLEle(ep));
-            fitsURL.setPath(fitsEdit->text());
+            schedulerProfileCombo->setCurrentText(pcdataXMLEle(ep));
         }
-        else if (!strcmp(tagXMLEle(ep), "StartupCondition"))
+        else if (!strcmp(tag, "ErrorHandlingStrategy"))
         {
-            for (subEP = nextXMLEle(ep, 1); subEP != nullptr; subEP = nextXMLEle(ep, 0))
+            setErrorHandlingStrategy(static_cast<ErrorHandlingStrategy>(cLocale.toInt(findXMLAttValu(ep, "value"))));
+
+            subEP = findXMLEle(ep, "delay");
+            if (subEP)
             {
-                if (!strcmp("ASAP", pcdataXMLEle(subEP)))
-                    asapConditionR->setChecked(true);
-                else if (!strcmp("Culmination", pcdataXMLEle(subEP)))
-                {
-                    culminationConditionR->setChecked(true);
-                    culminationOffset->setValue(cLocale.toDouble(findXMLAttValu(subEP, "value")));
-                }
-                else if (!strcmp("At", pcdataXMLEle(subEP)))
-                {
-                    startupTimeConditionR->setChecked(true);
-                    startupTimeEdit->setDateTime(QDateTime::fromString(findXMLAttValu(subEP, "value"), Qt::ISODate));
-                }
+                errorHandlingDelaySB->setValue(cLocale.toInt(pcdataXMLEle(subEP)));
             }
+            subEP = findXMLEle(ep, "RescheduleErrors");
+            errorHandlingRescheduleErrorsCB->setChecked(subEP != nullptr);
         }
-        else if (!strcmp(tagXMLEle(ep), "Constraints"))
+        else if (!strcmp(tag, "StartupProcedure"))
         {
-            for (subEP = nextXMLEle(ep, 1); subEP != nullptr; subEP = nextXMLEle(ep, 0))
+            XMLEle *procedure;
+            startupScript->clear();
+            unparkDomeCheck->setChecked(false);
+            unparkMountCheck->setChecked(false);
+            uncapCheck->setChecked(false);
+
+            for (procedure = nextXMLEle(ep, 1); procedure != nullptr; procedure = nextXMLEle(ep, 0))
             {
-                if (!strcmp("MinimumAltitude", pcdataXMLEle(subEP)))
-                {
-                    altConstraintCheck->setChecked(true);
-                    minAltitude->setValue(cLocale.toDouble(findXMLAttValu(subEP, "value")));
-                }
-                else if (!strcmp("MoonSeparation", pcdataXMLEle(subEP)))
+                const char *proc = pcdataXMLEle(procedure);
+
+                if (!strcmp(proc, "StartupScript"))
                 {
-                    moonSeparationCheck->setChecked(true);
-                    minMoonSeparation->setValue(cLocale.toDouble(findXMLAttValu(subEP, "value")));
+                    startupScript->setText(findXMLAttValu(procedure, "value"));
+                    startupScriptURL = QUrl::fromUserInput(startupScript->text());
                 }
-                else if (!strcmp("EnforceWeather", pcdataXMLEle(subEP)))
-                    weatherCheck->setChecked(true);
-                else if (!strcmp("EnforceTwilight", pcdataXMLEle(subEP)))
-                    twilightCheck->setChecked(true);
+                else if (!strcmp(proc, "UnparkDome"))
+                    unparkDomeCheck->setChecked(true);
+                else if (!strcmp(proc, "UnparkMount"))
+                    unparkMountCheck->setChecked(true);
+                else if (!strcmp(proc, "UnparkCap"))
+                    uncapCheck->setChecked(true);
             }
         }
-        else if (!strcmp(tagXMLEle(ep), "CompletionCondition"))
+        else if (!strcmp(tag, "ShutdownProcedure"))
         {
-            for (subEP = nextXMLEle(ep, 1); subEP != nullptr; subEP = nextXMLEle(ep, 0))
+            XMLEle *procedure;
+            shutdownScript->clear();
+            warmCCDCheck->setChecked(false);
+            parkDomeCheck->setChecked(false);
+            parkMountCheck->setChecked(false);
+            capCheck->setChecked(false);
+
+            for (procedure = nextXMLEle(ep, 1); procedure != nullptr; procedure = nextXMLEle(ep, 0))
             {
-                if (!strcmp("Sequence", pcdataXMLEle(subEP)))
-                    sequenceCompletionR->setChecked(true);
-                else if (!strcmp("Repeat", pcdataXMLEle(subEP)))
-                {
-                    repeatCompletionR->setChecked(true);
-                    repeatsSpin->setValue(cLocale.toInt(findXMLAttValu(subEP, "value")));
-                }
-                else if (!strcmp("Loop", pcdataXMLEle(subEP)))
-                    loopCompletionR->setChecked(true);
-                else if (!strcmp("At", pcdataXMLEle(subEP)))
+                const char *proc = pcdataXMLEle(procedure);
+
+                if (!strcmp(proc, "ShutdownScript"))
                 {
-                    timeCompletionR->setChecked(true);
-                    completionTimeEdit->setDateTime(QDateTime::fromString(findXMLAttValu(subEP, "value"), Qt::ISODate));
+                    shutdownScript->setText(findXMLAttValu(procedure, "value"));
+                    shutdownScriptURL = QUrl::fromUserInput(shutdownScript->text());
                 }
+                else if (!strcmp(proc, "ParkDome"))
+                    parkDomeCheck->setChecked(true);
+                else if (!strcmp(proc, "ParkMount"))
+                    parkMountCheck->setChecked(true);
+                else if (!strcmp(proc, "ParkCap"))
+                    capCheck->setChecked(true);
+                else if (!strcmp(proc, "WarmCCD"))
+                    warmCCDCheck->setChecked(true);
             }
         }
-        else if (!strcmp(tagXMLEle(ep), "Steps"))
-        {
-            XMLEle *module;
-            trackStepCheck->setChecked(false);
-            focusStepCheck->setChecked(false);
-            alignStepCheck->setChecked(false);
-            guideStepCheck->setChecked(false);
+    };
 
-            for (module = nextXMLEle(ep, 1); module != nullptr; module = nextXMLEle(ep, 0))
-            {
-                const char *proc = pcdataXMLEle(module);
-
-                if (!strcmp(proc, "Track"))
-                    trackStepCheck->setChecked(true);
-                else if (!strcmp(proc, "Focus"))
-                    focusStepCheck->setChecked(true);
-                else if (!strcmp(proc, "Align"))
-                    alignStepCheck->setChecked(true);
-                else if (!strcmp(proc, "Guide"))
-                    guideStepCheck->setChecked(true);
-            }
-        }
+    QList<SchedulerJob *> loadedJobs;
+    bool const loaded = m_Engine.loadJobs(fileURL, loadedJobs, processElement);
+
+    // Show each job in the editor and add it from there, as if it was entered by the end-user
+    for (SchedulerJob *job : loadedJobs)
+    {
+        syncGUIToJob(job);
+        sequenceURL = job->getSequenceFile();
+        fitsURL     = job->getFITSFile();
+        addToQueueB->setEnabled(true);
+        saveJob();
     }
+    qDeleteAll(loadedJobs);
+
+    if (!loaded)
+    {
+        state = old_state;
+        return false;
+    }
+
+    schedulerURL = QUrl::fromLocalFile(fileURL);
+    mosaicB->setEnabled(true);
+    mDirty = false;
+    // update save button tool tip
+    queueSaveB->setToolTip("Save schedule to " + schedulerURL.fileName());
 
-    addToQueueB->setEnabled(true);
-    saveJob();
 
+    state = old_state;
     return true;
 }
 
@@ -4771,17 +3999,9 @@ void Scheduler::updateCompletedJobsCount(bool forced)
     /* Use a temporary map in order to limit the number of file searches */
     SchedulerJob::CapturedFramesMap newFramesCount;
 
-    /* FIXME: Capture storage cache is refreshed too often, feature requires rework. */
-
-    /* Check if one job is idle or requires evaluation - if so, force refresh */
-    forced |= std::any_of(jobs.begin(), jobs.end(), [](SchedulerJob * oneJob) -> bool
-    {
-        SchedulerJob::JOBStatus const state = oneJob->getState();
-        return state == SchedulerJob::JOB_IDLE || state == SchedulerJob::JOB_EVALUATION;});
-
-    /* If update is forced, clear the frame map */
+    /* If update is forced, list the storage again */
     if (forced)
-        capturedFramesCount.clear();
+        m_CaptureStorage.clear();
 
     /* Enumerate SchedulerJobs to count captures that are already stored */
     for (SchedulerJob *oneJob : jobs)
@@ -4791,7 +4011,7 @@ void Scheduler::updateCompletedJobsCount(bool forced)
 
         //oneJob->setLightFramesRequired(false);
         /* Look into the sequence requirements, bypass if invalid */
-        if (loadSequenceQueue(oneJob->getSequenceFile().toLocalFile(), oneJob, seqjobs, hasAutoFocus) == false)
+        if (m_Engine.loadSequenceQueue(oneJob->getSequenceFile().toLocalFile(), oneJob, seqjobs, hasAutoFocus) == false)
         {
             appendLogText(i18n("Warning: job '%1' has inaccessible sequence '%2', marking invalid.", oneJob->getName(),
                                oneJob->getSequenceFile().toLocalFile()));
@@ -4814,16 +4034,9 @@ void Scheduler::updateCompletedJobsCount(bool forced)
             if (newFramesCount.constEnd() != newFramesCount.constFind(signature))
                 continue;
 
-            /* If signature was processed during an earlier run, use the earlier count */
-            QMap<QString, uint16_t>::const_iterator const earlierRunIterator = capturedFramesCount.constFind(signature);
-            if (capturedFramesCount.constEnd() != earlierRunIterator)
-            {
-                newFramesCount[signature] = earlierRunIterator.value();
-                continue;
-            }
-
-            /* Else recount captures already stored */
-            newFramesCount[signature] = getCompletedFiles(signature, oneSeqJob->getFullPrefix());
+            /* Else count captures already stored, from the index of the storage */
+            newFramesCount[signature] = m_CaptureStorage.count(QFileInfo(signature).dir().path(),
+                                        oneSeqJob->getFullPrefix());
         }
 
         // determine whether we need to continue capturing, depending on captured frames
@@ -4851,6 +4064,7 @@ void Scheduler::updateCompletedJobsCount(bool forced)
     }
 
     capturedFramesCount = newFramesCount;
+    m_Engine.setCapturedFramesCount(capturedFramesCount);
 
     //if (forced)
     {
@@ -4861,313 +4075,6 @@ void Scheduler::updateCompletedJobsCount(bool forced)
     }
 }
 
-bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
-{
-    static SchedulerJob *jobWarned = nullptr;
-
-    /* updateCompletedJobsCount(); */
-
-    // Load the sequence job associated with the argument scheduler job.
-    QList<SequenceJob *> seqJobs;
-    bool hasAutoFocus = false;
-    if (loadSequenceQueue(schedJob->getSequenceFile().toLocalFile(), schedJob, seqJobs, hasAutoFocus) == false)
-    {
-        qCWarning(KSTARS_EKOS_SCHEDULER) <<
-                                         QString("Warning: Failed estimating the duration of job '%1', its sequence file is invalid.").arg(
-                                             schedJob->getSequenceFile().toLocalFile());
-        return false;
-    }
-
-    // FIXME: setting in-sequence focus should be done in XML processing.
-    schedJob->setInSequenceFocus(hasAutoFocus);
-
-    // Stop spam of log on re-evaluation. If we display the warning once, then that's it.
-    if (schedJob != jobWarned && hasAutoFocus && !(schedJob->getStepPipeline() & SchedulerJob::USE_FOCUS))
-    {
-        appendLogText(
-            i18n("Warning: Job '%1' has its focus step disabled, periodic and/or HFR procedures currently set in its sequence will not occur.",
-                 schedJob->getName()));
-        jobWarned = schedJob;
-    }
-
-    /* This is the map of captured frames for this scheduler job, keyed per storage signature.
-     * It will be forwarded to the Capture module in order to capture only what frames are required.
-     * If option "Remember Job Progress" is disabled, this map will be empty, and the Capture module will process all requested captures unconditionally.
-     */
-    SchedulerJob::CapturedFramesMap capture_map;
-    bool const rememberJobProgress = Options::rememberJobProgress();
-
-    int totalSequenceCount = 0, totalCompletedCount = 0;
-    double totalImagingTime  = 0;
-
-    // Determine number of captures in the scheduler job
-    int capturesPerRepeat = 0;
-    foreach (SequenceJob *seqJob, seqJobs)
-        capturesPerRepeat += seqJob->getCount();
-
-    // Loop through sequence jobs to calculate the number of required frames and estimate duration.
-    foreach (SequenceJob *seqJob, seqJobs)
-    {
-        // FIXME: find a way to actually display the filter name.
-        QString seqName = i18n("Job '%1' %2x%3\" %4", schedJob->getName(), seqJob->getCount(), seqJob->getExposure(),
-                               seqJob->getFilterName());
-
-        if (seqJob->getUploadMode() == ISD::CCD::UPLOAD_LOCAL)
-        {
-            qCInfo(KSTARS_EKOS_SCHEDULER) <<
-                                          QString("%1 duration cannot be estimated time since the sequence saves the files remotely.").arg(seqName);
-            schedJob->setEstimatedTime(-2);
-            qDeleteAll(seqJobs);
-            return true;
-        }
-
-        // Note that looping jobs will have zero repeats required.
-        int const captures_required = seqJob->getCount() * schedJob->getRepeatsRequired();
-
-        int captures_completed = 0;
-        if (rememberJobProgress)
-        {
-            /* Enumerate sequence jobs associated to this scheduler job, and assign them a completed count.
-             *
-             * The objective of this block is to fill the storage map of the scheduler job with completed counts for each capture storage.
-             *
-             * Sequence jobs capture to a storage folder, and are given a count of captures to store at that location.
-             * The tricky part is to make sure the repeat count of the scheduler job is properly transferred to each sequence job.
-             *
-             * For instance, a scheduler job repeated three times must execute the full list of sequence jobs three times, thus
-             * has to tell each sequence job it misses all captures, three times. It cannot tell the sequence job three captures are
-             * missing, first because that's not how the sequence job is designed (completed count, not required count), and second
-             * because this would make the single sequence job repeat three times, instead of repeating the full list of sequence
-             * jobs three times.
-             *
-             * The consolidated storage map will be assigned to each sequence job based on their signature when the scheduler job executes them.
-             *
-             * For instance, consider a RGBL sequence of single captures. The map will store completed captures for R, G, B and L storages.
-             * If R and G have 1 file each, and B and L have no files, map[storage(R)] = map[storage(G)] = 1 and map[storage(B)] = map[storage(L)] = 0.
-             * When that scheduler job executes, only B and L captures will be processed.
-             *
-             * In the case of a RGBLRGB sequence of single captures, the second R, G and B map items will count one less capture than what is really in storage.
-             * If R and G have 1 file each, and B and L have no files, map[storage(R1)] = map[storage(B1)] = 1, and all others will be 0.
-             * When that scheduler job executes, B1, L, R2, G2 and B2 will be processed.
-             *
-             * This doesn't handle the case of duplicated scheduler jobs, that is, scheduler jobs with the same storage for capture sets.
-             * Those scheduler jobs will all change state to completion at the same moment as they all target the same storage.
-             * This is why it is important to manage the repeat count of the scheduler job, as stated earlier.
-             */
-
-            // Retrieve cached count of completed captures for the output folder of this seqJob
-            QString const signature = seqJob->getSignature();
-            QString const signature_path = QFileInfo(signature).path();
-            captures_completed = capturedFramesCount[signature];
-
-            qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 sees %2 captures in output folder '%3'.").arg(seqName).arg(
-                                              captures_completed).arg(signature_path);
-
-            // Enumerate sequence jobs to check how many captures are completed overall in the same storage as the current one
-            foreach (SequenceJob *prevSeqJob, seqJobs)
-            {
-                // Enumerate seqJobs up to the current one
-                if (seqJob == prevSeqJob)
-                    break;
-
-                // If the previous sequence signature matches the current, reduce completion count to take duplicates into account
-                if (!signature.compare(prevSeqJob->getLocalDir() + prevSeqJob->getDirectoryPostfix()))
-                {
-                    // Note that looping jobs will have zero repeats required.
-                    int const previous_captures_required = prevSeqJob->getCount() * schedJob->getRepeatsRequired();
-                    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 has a previous duplicate sequence job requiring %2 captures.").arg(
-                                                      seqName).arg(previous_captures_required);
-                    captures_completed -= previous_captures_required;
-                }
-
-                // Now completed count can be needlessly negative for this job, so clamp to zero
-                if (captures_completed < 0)
-                    captures_completed = 0;
-
-                // And break if no captures remain, this job has to execute
-                if (captures_completed == 0)
-                    break;
-            }
-
-            // Finally we're only interested in the number of captures required for this sequence item
-            if (0 < captures_required && captures_required < captures_completed)
-                captures_completed = captures_required;
-
-            qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 has completed %2/%3 of its required captures in output folder '%4'.").arg(
-                                              seqName).arg(captures_completed).arg(captures_required).arg(signature_path);
-
-            // Update the completion count for this signature in the frame map if we still have captures to take.
-            // That frame map will be transferred to the Capture module, for which the sequence is a single batch of the scheduler job.
-            // For instance, consider a scheduler job repeated 3 times and using a 3xLum sequence, so we want 9xLum in the end.
-            // - If no captures are already processed, the frame map contains Lum=0
-            // - If 1xLum are already processed, the frame map contains Lum=0 when the batch executes, so that 3xLum may be taken.
-            // - If 3xLum are already processed, the frame map contains Lum=0 when the batch executes, as we still need more than what the sequence provides.
-            // - If 7xLum are already processed, the frame map contains Lum=1 when the batch executes, because we now only need 2xLum to finish the job.
-            // Therefore we need to specify a number of existing captures only for the last batch of the scheduler job.
-            // In the last batch, we only need the remainder of frames to get to the required total.
-            if (captures_completed < captures_required)
-            {
-                if (captures_required - captures_completed < seqJob->getCount())
-                    capture_map[signature] = captures_completed % seqJob->getCount();
-                else
-                    capture_map[signature] = 0;
-            }
-            else capture_map[signature] = captures_required;
-
-            // From now on, 'captures_completed' is the number of frames completed for the *current* sequence job
-        }
-        // Else rely on the captures done during this session
-        else
-            captures_completed = schedJob->getCompletedCount() / capturesPerRepeat * seqJob->getCount();
-
-        // Check if we still need any light frames. Because light frames changes the flow of the observatory startup
-        // Without light frames, there is no need to do focusing, alignment, guiding...etc
-        // We check if the frame type is LIGHT and if either the number of captures_completed frames is less than required
-        // OR if the completion condition is set to LOOP so it is never complete due to looping.
-        // Note that looping jobs will have zero repeats required.
-        // FIXME: As it is implemented now, FINISH_LOOP may loop over a capture-complete, therefore inoperant, scheduler job.
-        bool const areJobCapturesComplete = !(captures_completed < captures_required || 0 == captures_required);
-        if (seqJob->getFrameType() == FRAME_LIGHT)
-        {
-            if(areJobCapturesComplete)
-            {
-                qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 completed its sequence of %2 light frames.").arg(seqName).arg(
-                                                  captures_required);
-            }
-        }
-        else
-        {
-            qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 captures calibration frames.").arg(seqName);
-        }
-
-        totalSequenceCount += captures_required;
-        totalCompletedCount += captures_completed;
-
-        /* If captures are not complete, we have imaging time left */
-        if (!areJobCapturesComplete)
-        {
-            /* if looping, consider we always have one capture left */
-            unsigned int const captures_to_go = 0 < captures_required ? captures_required - captures_completed : 1;
-            totalImagingTime += fabs((seqJob->getExposure() + seqJob->getDelay()) * captures_to_go);
-
-            /* If we have light frames to process, add focus/dithering delay */
-            if (seqJob->getFrameType() == FRAME_LIGHT)
-            {
-                // If inSequenceFocus is true
-                if (hasAutoFocus)
-                {
-                    // Wild guess that each in sequence auto focus takes an average of 30 seconds. It can take any where from 2 seconds to 2+ minutes.
-                    // FIXME: estimating one focus per capture is probably not realistic.
-                    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 requires a focus procedure.").arg(seqName);
-                    totalImagingTime += captures_to_go * 30;
-                }
-                // If we're dithering after each exposure, that's another 10-20 seconds
-                if (schedJob->getStepPipeline() & SchedulerJob::USE_GUIDE && Options::ditherEnabled())
-                {
-                    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 requires a dither procedure.").arg(seqName);
-                    totalImagingTime += (captures_to_go * 15) / Options::ditherFrames();
-                }
-            }
-        }
-    }
-
-    schedJob->setCapturedFramesMap(capture_map);
-    schedJob->setSequenceCount(totalSequenceCount);
-
-    // only in case we remember the job progress, we change the completion count
-    if (rememberJobProgress)
-        schedJob->setCompletedCount(totalCompletedCount);
-
-    qDeleteAll(seqJobs);
-
-    // FIXME: Move those ifs away to the caller in order to avoid estimating in those situations!
-
-    // We can't estimate times that do not finish when sequence is done
-    if (schedJob->getCompletionCondition() == SchedulerJob::FINISH_LOOP)
-    {
-        // We can't know estimated time if it is looping indefinitely
-        schedJob->setEstimatedTime(-2);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                       QString("Job '%1' is configured to loop until Scheduler is stopped manually, has undefined imaging time.")
-                                       .arg(schedJob->getName());
-    }
-    // If we know startup and finish times, we can estimate time right away
-    else if (schedJob->getStartupCondition() == SchedulerJob::START_AT &&
-             schedJob->getCompletionCondition() == SchedulerJob::FINISH_AT)
-    {
-        // FIXME: SchedulerJob is probably doing this already
-        qint64 const diff = schedJob->getStartupTime().secsTo(schedJob->getCompletionTime());
-        schedJob->setEstimatedTime(diff);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' has a startup time and fixed completion time, will run for %2.")
-                                       .arg(schedJob->getName())
-                                       .arg(dms(diff * 15.0 / 3600.0f).toHMSString());
-    }
-    // If we know finish time only, we can roughly estimate the time considering the job starts now
-    else if (schedJob->getStartupCondition() != SchedulerJob::START_AT &&
-             schedJob->getCompletionCondition() == SchedulerJob::FINISH_AT)
-    {
-        qint64 const diff = KStarsData::Instance()->lt().secsTo(schedJob->getCompletionTime());
-        schedJob->setEstimatedTime(diff);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) <<
-                                       QString("Job '%1' has no startup time but fixed completion time, will run for %2 if started now.")
-                                       .arg(schedJob->getName())
-                                       .arg(dms(diff * 15.0 / 3600.0f).toHMSString());
-    }
-    // Rely on the estimated imaging time to determine whether this job is complete or not - this makes the estimated time null
-    else if (totalImagingTime <= 0)
-    {
-        schedJob->setEstimatedTime(0);
-
-        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' will not run, complete with %2/%3 captures.")
-                                       .arg(schedJob->getName()).arg(totalCompletedCount).arg(totalSequenceCount);
-    }
-    // Else consolidate with step durations
-    else
-    {
-        if (schedJob->getLightFramesRequired())
-        {
-            /* FIXME: estimation should base on actual measure of each step, eventually with preliminary data as what it used now */
-            // Are we doing tracking? It takes about 30 seconds
-            if (schedJob->getStepPipeline() & SchedulerJob::USE_TRACK)
-                totalImagingTime += 30;
-            // Are we doing initial focusing? That can take about 2 minutes
-            if (schedJob->getStepPipeline() & SchedulerJob::USE_FOCUS)
-                totalImagingTime += 120;
-            // Are we doing astrometry? That can take about 60 seconds
-            if (schedJob->getStepPipeline() & SchedulerJob::USE_ALIGN)
-            {
-                totalImagingTime += 60;
-            }
-            // Are we doing guiding?
-            if (schedJob->getStepPipeline() & SchedulerJob::USE_GUIDE)
-            {
-                // Looping, finding guide star, settling takes 15 sec
-                totalImagingTime += 15;
-
-                // Add guiding settle time from dither setting (used by phd2::guide())
-                totalImagingTime += Options::ditherSettle();
-                // Add guiding settle time from ekos sccheduler setting
-                totalImagingTime += Options::guidingSettle();
-
-                // If calibration always cleared
-                // then calibration process can take about 2 mins
-                if(Options::resetGuideCalibration())
-                    totalImagingTime += 120;
-            }
-        }
-        dms const estimatedTime(totalImagingTime * 15.0 / 3600.0);
-        schedJob->setEstimatedTime(totalImagingTime);
-
-        qCInfo(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' estimated to take %2 to complete.").arg(schedJob->getName(),
-                                      estimatedTime.toHMSString());
-    }
-
-    return true;
-}
-
 void Scheduler::parkMount()
 {
     QVariant parkingStatus = mountInterface->property("parkStatus");
@@ -5870,9 +4777,9 @@ void Scheduler::sortJobsPerAltitude()
 
 void Scheduler::updatePreDawn()
 {
-    double earlyDawn = Dawn - Options::preDawnTime() / (60.0 * 24.0);
+    double earlyDawn = m_Engine.getDawn() - Options::preDawnTime() / (60.0 * 24.0);
     int dayOffset    = 0;
-    QTime dawn       = QTime(0, 0, 0).addSecs(Dawn * 24 * 3600);
+    QTime dawn       = QTime(0, 0, 0).addSecs(m_Engine.getDawn() * 24 * 3600);
     if (KStarsData::Instance()->lt().time() >= dawn)
         dayOffset = 1;
     preDawnDateTime.setDate(KStarsData::Instance()->lt().date().addDays(dayOffset));
@@ -6360,225 +5267,9 @@ void Scheduler::loadProfiles()
     }
 }
 
-bool Scheduler::loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob, QList<SequenceJob *> &jobs,
-                                  bool &hasAutoFocus)
-{
-    QFile sFile;
-    sFile.setFileName(fileURL);
-
-    if (!sFile.open(QIODevice::ReadOnly))
-    {
-        QString message = i18n("Unable to open sequence queue file '%1'", fileURL);
-        KSNotification::sorry(message, i18n("Could Not Open File"));
-        return false;
-    }
-
-    LilXML *xmlParser = newLilXML();
-    char errmsg[MAXRBUF];
-    XMLEle *root = nullptr;
-    XMLEle *ep   = nullptr;
-    char c;
-
-    while (sFile.getChar(&c))
-    {
-        root = readXMLEle(xmlParser, c, errmsg);
-
-        if (root)
-        {
-            for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
-            {
-                if (!strcmp(tagXMLEle(ep), "Autofocus"))
-                    hasAutoFocus = (!strcmp(findXMLAttValu(ep, "enabled"), "true"));
-                else if (!strcmp(tagXMLEle(ep), "Job"))
-                    jobs.append(processJobInfo(ep, schedJob));
-            }
-            delXMLEle(root);
-        }
-        else if (errmsg[0])
-        {
-            appendLogText(QString(errmsg));
-            delLilXML(xmlParser);
-            qDeleteAll(jobs);
-            return false;
-        }
-    }
-
-    return true;
-}
-
-SequenceJob *Scheduler::processJobInfo(XMLEle *root, SchedulerJob *schedJob)
-{
-    XMLEle *ep    = nullptr;
-    XMLEle *subEP = nullptr;
-
-    const QMap<QString, CCDFrameType> frameTypes =
-    {
-        { "Light", FRAME_LIGHT }, { "Dark", FRAME_DARK }, { "Bias", FRAME_BIAS }, { "Flat", FRAME_FLAT }
-    };
-
-    SequenceJob *job = new SequenceJob();
-    QString rawPrefix, frameType, filterType;
-    double exposure    = 0;
-    bool filterEnabled = false, expEnabled = false, tsEnabled = false;
-
-    /* Reset light frame presence flag before enumerating */
-    // JM 2018-09-14: If last sequence job is not LIGHT
-    // then scheduler job light frame is set to whatever last sequence job is
-    // so if it was non-LIGHT, this value is set to false which is wrong.
-    //if (nullptr != schedJob)
-    //    schedJob->setLightFramesRequired(false);
-
-    for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
-    {
-        if (!strcmp(tagXMLEle(ep), "Exposure"))
-        {
-            exposure = atof(pcdataXMLEle(ep));
-            job->setExposure(exposure);
-        }
-        else if (!strcmp(tagXMLEle(ep), "Filter"))
-        {
-            filterType = QString(pcdataXMLEle(ep));
-        }
-        else if (!strcmp(tagXMLEle(ep), "Type"))
-        {
-            frameType = QString(pcdataXMLEle(ep));
-
-            /* Record frame type and mark presence of light frames for this sequence */
-            CCDFrameType const frameEnum = frameTypes[frameType];
-            job->setFrameType(frameEnum);
-            if (FRAME_LIGHT == frameEnum && nullptr != schedJob)
-                schedJob->setLightFramesRequired(true);
-        }
-        else if (!strcmp(tagXMLEle(ep), "Prefix"))
-        {
-            subEP = findXMLEle(ep, "RawPrefix");
-            if (subEP)
-                rawPrefix = QString(pcdataXMLEle(subEP));
-
-            subEP = findXMLEle(ep, "FilterEnabled");
-            if (subEP)
-                filterEnabled = !strcmp("1", pcdataXMLEle(subEP));
-
-            subEP = findXMLEle(ep, "ExpEnabled");
-            if (subEP)
-                expEnabled = (!strcmp("1", pcdataXMLEle(subEP)));
-
-            subEP = findXMLEle(ep, "TimeStampEnabled");
-            if (subEP)
-                tsEnabled = (!strcmp("1", pcdataXMLEle(subEP)));
-
-            job->setPrefixSettings(rawPrefix, filterEnabled, expEnabled, tsEnabled);
-        }
-        else if (!strcmp(tagXMLEle(ep), "Count"))
-        {
-            job->setCount(atoi(pcdataXMLEle(ep)));
-        }
-        else if (!strcmp(tagXMLEle(ep), "Delay"))
-        {
-            job->setDelay(atoi(pcdataXMLEle(ep)));
-        }
-        else if (!strcmp(tagXMLEle(ep), "FITSDirectory"))
-        {
-            job->setLocalDir(pcdataXMLEle(ep));
-        }
-        else if (!strcmp(tagXMLEle(ep), "RemoteDirectory"))
-        {
-            job->setRemoteDir(pcdataXMLEle(ep));
-        }
-        else if (!strcmp(tagXMLEle(ep), "UploadMode"))
-        {
-            job->setUploadMode(static_cast<ISD::CCD::UploadMode>(atoi(pcdataXMLEle(ep))));
-        }
-    }
-
-    // Sanitize name
-    QString targetName = schedJob->getName();
-    targetName = targetName.replace( QRegularExpression("\\s|/|\\(|\\)|:|\\*|~|\"" ), "_" )
-                 // Remove any two or more __
-                 .replace( QRegularExpression("_{2,}"), "_")
-                 // Remove any _ at the end
-                 .replace( QRegularExpression("_$"), "");
-
-    // Because scheduler sets the target name in capture module
-    // it would be the same as the raw prefix
-    if (targetName.isEmpty() == false && rawPrefix.isEmpty())
-        rawPrefix = targetName;
-
-    // Make full prefix
-    QString imagePrefix = rawPrefix;
-
-    if (imagePrefix.isEmpty() == false)
-        imagePrefix += '_';
-
-    imagePrefix += frameType;
-
-    if (filterEnabled && filterType.isEmpty() == false &&
-            (job->getFrameType() == FRAME_LIGHT || job->getFrameType() == FRAME_FLAT))
-    {
-        imagePrefix += '_';
-
-        imagePrefix += filterType;
-    }
-
-    if (expEnabled)
-    {
-        imagePrefix += '_';
-
-        if (exposure == static_cast<int>(exposure))
-            // Whole number
-            imagePrefix += QString::number(exposure, 'd', 0) + QString("_secs");
-        else
-        {
-            // Decimal
-            if (exposure >= 0.001)
-                imagePrefix += QString::number(exposure, 'f', 3) + QString("_secs");
-            else
-                imagePrefix += QString::number(exposure, 'f', 6) + QString("_secs");
-        }
-    }
-
-    job->setFullPrefix(imagePrefix);
-
-    // Directory postfix
-    QString directoryPostfix;
-
-    /* FIXME: Refactor directoryPostfix assignment, whose code is duplicated in capture.cpp */
-    if (targetName.isEmpty())
-        directoryPostfix = QLatin1String("/") + frameType;
-    else
-        directoryPostfix = QLatin1String("/") + targetName + QLatin1String("/") + frameType;
-    if ((job->getFrameType() == FRAME_LIGHT || job->getFrameType() == FRAME_FLAT) && filterType.isEmpty() == false)
-        directoryPostfix += QLatin1String("/") + filterType;
-
-    job->setDirectoryPostfix(directoryPostfix);
-
-    return job;
-}
-
-int Scheduler::getCompletedFiles(const QString &path, const QString &seqPrefix)
+void Scheduler::addSequenceImage(const QString &filename)
 {
-    int seqFileCount = 0;
-    QFileInfo const path_info(path);
-    QString const sig_dir(path_info.dir().path());
-    QString const sig_file(path_info.completeBaseName());
-
-    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Searching in path '%1', files '%2*' for prefix '%3'...").arg(sig_dir, sig_file,
-                                   seqPrefix);
-    QDirIterator it(sig_dir, QDir::Files);
-
-    /* FIXME: this counts all files with prefix in the storage location, not just captures. DSS analysis files are counted in, for instance. */
-    while (it.hasNext())
-    {
-        QString const fileName = QFileInfo(it.next()).completeBaseName();
-
-        if (fileName.startsWith(seqPrefix))
-        {
-            qCDebug(KSTARS_EKOS_SCHEDULER) << QString("> Found '%1'").arg(fileName);
-            seqFileCount++;
-        }
-    }
-
-    return seqFileCount;
+    m_CaptureStorage.addFile(filename);
 }
 
 void Scheduler::setINDICommunicationStatus(Ekos::CommunicationStatus status)
@@ -6630,6 +5321,13 @@ void Scheduler::registerNewModule(const QString &name)
         connect(captureInterface, SIGNAL(ready()), this, SLOT(syncProperties()));
         connect(captureInterface, SIGNAL(newStatus(Ekos::CaptureState)), this, SLOT(setCaptureStatus(Ekos::CaptureState)),
                 Qt::UniqueConnection);
+
+        // The D-Bus interface declares newSequenceImage with the file name only, which Capture does not emit, so
+        // its adaptor never relays it: listen to the module itself for the captures to index
+        Capture *capture = Ekos::Manager::Instance()->captureModule();
+        if (capture == nullptr ||
+                !connect(capture, &Capture::newSequenceImage, this, &Scheduler::addSequenceImage, Qt::UniqueConnection))
+            qCWarning(KSTARS_EKOS_SCHEDULER) << "Failed to connect to the captures of Capture, their storage is listed again when it changes.";
     }
     else if (name == "Mount")
     {
@@ -6945,14 +5643,13 @@ void Scheduler::setCaptureStatus(Ekos::CaptureState status)
         }
         else if (status == Ekos::CAPTURE_IMAGE_RECEIVED)
         {
-            // We received a new image, but we don't know precisely where so update the storage map and re-estimate job times.
-            // FIXME: rework this once capture storage is reworked
+            // We received a new image, which Capture reported to the storage index, so recount captures and re-estimate job times.
             if (Options::rememberJobProgress())
             {
-                updateCompletedJobsCount(true);
+                updateCompletedJobsCount();
 
                 for (SchedulerJob * job : jobs)
-                    estimateJobTime(job);
+                    m_Engine.estimateJobTime(job, KStarsData::Instance()->lt());
             }
             // Else if we don't remember the progress on jobs, increase the completed count for the current job only - no cross-checks
             else currentJob->setCompletedCount(currentJob->getCompletedCount() + 1);
@@ -12,6 +12,8 @@
 #pragma once
 
 #include "ui_scheduler.h"
+#include "capturestorageindex.h"
+#include "schedulerengine.h"
 #include "ekos/align/align.h"
 #include "indi/indiweather.h"
 
@@ -26,6 +28,7 @@
 #include <cstdint>
 
 class QProgressIndicator;
+class QStringListModel;
 
 class GeoLocation;
 class SchedulerJob;
@@ -290,6 +293,8 @@ class Scheduler : public QWidget, public Ui::Scheduler
         void setAlignStatus(Ekos::AlignState status);
         void setGuideStatus(Ekos::GuideState status);
         void setCaptureStatus(Ekos::CaptureState status);
+        /** @brief addSequenceImage Add a capture just saved by the Capture module to the storage index. */
+        void addSequenceImage(const QString &filename);
         void setFocusStatus(Ekos::FocusState status);
         void setMountStatus(ISD::Telescope::Status status);
         void setWeatherStatus(ISD::Weather::Status status);
@@ -299,6 +304,11 @@ class Scheduler : public QWidget, public Ui::Scheduler
              */
         void selectObject();
 
+        /**
+             * @brief offer the names of known objects starting with the target name typed so far.
+             */
+        void updateNameCompletions(const QString &text);
+
         /**
              * @brief Selects FITS file for solving.
              */
@@ -500,21 +510,6 @@ class Scheduler : public QWidget, public Ui::Scheduler
 
         void executeScript(const QString &filename);
 
-        /**
-             * @brief getDarkSkyScore Get the dark sky score of a date and time. The further from dawn the better.
-             * @param when date and time to check the dark sky score, now if omitted
-             * @return Dark sky score. Daylight get bad score, as well as pre-dawn to dawn.
-             */
-        int16_t getDarkSkyScore(QDateTime const &when = QDateTime()) const;
-
-        /**
-             * @brief calculateJobScore Calculate job dark sky score, altitude score, and moon separation scores and returns the sum.
-             * @param job Target
-             * @param when date and time to evaluate constraints, now if omitted.
-             * @return Total score
-             */
-        int16_t calculateJobScore(SchedulerJob const *job, QDateTime const &when = QDateTime()) const;
-
         /**
              * @brief getWeatherScore Get current weather condition score.
              * @return If weather condition OK, return score 0, else bad score.
@@ -624,25 +619,11 @@ class Scheduler : public QWidget, public Ui::Scheduler
              */
         bool saveScheduler(const QUrl &fileURL);
 
-        /**
-             * @brief processJobInfo Process the job information from a scheduler file and populate jobs accordingly
-             * @param root XML root element of JOB
-             * @return true on success, false on failure.
-             */
-        bool processJobInfo(XMLEle *root);
-
         /**
              * @brief updatePreDawn Update predawn time depending on current time and user offset
              */
         void updatePreDawn();
 
-        /**
-             * @brief estimateJobTime Estimates the time the job takes to complete based on the sequence file and what modules to utilize during the observation run.
-             * @param job target job
-             * @return Estimated time in seconds.
-             */
-        bool estimateJobTime(SchedulerJob *schedJob);
-
         /**
              * @brief createJobSequence Creates a job sequence for the mosaic tool given the prefix and output dir. The currently selected sequence file is modified
              * and a new version given the supplied parameters are saved to the output directory
@@ -671,20 +652,17 @@ class Scheduler : public QWidget, public Ui::Scheduler
 
         /**
             * @brief updateCompletedJobsCount For each scheduler job, examine sequence job storage and count captures.
-            * @param forced forces recounting captures unconditionally if true, else only IDLE, EVALUATION or new jobs are examined.
+            * @param forced lists the storage directories again if true, else captures are counted from the storage index.
             */
         void updateCompletedJobsCount(bool forced = false);
 
-        SequenceJob *processJobInfo(XMLEle *root, SchedulerJob *schedJob);
-        bool loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob, QList<SequenceJob *> &jobs,
-                               bool &hasAutoFocus);
-        int getCompletedFiles(const QString &path, const QString &seqPrefix);
-
         // retrieve the guiding status
         GuideState getGuidingStatus();
 
 
         Ekos::Scheduler *ui { nullptr };
+        /// Target names offered for completion
+        QStringListModel *nameCompletionModel { nullptr };
         //DBus interfaces
         QPointer<QDBusInterface> focusInterface { nullptr };
         QPointer<QDBusInterface> ekosInterface { nullptr };
@@ -730,10 +708,8 @@ class Scheduler : public QWidget, public Ui::Scheduler
         uint16_t captureBatch { 0 };
         /// Startup and Shutdown scripts process
         QProcess scriptProcess;
-        /// Store day fraction of dawn to calculate dark skies range
-        double Dawn { -1 };
-        /// Store day fraction of dusk to calculate dark skies range
-        double Dusk { -1 };
+        /// Scores, estimates and orders the jobs of the queue
+        SchedulerEngine m_Engine;
         /// Pre-dawn is where we stop all jobs, it is a user-configurable value before Dawn.
         QDateTime preDawnDateTime;
         /// Dusk date time
@@ -783,6 +759,8 @@ class Scheduler : public QWidget, public Ui::Scheduler
         QUrl dirPath;
 
         QMap<QString, uint16_t> capturedFramesCount;
+        /// Files found in the capture storage, to count captures without listing directories on every refresh
+        CaptureStorageIndex m_CaptureStorage;
 
         bool m_MountReady { false };
         bool m_CaptureReady { false };
@@ -0,0 +1,1617 @@
+/*  Ekos Scheduler Engine
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "schedulerengine.h"
+
+#include "ksalmanac.h"
+#include "kstarsdata.h"
+#include "Options.h"
+#include "schedulerephemeris.h"
+#include "schedulerjob.h"
+#include "ekos/capture/sequencejob.h"
+
+#include <KLocalizedString>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QRegularExpression>
+#include <QUrl>
+
+#include <ekos_scheduler_debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define BAD_SCORE -1000
+
+namespace
+{
+// Interval at which the constraints of a simulated job are checked while it runs
+constexpr int SIMULATION_STEP_SECS = 5 * 60;
+// Bound on the jobs run in a simulation, in case interrupted jobs keep being resumed
+constexpr int MAX_SIMULATION_RUNS = 1000;
+}
+
+namespace Ekos
+{
+
+void SchedulerEngine::setLogger(const std::function<void (const QString &)> &logger)
+{
+    m_Logger = logger;
+}
+
+void SchedulerEngine::setRescheduleErrors(bool value)
+{
+    m_RescheduleErrors = value;
+}
+
+void SchedulerEngine::setCapturedFramesCount(const QMap<QString, uint16_t> &count)
+{
+    m_CapturedFramesCount = count;
+}
+
+void SchedulerEngine::appendLogText(const QString &text) const
+{
+    if (m_Logger)
+        m_Logger(text);
+    else
+        qCInfo(KSTARS_EKOS_SCHEDULER) << text;
+}
+
+void SchedulerEngine::calculateDawnDusk()
+{
+    // The almanac reads the date and location of KStars
+    Q_ASSERT(SchedulerEphemeris::kstarsData());
+    KSAlmanac ksal;
+    m_Dawn = ksal.getDawnAstronomicalTwilight() + Options::dawnOffset() / 24.0;
+    m_Dusk = ksal.getDuskAstronomicalTwilight() + Options::duskOffset() / 24.0;
+}
+
+void SchedulerEngine::prepareJobs(QList<SchedulerJob *> const &jobs, QDateTime const &now, bool running)
+{
+    /* Enumerate SchedulerJobs to consolidate imaging time */
+    foreach (SchedulerJob *job, jobs)
+    {
+        /* Let aborted jobs be rescheduled later instead of forgetting them */
+        switch (job->getState())
+        {
+            case SchedulerJob::JOB_SCHEDULED:
+                /* If job is scheduled, keep it for evaluation against others */
+                break;
+
+            case SchedulerJob::JOB_INVALID:
+            case SchedulerJob::JOB_COMPLETE:
+                /* If job is invalid or complete, bypass evaluation */
+                continue;
+
+            case SchedulerJob::JOB_BUSY:
+                /* If job is busy, edge case, bypass evaluation */
+                continue;
+
+            case SchedulerJob::JOB_ERROR:
+            case SchedulerJob::JOB_ABORTED:
+                /* If job is in error or aborted and we're running, keep its evaluation until there is nothing else to do */
+                if (running)
+                    continue;
+            /* Fall through */
+            case SchedulerJob::JOB_IDLE:
+            case SchedulerJob::JOB_EVALUATION:
+            default:
+                /* If job is idle, re-evaluate completely */
+                job->setEstimatedTime(-1);
+                break;
+        }
+
+        switch (job->getCompletionCondition())
+        {
+            case SchedulerJob::FINISH_AT:
+                /* If planned finishing time has passed, the job is set to IDLE waiting for a next chance to run */
+                if (job->getCompletionTime().isValid() && job->getCompletionTime() < now)
+                {
+                    job->setState(SchedulerJob::JOB_IDLE);
+                    continue;
+                }
+                break;
+
+            case SchedulerJob::FINISH_REPEAT:
+                // In case of a repeating jobs, let's make sure we have more runs left to go
+                // If we don't, re-estimate imaging time for the scheduler job before concluding
+                if (job->getRepeatsRemaining() == 0)
+                {
+                    appendLogText(i18n("Job '%1' has no more batches remaining.", job->getName()));
+                    if (Options::rememberJobProgress())
+                    {
+                        job->setEstimatedTime(-1);
+                    }
+                    else
+                    {
+                        job->setState(SchedulerJob::JOB_COMPLETE);
+                        job->setEstimatedTime(0);
+                        continue;
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        // -1 = Job is not estimated yet
+        // -2 = Job is estimated but time is unknown
+        // > 0  Job is estimated and time is known
+        if (job->getEstimatedTime() == -1)
+        {
+            if (estimateJobTime(job, now) == false)
+            {
+                job->setState(SchedulerJob::JOB_INVALID);
+                continue;
+            }
+        }
+
+        if (job->getEstimatedTime() == 0)
+        {
+            job->setRepeatsRemaining(0);
+            job->setState(SchedulerJob::JOB_COMPLETE);
+            continue;
+        }
+
+        // In any other case, evaluate
+        job->setState(SchedulerJob::JOB_EVALUATION);
+    }
+}
+
+void SchedulerEngine::scheduleJobs(QList<SchedulerJob *> &jobs, QDateTime const &now)
+{
+    if (jobs.isEmpty())
+        return;
+
+    /* If option says so, reorder by altitude and priority before sequencing */
+    /* FIXME: refactor so all sorts are using the same predicates */
+    /* FIXME: use std::stable_sort as qStableSort is deprecated */
+    /* FIXME: dissociate altitude and priority, it's difficult to choose which predicate to use first */
+    qCInfo(KSTARS_EKOS_SCHEDULER) << "Option to sort jobs based on priority and altitude is" << Options::sortSchedulerJobs();
+    if (Options::sortSchedulerJobs())
+    {
+        using namespace std::placeholders;
+        std::stable_sort(jobs.begin(), jobs.end(),
+                         std::bind(SchedulerJob::decreasingAltitudeOrder, _1, _2, now));
+        std::stable_sort(jobs.begin(), jobs.end(), SchedulerJob::increasingPriorityOrder);
+    }
+
+    /* The first reordered job has no lead time - this could also be the delay from now to startup */
+    jobs.first()->setLeadTime(0);
+
+    /* The objective of the following block is to make sure jobs are sequential in the list filtered previously.
+     *
+     * The algorithm manages overlap between jobs by stating that scheduled jobs that start sooner are non-movable.
+     * If the completion time of the previous job overlaps the current job, we offset the startup of the current job.
+     * Jobs that have no valid startup time when evaluated (ASAP jobs) are assigned an immediate startup time.
+     * The lead time from the Options registry is used as a buffer between jobs.
+     *
+     * Note about the situation where the current job overlaps the next job, and the next job is not movable:
+     * - If we mark the current job invalid, it will not be processed at all. Dropping is not satisfactory.
+     * - If we move the current job after the fixed job, we need to restart evaluation with a new list, and risk an
+     *   infinite loop eventually. This means swapping schedules, and is incompatible with altitude/priority sort.
+     * - If we mark the current job aborted, it will be re-evaluated each time a job is complete to see if it can fit.
+     *   Although puzzling for the end-user, this solution is dynamic: the aborted job might or might not be scheduled
+     *   at the planned time slot. But as the end-user did not enforce the start time, this is acceptable. Moreover, the
+     *   schedule will be altered by external events during the execution.
+     *
+     * Here are the constraints that have an effect on the job being examined, and indirectly on all subsequent jobs:
+     * - Twilight constraint moves jobs to the next dark sky interval.
+     * - Altitude constraint, currently linked with Moon separation, moves jobs to the next acceptable altitude time.
+     * - Culmination constraint moves jobs to the next transit time, with arbitrary offset.
+     * - Fixed startup time moves jobs to a fixed time, essentially making them non-movable, or invalid if in the past.
+     *
+     * Here are the constraints that have an effect on jobs following the job being examined:
+     * - Repeats requirement increases the duration of the current job, pushing subsequent jobs.
+     * - Looping requirement causes subsequent jobs to become invalid (until dynamic priority is implemented).
+     * - Fixed completion makes subsequent jobs start after that boundary time.
+     *
+     * However, we need a way to inform the end-user about failed schedules clearly in the UI.
+     * The message to get through is that if jobs are not sorted by altitude/priority, the aborted or invalid jobs
+     * should be modified or manually moved to a better position. If jobs are sorted automatically, aborted jobs will
+     * be processed when possible, probably not at the expected moment.
+     */
+
+    // Make sure no two jobs have the same scheduled time or overlap with other jobs
+    for (int index = 0; index < jobs.size(); index++)
+    {
+        SchedulerJob * const currentJob = jobs.at(index);
+
+        // Bypass jobs that are not marked for evaluation - we did not remove them to preserve schedule order
+        if (SchedulerJob::JOB_EVALUATION != currentJob->getState())
+            continue;
+
+        // At this point, a job with no valid start date is a problem, so consider invalid startup time is now
+        if (!currentJob->getStartupTime().isValid())
+            currentJob->setStartupTime(now);
+
+        // Locate the previous scheduled job, so that a full schedule plan may be actually consolidated
+        SchedulerJob const * previousJob = nullptr;
+        for (int i = index - 1; 0 <= i; i--)
+        {
+            SchedulerJob const * const a_job = jobs.at(i);
+
+            if (SchedulerJob::JOB_SCHEDULED == a_job->getState())
+            {
+                previousJob = a_job;
+                break;
+            }
+        }
+
+        Q_ASSERT_X(nullptr == previousJob
+                   || previousJob != currentJob, __FUNCTION__,
+                   "Previous job considered for schedule is either undefined or not equal to current.");
+
+        // Locate the next job - nothing special required except end of list check
+        SchedulerJob const * const nextJob = index + 1 < jobs.size() ? jobs.at(index + 1) : nullptr;
+
+        Q_ASSERT_X(nullptr == nextJob
+                   || nextJob != currentJob, __FUNCTION__, "Next job considered for schedule is either undefined or not equal to current.");
+
+        // We're attempting to schedule the job 10 times before making it invalid
+        for (int attempt = 1; attempt < 11; attempt++)
+        {
+            qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                           QString("Schedule attempt #%1 for %2-second job '%3' on row #%4 starting at %5, completing at %6.")
+                                           .arg(attempt)
+                                           .arg(static_cast<int>(currentJob->getEstimatedTime()))
+                                           .arg(currentJob->getName())
+                                           .arg(index + 1)
+                                           .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()))
+                                           .arg(currentJob->getCompletionTime().toString(currentJob->getDateTimeDisplayFormat()));
+
+
+            // ----- #1 Should we reject the current job because of its fixed startup time?
+            //
+            // A job with fixed startup time must be processed at the time of startup, and may be late up to leadTime.
+            // When such a job repeats, its startup time is reinitialized to prevent abort - see completion algorithm.
+            // If such a job requires night time, minimum altitude or Moon separation, the consolidated startup time is checked for errors.
+            // If all restrictions are complied with, we bypass the rest of the verifications as the job cannot be moved.
+
+            if (SchedulerJob::START_AT == currentJob->getFileStartupCondition())
+            {
+                // Check whether the current job is too far in the past to be processed - if job is repeating, its startup time is already now
+                if (currentJob->getStartupTime().addSecs(static_cast <int> (ceil(Options::leadTime() * 60))) < now)
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+
+                    appendLogText(i18n("Warning: job '%1' has fixed startup time %2 set in the past, marking invalid.",
+                                       currentJob->getName(), currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat())));
+
+                    break;
+                }
+                // Check whether the current job has a positive dark sky score at the time of startup
+                else if (true == currentJob->getEnforceTwilight() && getDarkSkyScore(currentJob->getStartupTime()) < 0)
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    appendLogText(i18n("Warning: job '%1' has a fixed start time incompatible with its twilight restriction, marking invalid.",
+                                       currentJob->getName()));
+
+                    break;
+                }
+                // Check whether the current job has a positive altitude score at the time of startup
+                else if (-90 < currentJob->getMinAltitude() && currentJob->getAltitudeScore(currentJob->getStartupTime()) < 0)
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    appendLogText(i18n("Warning: job '%1' has a fixed start time incompatible with its altitude restriction, marking invalid.",
+                                       currentJob->getName()));
+
+                    break;
+                }
+                // Check whether the current job has a positive Moon separation score at the time of startup
+                else if (0 < currentJob->getMinMoonSeparation() && currentJob->getMoonSeparationScore(currentJob->getStartupTime()) < 0)
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    appendLogText(
+                        i18n("Warning: job '%1' has a fixed start time incompatible with its Moon separation restriction, marking invalid.",
+                             currentJob->getName()));
+
+                    break;
+                }
+
+                // Check whether a previous job overlaps the current job
+                if (nullptr != previousJob && previousJob->getCompletionTime().isValid())
+                {
+                    // Calculate time we should be at after finishing the previous job
+                    QDateTime const previousCompletionTime = previousJob->getCompletionTime().addSecs(static_cast <int> (ceil(
+                                Options::leadTime() * 60.0)));
+
+                    // Make this job invalid if startup time is not achievable because a START_AT job is non-movable
+                    if (currentJob->getStartupTime() < previousCompletionTime)
+                    {
+                        currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                        appendLogText(
+                            i18n("Warning: job '%1' has fixed startup time %2 unachievable due to the completion time of its previous sibling, marking invalid.",
+                                 currentJob->getName(), currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat())));
+
+                        break;
+                    }
+
+                    currentJob->setLeadTime(previousJob->getCompletionTime().secsTo(currentJob->getStartupTime()));
+                }
+
+                // This job is non-movable, we're done
+                currentJob->setScore(calculateJobScore(currentJob, now));
+                currentJob->setState(SchedulerJob::JOB_SCHEDULED);
+                qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                               QString("Job '%1' is scheduled to start at %2, in compliance with fixed startup time requirement.")
+                                               .arg(currentJob->getName())
+                                               .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
+
+                break;
+            }
+
+            // ----- #2 Should we delay the current job because it overlaps the previous job?
+            //
+            // The previous job is considered non-movable, and its completion, plus lead time, is the origin for the current job.
+            // If no previous job exists, or if all prior jobs in the list are rejected, there is no overlap.
+            // If there is a previous job, the current job is simply delayed to avoid an eventual overlap.
+            // IF there is a previous job but it never finishes, the current job is rejected.
+            // This scheduling obviously relies on imaging time estimation: because errors stack up, future startup times are less and less reliable.
+
+            if (nullptr != previousJob)
+            {
+                if (previousJob->getCompletionTime().isValid())
+                {
+                    // Calculate time we should be at after finishing the previous job
+                    QDateTime const previousCompletionTime = previousJob->getCompletionTime().addSecs(static_cast <int> (ceil(
+                                Options::leadTime() * 60.0)));
+
+                    // Delay the current job to completion of its previous sibling if needed - this updates the completion time automatically
+                    if (currentJob->getStartupTime() < previousCompletionTime)
+                    {
+                        currentJob->setStartupTime(previousCompletionTime);
+
+                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                                       QString("Job '%1' is scheduled to start at %2, %3 seconds after %4, in compliance with previous job completion requirement.")
+                                                       .arg(currentJob->getName())
+                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()))
+                                                       .arg(previousJob->getCompletionTime().secsTo(currentJob->getStartupTime()))
+                                                       .arg(previousJob->getCompletionTime().toString(previousJob->getDateTimeDisplayFormat()));
+
+                        // If the job is repeating or looping, re-estimate imaging duration - error case may be a bug
+                        if (SchedulerJob::FINISH_SEQUENCE != currentJob->getCompletionCondition())
+                            if (false == estimateJobTime(currentJob, now))
+                                currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                        continue;
+                    }
+                }
+                else
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    appendLogText(i18n("Warning: Job '%1' cannot start because its previous sibling has no completion time, marking invalid.",
+                                       currentJob->getName()));
+
+                    break;
+                }
+
+                currentJob->setLeadTime(previousJob->getCompletionTime().secsTo(currentJob->getStartupTime()));
+
+                // Lead time can be zero, so completion may equal startup
+                Q_ASSERT_X(previousJob->getCompletionTime() <= currentJob->getStartupTime(), __FUNCTION__,
+                           "Previous and current jobs do not overlap.");
+            }
+
+
+            // ----- #3 Should we delay the current job because it overlaps daylight?
+            //
+            // Pre-dawn time rules whether a job may be started before dawn, or delayed to next night.
+            // Note that the case of START_AT jobs is considered earlier in the algorithm, thus may be omitted here.
+            // In addition to be hardcoded currently, the imaging duration is not reliable enough to start a short job during pre-dawn.
+            // However, completion time during daylight only causes a warning, as this case will be processed as the job runs.
+
+            if (currentJob->getEnforceTwilight())
+            {
+                // During that check, we don't verify the current job can actually complete before dawn.
+                // If the job is interrupted while running, it will be aborted and rescheduled at a later time.
+
+                // We wouldn't start observation 30 mins (default) before dawn.
+                // FIXME: Refactor duplicated dawn/dusk calculations
+                double const earlyDawn = m_Dawn - Options::preDawnTime() / (60.0 * 24.0);
+
+                // Compute dawn time for the startup date of the job
+                // FIXME: Use KAlmanac to find the real dawn/dusk time for the day the job is supposed to be processed
+                QDateTime const dawnDateTime(currentJob->getStartupTime().date(), QTime(0, 0).addSecs(earlyDawn * 24 * 3600));
+
+                // Check if the job starts after dawn
+                if (dawnDateTime < currentJob->getStartupTime())
+                {
+                    // Compute dusk time for the startup date of the job - no lead time on dusk
+                    QDateTime duskDateTime(currentJob->getStartupTime().date(), QTime(0, 0).addSecs(m_Dusk * 24 * 3600));
+
+                    // Near summer solstice, dusk may happen before dawn on the same day, shift dusk by one day in that case
+                    if (duskDateTime < dawnDateTime)
+                        duskDateTime = duskDateTime.addDays(1);
+
+                    // Check if the job starts before dusk
+                    if (currentJob->getStartupTime() < duskDateTime)
+                    {
+                        // Delay job to next dusk - we will check other requirements later on
+                        currentJob->setStartupTime(duskDateTime);
+
+                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                                       QString("Job '%1' is scheduled to start at %2, in compliance with night time requirement.")
+                                                       .arg(currentJob->getName())
+                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
+
+                        continue;
+                    }
+                }
+
+                // Compute dawn time for the day following the startup time, but disregard the pre-dawn offset as we'll consider completion
+                // FIXME: Use KAlmanac to find the real dawn/dusk time for the day next to the day the job is supposed to be processed
+                QDateTime const nextDawnDateTime(currentJob->getStartupTime().date().addDays(1), QTime(0, 0).addSecs(m_Dawn * 24 * 3600));
+
+                // Check if the completion date overlaps the next dawn, and issue a warning if so
+                if (nextDawnDateTime < currentJob->getCompletionTime())
+                {
+                    appendLogText(
+                        i18n("Warning: job '%1' execution overlaps daylight, it will be interrupted at dawn and rescheduled on next night time.",
+                             currentJob->getName()));
+                }
+
+
+                Q_ASSERT_X(0 <= getDarkSkyScore(currentJob->getStartupTime()), __FUNCTION__,
+                           "Consolidated startup time results in a positive dark sky score.");
+            }
+
+
+            // ----- #4 Should we delay the current job because of its target culmination?
+            //
+            // Culmination uses the transit time, and fixes the startup time of the job to a particular offset around this transit time.
+            // This restriction may be used to start a job at the least air mass, or after a meridian flip.
+            // Culmination is scheduled before altitude restriction because it is normally more restrictive for the resulting startup time.
+            // It may happen that a target cannot rise enough to comply with the altitude restriction, but a culmination time is always valid.
+
+            if (SchedulerJob::START_CULMINATION == currentJob->getFileStartupCondition())
+            {
+                // Consolidate the culmination time, with offset, of the current job
+                QDateTime const nextCulminationTime = currentJob->calculateCulmination(currentJob->getStartupTime());
+
+                if (nextCulminationTime.isValid()) // Guaranteed
+                {
+                    if (currentJob->getStartupTime() < nextCulminationTime)
+                    {
+                        currentJob->setStartupTime(nextCulminationTime);
+
+                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                                       QString("Job '%1' is scheduled to start at %2, in compliance with culmination requirements.")
+                                                       .arg(currentJob->getName())
+                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
+
+                        continue;
+                    }
+                }
+                else
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    appendLogText(i18n("Warning: job '%1' requires culmination offset of %2 minutes, not achievable, marking invalid.",
+                                       currentJob->getName(),
+                                       QString("%L1").arg(currentJob->getCulminationOffset())));
+
+                    break;
+                }
+
+                // Don't test altitude here, because we will push the job during the next check step
+                // Q_ASSERT_X(0 <= getAltitudeScore(currentJob, currentJob->getStartupTime()), __FUNCTION__, "Consolidated altitude time results in a positive altitude score.");
+            }
+
+
+            // ----- #5 Should we delay the current job because its altitude is incorrect?
+            //
+            // Altitude time ensures the job is assigned a startup time when its target is high enough.
+            // As other restrictions, the altitude is only considered for startup time, completion time is managed while the job is running.
+            // Because a target setting down is a problem for the schedule, a cutoff altitude is added in the case the job target is past the meridian at startup time.
+            // FIXME: though arguable, Moon separation is also considered in that restriction check - move it to a separate case.
+
+            if (-90 < currentJob->getMinAltitude())
+            {
+                // Consolidate a new altitude time from the startup time of the current job
+                QDateTime const nextAltitudeTime = currentJob->calculateAltitudeTime(currentJob->getStartupTime());
+
+                if (nextAltitudeTime.isValid())
+                {
+                    if (currentJob->getStartupTime() < nextAltitudeTime)
+                    {
+                        currentJob->setStartupTime(nextAltitudeTime);
+
+                        qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                                       QString("Job '%1' is scheduled to start at %2, in compliance with altitude and Moon separation requirements.")
+                                                       .arg(currentJob->getName())
+                                                       .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()));
+
+                        continue;
+                    }
+                }
+                else
+                {
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    appendLogText(
+                        i18n("Warning: job '%1' requires minimum altitude %2 and Moon separation %3, not achievable, marking invalid.",
+                             currentJob->getName(),
+                             QString("%L1").arg(static_cast<double>(currentJob->getMinAltitude()), 0, 'f', 2),
+                             0.0 < currentJob->getMinMoonSeparation() ?
+                             QString("%L1").arg(static_cast<double>(currentJob->getMinMoonSeparation()), 0, 'f', 2) :
+                             QString("-")));
+
+                    break;
+                }
+
+                Q_ASSERT_X(0 <= currentJob->getAltitudeScore(currentJob->getStartupTime()), __FUNCTION__,
+                           "Consolidated altitude time results in a positive altitude score.");
+            }
+
+
+            // ----- #6 Should we reject the current job because it overlaps the next job and that next job is not movable?
+            //
+            // If we have a blocker next to the current job, we compare the completion time of the current job and the startup time of this next job, taking lead time into account.
+            // This verification obviously relies on the imaging time to be reliable, but there's not much we can do at this stage of the implementation.
+
+            if (nullptr != nextJob && SchedulerJob::START_AT == nextJob->getFileStartupCondition())
+            {
+                // In the current implementation, it is not possible to abort a running job when the next job is supposed to start.
+                // Movable jobs after this one will be delayed, but non-movable jobs are considered blockers.
+
+                // Calculate time we have between the end of the current job and the next job
+                double const timeToNext = static_cast<double> (currentJob->getCompletionTime().secsTo(nextJob->getStartupTime()));
+
+                // If that time is overlapping the next job, abort the current job
+                if (timeToNext < Options::leadTime() * 60)
+                {
+                    currentJob->setState(SchedulerJob::JOB_ABORTED);
+
+                    appendLogText(
+                        i18n("Warning: job '%1' is constrained by the start time of the next job, and cannot finish in time, marking aborted.",
+                             currentJob->getName()));
+
+                    break;
+                }
+
+                Q_ASSERT_X(currentJob->getCompletionTime().addSecs(Options::leadTime() * 60) < nextJob->getStartupTime(), __FUNCTION__,
+                           "No overlap ");
+            }
+
+
+            // ----- #7 Should we reject the current job because it exceeded its fixed completion time?
+            //
+            // This verification simply checks that because of previous jobs, the startup time of the current job doesn't exceed its fixed completion time.
+            // Its main objective is to catch wrong dates in the FINISH_AT configuration.
+
+            if (SchedulerJob::FINISH_AT == currentJob->getCompletionCondition())
+            {
+                if (currentJob->getCompletionTime() < currentJob->getStartupTime())
+                {
+                    appendLogText(i18n("Job '%1' completion time (%2) could not be achieved before start up time (%3)",
+                                       currentJob->getName(),
+                                       currentJob->getCompletionTime().toString(currentJob->getDateTimeDisplayFormat()),
+                                       currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat())));
+
+                    currentJob->setState(SchedulerJob::JOB_INVALID);
+
+                    break;
+                }
+            }
+
+
+            // ----- #8 Should we reject the current job because of weather?
+            //
+            // That verification is left for runtime
+            //
+            // if (false == isWeatherOK(currentJob))
+            //{
+            //    currentJob->setState(SchedulerJob::JOB_ABORTED);
+            //
+            //    appendLogText(i18n("Job '%1' cannot run now because of bad weather, marking aborted.", currentJob->getName()));
+            //}
+
+
+            // ----- #9 Update score for current time and mark evaluating jobs as scheduled
+
+            currentJob->setScore(calculateJobScore(currentJob, now));
+            currentJob->setState(SchedulerJob::JOB_SCHEDULED);
+
+            qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                           QString("Job '%1' on row #%2 passed all checks after %3 attempts, will proceed at %4 for approximately %5 seconds, marking scheduled")
+                                           .arg(currentJob->getName())
+                                           .arg(index + 1)
+                                           .arg(attempt)
+                                           .arg(currentJob->getStartupTime().toString(currentJob->getDateTimeDisplayFormat()))
+                                           .arg(currentJob->getEstimatedTime());
+
+            break;
+        }
+
+        // Check if job was successfully scheduled, else reject it
+        if (SchedulerJob::JOB_EVALUATION == currentJob->getState())
+        {
+            currentJob->setState(SchedulerJob::JOB_INVALID);
+
+            //appendLogText(i18n("Warning: job '%1' on row #%2 could not be scheduled during evaluation and is marked invalid, please review your plan.",
+            //            currentJob->getName(),
+            //            index + 1));
+
+        }
+    }
+}
+
+int16_t SchedulerEngine::getDarkSkyScore(QDateTime const &when) const
+{
+    double const secsPerDay = 24.0 * 3600.0;
+    double const minsPerDay = 24.0 * 60.0;
+
+    // Dark sky score is calculated based on distance to today's dawn and next dusk.
+    // Option "Pre-dawn Time" avoids executing a job when dawn is approaching, and is a value in minutes.
+    // - If observation is between option "Pre-dawn Time" and dawn, score is BAD_SCORE/50.
+    // - If observation is before dawn today, score is fraction of the day from beginning of observation to dawn time, as percentage.
+    // - If observation is after dusk, score is fraction of the day from dusk to beginning of observation, as percentage.
+    // - If observation is between dawn and dusk, score is BAD_SCORE.
+    //
+    // If observation time is invalid, the score is calculated for the current day time.
+    // Note exact dusk time is considered valid in terms of night time, and will return a positive, albeit null, score.
+
+    // FIXME: Dark sky score should consider the middle of the local night as best value.
+    // FIXME: Current algorithm uses the dawn and dusk of today, instead of the day of the observation.
+
+    int const earlyDawnSecs = static_cast <int> ((m_Dawn - static_cast <double> (Options::preDawnTime()) / minsPerDay) *
+                              secsPerDay);
+    int const dawnSecs = static_cast <int> (m_Dawn * secsPerDay);
+    int const duskSecs = static_cast <int> (m_Dusk * secsPerDay);
+    int const obsSecs = (when.isValid() ? when : SchedulerEphemeris::kstarsData()->lt()).time().msecsSinceStartOfDay() / 1000;
+
+    int16_t score = 0;
+
+    if (earlyDawnSecs <= obsSecs && obsSecs < dawnSecs)
+    {
+        score = BAD_SCORE / 50;
+
+        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (between pre-dawn and dawn).")
+        //    .arg(observationDateTime.toString())
+        //    .arg(QString::asprintf("%+d", score));
+    }
+    else if (obsSecs < dawnSecs)
+    {
+        score = static_cast <int16_t> ((dawnSecs - obsSecs) / secsPerDay) * 100;
+
+        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (before dawn).")
+        //    .arg(observationDateTime.toString())
+        //    .arg(QString::asprintf("%+d", score));
+    }
+    else if (duskSecs <= obsSecs)
+    {
+        score = static_cast <int16_t> ((obsSecs - duskSecs) / secsPerDay) * 100;
+
+        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (after dusk).")
+        //    .arg(observationDateTime.toString())
+        //    .arg(QString::asprintf("%+d", score));
+    }
+    else
+    {
+        score = BAD_SCORE;
+
+        //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Dark sky score at %1 is %2 (during daylight).")
+        //    .arg(observationDateTime.toString())
+        //    .arg(QString::asprintf("%+d", score));
+    }
+
+    return score;
+}
+
+int16_t SchedulerEngine::calculateJobScore(SchedulerJob const *job, QDateTime const &when) const
+{
+    if (nullptr == job)
+        return BAD_SCORE;
+
+    /* Only consolidate the score if light frames are required, calibration frames can run whenever needed */
+    if (!job->getLightFramesRequired())
+        return 1000;
+
+    int16_t total = 0;
+
+    /* As soon as one score is negative, it's a no-go and other scores are unneeded */
+
+    if (job->getEnforceTwilight())
+    {
+        int16_t const darkSkyScore = getDarkSkyScore(when);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' dark sky score is %2 at %3")
+                                       .arg(job->getName())
+                                       .arg(QString::asprintf("%+d", darkSkyScore))
+                                       .arg(when.toString(job->getDateTimeDisplayFormat()));
+
+        total += darkSkyScore;
+    }
+
+    /* We still enforce altitude if the job is neither required to track nor guide, because this is too confusing for the end-user.
+     * If we bypass calculation here, it must also be bypassed when checking job constraints in checkJobStage.
+     */
+    if (0 <= total /*&& ((job->getStepPipeline() & SchedulerJob::USE_TRACK) || (job->getStepPipeline() & SchedulerJob::USE_GUIDE))*/)
+    {
+        int16_t const altitudeScore = job->getAltitudeScore(when);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' altitude score is %2 at %3")
+                                       .arg(job->getName())
+                                       .arg(QString::asprintf("%+d", altitudeScore))
+                                       .arg(when.toString(job->getDateTimeDisplayFormat()));
+
+        total += altitudeScore;
+    }
+
+    if (0 <= total)
+    {
+        int16_t const moonSeparationScore = job->getMoonSeparationScore(when);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' Moon separation score is %2 at %3")
+                                       .arg(job->getName())
+                                       .arg(QString::asprintf("%+d", moonSeparationScore))
+                                       .arg(when.toString(job->getDateTimeDisplayFormat()));
+
+        total += moonSeparationScore;
+    }
+
+    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' has a total score of %2 at %3.")
+                                  .arg(job->getName())
+                                  .arg(QString::asprintf("%+d", total))
+                                  .arg(when.toString(job->getDateTimeDisplayFormat()));
+
+    return total;
+}
+
+bool SchedulerEngine::estimateJobTime(SchedulerJob *schedJob, QDateTime const &now)
+{
+    /* updateCompletedJobsCount(); */
+
+    // Load the sequence job associated with the argument scheduler job.
+    QList<SequenceJob *> seqJobs;
+    bool hasAutoFocus = false;
+    if (loadSequenceQueue(schedJob->getSequenceFile().toLocalFile(), schedJob, seqJobs, hasAutoFocus) == false)
+    {
+        qCWarning(KSTARS_EKOS_SCHEDULER) <<
+                                         QString("Warning: Failed estimating the duration of job '%1', its sequence file is invalid.").arg(
+                                             schedJob->getSequenceFile().toLocalFile());
+        return false;
+    }
+
+    // FIXME: setting in-sequence focus should be done in XML processing.
+    schedJob->setInSequenceFocus(hasAutoFocus);
+
+    // Stop spam of log on re-evaluation. If we display the warning once, then that's it.
+    if (schedJob != m_JobWarned && hasAutoFocus && !(schedJob->getStepPipeline() & SchedulerJob::USE_FOCUS))
+    {
+        appendLogText(
+            i18n("Warning: Job '%1' has its focus step disabled, periodic and/or HFR procedures currently set in its sequence will not occur.",
+                 schedJob->getName()));
+        m_JobWarned = schedJob;
+    }
+
+    /* This is the map of captured frames for this scheduler job, keyed per storage signature.
+     * It will be forwarded to the Capture module in order to capture only what frames are required.
+     * If option "Remember Job Progress" is disabled, this map will be empty, and the Capture module will process all requested captures unconditionally.
+     */
+    SchedulerJob::CapturedFramesMap capture_map;
+    bool const rememberJobProgress = Options::rememberJobProgress();
+
+    int totalSequenceCount = 0, totalCompletedCount = 0;
+    double totalImagingTime  = 0;
+
+    // Determine number of captures in the scheduler job
+    int capturesPerRepeat = 0;
+    foreach (SequenceJob *seqJob, seqJobs)
+        capturesPerRepeat += seqJob->getCount();
+
+    // Loop through sequence jobs to calculate the number of required frames and estimate duration.
+    foreach (SequenceJob *seqJob, seqJobs)
+    {
+        // FIXME: find a way to actually display the filter name.
+        QString seqName = i18n("Job '%1' %2x%3\" %4", schedJob->getName(), seqJob->getCount(), seqJob->getExposure(),
+                               seqJob->getFilterName());
+
+        if (seqJob->getUploadMode() == ISD::CCD::UPLOAD_LOCAL)
+        {
+            qCInfo(KSTARS_EKOS_SCHEDULER) <<
+                                          QString("%1 duration cannot be estimated time since the sequence saves the files remotely.").arg(seqName);
+            schedJob->setEstimatedTime(-2);
+            qDeleteAll(seqJobs);
+            return true;
+        }
+
+        // Note that looping jobs will have zero repeats required.
+        int const captures_required = seqJob->getCount() * schedJob->getRepeatsRequired();
+
+        int captures_completed = 0;
+        if (rememberJobProgress)
+        {
+            /* Enumerate sequence jobs associated to this scheduler job, and assign them a completed count.
+             *
+             * The objective of this block is to fill the storage map of the scheduler job with completed counts for each capture storage.
+             *
+             * Sequence jobs capture to a storage folder, and are given a count of captures to store at that location.
+             * The tricky part is to make sure the repeat count of the scheduler job is properly transferred to each sequence job.
+             *
+             * For instance, a scheduler job repeated three times must execute the full list of sequence jobs three times, thus
+             * has to tell each sequence job it misses all captures, three times. It cannot tell the sequence job three captures are
+             * missing, first because that's not how the sequence job is designed (completed count, not required count), and second
+             * because this would make the single sequence job repeat three times, instead of repeating the full list of sequence
+             * jobs three times.
+             *
+             * The consolidated storage map will be assigned to each sequence job based on their signature when the scheduler job executes them.
+             *
+             * For instance, consider a RGBL sequence of single captures. The map will store completed captures for R, G, B and L storages.
+             * If R and G have 1 file each, and B and L have no files, map[storage(R)] = map[storage(G)] = 1 and map[storage(B)] = map[storage(L)] = 0.
+             * When that scheduler job executes, only B and L captures will be processed.
+             *
+             * In the case of a RGBLRGB sequence of single captures, the second R, G and B map items will count one less capture than what is really in storage.
+             * If R and G have 1 file each, and B and L have no files, map[storage(R1)] = map[storage(B1)] = 1, and all others will be 0.
+             * When that scheduler job executes, B1, L, R2, G2 and B2 will be processed.
+             *
+             * This doesn't handle the case of duplicated scheduler jobs, that is, scheduler jobs with the same storage for capture sets.
+             * Those scheduler jobs will all change state to completion at the same moment as they all target the same storage.
+             * This is why it is important to manage the repeat count of the scheduler job, as stated earlier.
+             */
+
+            // Retrieve cached count of completed captures for the output folder of this seqJob
+            QString const signature = seqJob->getSignature();
+            QString const signature_path = QFileInfo(signature).path();
+            captures_completed = m_CapturedFramesCount.value(signature);
+
+            qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 sees %2 captures in output folder '%3'.").arg(seqName).arg(
+                                              captures_completed).arg(signature_path);
+
+            // Enumerate sequence jobs to check how many captures are completed overall in the same storage as the current one
+            foreach (SequenceJob *prevSeqJob, seqJobs)
+            {
+                // Enumerate seqJobs up to the current one
+                if (seqJob == prevSeqJob)
+                    break;
+
+                // If the previous sequence signature matches the current, reduce completion count to take duplicates into account
+                if (!signature.compare(prevSeqJob->getLocalDir() + prevSeqJob->getDirectoryPostfix()))
+                {
+                    // Note that looping jobs will have zero repeats required.
+                    int const previous_captures_required = prevSeqJob->getCount() * schedJob->getRepeatsRequired();
+                    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 has a previous duplicate sequence job requiring %2 captures.").arg(
+                                                      seqName).arg(previous_captures_required);
+                    captures_completed -= previous_captures_required;
+                }
+
+                // Now completed count can be needlessly negative for this job, so clamp to zero
+                if (captures_completed < 0)
+                    captures_completed = 0;
+
+                // And break if no captures remain, this job has to execute
+                if (captures_completed == 0)
+                    break;
+            }
+
+            // Finally we're only interested in the number of captures required for this sequence item
+            if (0 < captures_required && captures_required < captures_completed)
+                captures_completed = captures_required;
+
+            qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 has completed %2/%3 of its required captures in output folder '%4'.").arg(
+                                              seqName).arg(captures_completed).arg(captures_required).arg(signature_path);
+
+            // Update the completion count for this signature in the frame map if we still have captures to take.
+            // That frame map will be transferred to the Capture module, for which the sequence is a single batch of the scheduler job.
+            // For instance, consider a scheduler job repeated 3 times and using a 3xLum sequence, so we want 9xLum in the end.
+            // - If no captures are already processed, the frame map contains Lum=0
+            // - If 1xLum are already processed, the frame map contains Lum=0 when the batch executes, so that 3xLum may be taken.
+            // - If 3xLum are already processed, the frame map contains Lum=0 when the batch executes, as we still need more than what the sequence provides.
+            // - If 7xLum are already processed, the frame map contains Lum=1 when the batch executes, because we now only need 2xLum to finish the job.
+            // Therefore we need to specify a number of existing captures only for the last batch of the scheduler job.
+            // In the last batch, we only need the remainder of frames to get to the required total.
+            if (captures_completed < captures_required)
+            {
+                if (captures_required - captures_completed < seqJob->getCount())
+                    capture_map[signature] = captures_completed % seqJob->getCount();
+                else
+                    capture_map[signature] = 0;
+            }
+            else capture_map[signature] = captures_required;
+
+            // From now on, 'captures_completed' is the number of frames completed for the *current* sequence job
+        }
+        // Else rely on the captures done during this session
+        else
+            captures_completed = schedJob->getCompletedCount() / capturesPerRepeat * seqJob->getCount();
+
+        // Check if we still need any light frames. Because light frames changes the flow of the observatory startup
+        // Without light frames, there is no need to do focusing, alignment, guiding...etc
+        // We check if the frame type is LIGHT and if either the number of captures_completed frames is less than required
+        // OR if the completion condition is set to LOOP so it is never complete due to looping.
+        // Note that looping jobs will have zero repeats required.
+        // FIXME: As it is implemented now, FINISH_LOOP may loop over a capture-complete, therefore inoperant, scheduler job.
+        bool const areJobCapturesComplete = !(captures_completed < captures_required || 0 == captures_required);
+        if (seqJob->getFrameType() == FRAME_LIGHT)
+        {
+            if(areJobCapturesComplete)
+            {
+                qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 completed its sequence of %2 light frames.").arg(seqName).arg(
+                                                  captures_required);
+            }
+        }
+        else
+        {
+            qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 captures calibration frames.").arg(seqName);
+        }
+
+        totalSequenceCount += captures_required;
+        totalCompletedCount += captures_completed;
+
+        /* If captures are not complete, we have imaging time left */
+        if (!areJobCapturesComplete)
+        {
+            /* if looping, consider we always have one capture left */
+            unsigned int const captures_to_go = 0 < captures_required ? captures_required - captures_completed : 1;
+            totalImagingTime += fabs((seqJob->getExposure() + seqJob->getDelay()) * captures_to_go);
+
+            /* If we have light frames to process, add focus/dithering delay */
+            if (seqJob->getFrameType() == FRAME_LIGHT)
+            {
+                // If inSequenceFocus is true
+                if (hasAutoFocus)
+                {
+                    // Wild guess that each in sequence auto focus takes an average of 30 seconds. It can take any where from 2 seconds to 2+ minutes.
+                    // FIXME: estimating one focus per capture is probably not realistic.
+                    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 requires a focus procedure.").arg(seqName);
+                    totalImagingTime += captures_to_go * 30;
+                }
+                // If we're dithering after each exposure, that's another 10-20 seconds
+                if (schedJob->getStepPipeline() & SchedulerJob::USE_GUIDE && Options::ditherEnabled())
+                {
+                    qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 requires a dither procedure.").arg(seqName);
+                    totalImagingTime += (captures_to_go * 15) / Options::ditherFrames();
+                }
+            }
+        }
+    }
+
+    schedJob->setCapturedFramesMap(capture_map);
+    schedJob->setSequenceCount(totalSequenceCount);
+
+    // only in case we remember the job progress, we change the completion count
+    if (rememberJobProgress)
+        schedJob->setCompletedCount(totalCompletedCount);
+
+    qDeleteAll(seqJobs);
+
+    // FIXME: Move those ifs away to the caller in order to avoid estimating in those situations!
+
+    // We can't estimate times that do not finish when sequence is done
+    if (schedJob->getCompletionCondition() == SchedulerJob::FINISH_LOOP)
+    {
+        // We can't know estimated time if it is looping indefinitely
+        schedJob->setEstimatedTime(-2);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                       QString("Job '%1' is configured to loop until Scheduler is stopped manually, has undefined imaging time.")
+                                       .arg(schedJob->getName());
+    }
+    // If we know startup and finish times, we can estimate time right away
+    else if (schedJob->getStartupCondition() == SchedulerJob::START_AT &&
+             schedJob->getCompletionCondition() == SchedulerJob::FINISH_AT)
+    {
+        // FIXME: SchedulerJob is probably doing this already
+        qint64 const diff = schedJob->getStartupTime().secsTo(schedJob->getCompletionTime());
+        schedJob->setEstimatedTime(diff);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' has a startup time and fixed completion time, will run for %2.")
+                                       .arg(schedJob->getName())
+                                       .arg(dms(diff * 15.0 / 3600.0f).toHMSString());
+    }
+    // If we know finish time only, we can roughly estimate the time considering the job starts now
+    else if (schedJob->getStartupCondition() != SchedulerJob::START_AT &&
+             schedJob->getCompletionCondition() == SchedulerJob::FINISH_AT)
+    {
+        qint64 const diff = now.secsTo(schedJob->getCompletionTime());
+        schedJob->setEstimatedTime(diff);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) <<
+                                       QString("Job '%1' has no startup time but fixed completion time, will run for %2 if started now.")
+                                       .arg(schedJob->getName())
+                                       .arg(dms(diff * 15.0 / 3600.0f).toHMSString());
+    }
+    // Rely on the estimated imaging time to determine whether this job is complete or not - this makes the estimated time null
+    else if (totalImagingTime <= 0)
+    {
+        schedJob->setEstimatedTime(0);
+
+        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' will not run, complete with %2/%3 captures.")
+                                       .arg(schedJob->getName()).arg(totalCompletedCount).arg(totalSequenceCount);
+    }
+    // Else consolidate with step durations
+    else
+    {
+        if (schedJob->getLightFramesRequired())
+        {
+            /* FIXME: estimation should base on actual measure of each step, eventually with preliminary data as what it used now */
+            // Are we doing tracking? It takes about 30 seconds
+            if (schedJob->getStepPipeline() & SchedulerJob::USE_TRACK)
+                totalImagingTime += 30;
+            // Are we doing initial focusing? That can take about 2 minutes
+            if (schedJob->getStepPipeline() & SchedulerJob::USE_FOCUS)
+                totalImagingTime += 120;
+            // Are we doing astrometry? That can take about 60 seconds
+            if (schedJob->getStepPipeline() & SchedulerJob::USE_ALIGN)
+            {
+                totalImagingTime += 60;
+            }
+            // Are we doing guiding?
+            if (schedJob->getStepPipeline() & SchedulerJob::USE_GUIDE)
+            {
+                // Looping, finding guide star, settling takes 15 sec
+                totalImagingTime += 15;
+
+                // Add guiding settle time from dither setting (used by phd2::guide())
+                totalImagingTime += Options::ditherSettle();
+                // Add guiding settle time from ekos sccheduler setting
+                totalImagingTime += Options::guidingSettle();
+
+                // If calibration always cleared
+                // then calibration process can take about 2 mins
+                if(Options::resetGuideCalibration())
+                    totalImagingTime += 120;
+            }
+        }
+        dms const estimatedTime(totalImagingTime * 15.0 / 3600.0);
+        schedJob->setEstimatedTime(totalImagingTime);
+
+        qCInfo(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' estimated to take %2 to complete.").arg(schedJob->getName(),
+                                      estimatedTime.toHMSString());
+    }
+
+    return true;
+}
+
+bool SchedulerEngine::loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob, QList<SequenceJob *> &jobs,
+                                        bool &hasAutoFocus)
+{
+    /* Check the file before reading it, so that a change while it is read has it parsed again next time */
+    QFileInfo const info(fileURL);
+    auto sequence = m_SequenceFiles.constFind(fileURL);
+    if (sequence == m_SequenceFiles.constEnd() || sequence->modified != info.lastModified() ||
+            sequence->size != info.size())
+    {
+        SequenceFile parsed;
+        if (!parseSequenceFile(fileURL, parsed))
+        {
+            m_SequenceFiles.remove(fileURL);
+            return false;
+        }
+
+        parsed.modified = info.lastModified();
+        parsed.size     = info.size();
+        sequence        = m_SequenceFiles.insert(fileURL, parsed);
+    }
+
+    for (const QSharedPointer<XMLEle> &root : sequence->roots)
+    {
+        for (XMLEle *ep = nextXMLEle(root.data(), 1); ep != nullptr; ep = nextXMLEle(root.data(), 0))
+        {
+            if (!strcmp(tagXMLEle(ep), "Autofocus"))
+                hasAutoFocus = (!strcmp(findXMLAttValu(ep, "enabled"), "true"));
+            else if (!strcmp(tagXMLEle(ep), "Job"))
+                jobs.append(processJobInfo(ep, schedJob));
+        }
+    }
+
+    return true;
+}
+
+bool SchedulerEngine::parseSequenceFile(const QString &fileURL, SequenceFile &sequence) const
+{
+    QFile sFile;
+    sFile.setFileName(fileURL);
+
+    if (!sFile.open(QIODevice::ReadOnly))
+    {
+        appendLogText(i18n("Unable to open sequence queue file '%1'", fileURL));
+        return false;
+    }
+
+    LilXML *xmlParser = newLilXML();
+    char errmsg[MAXRBUF];
+
+    /* Read the file at once, it may sit on slow storage */
+    QByteArray const content = sFile.readAll();
+    for (char const c : content)
+    {
+        XMLEle *root = readXMLEle(xmlParser, c, errmsg);
+
+        if (root)
+            sequence.roots.append(QSharedPointer<XMLEle>(root, delXMLEle));
+        else if (errmsg[0])
+        {
+            appendLogText(QString(errmsg));
+            delLilXML(xmlParser);
+            return false;
+        }
+    }
+
+    delLilXML(xmlParser);
+    return true;
+}
+
+SequenceJob *SchedulerEngine::processJobInfo(XMLEle *root, SchedulerJob *schedJob)
+{
+    XMLEle *ep    = nullptr;
+    XMLEle *subEP = nullptr;
+
+    const QMap<QString, CCDFrameType> frameTypes =
+    {
+        { "Light", FRAME_LIGHT }, { "Dark", FRAME_DARK }, { "Bias", FRAME_BIAS }, { "Flat", FRAME_FLAT }
+    };
+
+    SequenceJob *job = new SequenceJob();
+    QString rawPrefix, frameType, filterType;
+    double exposure    = 0;
+    bool filterEnabled = false, expEnabled = false, tsEnabled = false;
+
+    /* Reset light frame presence flag before enumerating */
+    // JM 2018-09-14: If last sequence job is not LIGHT
+    // then scheduler job light frame is set to whatever last sequence job is
+    // so if it was non-LIGHT, this value is set to false which is wrong.
+    //if (nullptr != schedJob)
+    //    schedJob->setLightFramesRequired(false);
+
+    for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
+    {
+        if (!strcmp(tagXMLEle(ep), "Exposure"))
+        {
+            exposure = atof(pcdataXMLEle(ep));
+            job->setExposure(exposure);
+        }
+        else if (!strcmp(tagXMLEle(ep), "Filter"))
+        {
+            filterType = QString(pcdataXMLEle(ep));
+        }
+        else if (!strcmp(tagXMLEle(ep), "Type"))
+        {
+            frameType = QString(pcdataXMLEle(ep));
+
+            /* Record frame type and mark presence of light frames for this sequence */
+            CCDFrameType const frameEnum = frameTypes[frameType];
+            job->setFrameType(frameEnum);
+            if (FRAME_LIGHT == frameEnum && nullptr != schedJob)
+                schedJob->setLightFramesRequired(true);
+        }
+        else if (!strcmp(tagXMLEle(ep), "Prefix"))
+        {
+            subEP = findXMLEle(ep, "RawPrefix");
+            if (subEP)
+                rawPrefix = QString(pcdataXMLEle(subEP));
+
+            subEP = findXMLEle(ep, "FilterEnabled");
+            if (subEP)
+                filterEnabled = !strcmp("1", pcdataXMLEle(subEP));
+
+            subEP = findXMLEle(ep, "ExpEnabled");
+            if (subEP)
+                expEnabled = (!strcmp("1", pcdataXMLEle(subEP)));
+
+            subEP = findXMLEle(ep, "TimeStampEnabled");
+            if (subEP)
+                tsEnabled = (!strcmp("1", pcdataXMLEle(subEP)));
+
+            job->setPrefixSettings(rawPrefix, filterEnabled, expEnabled, tsEnabled);
+        }
+        else if (!strcmp(tagXMLEle(ep), "Count"))
+        {
+            job->setCount(atoi(pcdataXMLEle(ep)));
+        }
+        else if (!strcmp(tagXMLEle(ep), "Delay"))
+        {
+            job->setDelay(atoi(pcdataXMLEle(ep)));
+        }
+        else if (!strcmp(tagXMLEle(ep), "FITSDirectory"))
+        {
+            job->setLocalDir(pcdataXMLEle(ep));
+        }
+        else if (!strcmp(tagXMLEle(ep), "RemoteDirectory"))
+        {
+            job->setRemoteDir(pcdataXMLEle(ep));
+        }
+        else if (!strcmp(tagXMLEle(ep), "UploadMode"))
+        {
+            job->setUploadMode(static_cast<ISD::CCD::UploadMode>(atoi(pcdataXMLEle(ep))));
+        }
+    }
+
+    // Sanitize name
+    QString targetName = schedJob->getName();
+    targetName = targetName.replace( QRegularExpression("\\s|/|\\(|\\)|:|\\*|~|\"" ), "_" )
+                 // Remove any two or more __
+                 .replace( QRegularExpression("_{2,}"), "_")
+                 // Remove any _ at the end
+                 .replace( QRegularExpression("_$"), "");
+
+    // Because scheduler sets the target name in capture module
+    // it would be the same as the raw prefix
+    if (targetName.isEmpty() == false && rawPrefix.isEmpty())
+        rawPrefix = targetName;
+
+    // Make full prefix
+    QString imagePrefix = rawPrefix;
+
+    if (imagePrefix.isEmpty() == false)
+        imagePrefix += '_';
+
+    imagePrefix += frameType;
+
+    if (filterEnabled && filterType.isEmpty() == false &&
+            (job->getFrameType() == FRAME_LIGHT || job->getFrameType() == FRAME_FLAT))
+    {
+        imagePrefix += '_';
+
+        imagePrefix += filterType;
+    }
+
+    if (expEnabled)
+    {
+        imagePrefix += '_';
+
+        if (exposure == static_cast<int>(exposure))
+            // Whole number
+            imagePrefix += QString::number(exposure, 'd', 0) + QString("_secs");
+        else
+        {
+            // Decimal
+            if (exposure >= 0.001)
+                imagePrefix += QString::number(exposure, 'f', 3) + QString("_secs");
+            else
+                imagePrefix += QString::number(exposure, 'f', 6) + QString("_secs");
+        }
+    }
+
+    job->setFullPrefix(imagePrefix);
+
+    // Directory postfix
+    QString directoryPostfix;
+
+    /* FIXME: Refactor directoryPostfix assignment, whose code is duplicated in capture.cpp */
+    if (targetName.isEmpty())
+        directoryPostfix = QLatin1String("/") + frameType;
+    else
+        directoryPostfix = QLatin1String("/") + targetName + QLatin1String("/") + frameType;
+    if ((job->getFrameType() == FRAME_LIGHT || job->getFrameType() == FRAME_FLAT) && filterType.isEmpty() == false)
+        directoryPostfix += QLatin1String("/") + filterType;
+
+    job->setDirectoryPostfix(directoryPostfix);
+
+    return job;
+}
+
+QList<SchedulerEngine::PlanEntry> SchedulerEngine::simulateNight(QList<SchedulerJob *> const &jobs, QDateTime const &from,
+        QDateTime const &until)
+{
+    QList<PlanEntry> plan;
+    QDateTime now = from;
+
+    for (int run = 0; run < MAX_SIMULATION_RUNS && now < until; run++)
+    {
+        /* Jobs left to run are evaluated from scratch, as their startup time depends on what ran before */
+        foreach (SchedulerJob *job, jobs)
+        {
+            SchedulerJob::JOBStatus const s = job->getState();
+            if (SchedulerJob::JOB_COMPLETE != s && SchedulerJob::JOB_INVALID != s && SchedulerJob::JOB_ERROR != s &&
+                    SchedulerJob::JOB_ABORTED != s)
+                job->reset();
+        }
+
+        QList<SchedulerJob *> sortedJobs = jobs;
+        prepareJobs(sortedJobs, now, true);
+
+        /* This predicate matches jobs being evaluated */
+        auto evaluated = [](SchedulerJob const * const job)
+        {
+            return SchedulerJob::JOB_EVALUATION == job->getState();
+        };
+
+        /* If there are only interrupted jobs that can run, resume those */
+        if (std::none_of(sortedJobs.begin(), sortedJobs.end(), evaluated))
+        {
+            bool resumed = false;
+            foreach (SchedulerJob *job, sortedJobs)
+            {
+                if (SchedulerJob::JOB_ABORTED == job->getState() ||
+                        (m_RescheduleErrors && SchedulerJob::JOB_ERROR == job->getState()))
+                {
+                    job->reset();
+                    resumed = true;
+                }
+            }
+
+            if (!resumed)
+                break;
+
+            prepareJobs(sortedJobs, now, true);
+        }
+
+        scheduleJobs(sortedJobs, now);
+
+        /* The job to run is the first scheduled, as the Scheduler module would select it */
+        auto const next = std::find_if(sortedJobs.begin(), sortedJobs.end(), [](SchedulerJob const * const job)
+        {
+            return SchedulerJob::JOB_SCHEDULED == job->getState();
+        });
+        if (sortedJobs.end() == next)
+            break;
+
+        SchedulerJob * const job = *next;
+        QDateTime const startup  = std::max(now, job->getStartupTime());
+        if (until <= startup)
+            break;
+
+        /* The job runs until its captures are done or its completion time, if any happens before the end of the simulation */
+        QDateTime completion = until;
+        bool complete = false;
+        if (SchedulerJob::FINISH_AT == job->getCompletionCondition() && job->getCompletionTime().isValid() &&
+                job->getCompletionTime() <= completion)
+        {
+            completion = job->getCompletionTime();
+            complete   = true;
+        }
+        if (0 < job->getEstimatedTime() && startup.addSecs(job->getEstimatedTime()) <= completion)
+        {
+            completion = startup.addSecs(job->getEstimatedTime());
+            complete   = true;
+        }
+
+        /* Constraints are checked while the job runs, and interrupt it as soon as one fails */
+        for (QDateTime when = startup.addSecs(SIMULATION_STEP_SECS); when < completion; when = when.addSecs(SIMULATION_STEP_SECS))
+        {
+            if (calculateJobScore(job, when) < 0)
+            {
+                completion = when;
+                complete   = false;
+                break;
+            }
+        }
+
+        PlanEntry entry;
+        entry.name       = job->getName();
+        entry.startup    = startup;
+        entry.completion = completion;
+        entry.score      = calculateJobScore(job, startup);
+        entry.complete   = complete;
+        plan.append(entry);
+
+        job->setState(complete ? SchedulerJob::JOB_COMPLETE : SchedulerJob::JOB_ABORTED);
+        now = completion.addSecs(static_cast <int> (ceil(Options::leadTime() * 60.0)));
+    }
+
+    return plan;
+}
+
+bool SchedulerEngine::loadJobs(QString const &fileURL, QList<SchedulerJob *> &jobs,
+                               std::function<void(XMLEle *)> const &processElement)
+{
+    QFile sFile;
+    sFile.setFileName(fileURL);
+
+    if (!sFile.open(QIODevice::ReadOnly))
+    {
+        appendLogText(i18n("Unable to open file %1", fileURL));
+        return false;
+    }
+
+    LilXML *xmlParser = newLilXML();
+    char errmsg[MAXRBUF];
+    XMLEle *root = nullptr;
+    XMLEle *ep   = nullptr;
+    char c;
+
+    while (sFile.getChar(&c))
+    {
+        root = readXMLEle(xmlParser, c, errmsg);
+
+        if (root)
+        {
+            for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
+            {
+                const char *tag = tagXMLEle(ep);
+                if (!strcmp(tag, "Job"))
+                {
+                    processJobInfo(ep, jobs);
+                    continue;
+                }
+
+                if (!strcmp(tag, "ErrorHandlingStrategy"))
+                    setRescheduleErrors(findXMLEle(ep, "RescheduleErrors") != nullptr);
+                if (processElement)
+                    processElement(ep);
+            }
+            delXMLEle(root);
+        }
+        else if (errmsg[0])
+        {
+            appendLogText(QString(errmsg));
+            delLilXML(xmlParser);
+            return false;
+        }
+    }
+
+    delLilXML(xmlParser);
+    return true;
+}
+
+bool SchedulerEngine::processJobInfo(XMLEle *root, QList<SchedulerJob *> &jobs)
+{
+    XMLEle *ep;
+    XMLEle *subEP;
+
+    /* Defaults are those of the job editor of the Scheduler module */
+    QString name, sequence, fits;
+    int priority = 10;
+    dms ra, dec;
+    SchedulerJob::StartupCondition startupCondition = SchedulerJob::START_ASAP;
+    QDateTime startupTime, completionTime;
+    double culminationOffset = -60;
+    double minAltitude = -90, minMoonSeparation = -1;
+    bool enforceWeather = false, enforceTwilight = false;
+    SchedulerJob::CompletionCondition completionCondition = SchedulerJob::FINISH_SEQUENCE;
+    int repeats = 1;
+    int stepPipeline = SchedulerJob::USE_NONE;
+
+    // We expect all data read from the XML to be in the C locale - QLocale::c()
+    QLocale cLocale = QLocale::c();
+
+    for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
+    {
+        if (!strcmp(tagXMLEle(ep), "Name"))
+            name = pcdataXMLEle(ep);
+        else if (!strcmp(tagXMLEle(ep), "Priority"))
+            priority = atoi(pcdataXMLEle(ep));
+        else if (!strcmp(tagXMLEle(ep), "Coordinates"))
+        {
+            subEP = findXMLEle(ep, "J2000RA");
+            if (subEP)
+                ra.setH(cLocale.toDouble(pcdataXMLEle(subEP)));
+            subEP = findXMLEle(ep, "J2000DE");
+            if (subEP)
+                dec.setD(cLocale.toDouble(pcdataXMLEle(subEP)));
+        }
+        else if (!strcmp(tagXMLEle(ep), "Sequence"))
+            sequence = pcdataXMLEle(ep);
+        else if (!strcmp(tagXMLEle(ep), "FITS"))
+            fits = pcdataXMLEle(ep);
+        else if (!strcmp(tagXMLEle(ep), "StartupCondition"))
+        {
+            for (subEP = nextXMLEle(ep, 1); subEP != nullptr; subEP = nextXMLEle(ep, 0))
+            {
+                if (!strcmp("ASAP", pcdataXMLEle(subEP)))
+                    startupCondition = SchedulerJob::START_ASAP;
+                else if (!strcmp("Culmination", pcdataXMLEle(subEP)))
+                {
+                    startupCondition  = SchedulerJob::START_CULMINATION;
+                    culminationOffset = cLocale.toDouble(findXMLAttValu(subEP, "value"));
+                }
+                else if (!strcmp("At", pcdataXMLEle(subEP)))
+                {
+                    startupCondition = SchedulerJob::START_AT;
+                    startupTime      = QDateTime::fromString(findXMLAttValu(subEP, "value"), Qt::ISODate);
+                }
+            }
+        }
+        else if (!strcmp(tagXMLEle(ep), "Constraints"))
+        {
+            for (subEP = nextXMLEle(ep, 1); subEP != nullptr; subEP = nextXMLEle(ep, 0))
+            {
+                if (!strcmp("MinimumAltitude", pcdataXMLEle(subEP)))
+                    minAltitude = cLocale.toDouble(findXMLAttValu(subEP, "value"));
+                else if (!strcmp("MoonSeparation", pcdataXMLEle(subEP)))
+                    minMoonSeparation = cLocale.toDouble(findXMLAttValu(subEP, "value"));
+                else if (!strcmp("EnforceWeather", pcdataXMLEle(subEP)))
+                    enforceWeather = true;
+                else if (!strcmp("EnforceTwilight", pcdataXMLEle(subEP)))
+                    enforceTwilight = true;
+            }
+        }
+        else if (!strcmp(tagXMLEle(ep), "CompletionCondition"))
+        {
+            for (subEP = nextXMLEle(ep, 1); subEP != nullptr; subEP = nextXMLEle(ep, 0))
+            {
+                if (!strcmp("Sequence", pcdataXMLEle(subEP)))
+                    completionCondition = SchedulerJob::FINISH_SEQUENCE;
+                else if (!strcmp("Repeat", pcdataXMLEle(subEP)))
+                {
+                    completionCondition = SchedulerJob::FINISH_REPEAT;
+                    repeats             = cLocale.toInt(findXMLAttValu(subEP, "value"));
+                }
+                else if (!strcmp("Loop", pcdataXMLEle(subEP)))
+                    completionCondition = SchedulerJob::FINISH_LOOP;
+                else if (!strcmp("At", pcdataXMLEle(subEP)))
+                {
+                    completionCondition = SchedulerJob::FINISH_AT;
+                    completionTime      = QDateTime::fromString(findXMLAttValu(subEP, "value"), Qt::ISODate);
+                }
+            }
+        }
+        else if (!strcmp(tagXMLEle(ep), "Steps"))
+        {
+            XMLEle *module;
+            stepPipeline = SchedulerJob::USE_NONE;
+
+            for (module = nextXMLEle(ep, 1); module != nullptr; module = nextXMLEle(ep, 0))
+            {
+                const char *proc = pcdataXMLEle(module);
+
+                if (!strcmp(proc, "Track"))
+                    stepPipeline |= SchedulerJob::USE_TRACK;
+                else if (!strcmp(proc, "Focus"))
+                    stepPipeline |= SchedulerJob::USE_FOCUS;
+                else if (!strcmp(proc, "Align"))
+                    stepPipeline |= SchedulerJob::USE_ALIGN;
+                else if (!strcmp(proc, "Guide"))
+                    stepPipeline |= SchedulerJob::USE_GUIDE;
+            }
+        }
+    }
+
+    if (name.isEmpty())
+    {
+        appendLogText(i18n("Warning: Target name is required."));
+        return false;
+    }
+
+    if (sequence.isEmpty())
+    {
+        appendLogText(i18n("Warning: Sequence file is required."));
+        return false;
+    }
+
+    /* Configure the job in the same order as the Scheduler module does when saving its job editor */
+    SchedulerJob *job = new SchedulerJob();
+
+    job->setName(name);
+    job->setPriority(priority);
+    job->setTargetCoords(ra, dec);
+    job->setDateTimeDisplayFormat("dd/MM/yy hh:mm");
+    job->setSequenceFile(QUrl::fromUserInput(sequence));
+    job->setFITSFile(QUrl::fromLocalFile(fits));
+
+    job->setStartupCondition(startupCondition);
+    if (SchedulerJob::START_CULMINATION == startupCondition)
+        job->setCulminationOffset(culminationOffset);
+    else if (SchedulerJob::START_AT == startupCondition)
+        job->setStartupTime(startupTime);
+    job->setFileStartupCondition(job->getStartupCondition());
+    job->setFileStartupTime(job->getStartupTime());
+
+    job->setMinAltitude(minAltitude);
+    job->setMinMoonSeparation(minMoonSeparation);
+    job->setEnforceWeather(enforceWeather);
+    job->setEnforceTwilight(enforceTwilight);
+
+    job->setCompletionCondition(completionCondition);
+    if (SchedulerJob::FINISH_REPEAT == completionCondition)
+    {
+        job->setRepeatsRequired(repeats);
+        job->setRepeatsRemaining(repeats);
+    }
+    else if (SchedulerJob::FINISH_AT == completionCondition)
+        job->setCompletionTime(completionTime);
+
+    job->setStepPipeline(static_cast<SchedulerJob::StepPipeline>(stepPipeline));
+    job->reset();
+
+    jobs.append(job);
+    return true;
+}
+}
@@ -0,0 +1,182 @@
+/*  Ekos Scheduler Engine
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <lilxml.h>
+
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+
+#include <cstdint>
+#include <functional>
+
+class SchedulerJob;
+
+namespace Ekos
+{
+class SequenceJob;
+
+/**
+ * @class SchedulerEngine
+ * Scores, estimates and orders the jobs of the scheduler, without any widget.
+ *
+ * The Scheduler module owns an engine for its queue, and shows what the engine decides. The engine may as well
+ * run on a worker thread, with jobs that are not shown in a table, to fast-forward a night of observation and
+ * find out which job would run when, as simulateNight() does.
+ *
+ * Messages for the end-user are passed to the logger, or to the debug log if there is none.
+ *
+ * On a worker thread, the engine must be given the dates it works with, and SchedulerEphemeris::clear() must have
+ * been called on the main thread: the data of KStars is only read on the main thread, which is asserted.
+ */
+class SchedulerEngine
+{
+    public:
+        /** @brief A job of a simulated night, as it would have run. */
+        struct PlanEntry
+        {
+            QString name;
+            QDateTime startup;
+            QDateTime completion;
+            /// Score of the job at startup
+            int16_t score { 0 };
+            /// Whether the job completed, or was interrupted by its constraints or the end of the night
+            bool complete { false };
+        };
+
+        SchedulerEngine() = default;
+
+        /** @brief Set where messages for the end-user go. */
+        void setLogger(const std::function<void(const QString &)> &logger);
+
+        /** @brief Set whether jobs in error are rescheduled along with aborted jobs. */
+        void setRescheduleErrors(bool value);
+        bool getRescheduleErrors() const
+        {
+            return m_RescheduleErrors;
+        }
+
+        /** @brief Set the captures found in storage, counted by signature, used to estimate jobs when remembering progress. */
+        void setCapturedFramesCount(const QMap<QString, uint16_t> &count);
+
+        /** @brief Update dawn and dusk for the current date of KStars, with the offsets of the options, on the main thread. */
+        void calculateDawnDusk();
+        /** @return dawn and dusk of the current day, as fractions of the day */
+        double getDawn() const
+        {
+            return m_Dawn;
+        }
+        double getDusk() const
+        {
+            return m_Dusk;
+        }
+
+        /**
+             * @brief getDarkSkyScore Get the dark sky score of a date and time. The further from dawn the better.
+             * @param when date and time to check the dark sky score, now if omitted
+             * @return Dark sky score. Daylight get bad score, as well as pre-dawn to dawn.
+             */
+        int16_t getDarkSkyScore(QDateTime const &when = QDateTime()) const;
+
+        /**
+             * @brief calculateJobScore Calculate job dark sky score, altitude score, and moon separation scores and returns the sum.
+             * @param job Target
+             * @param when date and time to evaluate constraints, now if omitted.
+             * @return Total score
+             */
+        int16_t calculateJobScore(SchedulerJob const *job, QDateTime const &when = QDateTime()) const;
+
+        /**
+             * @brief estimateJobTime Estimates the time the job takes to complete based on the sequence file and what modules to utilize during the observation run.
+             * @param schedJob target job
+             * @param now date and time the estimation is made at, for jobs with a fixed completion time.
+             * @return false if the sequence file of the job cannot be loaded.
+             */
+        bool estimateJobTime(SchedulerJob *schedJob, QDateTime const &now);
+
+        /**
+         * @brief prepareJobs Estimate the jobs that need it, and mark the jobs that may be scheduled for evaluation.
+         * @param jobs jobs of the queue.
+         * @param now date and time of the evaluation.
+         * @param running whether the scheduler is running, in which case aborted jobs and jobs in error are left out.
+         */
+        void prepareJobs(QList<SchedulerJob *> const &jobs, QDateTime const &now, bool running);
+
+        /**
+         * @brief scheduleJobs Sort the jobs if the options say so, and give the jobs marked for evaluation a startup time
+         * complying with their constraints and the jobs before them.
+         * @param jobs jobs of the queue, sorted on return.
+         * @param now date and time of the evaluation.
+         */
+        void scheduleJobs(QList<SchedulerJob *> &jobs, QDateTime const &now);
+
+        /**
+         * @brief simulateNight Fast-forward the queue, running each job as soon as it is selected.
+         * @param jobs jobs of the queue, which must not be shown in a table. Their state is changed as they run.
+         * @param from date and time the simulation starts at.
+         * @param until date and time the simulation stops at.
+         * @return the jobs in the order they ran, with the time they started and stopped.
+         * @note Running jobs are interrupted when their score turns negative, and are not resumed unless only
+         * interrupted jobs remain. A resumed job starts its sequence over.
+         */
+        QList<PlanEntry> simulateNight(QList<SchedulerJob *> const &jobs, QDateTime const &from, QDateTime const &until);
+
+        /**
+         * @brief loadJobs Load the jobs of a scheduler file, as the Scheduler module would add them to its queue.
+         * @param fileURL scheduler file.
+         * @param jobs list the jobs are appended to, owned by the caller.
+         * @param processElement if set, called with each element of the file other than jobs, such as the startup
+         * and shutdown procedures the Scheduler module shows.
+         * @return false if the file cannot be read.
+         * @note Call it on the main thread, jobs get the apparent coordinates of their target for the date of KStars.
+         */
+        bool loadJobs(QString const &fileURL, QList<SchedulerJob *> &jobs,
+                      std::function<void(XMLEle *)> const &processElement = nullptr);
+
+        /**
+         * @brief loadSequenceQueue Load the sequence jobs of a sequence file.
+         * @param fileURL sequence file.
+         * @param schedJob scheduler job the sequence belongs to.
+         * @param jobs list the sequence jobs are appended to, owned by the caller.
+         * @param hasAutoFocus set to whether the sequence uses autofocus.
+         * @return false if the file cannot be read.
+         * @note The file is parsed again only if it was modified since it was last loaded.
+         */
+        bool loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob, QList<SequenceJob *> &jobs,
+                               bool &hasAutoFocus);
+
+    private:
+        /** @brief A sequence file as parsed when last loaded. */
+        struct SequenceFile
+        {
+            QDateTime modified;
+            qint64 size { 0 };
+            QList<QSharedPointer<XMLEle>> roots;
+        };
+
+        bool parseSequenceFile(const QString &fileURL, SequenceFile &sequence) const;
+        SequenceJob *processJobInfo(XMLEle *root, SchedulerJob *schedJob);
+        bool processJobInfo(XMLEle *root, QList<SchedulerJob *> &jobs);
+        void appendLogText(const QString &text) const;
+
+        std::function<void(const QString &)> m_Logger;
+        /// Day fraction of dawn and dusk, to calculate dark skies range
+        double m_Dawn { -1 };
+        double m_Dusk { -1 };
+        bool m_RescheduleErrors { false };
+        QMap<QString, uint16_t> m_CapturedFramesCount;
+        /// Sequence files by path, the queue refers to the same few files over and over
+        QMap<QString, SequenceFile> m_SequenceFiles;
+        /// Last job warned about its disabled focus step, so that re-evaluations don't spam the log
+        SchedulerJob const *m_JobWarned { nullptr };
+};
+}
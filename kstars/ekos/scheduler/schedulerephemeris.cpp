@@ -0,0 +1,274 @@
+/*  Ekos Scheduler Ephemeris
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "schedulerephemeris.h"
+
+#include "ksnumbers.h"
+#include "kstarsdata.h"
+#include "skyobjects/skypoint.h"
+
+#include <KLocalizedString>
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// The Moon moves by a twentieth of a degree against the stars in that time, linear interpolation is plenty
+constexpr int STEP_MINUTES = 10;
+constexpr int STEPS_PER_NIGHT = 24 * 60 / STEP_MINUTES;
+// Tables kept before the oldest one is dropped, a week of planning and a bit more
+constexpr int MAX_NIGHTS = 10;
+
+constexpr long double MINUTE = 1.0L / (24 * 60);
+
+// Hours reduced to [0,24[
+double reduceHours(double hours)
+{
+    hours = std::fmod(hours, 24.0);
+    return hours < 0 ? hours + 24.0 : hours;
+}
+
+bool isMainThread()
+{
+    return QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+}
+
+SchedulerEphemeris *SchedulerEphemeris::Instance()
+{
+    static SchedulerEphemeris ephemeris;
+    return &ephemeris;
+}
+
+SchedulerEphemeris::SchedulerEphemeris() : m_Earth(i18n("Earth"))
+{
+}
+
+void SchedulerEphemeris::clear()
+{
+    QMutexLocker lock(&m_Mutex);
+    m_Nights.clear();
+    updateLocation();
+}
+
+GeoLocation SchedulerEphemeris::location()
+{
+    QMutexLocker lock(&m_Mutex);
+    return updateLocation() ? *m_Geo : GeoLocation(dms(0), dms(0));
+}
+
+void SchedulerEphemeris::apparentCoordinates(SkyPoint &point, long double jd)
+{
+    KSNumbers numbers(jd);
+    point.precessFromAnyEpoch(J2000L, jd);
+    point.nutate(&numbers);
+    point.aberrate(&numbers);
+}
+
+KStarsData *SchedulerEphemeris::kstarsData()
+{
+    Q_ASSERT_X(isMainThread(), __FUNCTION__, "The scheduler reads the data of KStars on the main thread only.");
+    return KStarsData::Instance();
+}
+
+KStarsDateTime SchedulerEphemeris::toUT(const KStarsDateTime &when) const
+{
+    // Don't use QDateTime's timezone, the location of KStars is what matters
+    return Qt::UTC == when.timeSpec() ? when : m_Geo->LTtoUT(when);
+}
+
+SchedulerEphemeris::Sample SchedulerEphemeris::sample(const SkyPoint &target, const KStarsDateTime &when, bool withMoon)
+{
+    QMutexLocker lock(&m_Mutex);
+    if (!updateLocation())
+        return Sample();
+    return sampleAt(target, toUT(when).djd(), withMoon);
+}
+
+int SchedulerEphemeris::findFirstMinute(const SkyPoint &target, const KStarsDateTime &from, int minutes,
+                                        const std::function<bool(const Sample &)> &accept, bool withMoon)
+{
+    QMutexLocker lock(&m_Mutex);
+    if (!updateLocation())
+        return -1;
+    long double const startJD = toUT(from).djd();
+    auto const holds = [&](int minute)
+    {
+        return accept(sampleAt(target, startJD + minute * MINUTE, withMoon));
+    };
+
+    if (minutes <= 0)
+        return -1;
+    if (holds(0))
+        return 0;
+
+    // Step over the curves until the condition holds, then bisect back to the minute it started to
+    int before = 0;
+    while (before < minutes - 1)
+    {
+        int const after = std::min(before + STEP_MINUTES, minutes - 1);
+        if (holds(after))
+        {
+            int low = before, high = after;
+            while (high - low > 1)
+            {
+                int const middle = (low + high) / 2;
+                if (holds(middle))
+                    high = middle;
+                else
+                    low = middle;
+            }
+            return high;
+        }
+        before = after;
+    }
+
+    return -1;
+}
+
+SchedulerEphemeris::Sample SchedulerEphemeris::sampleAt(const SkyPoint &point, long double jd, bool withMoon)
+{
+    Night &table         = night(jd);
+    Target const &coords = target(table, point);
+    double const lat     = m_Geo->lat()->radians();
+    long double const dt = jd - table.startJD;
+
+    // Sidereal time runs linearly, plenty accurate over a day
+    double const LST = reduceHours(table.startLST + static_cast<double>(dt * 24.0L * SIDEREALSECOND));
+    double const hourAngle = reduceHours(LST - coords.ra);
+
+    Sample result;
+    double const sinAlt = coords.sinDec * std::sin(lat) +
+                          coords.cosDec * std::cos(lat) * std::cos(hourAngle * 15.0 * dms::DegToRad);
+    result.altitude  = std::asin(qBound(-1.0, sinAlt, 1.0)) / dms::DegToRad;
+    // Hour angles under 12 hours are past the meridian
+    result.isSetting = hourAngle < 12.0;
+
+    if (!withMoon)
+        return result;
+
+    if (table.moon.isEmpty())
+        sampleMoon(table);
+
+    double const position = static_cast<double>(dt / (STEP_MINUTES * MINUTE));
+    int const index       = qBound(0, static_cast<int>(std::floor(position)), STEPS_PER_NIGHT - 1);
+    double const f        = position - index;
+    MoonSample const &a   = table.moon.at(index);
+    MoonSample const &b   = table.moon.at(index + 1);
+
+    result.moonAltitude     = a.altitude + f * (b.altitude - a.altitude);
+    result.moonIllumination = a.illumination + f * (b.illumination - a.illumination);
+
+    double const x    = a.x + f * (b.x - a.x);
+    double const y    = a.y + f * (b.y - a.y);
+    double const z    = a.z + f * (b.z - a.z);
+    double const ra   = coords.ra * 15.0 * dms::DegToRad;
+    double const dot  = coords.cosDec * (std::cos(ra) * x + std::sin(ra) * y) + coords.sinDec * z;
+    double const norm = std::sqrt(x * x + y * y + z * z);
+    result.moonSeparation = std::acos(qBound(-1.0, dot / norm, 1.0)) / dms::DegToRad;
+
+    return result;
+}
+
+SchedulerEphemeris::Night &SchedulerEphemeris::night(long double jd)
+{
+    // Julian days start at noon in Greenwich, shift them by the time zone to start at local noon
+    double const tz   = m_Geo->TZ0() / 24.0;
+    long long const n = static_cast<long long>(std::floor(jd + tz));
+
+    auto it = m_Nights.find(n);
+    if (it != m_Nights.end())
+        return it.value();
+
+    if (m_Nights.size() >= MAX_NIGHTS)
+        m_Nights.erase(m_Nights.begin());
+
+    Night table;
+    table.startJD  = n - tz;
+    table.startLST = m_Geo->GSTtoLST(KStarsDateTime(table.startJD).gst()).Hours();
+    return m_Nights.insert(n, table).value();
+}
+
+void SchedulerEphemeris::sampleMoon(Night &night)
+{
+    night.moon.resize(STEPS_PER_NIGHT + 1);
+    for (int i = 0; i <= STEPS_PER_NIGHT; i++)
+    {
+        long double const jd = night.startJD + i * STEP_MINUTES * MINUTE;
+        KStarsDateTime const ut(jd);
+        KSNumbers numbers(jd);
+        CachingDms const LST = m_Geo->GSTtoLST(ut.gst());
+
+        // The sky map may be updating its own Earth at the same time, from another thread, and finding the
+        // phase of a planet reads the planets of the sky map: find positions only
+        m_Earth.findPositionOnly(&numbers);
+        m_Moon.findPositionOnly(&numbers, m_Geo->lat(), &LST, &m_Earth);
+        m_Moon.EquatorialToHorizontal(&LST, m_Geo->lat());
+        m_Sun.findPositionOnly(&numbers, nullptr, nullptr, &m_Earth);
+
+        double sinRA, cosRA, sinDec, cosDec;
+        m_Moon.ra().SinCos(sinRA, cosRA);
+        m_Moon.dec().SinCos(sinDec, cosDec);
+
+        MoonSample &sample  = night.moon[i];
+        sample.x            = cosDec * cosRA;
+        sample.y            = cosDec * sinRA;
+        sample.z            = sinDec;
+        sample.altitude     = m_Moon.alt().Degrees();
+        // Same as KSMoon::illum(), without the phase image KSMoon::findPhase() loads
+        double const phase  = (m_Moon.ecLong() - m_Sun.ecLong()).radians();
+        sample.illumination = 0.5 * (1.0 - std::cos(phase));
+    }
+}
+
+const SchedulerEphemeris::Target &SchedulerEphemeris::target(Night &night, const SkyPoint &point)
+{
+    QPair<double, double> const key(point.ra0().Degrees(), point.dec0().Degrees());
+    auto it = night.targets.find(key);
+    if (it != night.targets.end())
+        return it.value();
+
+    // Precession, nutation and aberration barely move a target within a night, compute them at its middle
+    SkyPoint o;
+    o.setRA0(point.ra0());
+    o.setDec0(point.dec0());
+    apparentCoordinates(o, night.startJD + 0.5L);
+
+    Target coords;
+    coords.ra = o.ra().Hours();
+    o.dec().SinCos(coords.sinDec, coords.cosDec);
+    return night.targets.insert(key, coords).value();
+}
+
+bool SchedulerEphemeris::locationChanged()
+{
+    GeoLocation const *geo = kstarsData()->geo();
+    if (m_Geo && geo->lat()->Degrees() == m_Geo->lat()->Degrees() && geo->lng()->Degrees() == m_Geo->lng()->Degrees() &&
+            geo->TZ() == m_Geo->TZ0())
+        return false;
+
+    // Copy the location with the offset of the daylight saving time rule of KStars, the rule is shared with KStars
+    m_Geo.reset(new GeoLocation(*geo->lng(), *geo->lat(), geo->name(), geo->province(), geo->country(), geo->TZ(),
+                                nullptr, geo->elevation()));
+    m_Nights.clear();
+    return true;
+}
+
+bool SchedulerEphemeris::updateLocation()
+{
+    if (isMainThread())
+        locationChanged();
+
+    Q_ASSERT_X(m_Geo, __FUNCTION__, "The location of KStars was read on the main thread before querying.");
+    return !m_Geo.isNull();
+}
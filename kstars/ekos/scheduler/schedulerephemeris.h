@@ -0,0 +1,159 @@
+/*  Ekos Scheduler Ephemeris
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "geolocation.h"
+#include "ksmoon.h"
+#include "ksplanet.h"
+#include "kssun.h"
+#include "kstarsdatetime.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <functional>
+
+class KStarsData;
+class SkyPoint;
+
+/**
+ * @class SchedulerEphemeris
+ * Per-night tables of where the Moon and the scheduler targets are, so that evaluating the constraints of a
+ * job does not compute full positions for every minute it looks at.
+ *
+ * A night runs from local noon to the next one. Its table holds the Moon position, altitude and illumination
+ * sampled every few minutes, and for every target queried the apparent coordinates for that night. Queries
+ * interpolate the Moon between samples and derive altitudes from the sidereal time, which is linear in time.
+ * Tables are built on demand, and thrown away when the geographic location changes or clear() is called.
+ *
+ * Queries may come from the scheduler engine running on a worker thread, they are serialized. The Moon, the
+ * Sun and the Earth used to build the tables are private to the ephemeris and never the ones of the sky map,
+ * and only their positions are computed, not their phase or magnitude which read the sky map. The location of
+ * KStars is read on the main thread only, queries from another thread use the location last read, and must
+ * come after clear() was called on the main thread.
+ */
+class SchedulerEphemeris
+{
+    public:
+        /** @brief Where a target and the Moon are at some point in time. */
+        struct Sample
+        {
+            /// Altitude of the target, in degrees
+            double altitude { 0 };
+            /// Whether the target crossed the meridian and is going down
+            bool isSetting { false };
+            /// Altitude of the Moon, in degrees
+            double moonAltitude { 0 };
+            /// Illuminated fraction of the Moon, between 0 and 1
+            double moonIllumination { 0 };
+            /// Angular distance from the target to the Moon, in degrees
+            double moonSeparation { 0 };
+        };
+
+        static SchedulerEphemeris *Instance();
+
+        /**
+         * @brief Drop all tables, for instance before evaluating the scheduler queue again.
+         * @note Called on the main thread, this also reads the location of KStars for the queries to come.
+         */
+        void clear();
+
+        /** @return the location the tables are built for, with the time zone offset it had when read. */
+        GeoLocation location();
+
+        /**
+         * @brief apparentCoordinates Precess, nutate and aberrate a point from its catalog coordinates.
+         * @param point Point, with its catalog coordinates, whose apparent coordinates are set.
+         * @param jd Julian day to compute the apparent coordinates for.
+         * @note Unlike SkyPoint::updateCoords(), this reads neither the options nor the sky map, and the light
+         * bending near the Sun is left out.
+         */
+        static void apparentCoordinates(SkyPoint &point, long double jd);
+
+        /**
+         * @return the data of KStars, asserting it is read on the main thread.
+         * The scheduler engine may run on another thread, where it must not read the data of KStars.
+         */
+        static KStarsData *kstarsData();
+
+        /**
+         * @brief sample Look up a target at a given date and time.
+         * @param target Target, with its catalog coordinates.
+         * @param when Local date and time, or UTC if its time spec says so.
+         * @param withMoon false to skip the Moon, whose fields are then left to their defaults.
+         * @return the altitude of the target and where the Moon is.
+         */
+        Sample sample(const SkyPoint &target, const KStarsDateTime &when, bool withMoon = true);
+
+        /**
+         * @brief findFirstMinute Find when a condition on a target is met for the first time.
+         * @param target Target, with its catalog coordinates.
+         * @param from Local date and time to start searching at, or UTC if its time spec says so.
+         * @param minutes Number of minutes to search.
+         * @param accept Condition on the target and the Moon.
+         * @param withMoon false if the condition does not depend on the Moon.
+         * @return the number of minutes from @p from when @p accept holds first, or -1 if it does not hold in time.
+         * @note The condition is checked every few minutes and the first minute it holds is found by bisection in
+         * between. A condition holding for a shorter time than that interval may be missed.
+         */
+        int findFirstMinute(const SkyPoint &target, const KStarsDateTime &from, int minutes,
+                            const std::function<bool(const Sample &)> &accept, bool withMoon = true);
+
+    private:
+        SchedulerEphemeris();
+
+        struct MoonSample
+        {
+            /// Apparent position of the Moon as a unit vector, on the equatorial sphere of the date
+            double x { 0 }, y { 0 }, z { 0 };
+            double altitude { 0 };
+            double illumination { 0 };
+        };
+
+        struct Target
+        {
+            /// Apparent right ascension in hours, and declination, for the night
+            double ra { 0 };
+            double sinDec { 0 }, cosDec { 0 };
+        };
+
+        struct Night
+        {
+            /// Julian day at the local noon starting the night
+            long double startJD { 0 };
+            /// Local sidereal time at startJD, in hours
+            double startLST { 0 };
+            QVector<MoonSample> moon;
+            /// Targets by catalog right ascension and declination, in degrees
+            QMap<QPair<double, double>, Target> targets;
+        };
+
+        /** @return the target and the Moon at the universal time @p jd. */
+        Sample sampleAt(const SkyPoint &target, long double jd, bool withMoon);
+        KStarsDateTime toUT(const KStarsDateTime &when) const;
+        /** @return the night holding the universal time @p jd, building it if needed. */
+        Night &night(long double jd);
+        void sampleMoon(Night &night);
+        const Target &target(Night &night, const SkyPoint &point);
+        /** @return true, and forgets all tables, if the location changed since they were built. */
+        bool locationChanged();
+        /** @return false if no location was read yet, reading it if on the main thread. */
+        bool updateLocation();
+
+        QMutex m_Mutex;
+        /// Location of KStars when last read, with the time zone offset of that time
+        QScopedPointer<GeoLocation> m_Geo;
+        QMap<long long, Night> m_Nights;
+        KSPlanet m_Earth;
+        KSMoon m_Moon;
+        KSSun m_Sun;
+};
@@ -14,6 +14,7 @@
 #include "skymapcomposite.h"
 #include "Options.h"
 #include "scheduler.h"
+#include "schedulerephemeris.h"
 
 #include <knotification.h>
 
@@ -24,9 +25,55 @@
 #define BAD_SCORE -1000
 #define MIN_ALTITUDE 15.0
 
+namespace
+{
+// Moon separation score of a target, the further apart, the better, up to a maximum score of 20
+int16_t moonSeparationScore(SchedulerEphemeris::Sample const &sample, double minMoonSeparation)
+{
+    // Lunar illumination %
+    double const illum = sample.moonIllumination * 100.0;
+
+    // Moon/Sky separation p
+    double const separation = sample.moonSeparation;
+
+    // Zenith distance of the moon
+    double const zMoon = (90 - sample.moonAltitude);
+    // Zenith distance of target
+    double const zTarget = (90 - sample.altitude);
+
+    int16_t score = 0;
+
+    // If target = Moon, or no illuminiation, or moon below horizon, return static score.
+    if (zMoon == zTarget || illum == 0 || zMoon >= 90)
+        score = 100;
+    else
+    {
+        // JM: Some magic voodoo formula I came up with!
+        double moonEffect = (pow(separation, 1.7) * pow(zMoon, 0.5)) / (pow(zTarget, 1.1) * pow(illum, 0.5));
+
+        // Limit to 0 to 100 range.
+        moonEffect = KSUtils::clamp(moonEffect, 0.0, 100.0);
+
+        if (minMoonSeparation > 0)
+        {
+            if (separation < minMoonSeparation)
+                score = BAD_SCORE * 5;
+            else
+                score = moonEffect;
+        }
+        else
+            score = moonEffect;
+    }
+
+    // Limit to 0 to 20
+    score /= 5.0;
+
+    return score;
+}
+}
+
 SchedulerJob::SchedulerJob()
 {
-    moon = dynamic_cast<KSMoon *>(KStarsData::Instance()->skyComposite()->findByName(i18n("Moon")));
 }
 
 void SchedulerJob::setName(const QString &value)
@@ -421,7 +468,7 @@ void SchedulerJob::setTargetCoords(dms &ra, dms &dec)
     targetCoords.setRA0(ra);
     targetCoords.setDec0(dec);
 
-    targetCoords.apparentCoord(static_cast<long double>(J2000), KStarsData::Instance()->ut().djd());
+    targetCoords.apparentCoord(static_cast<long double>(J2000), SchedulerEphemeris::kstarsData()->ut().djd());
 }
 
 void SchedulerJob::updateJobCells()
@@ -720,28 +767,17 @@ bool SchedulerJob::increasingStartupTimeOrder(SchedulerJob const *job1, Schedule
 
 int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
-    GeoLocation *geo = KStarsData::Instance()->geo();
+    GeoLocation const location = SchedulerEphemeris::Instance()->location();
+    GeoLocation const * const geo = &location;
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
     KStarsDateTime ltWhen(when.isValid() ?
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
-                          KStarsData::Instance()->lt());
-
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
+                          SchedulerEphemeris::kstarsData()->lt());
 
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
-
-    // Compute local sidereal time for the current fraction of the day, calculate altitude
-    CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    o.EquatorialToHorizontal(&LST, geo->lat());
-    double const altitude = o.alt().Degrees();
+    // Look the target up in the tables of the night
+    SchedulerEphemeris::Sample const sample = SchedulerEphemeris::Instance()->sample(getTargetCoords(), ltWhen, false);
+    double const altitude = sample.altitude;
 
     double const SETTING_ALTITUDE_CUTOFF = Options::settingAltitudeCutoff();
     int16_t score = BAD_SCORE - 1;
@@ -759,17 +795,8 @@ int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
             score = BAD_SCORE;
         // Else if setting and under altitude cutoff, job would end soon after starting, bad score
         // FIXME: half bad score when under altitude cutoff risk getting positive again
-        else
-        {
-            double offset = LST.Hours() - o.ra().Hours();
-            if (24.0 <= offset)
-                offset -= 24.0;
-            else if (offset < 0.0)
-                offset += 24.0;
-            if (0.0 <= offset && offset < 12.0)
-                if (altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
-                    score = BAD_SCORE / 2;
-        }
+        else if (sample.isSetting && altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
+            score = BAD_SCORE / 2;
     }
     // If not constrained but below minimum hard altitude, set score to 10% of altitude value
     else if (altitude < MIN_ALTITUDE)
@@ -792,70 +819,17 @@ int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
 
 int16_t SchedulerJob::getMoonSeparationScore(QDateTime const &when) const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
-    GeoLocation *geo = KStarsData::Instance()->geo();
+    GeoLocation const location = SchedulerEphemeris::Instance()->location();
+    GeoLocation const * const geo = &location;
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
     KStarsDateTime ltWhen(when.isValid() ?
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
-                          KStarsData::Instance()->lt());
-
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
-
-    // Update moon
-    //ut = geo->LTtoUT(ltWhen);
-    //KSNumbers ksnum(ut.djd()); // BUG: possibly LT.djd() != UT.djd() because of translation
-    //LST = geo->GSTtoLST(ut.gst());
-    CachingDms LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    moon->updateCoords(&numbers, true, geo->lat(), &LST, true);
-
-    double const moonAltitude = moon->alt().Degrees();
+                          SchedulerEphemeris::kstarsData()->lt());
 
-    // Lunar illumination %
-    double const illum = moon->illum() * 100.0;
-
-    // Moon/Sky separation p
-    double const separation = moon->angularDistanceTo(&o).Degrees();
-
-    // Zenith distance of the moon
-    double const zMoon = (90 - moonAltitude);
-    // Zenith distance of target
-    double const zTarget = (90 - o.alt().Degrees());
-
-    int16_t score = 0;
-
-    // If target = Moon, or no illuminiation, or moon below horizon, return static score.
-    if (zMoon == zTarget || illum == 0 || zMoon >= 90)
-        score = 100;
-    else
-    {
-        // JM: Some magic voodoo formula I came up with!
-        double moonEffect = (pow(separation, 1.7) * pow(zMoon, 0.5)) / (pow(zTarget, 1.1) * pow(illum, 0.5));
-
-        // Limit to 0 to 100 range.
-        moonEffect = KSUtils::clamp(moonEffect, 0.0, 100.0);
-
-        if (getMinMoonSeparation() > 0)
-        {
-            if (separation < getMinMoonSeparation())
-                score = BAD_SCORE * 5;
-            else
-                score = moonEffect;
-        }
-        else
-            score = moonEffect;
-    }
-
-    // Limit to 0 to 20
-    score /= 5.0;
+    // Look the target and the moon up in the tables of the night
+    int16_t const score = moonSeparationScore(SchedulerEphemeris::Instance()->sample(getTargetCoords(), ltWhen),
+                          getMinMoonSeparation());
 
     //qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' target is %L3 degrees from Moon (score %2).")
     //    .arg(getName())
@@ -868,103 +842,61 @@ int16_t SchedulerJob::getMoonSeparationScore(QDateTime const &when) const
 
 double SchedulerJob::getCurrentMoonSeparation() const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
-    GeoLocation *geo = KStarsData::Instance()->geo();
-
-    // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
-    KStarsDateTime ltWhen(KStarsData::Instance()->lt());
-
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
-
-    // Update moon
-    //ut = geo->LTtoUT(ltWhen);
-    //KSNumbers ksnum(ut.djd()); // BUG: possibly LT.djd() != UT.djd() because of translation
-    //LST = geo->GSTtoLST(ut.gst());
-    CachingDms LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    moon->updateCoords(&numbers, true, geo->lat(), &LST, true);
-
     // Moon/Sky separation p
-    return moon->angularDistanceTo(&o).Degrees();
+    return SchedulerEphemeris::Instance()->sample(getTargetCoords(), SchedulerEphemeris::kstarsData()->lt()).moonSeparation;
 }
 
 QDateTime SchedulerJob::calculateAltitudeTime(QDateTime const &when) const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
-    GeoLocation *geo = KStarsData::Instance()->geo();
+    GeoLocation const location = SchedulerEphemeris::Instance()->location();
+    GeoLocation const * const geo = &location;
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
     KStarsDateTime ltWhen(when.isValid() ?
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
-                          KStarsData::Instance()->lt());
-
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Calculate the UT at the argument time
-    KStarsDateTime const ut = geo->LTtoUT(ltWhen);
+                          SchedulerEphemeris::kstarsData()->lt());
 
     double const SETTING_ALTITUDE_CUTOFF = Options::settingAltitudeCutoff();
+    double const minAltitude = getMinAltitude();
+    double const minMoonSeparation = getMinMoonSeparation();
 
-    // Within the next 24 hours, search when the job target matches the altitude and moon constraints
-    for (unsigned int minute = 0; minute < 24 * 60; minute++)
+    // The target matches the altitude and moon constraints
+    auto const acceptable = [&](SchedulerEphemeris::Sample const & sample)
     {
-        KStarsDateTime const ltOffset(ltWhen.addSecs(minute * 60));
+        if (sample.altitude < minAltitude)
+            return false;
 
-        // Update RA/DEC of the target for the current fraction of the day
-        KSNumbers numbers(ltOffset.djd());
-        o.updateCoordsNow(&numbers);
+        // Don't test proximity to dawn in this situation, we only cater for altitude here
 
-        // Compute local sidereal time for the current fraction of the day, calculate altitude
-        CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltOffset).gst());
-        o.EquatorialToHorizontal(&LST, geo->lat());
-        double const altitude = o.alt().Degrees();
+        // Continue searching if Moon separation is not good enough
+        if (0 < minMoonSeparation && moonSeparationScore(sample, minMoonSeparation) < 0)
+            return false;
 
-        if (getMinAltitude() <= altitude)
-        {
-            // Don't test proximity to dawn in this situation, we only cater for altitude here
-
-            // Continue searching if Moon separation is not good enough
-            if (0 < getMinMoonSeparation() && getMoonSeparationScore(ltOffset) < 0)
-                continue;
-
-            // Continue searching if target is setting and under the cutoff
-            double offset = LST.Hours() - o.ra().Hours();
-            if (24.0 <= offset)
-                offset -= 24.0;
-            else if (offset < 0.0)
-                offset += 24.0;
-            if (0.0 <= offset && offset < 12.0)
-                if (altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
-                    continue;
-
-            return ltOffset;
-        }
-    }
+        // Continue searching if target is setting and under the cutoff
+        if (sample.isSetting && sample.altitude - SETTING_ALTITUDE_CUTOFF < minAltitude)
+            return false;
 
-    return QDateTime();
+        return true;
+    };
+
+    // Within the next 24 hours, search when the job target matches the altitude and moon constraints
+    int const minute = SchedulerEphemeris::Instance()->findFirstMinute(getTargetCoords(), ltWhen, 24 * 60, acceptable,
+                       0 < minMoonSeparation);
+
+    return minute < 0 ? QDateTime() : ltWhen.addSecs(minute * 60);
 }
 
 QDateTime SchedulerJob::calculateCulmination(QDateTime const &when) const
 {
     // FIXME: culmination calculation is a min altitude requirement, should be an interval altitude requirement
-    GeoLocation *geo = KStarsData::Instance()->geo();
+    GeoLocation const location = SchedulerEphemeris::Instance()->location();
+    GeoLocation const * const geo = &location;
     // FIXME: block calculating target coordinates at a particular time is duplicated in calculateCulmination
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
     KStarsDateTime ltWhen(when.isValid() ?
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
-                          KStarsData::Instance()->lt());
+                          SchedulerEphemeris::kstarsData()->lt());
 
     // Create a sky object with the target catalog coordinates
     SkyPoint const target = getTargetCoords();
@@ -973,8 +905,7 @@ QDateTime SchedulerJob::calculateCulmination(QDateTime const &when) const
     o.setDec0(target.dec0());
 
     // Update RA/DEC for the argument date/time
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
+    SchedulerEphemeris::apparentCoordinates(o, ltWhen.djd());
 
     // Calculate transit date/time at the argument date - transitTime requires UT and returns LocalTime
     KStarsDateTime transitDateTime(ltWhen.date(), o.transitTime(geo->LTtoUT(ltWhen), geo), Qt::LocalTime);
@@ -1009,12 +940,22 @@ double SchedulerJob::findAltitude(const SkyPoint &target, const QDateTime &when,
 {
     // FIXME: block calculating target coordinates at a particular time is duplicated in several places
 
-    GeoLocation * const geo = KStarsData::Instance()->geo();
+    GeoLocation const location = SchedulerEphemeris::Instance()->location();
+    GeoLocation const * const geo = &location;
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
     KStarsDateTime ltWhen(when.isValid() ?
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
-                          KStarsData::Instance()->lt());
+                          SchedulerEphemeris::kstarsData()->lt());
+
+    // Unless the details are to be logged, look the target up in the tables of the night
+    if (!debug)
+    {
+        SchedulerEphemeris::Sample const sample = SchedulerEphemeris::Instance()->sample(target, ltWhen, false);
+        if (is_setting)
+            *is_setting = sample.isSetting;
+        return sample.altitude;
+    }
 
     // Create a sky object with the target catalog coordinates
     SkyObject o;
@@ -1022,8 +963,7 @@ double SchedulerJob::findAltitude(const SkyPoint &target, const QDateTime &when,
     o.setDec0(target.dec0());
 
     // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
+    SchedulerEphemeris::apparentCoordinates(o, ltWhen.djd());
 
     // Calculate alt/az coordinates using KStars instance's geolocation
     CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
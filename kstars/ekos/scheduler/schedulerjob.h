@@ -499,7 +499,4 @@ private:
     bool lightFramesRequired { false };
 
     QMap<QString, uint16_t> capturedFramesMap;
-
-    /// Pointer to Moon object
-    KSMoon *moon { nullptr };
 };
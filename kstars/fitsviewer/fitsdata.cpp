@@ -24,8 +24,6 @@
 #include "fitscentroiddetector.h"
 #include "fitssepdetector.h"
 
-#include "fpack.h"
-
 #include "kstarsdata.h"
 #include "ksutils.h"
 #include "kspaths.h"
@@ -38,6 +36,7 @@
 #include <QImage>
 #include <QtConcurrent>
 #include <QImageReader>
+#include <QtEndian>
 
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
 #include <wcshdr.h>
@@ -50,6 +49,8 @@
 
 #include <cfloat>
 #include <cmath>
+#include <limits>
+#include <type_traits>
 
 #include <fits_debug.h>
 
@@ -83,7 +84,7 @@ FITSData::FITSData(const FITSData * other)
     this->m_Mode = other->m_Mode;
     this->m_DataType = other->m_DataType;
     this->m_Channels = other->m_Channels;
-    memcpy(&stats, &(other->stats), sizeof(stats));
+    stats = other->stats;
     m_ImageBuffer = new uint8_t[stats.samples_per_channel * m_Channels * stats.bytesPerPixel];
     memcpy(m_ImageBuffer, other->m_ImageBuffer, stats.samples_per_channel * m_Channels * stats.bytesPerPixel);
 }
@@ -177,6 +178,26 @@ bool fitsOpenError(int status, const QString &message, bool silent)
     qCCritical(KSTARS_FITS) << errMessage;
     return false;
 }
+
+// Tile compressed images keep their keywords in a binary table header, cfitsio converts them
+// back to the equivalent image header.
+int imageHeaderToString(fitsfile *fptr, int nocomments, char **header, int *nkeys, int *status)
+{
+    if (fits_is_compressed_image(fptr, status))
+        return fits_convert_hdr2str(fptr, nocomments, nullptr, 0, header, nkeys, status);
+    return fits_hdr2str(fptr, nocomments, nullptr, 0, header, nkeys, status);
+}
+
+// Normalize a rotation given either in degrees or as a count of quarter turns to 0, 90, 180 or 270.
+int normalizedRotation(int rotate)
+{
+    if (rotate >= 1 && rotate <= 3)
+        rotate *= 90;
+    rotate %= 360;
+    if (rotate < 0)
+        rotate += 360;
+    return ((rotate + 45) / 90 % 4) * 90;
+}
 }
 
 bool FITSData::privateLoad(void *fits_buffer, size_t fits_buffer_size, bool silent)
@@ -187,33 +208,12 @@ bool FITSData::privateLoad(void *fits_buffer, size_t fits_buffer_size, bool sile
 
     m_isTemporary = m_Filename.startsWith(m_TemporaryPath);
 
-    if (fits_buffer == nullptr && m_Filename.endsWith(".fz"))
-    {
-        // Store so we don't lose.
+    // Tile compressed files are decompressed straight into the image buffer, the primary HDU of an
+    // fpacked file is empty and the image lives in the first extension.
+    m_isCompressed = (fits_buffer == nullptr && m_Filename.endsWith(".fz"));
+    if (m_isCompressed)
         m_compressedFilename = m_Filename;
 
-        QString uncompressedFile = QDir::tempPath() + QString("/%1").arg(QUuid::createUuid().toString().remove(
-                                       QRegularExpression("[-{}]")));
-        fpstate	fpvar;
-        fp_init (&fpvar);
-        if (fp_unpack(m_Filename.toLatin1().data(), uncompressedFile.toLatin1().data(), fpvar) < 0)
-        {
-            errMessage = i18n("Failed to unpack compressed fits");
-            if (!silent)
-                KSNotification::error(errMessage, i18n("FITS Open"));
-            qCCritical(KSTARS_FITS) << errMessage;
-            return false;
-        }
-
-        // Remove compressed .fz if it was temporary
-        if (m_isTemporary && autoRemoveTemporaryFITS)
-            QFile::remove(m_Filename);
-
-        m_Filename = uncompressedFile;
-        m_isTemporary = true;
-        m_isCompressed = true;
-    }
-
     if (fits_buffer == nullptr)
     {
         // Use open diskfile as it does not use extended file names which has problems opening
@@ -235,7 +235,7 @@ bool FITSData::privateLoad(void *fits_buffer, size_t fits_buffer_size, bool sile
             stats.size = fits_buffer_size;
     }
 
-    if (fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
+    if (fits_movabs_hdu(fptr, m_isCompressed ? 2 : 1, IMAGE_HDU, &status))
         return fitsOpenError(status, i18n("Could not locate image HDU."), silent);
 
     if (fits_get_img_param(fptr, 3, &(stats.bitpix), &(stats.ndim), naxes, &status))
@@ -320,22 +320,37 @@ bool FITSData::privateLoad(void *fits_buffer, size_t fits_buffer_size, bool sile
         m_Channels = 1;
 
     m_ImageBufferSize = stats.samples_per_channel * m_Channels * stats.bytesPerPixel;
-    m_ImageBuffer = new uint8_t[m_ImageBufferSize];
-    if (m_ImageBuffer == nullptr)
-    {
-        qCWarning(KSTARS_FITS) << "FITSData: Not enough memory for image_buffer channel. Requested: "
-                               << m_ImageBufferSize << " bytes.";
-        clearImageBuffers();
-        return false;
-    }
 
     rotCounter     = 0;
     flipHCounter   = 0;
     flipVCounter   = 0;
     long nelements = stats.samples_per_channel * m_Channels;
 
-    if (fits_read_img(fptr, m_DataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, &status))
-        return fitsOpenError(status, i18n("Error reading image."), silent);
+    // Uncompressed files on disk are read directly from a mapping of their data unit. Temporary files
+    // are excluded since they can be removed while the image is still in use.
+    if (fits_buffer == nullptr && !m_isTemporary && loadMappedImage(nelements))
+    {
+        qCDebug(KSTARS_FITS) << "Read" << m_Filename << (m_ImageBufferMapped ? "in place from" : "through") << "a memory mapping";
+    }
+    else
+    {
+        m_ImageBuffer = new uint8_t[m_ImageBufferSize];
+        if (m_ImageBuffer == nullptr)
+        {
+            qCWarning(KSTARS_FITS) << "FITSData: Not enough memory for image_buffer channel. Requested: "
+                                   << m_ImageBufferSize << " bytes.";
+            clearImageBuffers();
+            return false;
+        }
+
+        if (m_isCompressed)
+        {
+            if (!readCompressedImage(nelements, &status))
+                return fitsOpenError(status, i18n("Error decompressing image."), silent);
+        }
+        else if (fits_read_img(fptr, m_DataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, &status))
+            return fitsOpenError(status, i18n("Error reading image."), silent);
+    }
 
     parseHeader();
 
@@ -512,12 +527,8 @@ int FITSData::saveFITS(const QString &newFilename)
     }
 
     int rot = 0, mirror = 0;
-    if (rotCounter > 0)
-    {
-        rot = (90 * rotCounter) % 360;
-        if (rot < 0)
-            rot += 360;
-    }
+    if (rotCounter != 0)
+        rot = normalizedRotation(90 * rotCounter);
     if (flipHCounter % 2 != 0 || flipVCounter % 2 != 0)
         mirror = 1;
 
@@ -541,344 +552,775 @@ int FITSData::saveFITS(const QString &newFilename)
     return status;
 }
 
-void FITSData::clearImageBuffers()
-{
-    delete[] m_ImageBuffer;
-    m_ImageBuffer = nullptr;
-    //m_BayerBuffer = nullptr;
-}
-
-void FITSData::calculateStats(bool refresh)
+bool FITSData::saveImage(const QString &filename) const
 {
-    // Calculate min max
-    calculateMinMax(refresh);
+    if (m_ImageBuffer == nullptr)
+        return false;
 
-    // Get standard deviation and mean in one run
+    int bitpix = 0;
     switch (m_DataType)
     {
         case TBYTE:
-            runningAverageStdDev<uint8_t>();
-            break;
-
-        case TSHORT:
-            runningAverageStdDev<int16_t>();
+            bitpix = BYTE_IMG;
             break;
-
         case TUSHORT:
-            runningAverageStdDev<uint16_t>();
+            bitpix = USHORT_IMG;
             break;
-
-        case TLONG:
-            runningAverageStdDev<int32_t>();
-            break;
-
         case TULONG:
-            runningAverageStdDev<uint32_t>();
+            bitpix = ULONG_IMG;
             break;
-
         case TFLOAT:
-            runningAverageStdDev<float>();
+            bitpix = FLOAT_IMG;
             break;
-
         case TLONGLONG:
-            runningAverageStdDev<int64_t>();
+            bitpix = LONGLONG_IMG;
             break;
-
         case TDOUBLE:
-            runningAverageStdDev<double>();
+            bitpix = DOUBLE_IMG;
             break;
-
         default:
-            return;
+            return false;
     }
 
-    // FIXME That's not really SNR, must implement a proper solution for this value
-    stats.SNR = stats.mean[0] / stats.stddev[0];
+    int status = 0;
+    fitsfile *new_fptr = nullptr;
+    long naxes[3] = { stats.width, stats.height, m_Channels };
 
-    if (refresh && markStars)
-        // Let's try to find star positions again after transformation
-        starsSearched = false;
+    // A leading "!" makes cfitsio overwrite an existing file
+    if (fits_create_file(&new_fptr, QString("!%1").arg(filename).toLatin1(), &status) ||
+            fits_create_img(new_fptr, bitpix, m_Channels > 1 ? 3 : 2, naxes, &status))
+    {
+        fits_report_error(stderr, status);
+        if (new_fptr != nullptr)
+        {
+            status = 0;
+            fits_close_file(new_fptr, &status);
+        }
+        return false;
+    }
+
+    // Keywords describing the data unit were written by cfitsio for the buffer as it is now
+    const QStringList structural = { "SIMPLE", "BITPIX", "NAXIS", "NAXIS1", "NAXIS2", "NAXIS3", "EXTEND",
+                                     "BZERO", "BSCALE", "END"
+                                   };
+    for (const Record *oneRecord : records)
+    {
+        if (oneRecord->key.isEmpty() || structural.contains(oneRecord->key))
+            continue;
+
+        const QByteArray key     = oneRecord->key.toLatin1();
+        const QByteArray comment = oneRecord->comment.toLatin1();
+        if (oneRecord->key == "COMMENT")
+            fits_write_comment(new_fptr, comment.constData(), &status);
+        else if (oneRecord->key == "HISTORY")
+            fits_write_history(new_fptr, comment.constData(), &status);
+        else if (oneRecord->value.type() == QVariant::Int)
+        {
+            long value = oneRecord->value.toInt();
+            fits_update_key(new_fptr, TLONG, key.constData(), &value, comment.constData(), &status);
+        }
+        else if (oneRecord->value.type() == QVariant::Double)
+        {
+            double value = oneRecord->value.toDouble();
+            fits_update_key(new_fptr, TDOUBLE, key.constData(), &value, comment.constData(), &status);
+        }
+        else
+        {
+            QByteArray value = oneRecord->value.toString().toLatin1();
+            fits_update_key(new_fptr, TSTRING, key.constData(), value.data(), comment.constData(), &status);
+        }
+
+        // A record that cannot be written back is not worth losing the image for
+        if (status)
+        {
+            qCWarning(KSTARS_FITS) << "Skipping FITS keyword" << oneRecord->key << "when saving" << filename;
+            status = 0;
+        }
+    }
+
+    fits_write_img(new_fptr, m_DataType, 1, stats.samples_per_channel * m_Channels, m_ImageBuffer, &status);
+    if (status)
+        fits_report_error(stderr, status);
+
+    int closeStatus = 0;
+    fits_close_file(new_fptr, &closeStatus);
+
+    if (status || closeStatus)
+    {
+        QFile::remove(filename);
+        return false;
+    }
+
+    qCInfo(KSTARS_FITS) << "Saved FITS image:" << filename;
+    return true;
 }
 
-int FITSData::calculateMinMax(bool refresh)
+void FITSData::clearImageBuffers()
 {
-    int status, nfound = 0;
+    if (m_ImageBufferMapped)
+    {
+        m_MappedFile.close();
+        m_ImageBufferMapped = false;
+    }
+    else
+        delete[] m_ImageBuffer;
+    m_ImageBuffer = nullptr;
+    //m_BayerBuffer = nullptr;
+}
 
-    status = 0;
+namespace
+{
+// Converts count big-endian FITS samples of type T to native order into destination.
+// If flipSign is set, the sign bit is toggled, which is how unsigned integers are stored
+// in FITS (signed values with BZERO = 2^(BITPIX-1)).
+template <typename T>
+void convertBigEndian(const uchar *source, uint8_t *destination, uint32_t count, bool flipSign)
+{
+    const T signBit = static_cast<T>(T(1) << (sizeof(T) * 8 - 1));
+    const int nThreads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    const uint32_t stride = count / nThreads;
 
-    if ((fptr != nullptr) && !refresh)
+    QList<QFuture<void>> futures;
+    for (int n = 0; n < nThreads; n++)
     {
-        if (fits_read_key_dbl(fptr, "DATAMIN", &(stats.min[0]), nullptr, &status) == 0)
-            nfound++;
+        const uint32_t start = n * stride;
+        const uint32_t end = (n == nThreads - 1) ? count : start + stride;
+        futures.append(QtConcurrent::run([ = ]()
+        {
+            T * output = reinterpret_cast<T *>(destination);
+            for (uint32_t i = start; i < end; i++)
+            {
+                T value = qFromBigEndian<T>(source + i * sizeof(T));
+                output[i] = flipSign ? (value ^ signBit) : value;
+            }
+        }));
+    }
 
-        if (fits_read_key_dbl(fptr, "DATAMAX", &(stats.max[0]), nullptr, &status) == 0)
-            nfound++;
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
+}
+}
 
-        // If we found both keywords, no need to calculate them, unless they are both zeros
-        if (nfound == 2 && !(stats.min[0] == 0 && stats.max[0] == 0))
-            return 0;
+bool FITSData::loadMappedImage(long nelements)
+{
+    int status = 0;
+    LONGLONG headStart = 0, dataStart = 0, dataEnd = 0;
+    double bscale = 1, bzero = 0;
+
+    // Tile compressed images and scaled data must go through cfitsio
+    if (fits_is_compressed_image(fptr, &status) || status)
+        return false;
+    if (fits_get_hduaddrll(fptr, &headStart, &dataStart, &dataEnd, &status))
+        return false;
+    if (fits_read_key_dbl(fptr, "BSCALE", &bscale, nullptr, &status) == KEY_NO_EXIST)
+        status = 0;
+    if (fits_read_key_dbl(fptr, "BZERO", &bzero, nullptr, &status) == KEY_NO_EXIST)
+        status = 0;
+    if (status || bscale != 1)
+        return false;
+
+    // FITS stores unsigned 16 and 32-bit integers as signed values offset by BZERO,
+    // everything else we can handle must not be offset at all.
+    bool flipSign = false;
+    switch (stats.bitpix)
+    {
+        case SHORT_IMG:
+            if (bzero != 32768)
+                return false;
+            flipSign = true;
+            break;
+        case LONG_IMG:
+            if (bzero != 2147483648.0)
+                return false;
+            flipSign = true;
+            break;
+        case BYTE_IMG:
+        case FLOAT_IMG:
+        case LONGLONG_IMG:
+        case DOUBLE_IMG:
+            if (bzero != 0)
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    const qint64 dataSize = static_cast<qint64>(nelements) * stats.bytesPerPixel;
+    if (dataEnd - dataStart < dataSize)
+        return false;
+
+    m_MappedFile.setFileName(m_Filename);
+    if (!m_MappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    uchar * data = m_MappedFile.map(dataStart, dataSize);
+    if (data == nullptr)
+    {
+        m_MappedFile.close();
+        return false;
+    }
+
+    // Single byte samples need no conversion and are used in place until something modifies them.
+    if (stats.bytesPerPixel == 1)
+    {
+        m_ImageBuffer = data;
+        m_ImageBufferMapped = true;
+        return true;
+    }
+
+    m_ImageBuffer = new uint8_t[m_ImageBufferSize];
+    switch (stats.bytesPerPixel)
+    {
+        case 2:
+            convertBigEndian<uint16_t>(data, m_ImageBuffer, nelements, flipSign);
+            break;
+        case 4:
+            convertBigEndian<uint32_t>(data, m_ImageBuffer, nelements, flipSign);
+            break;
+        case 8:
+            convertBigEndian<uint64_t>(data, m_ImageBuffer, nelements, flipSign);
+            break;
     }
 
-    stats.min[0] = 1.0E30;
-    stats.max[0] = -1.0E30;
+    m_MappedFile.close();
+    return true;
+}
+
+void FITSData::detachImageBuffer()
+{
+    if (!m_ImageBufferMapped)
+        return;
+
+    auto * buffer = new uint8_t[m_ImageBufferSize];
+    memcpy(buffer, m_ImageBuffer, m_ImageBufferSize);
+    clearImageBuffers();
+    m_ImageBuffer = buffer;
+}
 
-    stats.min[1] = 1.0E30;
-    stats.max[1] = -1.0E30;
+bool FITSData::readCompressedImage(long nelements, int *status)
+{
+    const int nThreads = fits_is_reentrant() ? qBound(1, QThreadPool::globalInstance()->maxThreadCount(),
+                         static_cast<int>(stats.height)) : 1;
+    int anynull = 0;
 
-    stats.min[2] = 1.0E30;
-    stats.max[2] = -1.0E30;
+    if (nThreads == 1)
+        return fits_read_img(fptr, m_DataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, status) == 0;
 
+    int hdu = 1;
+    fits_get_hdu_num(fptr, &hdu);
+
+    // A fitsfile handle cannot be shared between threads, so each band decompresses its rows
+    // through its own handle on the same file.
+    const QByteArray filename = m_Filename.toLatin1();
+    const int rowsPerBand = (stats.height + nThreads - 1) / nThreads;
+    QList<QFuture<int>> futures;
+
+    for (int firstRow = 0; firstRow < stats.height; firstRow += rowsPerBand)
+    {
+        const int lastRow = qMin(static_cast<int>(stats.height), firstRow + rowsPerBand);
+        futures.append(QtConcurrent::run([ = ]()
+        {
+            int bandStatus = 0, bandAnyNull = 0;
+            fitsfile *bandFptr = nullptr;
+
+            if (fits_open_diskfile(&bandFptr, filename.constData(), READONLY, &bandStatus) == 0 &&
+                    fits_movabs_hdu(bandFptr, hdu, IMAGE_HDU, &bandStatus) == 0)
+            {
+                for (int channel = 0; channel < m_Channels && bandStatus == 0; channel++)
+                {
+                    long firstPixel[3] = { 1, firstRow + 1, channel + 1 };
+                    long lastPixel[3] = { stats.width, lastRow, channel + 1 };
+                    long increment[3] = { 1, 1, 1 };
+                    uint8_t *band = m_ImageBuffer + (channel * stats.samples_per_channel + firstRow * stats.width)
+                                    * stats.bytesPerPixel;
+                    fits_read_subset(bandFptr, m_DataType, firstPixel, lastPixel, increment, nullptr, band,
+                                     &bandAnyNull, &bandStatus);
+                }
+            }
+
+            if (bandFptr != nullptr)
+            {
+                int closeStatus = 0;
+                fits_close_file(bandFptr, &closeStatus);
+            }
+            return bandStatus;
+        }));
+    }
+
+    for (QFuture<int> &future : futures)
+    {
+        future.waitForFinished();
+        if (*status == 0)
+            *status = future.result();
+    }
+
+    return *status == 0;
+}
+
+void FITSData::calculateStats(bool refresh)
+{
+    // Min, max, mean, standard deviation, histogram and median in one run
     switch (m_DataType)
     {
         case TBYTE:
-            calculateMinMax<uint8_t>();
+            calculateStatistics<uint8_t>();
             break;
 
         case TSHORT:
-            calculateMinMax<int16_t>();
+            calculateStatistics<int16_t>();
             break;
 
         case TUSHORT:
-            calculateMinMax<uint16_t>();
+            calculateStatistics<uint16_t>();
             break;
 
         case TLONG:
-            calculateMinMax<int32_t>();
+            calculateStatistics<int32_t>();
             break;
 
         case TULONG:
-            calculateMinMax<uint32_t>();
+            calculateStatistics<uint32_t>();
             break;
 
         case TFLOAT:
-            calculateMinMax<float>();
+            calculateStatistics<float>();
             break;
 
         case TLONGLONG:
-            calculateMinMax<int64_t>();
+            calculateStatistics<int64_t>();
             break;
 
         case TDOUBLE:
-            calculateMinMax<double>();
+            calculateStatistics<double>();
             break;
 
         default:
-            break;
+            return;
     }
 
-    //qDebug() << "DATAMIN: " << stats.min << " - DATAMAX: " << stats.max;
-    return 0;
-}
-
-template <typename T>
-QPair<T, T> FITSData::getParitionMinMax(uint32_t start, uint32_t stride)
-{
-    auto * buffer = reinterpret_cast<T *>(m_ImageBuffer);
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
-
-    uint32_t end = start + stride;
-
-    for (uint32_t i = start; i < end; i++)
+    // Prefer DATAMIN & DATAMAX keywords if the file provides them, unless they are both zeros
+    if ((fptr != nullptr) && !refresh)
     {
-        if (buffer[i] < min)
-            min = buffer[i];
-        else if (buffer[i] > max)
-            max = buffer[i];
+        int status = 0;
+        double headerMin = 0, headerMax = 0;
+        if (fits_read_key_dbl(fptr, "DATAMIN", &headerMin, nullptr, &status) == 0 &&
+                fits_read_key_dbl(fptr, "DATAMAX", &headerMax, nullptr, &status) == 0 &&
+                !(headerMin == 0 && headerMax == 0))
+        {
+            stats.min[0] = headerMin;
+            stats.max[0] = headerMax;
+        }
     }
 
-    return qMakePair(min, max);
+    // FIXME That's not really SNR, must implement a proper solution for this value
+    stats.SNR = stats.mean[0] / stats.stddev[0];
+
+    if (refresh && markStars)
+        // Let's try to find star positions again after transformation
+        starsSearched = false;
 }
 
-template <typename T>
-void FITSData::calculateMinMax()
+namespace
+{
+// Statistics of one partition of a channel, or of a whole channel once all partitions are merged.
+struct PartitionStatistic
 {
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
+    double min { std::numeric_limits<double>::max() };
+    double max { std::numeric_limits<double>::lowest() };
+    // Number of samples, their mean and the sum of their squared deviations from the mean.
+    double count { 0 };
+    double mean { 0 };
+    double m2 { 0 };
+    QVector<uint32_t> histogram;
+};
 
-    // Create N threads
-    const uint8_t nThreads = 16;
+// Partitions are never smaller than this so that per-partition histograms stay cheap on small frames.
+constexpr uint32_t MIN_PARTITION_SAMPLES = 1 << 16;
+// Number of bins used for types that are too wide for one bin per value.
+constexpr int HISTOGRAM_BINS = 1 << 16;
 
-    for (int n = 0; n < m_Channels; n++)
-    {
-        uint32_t cStart = n * stats.samples_per_channel;
+// Runs partitionFunction(start, end) over the samples of a channel, one partition per pool thread,
+// and returns the partial results. Blocks until done.
+template <typename F>
+QVector<PartitionStatistic> runPartitions(uint32_t samples, const F &partitionFunction)
+{
+    const uint32_t nPartitions = qBound<uint32_t>(1, samples / MIN_PARTITION_SAMPLES,
+                                 static_cast<uint32_t>(QThreadPool::globalInstance()->maxThreadCount()));
+    const uint32_t stride = samples / nPartitions;
 
-        // Calculate how many elements we process per thread
-        uint32_t tStride = stats.samples_per_channel / nThreads;
+    QVector<PartitionStatistic> results;
+    if (nPartitions == 1)
+    {
+        results.push_back(partitionFunction(0, samples));
+        return results;
+    }
 
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
+    QList<QFuture<PartitionStatistic>> futures;
+    for (uint32_t i = 0; i < nPartitions; i++)
+    {
+        const uint32_t start = i * stride;
+        // The last partition takes what is left over due to the division above
+        const uint32_t end = (i == nPartitions - 1) ? samples : start + stride;
+        futures.append(QtConcurrent::run([ =, &partitionFunction]()
+        {
+            return partitionFunction(start, end);
+        }));
+    }
 
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
+    for (QFuture<PartitionStatistic> &future : futures)
+        results.push_back(future.result());
 
-        // List of futures
-        QList<QFuture<QPair<T, T>>> futures;
+    return results;
+}
 
-        for (int i = 0; i < nThreads; i++)
-        {
-            // Run threads
-            futures.append(QtConcurrent::run(this, &FITSData::getParitionMinMax<T>, tStart, (i == (nThreads - 1)) ? fStride : tStride));
-            tStart += tStride;
-        }
+// Median and median absolute deviation, in bins, from a histogram holding count samples.
+void histogramMedian(const QVector<uint32_t> &histogram, double count, double *medianBin, double *madBin)
+{
+    const int binCount = static_cast<int>(histogram.size());
+    const double half = std::floor(count / 2);
 
-        // Now wait for results
-        for (int i = 0; i < nThreads; i++)
-        {
-            QPair<T, T> result = futures[i].result();
-            if (result.first < min)
-                min = result.first;
-            if (result.second > max)
-                max = result.second;
-        }
+    double cumulative = 0;
+    int median = 0;
+    for (; median < binCount - 1; median++)
+    {
+        cumulative += histogram[median];
+        if (cumulative > half)
+            break;
+    }
 
-        stats.min[n] = min;
-        stats.max[n] = max;
+    // Deviations from the median bin, walking outwards on both sides at once.
+    cumulative = histogram[median];
+    int deviation = 0;
+    while (cumulative <= half && deviation < binCount)
+    {
+        deviation++;
+        if (median - deviation >= 0)
+            cumulative += histogram[median - deviation];
+        if (median + deviation < binCount)
+            cumulative += histogram[median + deviation];
     }
+
+    *medianBin = median;
+    *madBin = deviation;
 }
 
+// Integer types up to 16 bits. A single pass builds an exact histogram with one bin per value,
+// and everything else is derived from the merged histogram.
 template <typename T>
-QPair<double, double> FITSData::getSquaredSumAndMean(uint32_t start, uint32_t stride)
-{
-    uint32_t m_n       = 2;
-    double m_oldM = 0, m_newM = 0, m_oldS = 0, m_newS = 0;
+void channelStatistics(const T *buffer, uint32_t samples, FITSData::Statistic &stats, int channel, std::true_type)
+{
+    typedef typename std::make_unsigned<T>::type UT;
+    constexpr int binCount = std::numeric_limits<UT>::max() + 1;
+    // Signed types are shifted so that their lowest value lands in bin 0
+    constexpr int binOffset = -static_cast<int>(std::numeric_limits<T>::min());
+
+    auto partitionHistogram = [buffer](uint32_t start, uint32_t end)
+    {
+        PartitionStatistic partition;
+        partition.histogram.fill(0, binCount);
+        uint32_t * histogram = partition.histogram.data();
+        for (uint32_t i = start; i < end; i++)
+            histogram[buffer[i] + binOffset]++;
+        return partition;
+    };
+
+    QVector<PartitionStatistic> partitions = runPartitions(samples, partitionHistogram);
+    QVector<uint32_t> &histogram = partitions[0].histogram;
+    for (size_t p = 1; p < partitions.size(); p++)
+    {
+        const uint32_t * partial = partitions[p].histogram.constData();
+        for (int i = 0; i < binCount; i++)
+            histogram[i] += partial[i];
+    }
+
+    int first = 0, last = binCount - 1;
+    while (first < last && histogram[first] == 0)
+        first++;
+    while (last > first && histogram[last] == 0)
+        last--;
+
+    double sum = 0;
+    for (int i = first; i <= last; i++)
+        sum += static_cast<double>(histogram[i]) * (i - binOffset);
+    const double mean = sum / samples;
+
+    double m2 = 0;
+    for (int i = first; i <= last; i++)
+        m2 += histogram[i] * (i - binOffset - mean) * (i - binOffset - mean);
+
+    double medianBin = 0, madBin = 0;
+    histogramMedian(histogram, samples, &medianBin, &madBin);
+
+    stats.min[channel]    = first - binOffset;
+    stats.max[channel]    = last - binOffset;
+    stats.mean[channel]   = mean;
+    stats.stddev[channel] = std::sqrt(m2 / samples);
+    stats.median[channel] = medianBin - binOffset;
+    stats.mad[channel]    = madBin;
+    stats.histogram[channel] = histogram;
+    stats.histogramMin[channel] = -binOffset;
+    stats.histogramBinWidth[channel] = 1;
+}
+
+// Wider integer and floating point types. Min, max, mean and variance are gathered in one pass,
+// then a fixed number of bins spanning [min, max] yields the median and MAD at bin resolution.
+template <typename T>
+void channelStatistics(const T *buffer, uint32_t samples, FITSData::Statistic &stats, int channel, std::false_type)
+{
+    auto partitionMoments = [buffer](uint32_t start, uint32_t end)
+    {
+        PartitionStatistic partition;
+        // Sums are shifted by the first sample to limit cancellation when computing the variance
+        const double shift = buffer[start];
+        double sum = 0, squaredSum = 0, count = 0;
+        double min = partition.min, max = partition.max;
+        for (uint32_t i = start; i < end; i++)
+        {
+            const double value = buffer[i];
+            // Skip NaN samples in floating point data
+            if (value != value)
+                continue;
+            if (value < min)
+                min = value;
+            if (value > max)
+                max = value;
+            sum += value - shift;
+            squaredSum += (value - shift) * (value - shift);
+            count++;
+        }
+
+        partition.min = min;
+        partition.max = max;
+        partition.count = count;
+        if (count > 0)
+        {
+            partition.mean = shift + sum / count;
+            partition.m2 = squaredSum - sum * sum / count;
+        }
+        return partition;
+    };
+
+    // Merge partitions using Chan's parallel variance algorithm
+    QVector<PartitionStatistic> partitions = runPartitions(samples, partitionMoments);
+    PartitionStatistic total;
+    for (const PartitionStatistic &partition : partitions)
+    {
+        if (partition.count == 0)
+            continue;
+        const double count = total.count + partition.count;
+        const double delta = partition.mean - total.mean;
+        total.mean += delta * partition.count / count;
+        total.m2   += partition.m2 + delta * delta * total.count * partition.count / count;
+        total.count = count;
+        total.min = std::min(total.min, partition.min);
+        total.max = std::max(total.max, partition.max);
+    }
+
+    if (total.count == 0)
+    {
+        stats.min[channel] = stats.max[channel] = stats.mean[channel] = stats.stddev[channel] = 0;
+        stats.median[channel] = stats.mad[channel] = 0;
+        stats.histogram[channel].clear();
+        return;
+    }
 
-    auto * buffer = reinterpret_cast<T *>(m_ImageBuffer);
-    uint32_t end = start + stride;
+    const double min = total.min;
+    const double binWidth = (total.max - total.min) / (HISTOGRAM_BINS - 1);
+    const double binScale = binWidth > 0 ? 1.0 / binWidth : 0;
 
-    for (uint32_t i = start; i < end; i++)
+    auto partitionHistogram = [buffer, min, binScale](uint32_t start, uint32_t end)
     {
-        m_newM = m_oldM + (buffer[i] - m_oldM) / m_n;
-        m_newS = m_oldS + (buffer[i] - m_oldM) * (buffer[i] - m_newM);
+        PartitionStatistic partition;
+        partition.histogram.fill(0, HISTOGRAM_BINS);
+        uint32_t * histogram = partition.histogram.data();
+        for (uint32_t i = start; i < end; i++)
+        {
+            const double value = buffer[i];
+            if (value != value)
+                continue;
+            histogram[qBound(0, static_cast<int>((value - min) * binScale + 0.5), HISTOGRAM_BINS - 1)]++;
+        }
+        return partition;
+    };
 
-        m_oldM = m_newM;
-        m_oldS = m_newS;
-        m_n++;
+    partitions = runPartitions(samples, partitionHistogram);
+    QVector<uint32_t> &histogram = partitions[0].histogram;
+    for (size_t p = 1; p < partitions.size(); p++)
+    {
+        const uint32_t * partial = partitions[p].histogram.constData();
+        for (int i = 0; i < HISTOGRAM_BINS; i++)
+            histogram[i] += partial[i];
     }
 
-    return qMakePair<double, double>(m_newM, m_newS);
+    double medianBin = 0, madBin = 0;
+    histogramMedian(histogram, total.count, &medianBin, &madBin);
+
+    stats.min[channel]    = total.min;
+    stats.max[channel]    = total.max;
+    stats.mean[channel]   = total.mean;
+    stats.stddev[channel] = std::sqrt(total.m2 / total.count);
+    stats.median[channel] = min + medianBin * binWidth;
+    stats.mad[channel]    = madBin * binWidth;
+    stats.histogram[channel] = histogram;
+    stats.histogramMin[channel] = min;
+    stats.histogramBinWidth[channel] = binWidth;
+}
 }
 
 template <typename T>
-void FITSData::runningAverageStdDev()
+void FITSData::calculateStatistics()
 {
-    // Create N threads
-    const uint8_t nThreads = 16;
-
-    for (int n = 0; n < m_Channels; n++)
-    {
-        uint32_t cStart = n * stats.samples_per_channel;
+    typedef std::integral_constant < bool, std::is_integral<T>::value && sizeof(T) <= 2 > HasExactBins;
 
-        // Calculate how many elements we process per thread
-        uint32_t tStride = stats.samples_per_channel / nThreads;
+    auto * buffer = reinterpret_cast<T const *>(m_ImageBuffer);
 
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
+    for (int n = 0; n < m_Channels; n++)
+        channelStatistics(buffer + n * stats.samples_per_channel, stats.samples_per_channel, stats, n, HasExactBins());
+}
 
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
+QVector<double> FITSData::createGaussianKernel(int size, double sigma)
+{
+    // The 2D Gaussian is the product of two 1D Gaussians, so a single normalized row is enough
+    QVector<double> kernel(size);
 
-        // List of futures
-        QList<QFuture<QPair<double, double>>> futures;
+    double kernelSum = 0.0;
+    int fOff = (size - 1) / 2;
+    for (int x = -fOff; x <= fOff; x++)
+    {
+        kernel[x + fOff] = qExp(-(x * x) / (2.0 * sigma * sigma));
+        kernelSum += kernel.at(x + fOff);
+    }
+    for (int x = 0; x < size; x++)
+        kernel[x] /= kernelSum;
 
-        for (int i = 0; i < nThreads; i++)
-        {
-            // Run threads
-            futures.append(QtConcurrent::run(this, &FITSData::getSquaredSumAndMean<T>, tStart,
-                                             (i == (nThreads - 1)) ? fStride : tStride));
-            tStart += tStride;
-        }
+    return kernel;
+}
 
-        double mean = 0, squared_sum = 0;
+namespace
+{
+// Splits rows into one band per thread of the global pool and waits for all of them.
+template <typename Function>
+void runRowBands(int rows, Function function)
+{
+    const int nThreads = qBound(1, QThreadPool::globalInstance()->maxThreadCount(), rows);
+    const int rowsPerBand = (rows + nThreads - 1) / nThreads;
 
-        // Now wait for results
-        for (int i = 0; i < nThreads; i++)
+    QList<QFuture<void>> futures;
+    for (int firstRow = 0; firstRow < rows; firstRow += rowsPerBand)
+    {
+        const int lastRow = std::min(rows, firstRow + rowsPerBand);
+        futures.append(QtConcurrent::run([ =, &function]()
         {
-            QPair<double, double> result = futures[i].result();
-            mean += result.first;
-            squared_sum += result.second;
-        }
-
-        double variance = squared_sum / stats.samples_per_channel;
-
-        stats.mean[n]   = mean / nThreads;
-        stats.stddev[n] = sqrt(variance);
+            function(firstRow, lastRow);
+        }));
     }
+
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
 }
 
-QVector<double> FITSData::createGaussianKernel(int size, double sigma)
+// Convolves width samples of input with weights, out-of-range taps count as zero. Only the first and
+// last columns need the range check; the remaining ones accumulate one tap at a time over the row,
+// which the compiler vectorizes.
+void convolveRow(const float *input, float *output, int width, const QVector<float> &weights)
 {
-    QVector<double> kernel(size * size);
-    kernel.fill(0.0, size * size);
+    const int kernelSize = weights.size();
+    const int fOff = (kernelSize - 1) / 2;
+    const int interiorStart = std::min(fOff, width);
+    const int interiorEnd = std::max(interiorStart, width - fOff);
 
-    double kernelSum = 0.0;
-    int fOff = (size - 1) / 2;
-    double normal = 1.0 / (2.0 * M_PI * sigma * sigma);
-    for (int y = -fOff; y <= fOff; y++)
+    auto border = [&](int x)
     {
-        for (int x = -fOff; x <= fOff; x++)
+        float sum = 0;
+        for (int k = 0; k < kernelSize; k++)
         {
-            double distance = ((y * y) + (x * x)) / (2.0 * sigma * sigma);
-            int index = (y + fOff) * size + (x + fOff);
-            kernel[index] = normal * qExp(-distance);
-            kernelSum += kernel.at(index);
+            const int source = x - fOff + k;
+            if (source >= 0 && source < width)
+                sum += weights.at(k) * input[source];
         }
-    }
-    for (int y = 0; y < size; y++)
+        output[x] = sum;
+    };
+
+    for (int x = 0; x < interiorStart; x++)
+        border(x);
+    for (int x = interiorEnd; x < width; x++)
+        border(x);
+
+    std::fill(output + interiorStart, output + interiorEnd, 0.0f);
+    for (int k = 0; k < kernelSize; k++)
     {
-        for (int x = 0; x < size; x++)
-        {
-            int index = y * size + x;
-            kernel[index] = kernel.at(index) * 1.0 / kernelSum;
-        }
+        const float weight = weights.at(k);
+        const float *tap = input + k - fOff;
+        for (int x = interiorStart; x < interiorEnd; x++)
+            output[x] += weight * tap[x];
     }
+}
 
-    return kernel;
+template <typename T>
+T fromFloat(float value, std::true_type)
+{
+    return static_cast<T>(std::lround(value));
+}
+
+template <typename T>
+T fromFloat(float value, std::false_type)
+{
+    return static_cast<T>(value);
+}
 }
 
 template <typename T>
 void FITSData::convolutionFilter(const QVector<double> &kernel, int kernelSize)
 {
     T * imagePtr = reinterpret_cast<T *>(m_ImageBuffer);
+    const int width = stats.width;
+    const int height = stats.height;
+    const int fOff = (kernelSize - 1) / 2;
 
-    // Create variable for pixel data for each kernel
-    T gt = 0;
+    QVector<float> weights(kernelSize);
+    for (int k = 0; k < kernelSize; k++)
+        weights[k] = kernel.at(k);
 
-    // This is how much your center pixel is offset from the border of your kernel
-    int fOff = (kernelSize - 1) / 2;
+    // Horizontal pass from the image into the scratch buffer, so every output pixel is computed
+    // from the original data
+    QVector<float> scratch(width * height);
+    float * scratchPtr = scratch.data();
 
-    // Start with the pixel that is offset fOff from top and fOff from the left side
-    // this is so entire kernel is on your image
-    for (int offsetY = 0; offsetY < stats.height; offsetY++)
+    runRowBands(height, [&](int firstRow, int lastRow)
     {
-        for (int offsetX = 0; offsetX < stats.width; offsetX++)
+        QVector<float> row(width);
+        for (int y = firstRow; y < lastRow; y++)
         {
-            // reset gray value to 0
-            gt = 0;
-            // position of the kernel center pixel
-            int byteOffset = offsetY * stats.width + offsetX;
+            const T * input = imagePtr + y * width;
+            for (int x = 0; x < width; x++)
+                row[x] = input[x];
+            convolveRow(row.constData(), scratchPtr + y * width, width, weights);
+        }
+    });
 
-            // kernel calculations
-            for (int filterY = -fOff; filterY <= fOff; filterY++)
+    // Vertical pass from the scratch buffer back into the image, accumulating whole rows
+    runRowBands(height, [&](int firstRow, int lastRow)
+    {
+        QVector<float> sum(width);
+        float * sumPtr = sum.data();
+        for (int y = firstRow; y < lastRow; y++)
+        {
+            std::fill(sumPtr, sumPtr + width, 0.0f);
+            const int firstTap = std::max(0, fOff - y);
+            const int lastTap = std::min(kernelSize, height - y + fOff);
+            for (int k = firstTap; k < lastTap; k++)
             {
-                for (int filterX = -fOff; filterX <= fOff; filterX++)
-                {
-                    if ((offsetY + filterY) >= 0 && (offsetY + filterY) < stats.height
-                            && ((offsetX + filterX) >= 0 && (offsetX + filterX) < stats.width ))
-                    {
-
-                        int calcOffset = byteOffset + filterX + filterY * stats.width;
-                        int index = (filterY + fOff) * kernelSize + (filterX + fOff);
-                        double kernelValue = kernel.at(index);
-                        gt += (imagePtr[calcOffset]) * kernelValue;
-                    }
-                }
+                const float weight = weights.at(k);
+                const float * input = scratchPtr + (y - fOff + k) * width;
+                for (int x = 0; x < width; x++)
+                    sumPtr[x] += weight * input[x];
             }
 
-            // set new data in the other byte array for your image data
-            imagePtr[byteOffset] = gt;
+            T * output = imagePtr + y * width;
+            for (int x = 0; x < width; x++)
+                output[x] = fromFloat<T>(sumPtr[x], std::is_integral<T>());
         }
-    }
+    });
 }
 
 template <typename T>
@@ -911,7 +1353,7 @@ bool FITSData::parseHeader()
     char * header = nullptr;
     int status = 0, nkeys = 0;
 
-    if (fits_hdr2str(fptr, 0, nullptr, 0, &header, &nkeys, &status))
+    if (imageHeaderToString(fptr, 0, &header, &nkeys, &status))
     {
         fits_report_error(stderr, status);
         free(header);
@@ -1151,6 +1593,9 @@ void FITSData::applyFilter(FITSScale type, uint8_t * image, QVector<double> * mi
     if (type == FITS_NONE)
         return;
 
+    if (image == nullptr)
+        detachImageBuffer();
+
     QVector<double> dataMin(3);
     QVector<double> dataMax(3);
 
@@ -1421,8 +1866,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t * targetImage, QVector<double
                     stats.max[i] = max[i];
                 }
                 //if (type != FITS_AUTO && type != FITS_LINEAR)
-                runningAverageStdDev<T>();
-                //QtConcurrent::run(this, &FITSData::runningAverageStdDev<T>);
+                calculateStatistics<T>();
             }
         }
         break;
@@ -1530,7 +1974,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t * targetImage, QVector<double
             delete[] extension;
 
             if (calcStats)
-                runningAverageStdDev<T>();
+                calculateStatistics<T>();
         }
         break;
 
@@ -1596,7 +2040,7 @@ bool FITSData::checkForWCS()
         m_wcs = nullptr;
     }
 
-    if (fits_hdr2str(fptr, 1, nullptr, 0, &header, &nkeyrec, &status))
+    if (imageHeaderToString(fptr, 1, &header, &nkeyrec, &status))
     {
         char errmsg[512];
         fits_get_errstatus(status, errmsg);
@@ -1668,7 +2112,7 @@ bool FITSData::loadWCS()
     int w  = width();
     int h = height();
 
-    if (fits_hdr2str(fptr, 1, nullptr, 0, &header, &nkeyrec, &status))
+    if (imageHeaderToString(fptr, 1, &header, &nkeyrec, &status))
     {
         char errmsg[512];
         fits_get_errstatus(status, errmsg);
@@ -1944,258 +2388,133 @@ void FITSData::setRotCounter(int value)
     rotCounter = value;
 }
 
-/* Rotate an image by 90, 180, or 270 degrees, with an optional
- * reflection across the vertical or horizontal axis.
- * verbose generates extra info on stdout.
- * return nullptr if successful or rotated image.
- */
-template <typename T>
-bool FITSData::rotFITS(int rotate, int mirror)
+namespace
 {
-    int ny, nx;
-    int x1, y1, x2, y2;
-    uint8_t * rotimage = nullptr;
-    int offset        = 0;
-
-    if (rotate == 1)
-        rotate = 90;
-    else if (rotate == 2)
-        rotate = 180;
-    else if (rotate == 3)
-        rotate = 270;
-    else if (rotate < 0)
-        rotate = rotate + 360;
-
-    nx = stats.width;
-    ny = stats.height;
-
-    int BBP = stats.bytesPerPixel;
+// Pixel (x, y) of a width x height source lands at destination index origin + x * strideX + y * strideY.
+// Every rotation by a multiple of 90 degrees, with or without a mirror, is one such mapping.
+struct PixelTransform
+{
+    long origin;
+    long strideX;
+    long strideY;
+    bool swapAxes;
+};
+
+PixelTransform pixelTransform(int rotate, int mirror, long nx, long ny)
+{
+    switch (normalizedRotation(rotate))
+    {
+        case 90:
+            if (mirror == 1)
+                return { (nx - 1) * ny + ny - 1, -ny, -1, true };
+            if (mirror == 2)
+                return { 0, ny, 1, true };
+            return { ny - 1, ny, -1, true };
+
+        case 180:
+            // Mirroring a half turn is a flip across the other axis
+            if (mirror == 1)
+                return { (ny - 1) * nx, 1, -nx, false };
+            if (mirror == 2)
+                return { nx - 1, -1, nx, false };
+            return { (ny - 1) * nx + nx - 1, -1, -nx, false };
+
+        case 270:
+            if (mirror == 1)
+                return { 0, ny, 1, true };
+            if (mirror == 2)
+                return { (nx - 1) * ny + ny - 1, -ny, -1, true };
+            return { (nx - 1) * ny, -ny, 1, true };
 
-    /* Allocate buffer for rotated image */
-    rotimage = new uint8_t[stats.samples_per_channel * m_Channels * BBP];
-
-    if (rotimage == nullptr)
-    {
-        qWarning() << "Unable to allocate memory for rotated image buffer!";
-        return false;
+        default:
+            if (mirror == 1)
+                return { nx - 1, -1, nx, false };
+            if (mirror == 2)
+                return { (ny - 1) * nx, 1, -nx, false };
+            return { 0, 1, nx, false };
     }
+}
 
-    auto * rotBuffer = reinterpret_cast<T *>(rotimage);
-    auto * buffer    = reinterpret_cast<T *>(m_ImageBuffer);
+// Apply a pixel transform to every channel. The source is walked in square blocks so that when the
+// transform swaps axes, the destination columns written by a block still fit in cache. Bands of block
+// rows are processed in parallel since they write disjoint parts of the destination.
+template <typename T>
+void transformPixels(const T *source, T *destination, int width, int height, int channels, const PixelTransform &transform)
+{
+    constexpr int blockSize = 64;
+    const long channelSize = static_cast<long>(width) * height;
+    const int blockRows = (height + blockSize - 1) / blockSize;
+    const int nThreads = qBound(1, QThreadPool::globalInstance()->maxThreadCount(), blockRows);
+    const int blockRowsPerThread = (blockRows + nThreads - 1) / nThreads;
 
-    /* Mirror image without rotation */
-    if (rotate < 45 && rotate > -45)
+    QList<QFuture<void>> futures;
+    for (int firstBlockRow = 0; firstBlockRow < blockRows; firstBlockRow += blockRowsPerThread)
     {
-        if (mirror == 1)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (x1 = 0; x1 < nx; x1++)
-                {
-                    x2 = nx - x1 - 1;
-                    for (y1 = 0; y1 < ny; y1++)
-                        rotBuffer[(y1 * nx) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-        else if (mirror == 2)
+        const int firstRow = firstBlockRow * blockSize;
+        const int lastRow = std::min(height, (firstBlockRow + blockRowsPerThread) * blockSize);
+        futures.append(QtConcurrent::run([ = ]()
         {
-            for (int i = 0; i < m_Channels; i++)
+            for (int channel = 0; channel < channels; channel++)
             {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    y2 = ny - y1 - 1;
-                    for (x1 = 0; x1 < nx; x1++)
-                        rotBuffer[(y2 * nx) + x1 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-        else
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    for (x1 = 0; x1 < nx; x1++)
-                        rotBuffer[(y1 * nx) + x1 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-    }
+                const T *input = source + channel * channelSize;
+                T *output = destination + channel * channelSize + transform.origin;
 
-    /* Rotate by 90 degrees */
-    else if (rotate >= 45 && rotate < 135)
-    {
-        if (mirror == 1)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    x2 = ny - y1 - 1;
-                    for (x1 = 0; x1 < nx; x1++)
-                    {
-                        y2                                 = nx - x1 - 1;
-                        rotBuffer[(y2 * ny) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                    }
-                }
-            }
-        }
-        else if (mirror == 2)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    for (x1 = 0; x1 < nx; x1++)
-                        rotBuffer[(x1 * ny) + y1 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-        else
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
+                for (int y0 = firstRow; y0 < lastRow; y0 += blockSize)
                 {
-                    x2 = ny - y1 - 1;
-                    for (x1 = 0; x1 < nx; x1++)
+                    const int y1 = std::min(lastRow, y0 + blockSize);
+                    for (int x0 = 0; x0 < width; x0 += blockSize)
                     {
-                        y2                                 = x1;
-                        rotBuffer[(y2 * ny) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
+                        const int x1 = std::min(width, x0 + blockSize);
+                        for (int y = y0; y < y1; y++)
+                        {
+                            const T *in = input + static_cast<long>(y) * width;
+                            T *out = output + y * transform.strideY;
+                            if (transform.strideX == 1)
+                                std::copy(in + x0, in + x1, out + x0);
+                            else
+                                for (int x = x0; x < x1; x++)
+                                    out[x * transform.strideX] = in[x];
+                        }
                     }
                 }
             }
-        }
-
-        stats.width  = ny;
-        stats.height = nx;
+        }));
     }
 
-    /* Rotate by 180 degrees */
-    else if (rotate >= 135 && rotate < 225)
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
+}
+}
+
+/* Rotate an image by 90, 180, or 270 degrees, with an optional
+ * reflection across the vertical (mirror = 1) or horizontal (mirror = 2) axis.
+ */
+template <typename T>
+bool FITSData::rotFITS(int rotate, int mirror)
+{
+    const int nx = stats.width;
+    const int ny = stats.height;
+
+    /* Allocate buffer for rotated image */
+    uint8_t * rotimage = new uint8_t[stats.samples_per_channel * m_Channels * stats.bytesPerPixel];
+
+    if (rotimage == nullptr)
     {
-        if (mirror == 1)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    y2 = ny - y1 - 1;
-                    for (x1 = 0; x1 < nx; x1++)
-                        rotBuffer[(y2 * nx) + x1 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-        else if (mirror == 2)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (x1 = 0; x1 < nx; x1++)
-                {
-                    x2 = nx - x1 - 1;
-                    for (y1 = 0; y1 < ny; y1++)
-                        rotBuffer[(y1 * nx) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-        else
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    y2 = ny - y1 - 1;
-                    for (x1 = 0; x1 < nx; x1++)
-                    {
-                        x2                                 = nx - x1 - 1;
-                        rotBuffer[(y2 * nx) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                    }
-                }
-            }
-        }
+        qWarning() << "Unable to allocate memory for rotated image buffer!";
+        return false;
     }
 
-    /* Rotate by 270 degrees */
-    else if (rotate >= 225 && rotate < 315)
-    {
-        if (mirror == 1)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    for (x1 = 0; x1 < nx; x1++)
-                        rotBuffer[(x1 * ny) + y1 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-        else if (mirror == 2)
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    x2 = ny - y1 - 1;
-                    for (x1 = 0; x1 < nx; x1++)
-                    {
-                        y2                                 = nx - x1 - 1;
-                        rotBuffer[(y2 * ny) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                    }
-                }
-            }
-        }
-        else
-        {
-            for (int i = 0; i < m_Channels; i++)
-            {
-                offset = stats.samples_per_channel * i;
-                for (y1 = 0; y1 < ny; y1++)
-                {
-                    x2 = y1;
-                    for (x1 = 0; x1 < nx; x1++)
-                    {
-                        y2                                 = nx - x1 - 1;
-                        rotBuffer[(y2 * ny) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                    }
-                }
-            }
-        }
+    const PixelTransform transform = pixelTransform(rotate, mirror, nx, ny);
+    transformPixels<T>(reinterpret_cast<T *>(m_ImageBuffer), reinterpret_cast<T *>(rotimage), nx, ny, m_Channels,
+                       transform);
 
+    if (transform.swapAxes)
+    {
         stats.width  = ny;
         stats.height = nx;
     }
 
-    /* If rotating by more than 315 degrees, assume top-bottom reflection */
-    else if (rotate >= 315 && mirror)
-    {
-        for (int i = 0; i < m_Channels; i++)
-        {
-            offset = stats.samples_per_channel * i;
-            for (y1 = 0; y1 < ny; y1++)
-            {
-                for (x1 = 0; x1 < nx; x1++)
-                {
-                    x2                                 = y1;
-                    y2                                 = x1;
-                    rotBuffer[(y2 * ny) + x2 + offset] = buffer[(y1 * nx) + x1 + offset];
-                }
-            }
-        }
-    }
-
-    delete[] m_ImageBuffer;
+    clearImageBuffers();
     m_ImageBuffer = rotimage;
 
     return true;
@@ -2211,6 +2530,9 @@ void FITSData::rotWCSFITS(int angle, int mirror)
     naxis1 = stats.width;
     naxis2 = stats.height;
 
+    // Same angle convention as the pixel transform applied by rotFITS()
+    angle = normalizedRotation(angle);
+
     if (fits_read_key_dbl(fptr, "CD1_1", &ctemp1, comment, &status))
     {
         // No WCS keywords
@@ -2486,6 +2808,7 @@ void FITSData::rotWCSFITS(int angle, int mirror)
 
 uint8_t * FITSData::getWritableImageBuffer()
 {
+    detachImageBuffer();
     return m_ImageBuffer;
 }
 
@@ -2496,7 +2819,7 @@ uint8_t const * FITSData::getImageBuffer() const
 
 void FITSData::setImageBuffer(uint8_t * buffer)
 {
-    delete[] m_ImageBuffer;
+    clearImageBuffers();
     m_ImageBuffer = buffer;
 }
 
@@ -2615,6 +2938,83 @@ bool FITSData::debayer()
     }
 }
 
+namespace
+{
+// Debayers height rows of source into the planar R, G and B channels of destination, each channel
+// being width * height samples. The frame is split into horizontal bands decoded concurrently. Every
+// band is decoded together with a margin of rows above and below it, so the demosaic kernels and the
+// border clearing of bayer.c only affect rows that are dropped, and its own rows are then written
+// straight into the three planes.
+template <typename T, typename Decoder>
+dc1394error_t debayerBands(const T *source, T *destination, uint32_t width, uint32_t height, uint32_t decodeHeight,
+                           dc1394bayer_method_t method, Decoder decode)
+{
+    // Covers the widest banded kernel and is even so every band starts on the same color filter phase
+    constexpr uint32_t margin = 8;
+    const uint32_t planeSize = width * height;
+    uint32_t nThreads = 1;
+    switch (method)
+    {
+        // Downsampling changes the output geometry, VNG and AHD keep static state in bayer.c
+        // that is not thread safe. These are decoded as a single band.
+        case DC1394_BAYER_METHOD_DOWNSAMPLE:
+        case DC1394_BAYER_METHOD_VNG:
+        case DC1394_BAYER_METHOD_AHD:
+            break;
+        default:
+            nThreads = qBound(1u, static_cast<uint32_t>(QThreadPool::globalInstance()->maxThreadCount()),
+                              decodeHeight / (4 * margin));
+            break;
+    }
+    uint32_t rowsPerBand = (decodeHeight + nThreads - 1) / nThreads;
+    rowsPerBand += rowsPerBand % 2;
+
+    QList<QFuture<dc1394error_t>> futures;
+    for (uint32_t firstRow = 0; firstRow < decodeHeight; firstRow += rowsPerBand)
+    {
+        const uint32_t lastRow = std::min(decodeHeight, firstRow + rowsPerBand);
+        futures.append(QtConcurrent::run([ = ]()
+        {
+            const uint32_t decodeFirst = firstRow >= margin ? firstRow - margin : 0;
+            const uint32_t decodeLast = std::min(decodeHeight, lastRow + margin);
+            // bayer.c works on pairs of rows and writes one row past an odd height
+            QVector<T> rgb((decodeLast - decodeFirst + 1) * width * 3);
+
+            dc1394error_t result = decode(source + decodeFirst * width, rgb.data(), width, decodeLast - decodeFirst);
+            if (result != DC1394_SUCCESS)
+                return result;
+
+            // Data in R1G1B1, we need to copy them into 3 layers for FITS
+            const T *input = rgb.constData() + (firstRow - decodeFirst) * width * 3;
+            T *rBuff = destination + firstRow * width;
+            T *gBuff = rBuff + planeSize;
+            T *bBuff = gBuff + planeSize;
+            const uint32_t count = (lastRow - firstRow) * width;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                rBuff[i] = input[i * 3];
+                gBuff[i] = input[i * 3 + 1];
+                bBuff[i] = input[i * 3 + 2];
+            }
+            return result;
+        }));
+    }
+
+    dc1394error_t error_code = DC1394_SUCCESS;
+    for (QFuture<dc1394error_t> &future : futures)
+    {
+        if (future.result() != DC1394_SUCCESS)
+            error_code = future.result();
+    }
+
+    // With a vertical bayer offset the last row has no color information
+    for (uint32_t channel = 0; channel < 3 && decodeHeight < height; channel++)
+        std::fill_n(destination + channel * planeSize + decodeHeight * width, (height - decodeHeight) * width, T(0));
+
+    return error_code;
+}
+}
+
 bool FITSData::debayer_8bit()
 {
     dc1394error_t error_code;
@@ -2641,9 +3041,13 @@ bool FITSData::debayer_8bit()
     }
     // offsetX == 1 is handled in checkDebayer() and should be 0 here.
 
-    error_code = dc1394_bayer_decoding_8bit(dc1394_source, bayer_destination_buffer, stats.width, ds1394_height,
-                                            debayerParams.filter,
-                                            debayerParams.method);
+    const dc1394color_filter_t filter = debayerParams.filter;
+    const dc1394bayer_method_t method = debayerParams.method;
+    error_code = debayerBands<uint8_t>(dc1394_source, bayer_destination_buffer, stats.width, stats.height, ds1394_height,
+                                       method, [filter, method](const uint8_t *bayer, uint8_t *rgb, uint32_t sx, uint32_t sy)
+    {
+        return dc1394_bayer_decoding_8bit(bayer, rgb, sx, sy, filter, method);
+    });
 
     if (error_code != DC1394_SUCCESS)
     {
@@ -2653,39 +3057,12 @@ bool FITSData::debayer_8bit()
         return false;
     }
 
-    if (m_ImageBufferSize != rgb_size)
-    {
-        delete[] m_ImageBuffer;
-        m_ImageBuffer = new uint8_t[rgb_size];
-
-        if (m_ImageBuffer == nullptr)
-        {
-            delete[] destinationBuffer;
-            KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
-            return false;
-        }
-
-        m_ImageBufferSize = rgb_size;
-    }
-
-    auto bayered_buffer = reinterpret_cast<uint8_t *>(m_ImageBuffer);
-
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-
-    uint8_t * rBuff = bayered_buffer;
-    uint8_t * gBuff = bayered_buffer + (stats.width * stats.height);
-    uint8_t * bBuff = bayered_buffer + (stats.width * stats.height * 2);
-
-    int imax = stats.samples_per_channel * 3 - 3;
-    for (int i = 0; i <= imax; i += 3)
-    {
-        *rBuff++ = bayer_destination_buffer[i];
-        *gBuff++ = bayer_destination_buffer[i + 1];
-        *bBuff++ = bayer_destination_buffer[i + 2];
-    }
+    // The planes were written to a new buffer since the bayer data is read until the last band is done
+    clearImageBuffers();
+    m_ImageBuffer = destinationBuffer;
+    m_ImageBufferSize = rgb_size;
 
     m_Channels = (m_Mode == FITS_NORMAL) ? 3 : 1;
-    delete[] destinationBuffer;
     return true;
 }
 
@@ -2715,9 +3092,13 @@ bool FITSData::debayer_16bit()
     }
     // offsetX == 1 is handled in checkDebayer() and should be 0 here.
 
-    error_code = dc1394_bayer_decoding_16bit(dc1394_source, bayer_destination_buffer, stats.width, ds1394_height,
-                 debayerParams.filter,
-                 debayerParams.method, 16);
+    const dc1394color_filter_t filter = debayerParams.filter;
+    const dc1394bayer_method_t method = debayerParams.method;
+    error_code = debayerBands<uint16_t>(dc1394_source, bayer_destination_buffer, stats.width, stats.height, ds1394_height,
+                                        method, [filter, method](const uint16_t *bayer, uint16_t *rgb, uint32_t sx, uint32_t sy)
+    {
+        return dc1394_bayer_decoding_16bit(bayer, rgb, sx, sy, filter, method, 16);
+    });
 
     if (error_code != DC1394_SUCCESS)
     {
@@ -2727,39 +3108,12 @@ bool FITSData::debayer_16bit()
         return false;
     }
 
-    if (m_ImageBufferSize != rgb_size)
-    {
-        delete[] m_ImageBuffer;
-        m_ImageBuffer = new uint8_t[rgb_size];
-
-        if (m_ImageBuffer == nullptr)
-        {
-            delete[] destinationBuffer;
-            KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
-            return false;
-        }
-
-        m_ImageBufferSize = rgb_size;
-    }
-
-    auto bayered_buffer = reinterpret_cast<uint16_t *>(m_ImageBuffer);
-
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-
-    uint16_t * rBuff = bayered_buffer;
-    uint16_t * gBuff = bayered_buffer + (stats.width * stats.height);
-    uint16_t * bBuff = bayered_buffer + (stats.width * stats.height * 2);
-
-    int imax = stats.samples_per_channel * 3 - 3;
-    for (int i = 0; i <= imax; i += 3)
-    {
-        *rBuff++ = bayer_destination_buffer[i];
-        *gBuff++ = bayer_destination_buffer[i + 1];
-        *bBuff++ = bayer_destination_buffer[i + 2];
-    }
+    // The planes were written to a new buffer since the bayer data is read until the last band is done
+    clearImageBuffers();
+    m_ImageBuffer = destinationBuffer;
+    m_ImageBufferSize = rgb_size;
 
     m_Channels = (m_Mode == FITS_NORMAL) ? 3 : 1;
-    delete[] destinationBuffer;
     return true;
 }
 
@@ -33,10 +33,12 @@
 
 #include <fitsio.h>
 
+#include <QFile>
 #include <QFuture>
 #include <QObject>
 #include <QRect>
 #include <QVariant>
+#include <QVector>
 
 #ifndef KSTARS_LITE
 #include <kxmlguiwindow.h>
@@ -105,6 +107,8 @@ class FITSData : public QObject
             double mean[3] = {0};
             double stddev[3] = {0};
             double median[3] = {0};
+            /// Median absolute deviation from the median
+            double mad[3] = {0};
             double SNR { 0 };
             int bitpix { 8 };
             int bytesPerPixel { 1 };
@@ -113,6 +117,11 @@ class FITSData : public QObject
             uint32_t samples_per_channel { 0 };
             uint16_t width { 0 };
             uint16_t height { 0 };
+            /// Histogram of each channel. Bin i counts the samples closest to histogramMin + i * histogramBinWidth.
+            /// 8 and 16-bit integer data get one bin per value.
+            QVector<uint32_t> histogram[3];
+            double histogramMin[3] = {0};
+            double histogramBinWidth[3] = {0};
         } Statistic;
 
         /**
@@ -135,6 +144,14 @@ class FITSData : public QObject
                                 size_t fits_buffer_size, bool silent);
         /* Save FITS */
         int saveFITS(const QString &newFilename);
+        /**
+         * @brief saveImage Writes the image buffer and header records to a new FITS file. Unlike saveFITS, the data
+         * keeps its file name and does not depend on the file it was loaded from, so frames loaded from memory can be
+         * written after their buffer is gone.
+         * @param filename Path of the file to create, overwritten if it exists.
+         * @return true if the file was written.
+         */
+        bool saveImage(const QString &filename) const;
         /* Rescale image lineary from image_buffer, fit to window if desired */
         int rescale(FITSZoom type);
         /* Calculate stats */
@@ -210,6 +227,10 @@ class FITSData : public QObject
         {
             return stats.median[channel];
         }
+        double getMAD(uint8_t channel = 0) const
+        {
+            return stats.mad[channel];
+        }
 
         int getBytesPerPixel() const
         {
@@ -418,8 +439,13 @@ class FITSData : public QObject
     private:
         void loadCommon(const QString &inFilename);
         bool privateLoad(void *fits_buffer, size_t fits_buffer_size, bool silent);
+        /* Read the primary image straight from a memory mapping of the file, if the data layout allows it */
+        bool loadMappedImage(long nelements);
+        /* Decompress a tile compressed image into the image buffer, in parallel row bands when cfitsio is reentrant */
+        bool readCompressedImage(long nelements, int *status);
+        /* Replace a read-only mapped image buffer with a private copy before it gets modified */
+        void detachImageBuffer();
         void rotWCSFITS(int angle, int mirror);
-        int calculateMinMax(bool refresh = false);
         bool checkDebayer();
         void readWCSKeys();
 
@@ -438,25 +464,18 @@ class FITSData : public QObject
         template <typename T>
         void applyFilter(FITSScale type, uint8_t *targetImage, QVector<double> * min = nullptr, QVector<double> * max = nullptr);
 
+        /* Calculate min, max, mean, standard deviation, histogram, median and MAD of all channels in one pass */
         template <typename T>
-        void calculateMinMax();
+        void calculateStatistics();
 
-        template <typename T>
-        QPair<T, T> getParitionMinMax(uint32_t start, uint32_t stride);
-
-        /* Calculate the Gaussian blur matrix and apply it to the image using the convolution filter */
+        /* Calculate the 1D Gaussian blur kernel and apply it to the image using the separable convolution filter */
         QVector<double> createGaussianKernel(int size, double sigma);
+        /* Convolve the image with the kernel along rows, then along columns */
         template <typename T>
         void convolutionFilter(const QVector<double> &kernel, int kernelSize);
         template <typename T>
         void gaussianBlur(int kernelSize, double sigma);
 
-        /* Calculate running average & standard deviation using Welford’s method for computing variance */
-        template <typename T>
-        void runningAverageStdDev();
-        template <typename T>
-        QPair<double, double> getSquaredSumAndMean(uint32_t start, uint32_t stride);
-
         template <typename T>
         void convertToQImage(double dataMin, double dataMax, double scale, double zero, QImage &image);
 
@@ -474,6 +493,10 @@ class FITSData : public QObject
         uint8_t *m_ImageBuffer { nullptr };
         /// Above buffer size in bytes
         uint32_t m_ImageBufferSize { 0 };
+        /// Is the image buffer pointing into the read-only mapping of the file?
+        bool m_ImageBufferMapped { false };
+        /// File backing the image buffer when it is mapped
+        QFile m_MappedFile;
         /// Is this a temporary file or one loaded from disk?
         bool m_isTemporary { false };
         /// is this file compress (.fits.fz)?
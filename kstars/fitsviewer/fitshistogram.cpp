@@ -212,8 +212,6 @@ template <typename T> void FITSHistogram::constructHistogram()
         frequency[n].fill(0, binCount);
         cumulativeFrequency[n].fill(0, binCount);
         binWidth[n] = (FITSMax[n] - FITSMin[n]) / (binCount - 1);
-        // Initialize the median to 0 in case the computation below fails.
-        imageData->setMedian(0, n);
     }
 
     QVector<QFuture<void>> futures;
@@ -270,59 +268,7 @@ template <typename T> void FITSHistogram::constructHistogram()
     {
         futures.append(QtConcurrent::run([ = ]()
         {
-            double median[3] = {0};
             const bool cutoffSpikes = ui->hideSaturated->isChecked();
-            const uint32_t halfCumulative = cumulativeFrequency[n][binCount - 1] / 2;
-
-            // Find which bin contains the median.
-            int median_bin = -1;
-            for (int i = 0; i < binCount; i++)
-            {
-                if (cumulativeFrequency[n][i] > halfCumulative)
-                {
-                    median_bin = i;
-                    break;
-                }
-            }
-
-            if (median_bin >= 0)
-            {
-                // The number of items in the median bin
-                const uint32_t median_bin_size = frequency[n][median_bin] / sampleBy;
-                if (median_bin_size > 0)
-                {
-                    // The median is this element inside the sorted median_bin;
-                    const uint32_t samples_before_median_bin = median_bin == 0 ? 0 : cumulativeFrequency[n][median_bin - 1];
-                    uint32_t median_position = (halfCumulative - samples_before_median_bin) / sampleBy;
-
-                    if (median_position >= median_bin_size)
-                        median_position = median_bin_size - 1;
-                    if (median_position >= 0 && median_position < median_bin_size)
-                    {
-                        // Fill a vector with the values in the median bin (sampled by sampleBy).
-                        std::vector<T> median_bin_samples(median_bin_size);
-                        uint32_t upto = 0;
-                        const uint32_t offset = n * samples;
-                        for (uint32_t i = 0; i < samples; i += sampleBy)
-                        {
-                            if (upto >= median_bin_size) break;
-                            const int32_t id = rint((buffer[i + offset] - FITSMin[n]) / binWidth[n]);
-                            if (id == median_bin)
-                                median_bin_samples[upto++] = buffer[i + offset];
-                        }
-                        // Get the Nth value using N = the median position.
-                        if (upto > 0)
-                        {
-                            if (median_position >= upto) median_position = upto - 1;
-                            std::nth_element(median_bin_samples.begin(), median_bin_samples.begin() + median_position,
-                                             median_bin_samples.begin() + upto);
-                            median[n] = median_bin_samples[median_position];
-                        }
-                    }
-                }
-            }
-
-            imageData->setMedian(median[n], n);
 
             if (cutoffSpikes)
             {
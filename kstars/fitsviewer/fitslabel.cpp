@@ -26,6 +26,8 @@
 #include "indi/indilistener.h"
 #endif
 
+#include <QPainter>
+#include <QPaintEvent>
 #include <QScrollBar>
 #include <QToolTip>
 
@@ -53,6 +55,22 @@ bool FITSLabel::getMouseButtonDown()
     return mouseButtonDown;
 }
 
+/**
+Large images in the FITS viewer have no pixmap, only the tiles intersecting the exposed area are painted.
+ */
+void FITSLabel::paintEvent(QPaintEvent *e)
+{
+    if (view->tilePyramid.isEmpty() || !view->useTilePyramid())
+    {
+        QLabel::paintEvent(e);
+        return;
+    }
+
+    QPainter painter(this);
+    painter.setClipRect(e->rect());
+    view->drawTiledImage(&painter, e->rect());
+}
+
 /**
 This method was added to make the panning function work.
 If the mouse button is released, it resets mouseButtonDown variable and the mouse cursor.
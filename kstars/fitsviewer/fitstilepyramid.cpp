@@ -0,0 +1,240 @@
+/*  FITS Tile Pyramid
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "fitstilepyramid.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+
+#include <cmath>
+
+namespace
+{
+
+// Averages each 2x2 block of sourceRect into one pixel of destination, starting at offset.
+// Blocks on an odd right or bottom edge only average the pixels that exist.
+void downsample(const QImage &source, const QRect &sourceRect, QImage &destination, const QPoint &offset)
+{
+    const int width  = (sourceRect.width() + 1) / 2;
+    const int height = (sourceRect.height() + 1) / 2;
+
+    for (int y = 0; y < height; y++)
+    {
+        const int y0 = sourceRect.y() + 2 * y;
+        const int y1 = std::min(y0 + 1, sourceRect.bottom());
+
+        if (source.format() == QImage::Format_Indexed8)
+        {
+            // The color table is a linear grayscale ramp, so indices can be averaged directly.
+            const uchar *row0 = source.constScanLine(y0);
+            const uchar *row1 = source.constScanLine(y1);
+            uchar *output = destination.scanLine(offset.y() + y) + offset.x();
+
+            for (int x = 0; x < width; x++)
+            {
+                const int x0 = sourceRect.x() + 2 * x;
+                const int x1 = std::min(x0 + 1, sourceRect.right());
+                output[x] = (row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) / 4;
+            }
+        }
+        else
+        {
+            const QRgb *row0 = reinterpret_cast<const QRgb *>(source.constScanLine(y0));
+            const QRgb *row1 = reinterpret_cast<const QRgb *>(source.constScanLine(y1));
+            QRgb *output = reinterpret_cast<QRgb *>(destination.scanLine(offset.y() + y)) + offset.x();
+
+            for (int x = 0; x < width; x++)
+            {
+                const int x0 = sourceRect.x() + 2 * x;
+                const int x1 = std::min(x0 + 1, sourceRect.right());
+                const QRgb a = row0[x0], b = row0[x1], c = row1[x0], d = row1[x1];
+                output[x] = qRgb((qRed(a) + qRed(b) + qRed(c) + qRed(d) + 2) / 4,
+                                 (qGreen(a) + qGreen(b) + qGreen(c) + qGreen(d) + 2) / 4,
+                                 (qBlue(a) + qBlue(b) + qBlue(c) + qBlue(d) + 2) / 4);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+constexpr int FITSTilePyramid::TILE_SIZE;
+
+FITSTilePyramid::~FITSTilePyramid()
+{
+    stopFill();
+}
+
+void FITSTilePyramid::setImage(const QImage &image, bool prefill)
+{
+    clear();
+
+    m_Image = image;
+    if (m_Image.isNull())
+        return;
+
+    m_Levels = 1;
+    while (levelSize(m_Levels - 1).width() > TILE_SIZE || levelSize(m_Levels - 1).height() > TILE_SIZE)
+        m_Levels++;
+
+    m_Tiles.resize(m_Levels - 1);
+    for (int level = 1; level < m_Levels; level++)
+    {
+        const QSize size = levelSize(level);
+        const int columns = (size.width() + TILE_SIZE - 1) / TILE_SIZE;
+        const int rows = (size.height() + TILE_SIZE - 1) / TILE_SIZE;
+        m_Tiles[level - 1].resize(columns * rows);
+    }
+
+    if (prefill && m_Levels > 1)
+        m_Fill = QtConcurrent::run(this, &FITSTilePyramid::fill);
+}
+
+void FITSTilePyramid::clear()
+{
+    stopFill();
+
+    m_Image = QImage();
+    m_Levels = 0;
+    m_Tiles.clear();
+}
+
+void FITSTilePyramid::draw(QPainter *painter, const QRect &exposed, double scale)
+{
+    if (m_Image.isNull() || scale <= 0)
+        return;
+
+    const int level = levelForScale(scale);
+    const QSize size = levelSize(level);
+    // Widget pixels per pixel of the selected level
+    const double levelScale = scale * (1 << level);
+    const double tileExtent = TILE_SIZE * levelScale;
+
+    const int firstColumn = std::max(0, static_cast<int>(exposed.left() / tileExtent));
+    const int lastColumn  = std::min((size.width() - 1) / TILE_SIZE, static_cast<int>(exposed.right() / tileExtent));
+    const int firstRow    = std::max(0, static_cast<int>(exposed.top() / tileExtent));
+    const int lastRow     = std::min((size.height() - 1) / TILE_SIZE, static_cast<int>(exposed.bottom() / tileExtent));
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    for (int row = firstRow; row <= lastRow; row++)
+    {
+        for (int column = firstColumn; column <= lastColumn; column++)
+        {
+            const QRect source = QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(QRect(QPoint(0, 0),
+                                 size));
+            // Round both edges so neighbouring tiles share them exactly and no seams show up.
+            const QRect target(QPoint(std::lround(source.left() * levelScale), std::lround(source.top() * levelScale)),
+                               QPoint(std::lround((source.right() + 1) * levelScale) - 1,
+                                      std::lround((source.bottom() + 1) * levelScale) - 1));
+
+            if (level == 0)
+                painter->drawImage(target, m_Image, source);
+            else
+                painter->drawImage(target, tile(level, column, row));
+        }
+    }
+}
+
+int FITSTilePyramid::levelForScale(double scale) const
+{
+    // Use the coarsest level that still has at least as many pixels as the display needs
+    if (scale >= 1)
+        return 0;
+    return std::min(m_Levels - 1, static_cast<int>(std::floor(std::log2(1.0 / scale))));
+}
+
+QSize FITSTilePyramid::levelSize(int level) const
+{
+    const int divisor = 1 << level;
+    return QSize((m_Image.width() + divisor - 1) / divisor, (m_Image.height() + divisor - 1) / divisor);
+}
+
+QImage FITSTilePyramid::tile(int level, int x, int y)
+{
+    const int columns = (levelSize(level).width() + TILE_SIZE - 1) / TILE_SIZE;
+    const int index = y * columns + x;
+
+    {
+        QMutexLocker locker(&m_TilesMutex);
+        const QImage &cached = m_Tiles[level - 1][index];
+        if (!cached.isNull())
+            return cached;
+    }
+
+    // Building happens outside the lock; if the painter and the fill thread race for the same tile,
+    // both results are identical and the second one simply replaces the first.
+    QImage built = buildTile(level, x, y);
+
+    QMutexLocker locker(&m_TilesMutex);
+    m_Tiles[level - 1][index] = built;
+    return built;
+}
+
+QImage FITSTilePyramid::buildTile(int level, int x, int y)
+{
+    const QSize size = levelSize(level);
+    const QSize childSize = levelSize(level - 1);
+
+    QImage result(std::min(TILE_SIZE, size.width() - x * TILE_SIZE), std::min(TILE_SIZE, size.height() - y * TILE_SIZE),
+                  m_Image.format());
+    if (m_Image.format() == QImage::Format_Indexed8)
+        result.setColorTable(m_Image.colorTable());
+
+    for (int j = 0; j < 2; j++)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            const int childX = 2 * x + i;
+            const int childY = 2 * y + j;
+            if (childX * TILE_SIZE >= childSize.width() || childY * TILE_SIZE >= childSize.height())
+                continue;
+
+            const QPoint offset(i * TILE_SIZE / 2, j * TILE_SIZE / 2);
+            if (level == 1)
+            {
+                const QRect childRect = QRect(childX * TILE_SIZE, childY * TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(m_Image.rect());
+                downsample(m_Image, childRect, result, offset);
+            }
+            else
+            {
+                const QImage child = tile(level - 1, childX, childY);
+                downsample(child, child.rect(), result, offset);
+            }
+        }
+    }
+
+    return result;
+}
+
+void FITSTilePyramid::fill()
+{
+    for (int level = 1; level < m_Levels; level++)
+    {
+        const QSize size = levelSize(level);
+        const int columns = (size.width() + TILE_SIZE - 1) / TILE_SIZE;
+        const int rows = (size.height() + TILE_SIZE - 1) / TILE_SIZE;
+
+        for (int y = 0; y < rows; y++)
+        {
+            for (int x = 0; x < columns; x++)
+            {
+                if (m_StopFill)
+                    return;
+                tile(level, x, y);
+            }
+        }
+    }
+}
+
+void FITSTilePyramid::stopFill()
+{
+    m_StopFill = true;
+    m_Fill.waitForFinished();
+    m_StopFill = false;
+}
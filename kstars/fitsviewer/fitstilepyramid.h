@@ -0,0 +1,73 @@
+/*  FITS Tile Pyramid
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QFuture>
+#include <QImage>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+
+class QPainter;
+
+/**
+ * @class FITSTilePyramid
+ * Multi-resolution cache of a stretched display image. Level 0 is the full resolution image and every
+ * following level halves both dimensions. Each level is split into TILE_SIZE x TILE_SIZE tiles that are
+ * built on demand from the four tiles of the level below, so drawing a zoomed out view only touches
+ * the tiles that are visible at the closest matching resolution.
+ */
+class FITSTilePyramid
+{
+    public:
+        static constexpr int TILE_SIZE = 256;
+
+        FITSTilePyramid() = default;
+        ~FITSTilePyramid();
+
+        /**
+         * @brief setImage Replace the image of the pyramid and drop all cached tiles.
+         * @param image Stretched full resolution image, either Indexed8 grayscale or RGB32.
+         * @param prefill If set, coarser levels are filled in the background.
+         */
+        void setImage(const QImage &image, bool prefill = true);
+
+        /** Release the image and all cached tiles. */
+        void clear();
+
+        bool isEmpty() const
+        {
+            return m_Image.isNull();
+        }
+
+        /**
+         * @brief draw Paint the part of the image that falls in the exposed rectangle.
+         * @param painter Painter of the widget displaying the image.
+         * @param exposed Widget area to repaint.
+         * @param scale Ratio of widget pixels to full resolution image pixels.
+         */
+        void draw(QPainter *painter, const QRect &exposed, double scale);
+
+    private:
+        int levelForScale(double scale) const;
+        QSize levelSize(int level) const;
+        QImage tile(int level, int x, int y);
+        QImage buildTile(int level, int x, int y);
+        void fill();
+        void stopFill();
+
+        QImage m_Image;
+        int m_Levels { 0 };
+        // Cached tiles of levels 1 and up, indexed by level - 1 then by row-major tile index
+        QVector<QVector<QImage>> m_Tiles;
+        QMutex m_TilesMutex;
+        QFuture<void> m_Fill;
+        std::atomic<bool> m_StopFill { false };
+};
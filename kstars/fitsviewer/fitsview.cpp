@@ -582,9 +582,13 @@ bool FITSView::rescale(FITSZoom type)
             break;
     }
 
+    // Release the tiles of the previous image before allocating the new one
+    tilePyramid.clear();
     initDisplayImage();
     image_frame->setScaledContents(true);
     doStretch(imageData, &rawImage);
+    if (useTilePyramid())
+        tilePyramid.setImage(rawImage, !Options::limitedResourcesMode());
     setWidget(image_frame.get());
 
     // This is needed by fitstab, even if the zoom doesn't change, to change the stretch UI.
@@ -675,6 +679,14 @@ bool FITSView::isLargeImage()
     return rawImage.width() * rawImage.height() >= largeImageNumPixels;
 }
 
+// useTilePyramid() returns whether large images are displayed from the tile pyramid. The viewer then
+// paints only the visible tiles at the closest resolution instead of converting and scaling the full
+// image on every zoom. Ekos views keep the pixmap as it is also streamed and grabbed from.
+bool FITSView::useTilePyramid()
+{
+    return mode == FITS_NORMAL && isLargeImage();
+}
+
 // getScale() is related to the image and overlay rendering strategy used.
 // If we're using a pixmap apprpriate for a large image, where we draw and render on a pixmap that's the image size
 // and we let the QLabel deal with scaling and zooming, then the scale is 1.0.
@@ -704,7 +716,9 @@ void FITSView::updateFrame()
     // and whether we need to therefore conserve memory. The small-image strategy explicitly scales up
     // the image, and writes overlays on the scaled pixmap. The large-image strategy uses a pixmap that's
     // the size of the image itself, never scaling that up.
-    if (isLargeImage())
+    if (useTilePyramid())
+        updateFrameTiledImage();
+    else if (isLargeImage())
         updateFrameLargeImage();
     else
         updateFrameSmallImage();
@@ -751,6 +765,33 @@ void FITSView::updateFrameSmallImage()
     image_frame->resize(currentWidth, currentHeight);
 }
 
+void FITSView::updateFrameTiledImage()
+{
+    // Nothing is rendered here, FITSLabel::paintEvent() draws the exposed tiles and overlays.
+    displayPixmap = QPixmap();
+    image_frame->clear();
+    image_frame->resize(((sampling * currentZoom) / 100.0) * rawImage.size());
+    image_frame->update();
+}
+
+void FITSView::drawTiledImage(QPainter *painter, const QRect &exposed)
+{
+    const double scale = (sampling * currentZoom) / ZOOM_DEFAULT;
+    tilePyramid.draw(painter, exposed, scale);
+
+    if (sampling == 1)
+    {
+        // Same as the large-image strategy, overlays are drawn in full image coordinates.
+        painter->scale(scale, scale);
+        QFont font = painter->font();
+        font.setPixelSize(scaleSize(FONT_SIZE));
+        painter->setFont(font);
+
+        drawOverlay(painter, 1.0);
+        drawStarFilter(painter, 1.0);
+    }
+}
+
 void FITSView::drawStarFilter(QPainter *painter, double scale)
 {
     if (!starFilter.used())
@@ -13,6 +13,7 @@
 #include "fitscommon.h"
 
 #include <config-kstars.h>
+#include "fitstilepyramid.h"
 #include "stretch.h"
 
 #ifdef HAVE_DATAVISUALIZATION
@@ -297,8 +298,11 @@ class FITSView : public QScrollArea
         void doStretch(FITSData *data, QImage *outputImage);
         double scaleSize(double size);
         bool isLargeImage();
+        bool useTilePyramid();
         void updateFrameLargeImage();
         void updateFrameSmallImage();
+        void updateFrameTiledImage();
+        void drawTiledImage(QPainter *painter, const QRect &exposed);
         bool drawHFR(QPainter * painter, const QString & hfr, int x, int y);
 
 
@@ -318,6 +322,8 @@ class FITSView : public QScrollArea
 
         // Original full-size image
         QImage rawImage;
+        // Downsampled tiles of rawImage, used to display large images in the FITS viewer
+        FITSTilePyramid tilePyramid;
         // Actual pixmap after all the overlays
         QPixmap displayPixmap;
 
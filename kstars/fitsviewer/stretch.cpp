@@ -12,6 +12,9 @@
 #include <math.h>
 #include <QtConcurrent>
 
+#include <limits>
+#include <type_traits>
+
 namespace {
 
 // Returns the median value of the vector.
@@ -47,6 +50,29 @@ T median(T const *values, int size, int sampleBy)
   return median(samples);
 }
 
+// Splits the output rows into contiguous bands, one per pool thread, and calls
+// rowFunction(outputRow) for every row of every band.
+// Uses multiple threads, blocks until done.
+template <typename F>
+void runInBands(int outputHeight, const F &rowFunction)
+{
+  const int nThreads = std::max(1, std::min(QThreadPool::globalInstance()->maxThreadCount(), outputHeight));
+  const int rowsPerBand = (outputHeight + nThreads - 1) / nThreads;
+
+  QVector<QFuture<void>> futures;
+  for (int start = 0; start < outputHeight; start += rowsPerBand)
+  {
+    const int end = std::min(outputHeight, start + rowsPerBand);
+    futures.append(QtConcurrent::run([ =, &rowFunction]()
+    {
+      for (int jout = start; jout < end; jout++)
+        rowFunction(jout);
+    }));
+  }
+  for(QFuture<void> future : futures)
+    future.waitForFinished();
+}
+
 // This stretches one channel given the input parameters.
 // Based on the spec in section 8.5.6
 // https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
@@ -59,8 +85,6 @@ void stretchOneChannel(T *input_buffer, QImage *output_image,
                        const StretchParams& stretch_params, 
                        int input_range, int image_height, int image_width, int sampling)
 {
-  QVector<QFuture<void>> futures;
-
   // We're outputting uint8, so the max output is 255.
   constexpr int maxOutput = 255;
 
@@ -81,13 +105,16 @@ void stretchOneChannel(T *input_buffer, QImage *output_image,
   const float k1 = (midtones - 1) * hsRangeFactor * maxOutput / maxInput;
   const float k2 = ((2 * midtones) - 1) * hsRangeFactor / maxInput;
   
+  uchar * outputBits = output_image->bits();
+  const int bytesPerLine = output_image->bytesPerLine();
+  const int outputHeight = (image_height + sampling - 1) / sampling;
+
   // Increment the input index by the sampling, the output index increments by 1.
-  for (int j = 0, jout = 0; j < image_height; j+=sampling, jout++)
+  runInBands(outputHeight, [ = ](int jout)
   {
-    futures.append(QtConcurrent::run([ = ]()
-    {
+        const int j = jout * sampling;
         T * inputLine  = input_buffer + j * image_width;
-        auto * scanLine = output_image->scanLine(jout);
+        auto * scanLine = outputBits + jout * bytesPerLine;
         
     for (int i = 0, iout = 0; i < image_width; i+=sampling, iout++)
         {
@@ -100,10 +127,7 @@ void stretchOneChannel(T *input_buffer, QImage *output_image,
             scanLine[iout] = (inputFloored * k1) / (inputFloored * k2 - midtones);
 	  }
         }
-    }));
-  }
-  for(QFuture<void> future : futures)
-    future.waitForFinished();
+  });
 }
 
 // This is like the above 1-channel stretch, but extended for 3 channels.
@@ -118,8 +142,6 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
                           const StretchParams& stretchParams, 
                           int inputRange, int imageHeight, int imageWidth, int sampling)
 {
-  QVector<QFuture<void>> futures;
-
   // We're outputting uint8, so the max output is 255.
   constexpr int maxOutput = 255;
 
@@ -157,17 +179,20 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
   const float k2B = ((2 * midtonesB) - 1) * hsRangeFactorB / maxInput;
   
   const int size = imageWidth * imageHeight;
+
+  uchar * outputBits = outputImage->bits();
+  const int bytesPerLine = outputImage->bytesPerLine();
+  const int outputHeight = (imageHeight + sampling - 1) / sampling;
   
-  for (int j = 0, jout = 0; j < imageHeight; j+=sampling, jout++)
+  runInBands(outputHeight, [ = ](int jout)
   {
-    futures.append(QtConcurrent::run([ = ]()
-    {
+        const int j = jout * sampling;
         // R, G, B input images are stored one after another.
         T * inputLineR  = inputBuffer + j * imageWidth;
         T * inputLineG  = inputLineR + size;
         T * inputLineB  = inputLineG + size;
         
-        auto * scanLine = reinterpret_cast<QRgb*>(outputImage->scanLine(jout));
+        auto * scanLine = reinterpret_cast<QRgb*>(outputBits + jout * bytesPerLine);
         
     for (int i = 0, iout = 0; i < imageWidth; i+=sampling, iout++)
         {
@@ -202,10 +227,7 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
 	  }
           scanLine[iout] = qRgb(red, green, blue);
         }
-    }));
-  }
-  for(QFuture<void> future : futures)
-    future.waitForFinished();
+  });
 }
 
 template <typename T>
@@ -220,6 +242,107 @@ void stretchChannels(T *input_buffer, QImage *output_image,
       stretchThreeChannels(input_buffer, output_image, stretch_params, input_range,
                            image_height, image_width, sampling);
 }
+
+// Fills lut with the stretched output of every possible value of an 8 or 16-bit
+// input type. The table is indexed by the unsigned bit pattern of the input, and the
+// values are computed with exactly the same expression as stretchOneChannel().
+template <typename T>
+void computeLUT(const StretchParams1Channel &params, int inputRange, std::vector<uint8_t> *lut)
+{
+  typedef typename std::make_unsigned<T>::type UT;
+  constexpr int lutSize = std::numeric_limits<UT>::max() + 1;
+
+  // We're outputting uint8, so the max output is 255.
+  constexpr int maxOutput = 255;
+  const float maxInput = inputRange > 1 ? inputRange - 1 : inputRange;
+
+  const float hsRangeFactor = params.highlights == params.shadows ? 1.0f : 1.0f / (params.highlights - params.shadows);
+  const T nativeShadows = params.shadows * maxInput;
+  const T nativeHighlights = params.highlights * maxInput;
+  const float k1 = (params.midtones - 1) * hsRangeFactor * maxOutput / maxInput;
+  const float k2 = ((2 * params.midtones) - 1) * hsRangeFactor / maxInput;
+
+  lut->resize(lutSize);
+  uint8_t * table = lut->data();
+  for (int index = 0; index < lutSize; index++)
+  {
+    const T input = static_cast<T>(static_cast<UT>(index));
+    if (input < nativeShadows) table[index] = 0;
+    else if (input >= nativeHighlights) table[index] = maxOutput;
+    else
+    {
+      const T inputFloored = (input - nativeShadows);
+      table[index] = (inputFloored * k1) / (inputFloored * k2 - params.midtones);
+    }
+  }
+}
+
+// Lookup-table version of stretchOneChannel()/stretchThreeChannels() for 8 and 16-bit data.
+// The per-pixel float math is replaced by one table read per sample. The tables are at most
+// 64KB per channel, so they stay cache resident while the rows of a band are streamed through.
+// Uses multiple threads, blocks until done.
+template <typename T>
+void stretchChannelsLUT(T const *input_buffer, QImage *output_image,
+                        const StretchParams& stretch_params,
+                        int input_range, int image_height, int image_width, int num_channels, int sampling)
+{
+  typedef typename std::make_unsigned<T>::type UT;
+
+  if (num_channels != 1 && num_channels != 3)
+    return;
+
+  std::vector<uint8_t> lutR, lutG, lutB;
+  computeLUT<T>(stretch_params.grey_red, input_range, &lutR);
+  if (num_channels == 3)
+  {
+    computeLUT<T>(stretch_params.green, input_range, &lutG);
+    computeLUT<T>(stretch_params.blue, input_range, &lutB);
+  }
+  const uint8_t * tableR = lutR.data();
+  const uint8_t * tableG = lutG.data();
+  const uint8_t * tableB = lutB.data();
+
+  const UT * input = reinterpret_cast<UT const *>(input_buffer);
+  const int size = image_width * image_height;
+  uchar * outputBits = output_image->bits();
+  const int bytesPerLine = output_image->bytesPerLine();
+  const int outputHeight = (image_height + sampling - 1) / sampling;
+  const int outputWidth = (image_width + sampling - 1) / sampling;
+
+  if (num_channels == 1)
+  {
+    runInBands(outputHeight, [ = ](int jout)
+    {
+      const UT * inputLine = input + jout * sampling * image_width;
+      uint8_t * scanLine = outputBits + jout * bytesPerLine;
+
+      if (sampling == 1)
+      {
+        for (int i = 0; i < image_width; i++)
+          scanLine[i] = tableR[inputLine[i]];
+      }
+      else
+      {
+        for (int i = 0, iout = 0; iout < outputWidth; i += sampling, iout++)
+          scanLine[iout] = tableR[inputLine[i]];
+      }
+    });
+  }
+  else
+  {
+    runInBands(outputHeight, [ = ](int jout)
+    {
+      // R, G, B input images are stored one after another.
+      const UT * inputLineR = input + jout * sampling * image_width;
+      const UT * inputLineG = inputLineR + size;
+      const UT * inputLineB = inputLineG + size;
+      auto * scanLine = reinterpret_cast<QRgb*>(outputBits + jout * bytesPerLine);
+
+      for (int i = 0, iout = 0; iout < outputWidth; i += sampling, iout++)
+        scanLine[iout] = 0xff000000u | (tableR[inputLineR[i]] << 16) | (tableG[inputLineG[i]] << 8) | tableB[inputLineB[i]];
+    });
+  }
+}
   
 // See section 8.5.7 in above link  https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
 template <typename T>
@@ -324,17 +447,18 @@ void Stretch::run(uint8_t const *input, QImage *outputImage, int sampling)
 
     switch (dataType)
     {
+        // 8 and 16-bit data are stretched through lookup tables.
         case TBYTE:
-            stretchChannels(reinterpret_cast<uint8_t const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+            stretchChannelsLUT(reinterpret_cast<uint8_t const*>(input), outputImage, params,
+                               input_range, image_height, image_width, image_channels, sampling);
             break;
         case TSHORT:
-            stretchChannels(reinterpret_cast<short const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+            stretchChannelsLUT(reinterpret_cast<short const*>(input), outputImage, params,
+                               input_range, image_height, image_width, image_channels, sampling);
             break;
         case TUSHORT:
-            stretchChannels(reinterpret_cast<unsigned short const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+            stretchChannelsLUT(reinterpret_cast<unsigned short const*>(input), outputImage, params,
+                               input_range, image_height, image_width, image_channels, sampling);
             break;
         case TLONG:
             stretchChannels(reinterpret_cast<long const*>(input), outputImage, params,
@@ -21,12 +21,29 @@
 #include "hipsrenderer.h"
 
 #include "colorscheme.h"
+#include "ksutils.h"
 #include "kstars_debug.h"
 #include "Options.h"
 #include "skymap.h"
 #include "skyqpainter.h"
 #include "projections/projector.h"
 
+namespace
+{
+// Projects the corners of a HEALPix pixel in a single batch
+void projectCorners(const Projector *projector, const SkyPoint *corners, int count, QPointF *screen)
+{
+  const SkyPoint *points[4];
+  Vector2f projected[4];
+
+  for (int i = 0; i < count; i++)
+      points[i] = &corners[i];
+  projector->projectBatch(points, count, projected);
+  for (int i = 0; i < count; i++)
+      screen[i] = KSUtils::vecToPoint(projected[i]);
+}
+}
+
 HIPSRenderer::HIPSRenderer()
 {
     m_scanRender.reset(new ScanRender());
@@ -94,8 +111,7 @@ bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Proje
   //qCDebug(KSTARS) << "#" << i+1 << "X" << tileLine[i].x();
   //qCDebug(KSTARS) << "#" << i+1 << "Y" << tileLine[i].y();
 
-  for (int i=0; i < 2; i++)
-      tileLine[i] = m_projector->toScreen(&cornerSkyCoords[i]);
+  projectCorners(m_projector, cornerSkyCoords, 2, tileLine);
 
   int size = std::sqrt(std::pow(tileLine[0].x()-tileLine[1].x(), 2) + std::pow(tileLine[0].y()-tileLine[1].y(), 2));
   if (size < 0)
@@ -142,11 +158,9 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
   m_HEALpix->getCornerPoints(level, pix, cornerSkyCoords);
   bool isVisible = false;
 
+  projectCorners(m_projector, cornerSkyCoords, 4, cornerScreenCoords);
   for (int i=0; i < 4; i++)
-  {
-      cornerScreenCoords[i] = m_projector->toScreen(&cornerSkyCoords[i]);
       isVisible |= m_projector->checkVisibility(&cornerSkyCoords[i]);
-  }  
 
   //if (SKPLANECheckFrustumToPolygon(trfGetFrustum(), pts, 4))
   // Is the right way to do this?
@@ -225,8 +239,7 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
           SkyPoint fineSkyPoints[4];
           m_HEALpix->getCornerPoints(level + 2, id2, fineSkyPoints);
 
-          for (int i = 0; i < 4; i++)
-              fineScreenCoords[i] = m_projector->toScreen(&fineSkyPoints[i]);
+          projectCorners(m_projector, fineSkyPoints, 4, fineScreenCoords);
           m_scanRender->renderPolygon(3, fineScreenCoords, pDest, image, uv[j]);
           j++;
         }
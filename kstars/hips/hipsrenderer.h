@@ -37,6 +37,8 @@ public:
   bool render(uint16_t w, uint16_t h, QImage *hipsImage, const Projector *m_proj);
   void renderRec(bool allsky, int level, int pix, QImage *pDest);
   bool renderPix(bool allsky, int level, int pix, QImage *pDest);
+  /** @return false if some visible tiles of the last render were not available yet */
+  bool isComplete() const { return m_rendered >= m_blocks; }
 
 signals:
 
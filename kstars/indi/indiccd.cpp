@@ -29,10 +29,13 @@
 #include <KNotifications/KNotification>
 #include <QImageReader>
 #include <QStatusBar>
+#include <QUuid>
 #include <QtConcurrent>
 
 #include <basedevice.h>
 
+#include <chrono>
+
 const QStringList RAWFormats = { "cr2", "cr3", "crw", "nef", "raf", "dng", "arw" };
 
 namespace
@@ -128,6 +131,30 @@ bool writeTempImageFile(const QString &format, char * buffer, size_t size, QStri
     *filename = tmpFile.fileName();
     return true;
 }
+
+// Internal function to generate a temporary image file name without touching the disk.
+// FITS frames are loaded directly from the BLOB buffer, so the file is only created if the
+// frame is persisted afterwards.
+QString tempImageFilename(const QString &format)
+{
+    return QDir::tempPath() + QString("/fits%1%2").arg(QUuid::createUuid().toString().remove(
+                QRegularExpression("[-{}]")), format);
+}
+
+// Focus and guide frames stay in memory, Focus and Guide only write them with FITSData::saveImage
+// when they are opened in the FITS viewer. All other modes hand the file name to consumers
+// that read it back from disk (solver, dark library, FITS viewer tabs).
+bool requiresTempImageFile(FITSMode mode)
+{
+    return (mode != FITS_FOCUS && mode != FITS_GUIDE);
+}
+
+// Microseconds on the monotonic clock the guide loop latency is measured with, see GuideLatency
+qint64 latencyTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 }
 
 namespace ISD
@@ -1539,6 +1566,8 @@ void CCD::processBLOB(IBLOB *bp)
     if (bp->bvp->p == IP_WO || bp->size == 0)
         return;
 
+    const qint64 receivedTimestamp = latencyTimestamp();
+
     BType = BLOB_OTHER;
 
     QString format = QString(bp->format).toLower();
@@ -1580,17 +1609,31 @@ void CCD::processBLOB(IBLOB *bp)
     // Create temporary name if ANY of the following conditions are met:
     // 1. file is preview or batch mode is not enabled
     // 2. file type is not FITS_NORMAL (focus, guide..etc)
+    // FITS data is ingested straight from the BLOB buffer. If the temporary file is needed, it is
+    // written in the background while the frame is being loaded.
     QString filename;
+    QFuture<bool> tempFileWriteThread;
+    bool tempFileWriteStarted = false;
+    bool fileWritten = true;
     if (targetChip->isBatchMode() == false || targetChip->getCaptureMode() != FITS_NORMAL)
     {
-        if (!writeTempImageFile(format, static_cast<char *>(bp->blob), bp->size, &filename))
+        if (BType == BLOB_FITS)
+        {
+            filename = tempImageFilename(format);
+            if (requiresTempImageFile(targetChip->getCaptureMode()))
+            {
+                tempFileWriteThread = QtConcurrent::run(WriteImageFileInternal, filename,
+                                                        static_cast<char *>(bp->blob), static_cast<size_t>(bp->size), true, filter);
+                tempFileWriteStarted = true;
+            }
+            else
+                fileWritten = false;
+        }
+        else if (!writeTempImageFile(format, static_cast<char *>(bp->blob), bp->size, &filename))
         {
             emit BLOBUpdated(nullptr);
             return;
         }
-        if (BType == BLOB_FITS)
-            addFITSKeywords(filename, filter);
-
     }
     // Create file name for others
     else
@@ -1603,8 +1646,8 @@ void CCD::processBLOB(IBLOB *bp)
         }
     }
 
-    // store file name
-    strncpy(BLOBFilename, filename.toLatin1(), MAXINDIFILENAME);
+    // store file name, left empty for focus and guide frames which are never written to disk
+    strncpy(BLOBFilename, fileWritten ? filename.toLatin1().constData() : "", MAXINDIFILENAME);
     bp->aux0 = targetChip;
     bp->aux1 = &BType;
     bp->aux2 = BLOBFilename;
@@ -1707,12 +1750,27 @@ void CCD::processBLOB(IBLOB *bp)
         if ((targetChip->getCaptureMode() == FITS_NORMAL || targetChip->getCaptureMode() == FITS_CALIBRATE) &&
                 (!Options::useFITSViewer() && targetChip->isBatchMode()))
         {
+            if (tempFileWriteStarted && tempFileWriteThread.result() == false)
+            {
+                qCWarning(KSTARS_INDI) << "ISD:CCD failed to write temporary file" << filename;
+                BLOBFilename[0] = '\0';
+            }
             emit BLOBUpdated(bp);
             return;
         }
         FITSData *blob_fits_data = new FITSData(targetChip->getCaptureMode());
 
-        if (!blob_fits_data->loadFITSFromMemory(filename, bp->blob, bp->size, false))
+        bool loaded = blob_fits_data->loadFITSFromMemory(filename, bp->blob, bp->size, false);
+
+        // Consumers read the file back as soon as they are notified, so it must be complete by then.
+        // The writer also reads from the BLOB buffer which is only valid until we return.
+        if (tempFileWriteStarted && tempFileWriteThread.result() == false)
+        {
+            qCWarning(KSTARS_INDI) << "ISD:CCD failed to write temporary file" << filename;
+            BLOBFilename[0] = '\0';
+        }
+
+        if (!loaded)
         {
             // If reading the blob fails, we treat it the same as exposure failure
             // and recapture again if possible
@@ -1722,6 +1780,13 @@ void CCD::processBLOB(IBLOB *bp)
             return;
         }
 
+        // The guider measures its loop from these
+        if (targetChip->getCaptureMode() == FITS_GUIDE)
+        {
+            blob_fits_data->setProperty("blobReceived", receivedTimestamp);
+            blob_fits_data->setProperty("fitsLoaded", latencyTimestamp());
+        }
+
         displayFits(targetChip, filename, bp, blob_fits_data);
     }
     else
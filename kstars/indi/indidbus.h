@@ -165,7 +165,7 @@ class INDIDBus : public QObject
         * @param blobName blob element name
         * @param blobFormat blob element format. It is usually the extension of a file.
         * @param size blob element size in bytes. If -1, then there is an error.
-        * @returns full file name
+        * @returns full file name, empty if the blob was not stored, as focus and guide frames are not.
         */
     Q_SCRIPTABLE QString getBLOBFile(const QString &device, const QString &property, const QString &blobName,
                                      QString &blobFormat, int &size);
@@ -16,6 +16,7 @@
 #include "Options.h"
 #include "skymap.h"
 #include "skymapcomposite.h"
+#include "starcomponent.h"
 #include "ksnotification.h"
 
 #include <KActionCollection>
@@ -790,6 +791,15 @@ bool Telescope::sendCoords(SkyPoint *ScopeTarget)
         DecEle->value = de.Degrees();
         clientManager->sendNewNumber(EqProp);
 
+        // Start loading the stars around the target, the sky map follows the mount there
+        if (StarComponent::Instance())
+        {
+            SkyPoint target(ra, de);
+            if (useJ2000)
+                target.apparentCoord(static_cast<long double>(J2000), KStars::Instance()->data()->ut().djd());
+            StarComponent::Instance()->setPrefetchTarget(target);
+        }
+
         qCDebug(KSTARS_INDI) << "ISD:Telescope sending coords RA:" << ra.toHMSString() <<
                              "(" << RAEle->value << ") DE:" << de.toDMSString() <<
                              "(" << DecEle->value << ")";
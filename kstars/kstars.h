@@ -437,6 +437,32 @@ class KStars : public KXmlGuiWindow
              */
         Q_SCRIPTABLE QString getObjectDataXML(const QString &objectName);
 
+        /** DBUS interface function.  Return a newline-separated list of the names of sky objects starting with prefix.
+             * @param prefix start of the names, matched ignoring case.
+             * @param limit maximum number of names returned, or -1 for all of them.
+             * @note Names are sorted ignoring case, an object can appear under its primary and its long name.
+             */
+        Q_SCRIPTABLE QString findObjectNames(const QString &prefix, int limit);
+
+        /** DBUS interface function.  Start or stop recording the time spent in each component of the sky map.
+             * @param enabled true to record a profile of every frame drawn from now on.
+             * @note Profiling also runs while the profile is shown on the sky map.
+             */
+        Q_SCRIPTABLE Q_NOREPLY void setFrameProfiling(bool enabled);
+
+        /** DBUS interface function.  Return JSON describing the last frames drawn while profiling.
+             * @param frames number of frames, or -1 for all frames kept.
+             * @note Each frame lists, per component, update and draw times in milliseconds, objects drawn,
+             * trig functions computed and cache hits and misses.
+             */
+        Q_SCRIPTABLE QString getFrameProfile(int frames);
+
+        /** DBUS interface function.  Save the JSON of all frames kept by the profiler to a file.
+             * @param filename path of the file to write.
+             * @return true if the file was written.
+             */
+        Q_SCRIPTABLE bool exportFrameProfile(const QString &filename);
+
         /** DBUS interface function.  Return XML containing position info about a sky object
              * @param objectName name of the object.
              * @note If the object was not found, the XML is empty.
@@ -29,6 +29,7 @@
 #include "skymap.h"
 #include "skycomponents/constellationboundarylines.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skymapprofiler.h"
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skyobjects/starobject.h"
@@ -46,6 +47,7 @@
 #include <QPrintDialog>
 #include <QPrinter>
 #include <QElapsedTimer>
+#include <QJsonDocument>
 
 #include "kstars_debug.h"
 
@@ -790,6 +792,41 @@ QString KStars::getObjectDataXML(const QString &objectName)
     return output;
 }
 
+QString KStars::findObjectNames(const QString &prefix, int limit)
+{
+    Q_ASSERT(data());
+    QString output;
+
+    for (const auto &name : data()->skyComposite()->findByNamePrefix(prefix, QList<int>(), limit))
+    {
+        output.append(name.first + '\n');
+    }
+    return output;
+}
+
+void KStars::setFrameProfiling(bool enabled)
+{
+    SkyMapProfiler::Instance()->setEnabled(enabled);
+}
+
+QString KStars::getFrameProfile(int frames)
+{
+    return QJsonDocument(SkyMapProfiler::Instance()->toJson(frames)).toJson(QJsonDocument::Compact);
+}
+
+bool KStars::exportFrameProfile(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCWarning(KSTARS) << "Cannot write the frame profile to" << filename << ":" << file.errorString();
+        return false;
+    }
+
+    file.write(QJsonDocument(SkyMapProfiler::Instance()->toJson()).toJson());
+    return true;
+}
+
 QString KStars::getObjectPositionInfo(const QString &objectName)
 {
     Q_ASSERT(data());
@@ -71,6 +71,28 @@ Vector2f EquirectangularProjector::toScreenVec(const SkyPoint *o, bool oRefract,
     return p;
 }
 
+void EquirectangularProjector::projectBatch(const double *longitude, const double *latitude, int count,
+        Vector2f *screen, bool *visible) const
+{
+    const double focusLongitude = m_vp.useAltAz ? m_vp.focus->az().radians() : m_vp.focus->ra().radians();
+    const double focusLatitude  = m_vp.useAltAz ? m_vp.focus->alt().radians() : m_vp.focus->dec().radians();
+    // For horizontal coordinates the offset is taken from the point to the focus, see toScreenVec()
+    const double sign  = m_vp.useAltAz ? -1 : 1;
+    const double origX = 0.5 * m_vp.width;
+    const double origY = 0.5 * m_vp.height;
+    const double zoom  = m_vp.zoomFactor;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const double dX = KSUtils::reduceAngle(sign * (longitude[i] - focusLongitude), -dms::PI, dms::PI);
+        const double x  = origX - zoom * dX;
+
+        screen[i] = Vector2f(x, origY - zoom * (latitude[i] - focusLatitude));
+        if (visible)
+            visible[i] = (x > 0 && x < m_vp.width);
+    }
+}
+
 SkyPoint EquirectangularProjector::fromScreen(const QPointF &p, dms *LST, const dms *lat) const
 {
     SkyPoint result;
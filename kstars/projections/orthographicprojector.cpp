@@ -40,6 +40,12 @@ double OrthographicProjector::projectionK(double x) const
     return 1.0;
 }
 
+void OrthographicProjector::projectionKBatch(double *c, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        c[i] = 1.0;
+}
+
 double OrthographicProjector::projectionL(double x) const
 {
     return asin(x);
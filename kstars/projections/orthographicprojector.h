@@ -35,6 +35,7 @@ class OrthographicProjector : public Projector
     Projection type() const override;
     double radius() const override;
     double projectionK(double x) const override;
+    void projectionKBatch(double *c, int count) const override;
     double projectionL(double x) const override;
 };
 
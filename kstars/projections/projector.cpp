@@ -25,8 +25,13 @@
 #endif
 #include "skycomponents/skylabeler.h"
 
+#include <algorithm>
+
 namespace
 {
+// Points are projected in chunks of this size, so that the intermediate values stay on the stack
+constexpr int projectionBatchSize = 256;
+
 void toXYZ(const SkyPoint *p, double *x, double *y, double *z)
 {
     double sinRa, sinDec, cosRa, cosDec;
@@ -558,3 +563,108 @@ Vector2f Projector::toScreenVec(const SkyPoint *o, bool oRefract, bool *onVisibl
 #endif
     return Vector2f(x, y);
 }
+
+void Projector::projectionKBatch(double *c, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        c[i] = projectionK(c[i]);
+}
+
+void Projector::projectBatch(const double *longitude, const double *latitude, int count, Vector2f *screen,
+                             bool *visible) const
+{
+    const double focusLongitude = m_vp.useAltAz ? m_vp.focus->az().radians() : m_vp.focus->ra().radians();
+    // For horizontal coordinates the offset is taken from the point to the focus, see toScreenVec()
+    const double sign     = m_vp.useAltAz ? -1 : 1;
+    const double origX    = m_vp.width / 2;
+    const double origY    = m_vp.height / 2;
+    const double zoom     = m_vp.zoomFactor;
+    const double cosLimit = cosMaxFieldAngle();
+#ifdef KSTARS_LITE
+    double sinT = 0, cosT = 1;
+    const double skyRotation = SkyMapLite::Instance()->getSkyRotation();
+    if (skyRotation != 0)
+        dms(skyRotation).SinCos(sinT, cosT);
+#endif
+
+    double sindX[projectionBatchSize], cosdX[projectionBatchSize];
+    double sinY[projectionBatchSize], cosY[projectionBatchSize], k[projectionBatchSize];
+
+    for (int first = 0; first < count; first += projectionBatchSize)
+    {
+        const int n = std::min(projectionBatchSize, count - first);
+        const double *lon = longitude + first;
+        const double *lat = latitude + first;
+
+        for (int i = 0; i < n; ++i)
+        {
+            const double dX = KSUtils::reduceAngle(sign * (lon[i] - focusLongitude), -dms::PI, dms::PI);
+#if (__GLIBC__ >= 2 && __GLIBC_MINOR__ >= 1)
+            sincos(dX, &sindX[i], &cosdX[i]);
+            sincos(lat[i], &sinY[i], &cosY[i]);
+#else
+            sindX[i] = sin(dX);
+            cosdX[i] = cos(dX);
+            sinY[i]  = sin(lat[i]);
+            cosY[i]  = cos(lat[i]);
+#endif
+            //k holds the cosine of the angular distance from the center until projectionKBatch() runs
+            k[i] = m_sinY0 * sinY[i] + m_cosY0 * cosY[i] * cosdX[i];
+            if (visible)
+                visible[first + i] = k[i] > cosLimit;
+        }
+
+        projectionKBatch(k, n);
+
+        for (int i = 0; i < n; ++i)
+        {
+            Vector2f &p = screen[first + i];
+            if (!(std::isfinite(lon[i]) && std::isfinite(lat[i])))
+            {
+                p = Vector2f(0, 0);
+                if (visible)
+                    visible[first + i] = false;
+                continue;
+            }
+
+            double x = origX - zoom * k[i] * cosY[i] * sindX[i];
+            double y = origY - zoom * k[i] * (m_cosY0 * sinY[i] - m_sinY0 * cosY[i] * cosdX[i]);
+#ifdef KSTARS_LITE
+            if (skyRotation != 0)
+            {
+                const double newX = origX + (x - origX) * cosT - (y - origY) * sinT;
+                y = origY + (x - origX) * sinT + (y - origY) * cosT;
+                x = newX;
+            }
+#endif
+            p = Vector2f(x, y);
+        }
+    }
+}
+
+void Projector::projectBatch(const SkyPoint *const *points, int count, Vector2f *screen, bool *visible,
+                             bool oRefract) const
+{
+    double longitude[projectionBatchSize], latitude[projectionBatchSize];
+    const bool refract = oRefract && m_vp.useRefraction && m_vp.useAltAz;
+
+    for (int first = 0; first < count; first += projectionBatchSize)
+    {
+        const int n = std::min(projectionBatchSize, count - first);
+        for (int i = 0; i < n; ++i)
+        {
+            const SkyPoint *o = points[first + i];
+            if (m_vp.useAltAz)
+            {
+                longitude[i] = o->az().radians();
+                latitude[i]  = refract ? SkyPoint::refract(o->alt()).radians() : o->alt().radians();
+            }
+            else
+            {
+                longitude[i] = o->ra().radians();
+                latitude[i]  = o->dec().radians();
+            }
+        }
+        projectBatch(longitude, latitude, n, screen + first, visible ? visible + first : nullptr);
+    }
+}
@@ -132,6 +132,33 @@ class Projector
      */
     virtual Vector2f toScreenVec(const SkyPoint *o, bool oRefract = true, bool *onVisibleHemisphere = nullptr) const;
 
+    /**
+     * @short Project a batch of points given as contiguous coordinate arrays.
+     *
+     * The result is the same as calling toScreenVec() on every point, but the focus terms and the
+     * projection factors are computed once per batch and the inner loops are free of virtual calls,
+     * so that the compiler can vectorize them.
+     *
+     * @param longitude RA, or Az if the map uses horizontal coordinates, of each point in radians.
+     * @param latitude Dec, or Alt if the map uses horizontal coordinates, of each point in radians.
+     *   Refraction must already be applied to the altitudes.
+     * @param count number of points.
+     * @param screen receives the screen pixel coordinates of each point.
+     * @param visible if not null, receives whether each point is on the visible part of the
+     *   Celestial Sphere.
+     */
+    virtual void projectBatch(const double *longitude, const double *latitude, int count, Vector2f *screen,
+                              bool *visible = nullptr) const;
+
+    /**
+     * @short Project a batch of SkyPoints.
+     * Gathers the coordinates of the points, applying refraction when needed, and projects them
+     * with the array overload.
+     * @see toScreenVec()
+     */
+    void projectBatch(const SkyPoint *const *points, int count, Vector2f *screen, bool *visible = nullptr,
+                      bool oRefract = true) const;
+
     /**
      * This is exactly the same as toScreenVec but it returns a QPointF.
      * It just calls toScreenVec and converts the result.
@@ -264,6 +291,13 @@ class Projector
      */
     virtual double projectionK(double x) const { return x; }
 
+    /**
+     * Batch version of projectionK(), replacing in place each cosine of the field angle with the
+     * projection factor. Projections override it with a loop that can be vectorized.
+     * @see projectBatch()
+     */
+    virtual void projectionKBatch(double *c, int count) const;
+
     /**
      * This function handles some of the projection-specific code.
      * @see toScreen()
@@ -264,5 +264,6 @@ void  BinaryListComponent<T, Component>::clearData()
     parent->m_ObjectHash.clear();
 
     parent->objectLists(T::TYPE).clear();
+    parent->objectListsChanged(T::TYPE);
     parent->objectNames(T::TYPE).clear();
 }
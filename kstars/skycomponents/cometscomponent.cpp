@@ -98,6 +98,7 @@ void CometsComponent::loadData()
 
     objectNames(SkyObject::COMET).clear();
     objectLists(SkyObject::COMET).clear();
+    objectListsChanged(SkyObject::COMET);
 
     QList<QPair<QString, KSParser::DataTypes>> sequence;
     sequence.append(qMakePair(QString("full name"), KSParser::D_QSTRING));
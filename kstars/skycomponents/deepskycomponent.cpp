@@ -578,10 +578,7 @@ void DeepSkyComponent::drawLabels()
     {
         LabelList *list = m_labelList[i];
 
-        for (const auto &item : *list)
-        {
-            labeler->drawNameLabel(item.obj, item.o);
-        }
+        labeler->drawNameLabels(*list);
         list->clear();
     }
 #endif
@@ -24,6 +24,7 @@
 #include "skymap.h"
 #endif
 #include "skymesh.h"
+#include "skymapprofiler.h"
 #include "skypainter.h"
 #include "starblock.h"
 #include "starcomponent.h"
@@ -34,12 +35,22 @@
 #include <QtConcurrent>
 #include <QElapsedTimer>
 
+#include <numeric>
+
 #include <kstars_debug.h>
 
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
+namespace
+{
+// How far ahead of the current motion of the view blocks are prefetched, in seconds
+constexpr double PREFETCH_LOOKAHEAD = 0.5;
+// Number of draws between two reports of the prefetch hit rate
+constexpr unsigned int PREFETCH_REPORT_INTERVAL = 100;
+}
+
 DeepStarComponent::DeepStarComponent(SkyComposite *parent, QString fileName, float trigMag, bool staticstars)
     : ListComponent(parent), m_reindexNum(J2000), triggerMag(trigMag), m_FaintMagnitude(-5.0), staticStars(staticstars),
       dataFileName(fileName)
@@ -53,6 +64,8 @@ DeepStarComponent::DeepStarComponent(SkyComposite *parent, QString fileName, flo
 
 DeepStarComponent::~DeepStarComponent()
 {
+    m_StopPrefetch = true;
+    m_Prefetch.waitForFinished();
     if (fileOpened)
         starReader.closeFile();
     fileOpened = false;
@@ -104,6 +117,11 @@ bool DeepStarComponent::loadStaticStars()
     // TODO: Read the multiplying factor from the dataFile
     m_FaintMagnitude = faintmag / 100.0;
 
+    // Records follow the header right away. When the catalog is mapped, they are decoded from memory
+    // instead of going through one fread call each.
+    const bool mapped = starReader.isMapped();
+    quint64 offset    = QT_FTELL(dataFile);
+
     if (htm_level != m_skyMesh->level())
         qCWarning(KSTARS) << "HTM Level in shallow star data file and HTM Level in m_skyMesh do not match. EXPECT TROUBLE!";
 
@@ -126,18 +144,19 @@ bool DeepStarComponent::loadStaticStars()
 
             for (quint64 j = 0; j < records; ++j)
             {
-                bool fread_success = fread(&stardata, sizeof(StarData), 1, dataFile);
-
-                if (!fread_success)
+                bool read_success = false;
+                if (mapped)
+                    read_success = readMappedRecord(offset, &stardata);
+                else if ((read_success = fread(&stardata, sizeof(StarData), 1, dataFile)) && starReader.getByteSwap())
+                    byteSwap(&stardata); /* Swap Bytes when required */
+                offset += sizeof(StarData);
+
+                if (!read_success)
                 {
                     qCCritical(KSTARS) << "ERROR: Could not read StarData structure for star #" << j << " under trixel #"
                                        << trixel;
                 }
 
-                /* Swap Bytes when required */
-                if (starReader.getByteSwap())
-                    byteSwap(&stardata);
-
                 /* Initialize star with data just read. */
                 StarObject *star;
 #ifdef KSTARS_LITE
@@ -177,19 +196,20 @@ bool DeepStarComponent::loadStaticStars()
 
             for (quint64 j = 0; j < records; ++j)
             {
-                bool fread_success = false;
-                fread_success      = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
-
-                if (!fread_success)
+                bool read_success = false;
+                if (mapped)
+                    read_success = readMappedRecord(offset, &deepstardata);
+                else if ((read_success = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile)) &&
+                         starReader.getByteSwap())
+                    byteSwap(&deepstardata); /* Swap Bytes when required */
+                offset += sizeof(DeepStarData);
+
+                if (!read_success)
                 {
                     qCCritical(KSTARS) << "Could not read StarData structure for star #" << j << " under trixel #"
                                        << trixel;
                 }
 
-                /* Swap Bytes when required */
-                if (starReader.getByteSwap())
-                    byteSwap(&deepstardata);
-
                 /* Initialize star with data just read. */
                 StarObject *star;
 #ifdef KSTARS_LITE
@@ -256,9 +276,7 @@ void DeepStarComponent::draw(SkyPainter *skyp)
     StarObject::updateCoordsCpuTime = 0.;
     StarObject::starsUpdated        = 0;
 #endif
-    SkyMap *map       = SkyMap::Instance();
-    KStarsData *data  = KStarsData::Instance();
-    UpdateID updateID = data->updateID();
+    SkyMap *map = SkyMap::Instance();
 
     //FIXME_FOV -- maybe not clamp like that...
     float radius = map->projector()->fov();
@@ -300,6 +318,8 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         maglim = hideStarsMag;
 
     StarBlockFactory *m_StarBlockFactory = StarBlockFactory::Instance();
+    // Dynamically loaded blocks must not change under us while a prefetch runs in the background
+    QMutexLocker locker(staticStars ? nullptr : m_StarBlockFactory->mutex());
     //    m_StarBlockFactory->drawID = m_skyMesh->drawID();
     //    qDebug() << "Mesh size = " << m_skyMesh->size() << "; drawID = " << m_skyMesh->drawID();
     QElapsedTimer t;
@@ -338,6 +358,10 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         region.reset();
     }
 
+    // Gather the blocks of the whole view first, so that the JIT update, projection and culling of all
+    // visible stars can be spread over the thread pool at once instead of one small job per trixel.
+    QVector<StarBlock *> blocks;
+    unsigned long prefetchHits = 0, prefetchMisses = 0;
     while (region.hasNext())
     {
         ++nTrixels;
@@ -352,58 +376,127 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         if (currentRegion >= m_starBlockList.size())
             continue;
 
-        //        if (!staticStars && !m_starBlockList.at(currentRegion)->fillToMag(maglim) &&
-        //            maglim <= m_FaintMagnitude * (1 - 1.5 / 16))
-        //        {
-        //            qCWarning(KSTARS) << "SBL::fillToMag( " << maglim << " ) failed for trixel " << currentRegion;
-        //        }
+        const std::shared_ptr<StarBlockList> &starBlockList = m_starBlockList.at(currentRegion);
 
-        t_dynamicLoad += t.restart();
+        // A trixel read here stalls the frame, one that a prefetch already filled is a hit
+        if (!staticStars && !starBlockList->isFilledToMag(maglim))
+        {
+            ++prefetchMisses;
+            m_Prefetched.remove(currentRegion);
+            if (!starBlockList->fillToMag(maglim) && maglim <= m_FaintMagnitude * (1 - 1.5 / 16))
+            {
+                qCWarning(KSTARS) << "SBL::fillToMag( " << maglim << " ) failed for trixel " << currentRegion;
+            }
+        }
+        else if (m_Prefetched.remove(currentRegion))
+            ++prefetchHits;
 
         //        qDebug() << "Drawing SBL for trixel " << currentRegion << ", SBL has "
         //                 <<  m_starBlockList[ currentRegion ]->getBlockCount() << " blocks";
 
-        // REMARK: The following should never carry state, except for const parameters like updateID and maglim
-        std::function<void(std::shared_ptr<StarBlock>)> mapFunction = [&updateID, &maglim](std::shared_ptr<StarBlock> myBlock)
+        for (int i = 0; i < starBlockList->getBlockCount(); ++i)
         {
-            for (StarObject &star : myBlock->contents())
-            {
-                if (star.updateID != updateID)
-                    star.JITupdate();
-                if (star.mag() > maglim)
-                    break;
-            }
-        };
+            StarBlock *block = starBlockList->block(i).get();
+            // Blocks of a trixel get fainter one after the other, the rest would not draw anything
+            if (block->getStarCount() == 0 || block->getBrightMag() > maglim)
+                break;
+            blocks.append(block);
+        }
+    }
+    t_dynamicLoad += t.restart();
+    m_PrefetchHits += prefetchHits;
+    m_PrefetchMisses += prefetchMisses;
+    SkyMapProfiler::Instance()->addCacheLookups(prefetchHits, prefetchMisses);
+
+    // REMARK: The following should never carry state, except for const parameters like maglim and the projector.
+    // Every block fills its own draw list, and the lists are painted in order afterwards since painting is serial.
+    const Projector *projector = map->projector();
+    QVector<QVector<SkyPainter::ProjectedPointSource>> drawLists(blocks.size());
+    QVector<SkyPainter::ProjectedPointSource> *lists = drawLists.data();
+    QVector<int> indexes(blocks.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    QtConcurrent::blockingMap(indexes, [&blocks, lists, projector, maglim](int index)
+    {
+        StarBlock *block = blocks.at(index);
+        block->JITupdate(maglim);
 
-        QtConcurrent::blockingMap(m_starBlockList.at(currentRegion)->contents(), mapFunction);
+        // Stars are sorted by magnitude, so the ones to draw are the leading run brighter than maglim
+        int count = 0;
+        while (count < block->getStarCount() && block->star(count)->mag() <= maglim)
+            ++count;
 
-        for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
-        {
-            std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
-            //            qDebug() << "---> Drawing stars from block " << i << " of trixel " <<
-            //                currentRegion << ". SB has " << block->getStarCount() << " stars";
-            for (int j = 0; j < block->getStarCount(); j++)
-            {
-                StarObject *curStar = block->star(j);
+        if (count > 0)
+            SkyPainter::projectPointSources(projector, block->star(0), count, lists[index]);
+    });
 
-                //                qDebug() << "We claim that he's from trixel " << currentRegion
-                //<< ", and indexStar says he's from " << m_skyMesh->indexStar( curStar );
+    for (const auto &drawList : drawLists)
+    {
+        skyp->drawPointSources(drawList);
+        visibleStarCount += drawList.size();
+    }
 
-                float mag = curStar->mag();
+    // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
+    //        verifySBLIntegrity();
+    t_drawUnnamed += t.restart();
+    m_skyMesh->inDraw(false);
 
-                if (mag > maglim)
-                    break;
+    if (!staticStars)
+    {
+        // Where the view is heading: further along its current motion, the destination of a slew of the
+        // map, and the target of a telescope slew that the map is going to follow
+        QList<SkyPoint> ahead;
+
+        if (m_FocusTimer.isValid() && m_FocusTimer.elapsed() > 0 && m_FocusTimer.elapsed() < 1000)
+        {
+            const double seconds = m_FocusTimer.elapsed() / 1000.0;
+            const double moved   = focus->angularDistanceTo(&m_LastFocus).Degrees();
 
-                if (skyp->drawPointSource(curStar, mag, curStar->spchar()))
-                    visibleStarCount++;
+            // Ignore a view standing still, and jumps like centering on a search result without slewing
+            if (moved > 0.01 * radius && moved < radius)
+            {
+                double dRA = focus->ra().Degrees() - m_LastFocus.ra().Degrees();
+                if (dRA > 180.0)
+                    dRA -= 360.0;
+                else if (dRA < -180.0)
+                    dRA += 360.0;
+                const double dDec  = focus->dec().Degrees() - m_LastFocus.dec().Degrees();
+                const double scale = PREFETCH_LOOKAHEAD / seconds;
+
+                dms ra = dms(focus->ra().Degrees() + dRA * scale).reduce();
+                SkyPoint predicted;
+                predicted.setRA(ra);
+                predicted.setDec(qBound(-90.0, focus->dec().Degrees() + dDec * scale, 90.0));
+                ahead.append(predicted);
             }
         }
+        m_LastFocus = SkyPoint(focus->ra(), focus->dec());
+        m_FocusTimer.start();
+
+        if (map->isSlewing())
+            ahead.append(*map->destination());
+
+        if (m_HasPrefetchTarget)
+        {
+            if (focus->angularDistanceTo(&m_PrefetchTarget).Degrees() < radius)
+                m_HasPrefetchTarget = false;
+            else
+                ahead.append(m_PrefetchTarget);
+        }
+
+        if (!ahead.isEmpty())
+            prefetch(ahead, radius + 1.0, m_zoomMagLimit);
 
-        // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
-        //        verifySBLIntegrity();
-        t_drawUnnamed += t.restart();
+        if (++m_DrawsSinceReport >= PREFETCH_REPORT_INTERVAL && m_PrefetchHits + m_PrefetchMisses > 0)
+        {
+            qCDebug(KSTARS) << "Star block prefetch for" << dataFileName << ":" << m_PrefetchHits << "hits,"
+                            << m_PrefetchMisses << "misses, hit rate"
+                            << 100.0 * m_PrefetchHits / (m_PrefetchHits + m_PrefetchMisses) << "%";
+            m_PrefetchHits     = 0;
+            m_PrefetchMisses   = 0;
+            m_DrawsSinceReport = 0;
+        }
     }
-    m_skyMesh->inDraw(false);
 #ifdef PROFILE_SINCOS
     trig_calls_here += dms::trig_function_calls;
     trig_redundancy_here += dms::redundant_trig_function_calls;
@@ -428,6 +521,58 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 #endif
 }
 
+void DeepStarComponent::setPrefetchTarget(const SkyPoint &target)
+{
+    m_PrefetchTarget    = SkyPoint(target.ra(), target.dec());
+    m_HasPrefetchTarget = true;
+}
+
+void DeepStarComponent::prefetch(const QList<SkyPoint> &centers, double radius, float maglim)
+{
+    // Only one prefetch runs at a time, the next draw picks up wherever the view is heading by then
+    if (staticStars || !fileOpened || !m_Prefetch.isFinished())
+        return;
+
+    // Trixels are looked up here since the mesh buffers are not meant to be shared across threads
+    QVector<StarBlockList *> lists;
+    const long double now = KStarsData::Instance()->updateNum()->julianDay();
+    for (const SkyPoint &center : centers)
+    {
+        // Same reverse precession as SkyMesh::aperture(), which cannot be used since it bumps the drawID
+        SkyPoint p(center.ra(), center.dec());
+        p.catalogueCoord(now);
+        m_skyMesh->index(&p, radius, PREFETCH_BUF);
+
+        MeshIterator region(m_skyMesh, PREFETCH_BUF);
+        while (region.hasNext())
+        {
+            Trixel currentRegion = region.next();
+            if (currentRegion < m_starBlockList.size())
+                lists.append(m_starBlockList.at(currentRegion).get());
+        }
+    }
+
+    if (lists.isEmpty())
+        return;
+
+    m_Prefetch = QtConcurrent::run([this, lists, maglim]()
+    {
+        StarBlockFactory *factory = StarBlockFactory::Instance();
+        for (StarBlockList *list : lists)
+        {
+            if (m_StopPrefetch)
+                return;
+
+            // Lock one trixel at a time, so that a draw never waits for more than a single trixel to load
+            QMutexLocker locker(factory->mutex());
+            if (list->isFilledToMag(maglim))
+                continue;
+            if (list->fillToMag(maglim))
+                m_Prefetched.insert(list->getTrixel());
+        }
+    });
+}
+
 bool DeepStarComponent::openDataFile()
 {
     if (starReader.getFileHandle())
@@ -468,6 +613,8 @@ bool DeepStarComponent::openDataFile()
         if (starReader.getByteSwap())
             MSpT = bswap_16(MSpT);
         fileOpened = true;
+        if (!starReader.mapFile())
+            qCWarning(KSTARS) << "Could not map deep star catalog " << dataFileName << " into memory, reading it from disk";
         qCInfo(KSTARS) << "  Sky Mesh Size: " << m_skyMesh->size();
         for (long int i = 0; i < m_skyMesh->size(); i++)
         {
@@ -507,6 +654,7 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
     if (!fileOpened)
         return nullptr;
 
+    QMutexLocker locker(StarBlockFactory::Instance()->mutex());
     m_skyMesh->index(p, maxrad + 1.0, OBJ_NEAREST_BUF);
 
     MeshIterator region(m_skyMesh, OBJ_NEAREST_BUF);
@@ -576,6 +724,7 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
     if (maglim < -28)
         maglim = m_FaintMagnitude;
 
+    QMutexLocker locker(StarBlockFactory::Instance()->mutex());
     while (region.hasNext())
     {
         Trixel currentRegion = region.next();
@@ -33,6 +33,13 @@
 #include "skyobjects/deepstardata.h"
 #include "skyobjects/stardata.h"
 
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QSet>
+
+#include <atomic>
+#include <cstring>
+
 class SkyLabeler;
 class SkyMesh;
 class StarBlockFactory;
@@ -106,13 +113,48 @@ class DeepStarComponent : public ListComponent
      */
     bool starsInAperture(QList<StarObject *> &list, const SkyPoint &center, float radius, float maglim = -29);
 
+    /**
+     * @short Load the blocks around a point the view is about to move to, on a background thread
+     * The hint is dropped once the view has reached the point.
+     * @p target Point the sky map is expected to follow, like the target of a telescope slew
+     */
+    void setPrefetchTarget(const SkyPoint &target);
+
     // TODO: Find the right place for this method
     static void byteSwap(DeepStarData *stardata);
     static void byteSwap(StarData *stardata);
 
+    /**
+     * @short Copy a record straight out of the memory mapped catalog, swapping bytes when required
+     * @param offset Offset of the record in the catalog file
+     * @param record Record to fill
+     * @return false if the catalog is not mapped or the record lies past the end of the file
+     */
+    template <typename T>
+    bool readMappedRecord(quint64 offset, T *record) const
+    {
+        const uchar *data = starReader.mappedAt(offset, sizeof(T));
+        if (!data)
+            return false;
+        // Records are not aligned in the file, so copy them instead of casting the pointer
+        memcpy(record, data, sizeof(T));
+        if (starReader.getByteSwap())
+            byteSwap(record);
+        return true;
+    }
+
     static StarBlockFactory m_StarBlockFactory;
 
   private:
+    /**
+     * @short Fill the trixels covering the given apertures to maglim on a background thread
+     * Nothing is started while the previous prefetch is still running.
+     * @p centers Centers of the apertures, in coordinates of date
+     * @p radius Radius of the apertures in degrees
+     * @p maglim Magnitude limit to load stars upto
+     */
+    void prefetch(const QList<SkyPoint> &centers, double radius, float maglim);
+
     SkyMesh *m_skyMesh { nullptr };
     KSNumbers m_reindexNum;
 
@@ -132,6 +174,21 @@ class DeepStarComponent : public ListComponent
     long unsigned t_drawUnnamed { 0 };
     long unsigned t_updateCache { 0 };
 
+    // Prefetching of the blocks the view is heading to
+    QFuture<void> m_Prefetch;
+    std::atomic<bool> m_StopPrefetch { false };
+    /// Trixels filled in the background and not drawn since, guarded by the StarBlockFactory lock
+    QSet<Trixel> m_Prefetched;
+    /// Focus of the previous draw and time since then, to estimate how fast the view moves
+    SkyPoint m_LastFocus;
+    QElapsedTimer m_FocusTimer;
+    SkyPoint m_PrefetchTarget;
+    bool m_HasPrefetchTarget { false };
+    /// Trixels found filled by a prefetch, and trixels that had to be read while drawing
+    unsigned long m_PrefetchHits { 0 };
+    unsigned long m_PrefetchMisses { 0 };
+    unsigned int m_DrawsSinceReport { 0 };
+
     QVector<std::shared_ptr<StarBlockList>> m_starBlockList;
     QHash<int, StarObject *> m_CatalogNumber;
 
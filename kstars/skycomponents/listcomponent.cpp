@@ -18,9 +18,11 @@
 #include "listcomponent.h"
 
 #include "kstarsdata.h"
+#include "skymesh.h"
 #ifndef KSTARS_LITE
 #include "skymap.h"
 #endif
+#include "htmesh/MeshIterator.h"
 
 ListComponent::ListComponent(SkyComposite *parent) : SkyComponent(parent)
 {
@@ -43,6 +45,7 @@ void ListComponent::clear()
         removeFromNames(o);
         delete o;
     }
+    invalidateTrixelIndex();
 }
 
 void ListComponent::appendListObject(SkyObject *object)
@@ -54,6 +57,8 @@ void ListComponent::appendListObject(SkyObject *object)
     m_ObjectHash.insert(object->name().toLower(), object);
     m_ObjectHash.insert(object->longname().toLower(), object);
     m_ObjectHash.insert(object->name2().toLower(), object);
+
+    invalidateTrixelIndex();
 }
 
 void ListComponent::update(KSNumbers *num)
@@ -79,14 +84,50 @@ SkyObject *ListComponent::objectNearest(SkyPoint *p, double &maxrad)
     if (!selected())
         return nullptr;
 
+    return indexedObjectNearest(p, maxrad);
+}
+
+const ListComponent::TrixelIndex &ListComponent::trixelIndex()
+{
+    SkyObject *last = m_ObjectList.isEmpty() ? nullptr : m_ObjectList.last();
+    if (m_TrixelIndexValid && m_IndexedCount == m_ObjectList.size() && m_IndexedLast == last)
+        return m_TrixelIndex;
+
+    SkyMesh *skyMesh = SkyMesh::Instance();
+    m_TrixelIndex.clear();
+    for (SkyObject *o : m_ObjectList)
+        m_TrixelIndex[skyMesh->index(o)].append(o);
+
+    m_IndexedCount     = m_ObjectList.size();
+    m_IndexedLast      = last;
+    m_TrixelIndexValid = true;
+    return m_TrixelIndex;
+}
+
+SkyObject *ListComponent::indexedObjectNearest(SkyPoint *p, double &maxrad,
+        const std::function<bool(SkyObject *)> &accept)
+{
+    const TrixelIndex &index = trixelIndex();
     SkyObject *oBest = nullptr;
-    foreach (SkyObject *o, m_ObjectList)
+
+    MeshIterator region(SkyMesh::Instance(), OBJ_NEAREST_BUF);
+    while (region.hasNext())
     {
-        double r = o->angularDistanceTo(p).Degrees();
-        if (r < maxrad)
+        auto objects = index.constFind(region.next());
+        if (objects == index.constEnd())
+            continue;
+
+        for (SkyObject *o : objects.value())
         {
-            oBest  = o;
-            maxrad = r;
+            if (accept && !accept(o))
+                continue;
+
+            double r = o->angularDistanceTo(p).Degrees();
+            if (r < maxrad)
+            {
+                oBest  = o;
+                maxrad = r;
+            }
         }
     }
     return oBest;
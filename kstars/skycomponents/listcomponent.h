@@ -18,8 +18,13 @@
 #pragma once
 
 #include "skycomponent.h"
+#include "typedef.h"
 
+#include <QHash>
 #include <QList>
+#include <QVector>
+
+#include <functional>
 
 class SkyComposite;
 class SkyMap;
@@ -53,6 +58,11 @@ class ListComponent : public SkyComponent
     void update(KSNumbers *num = nullptr) override;
 
     SkyObject *findByName(const QString &name) override;
+
+    /**
+     * @short Find the object nearest to p, looking only at the trixels of
+     * OBJ_NEAREST_BUF as set up by SkyMapComposite::objectNearest().
+     */
     SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
 
     void clear();
@@ -69,6 +79,35 @@ class ListComponent : public SkyComponent
     void appendListObject(SkyObject * object);
 
   protected:
+    typedef QHash<Trixel, QVector<SkyObject *>> TrixelIndex;
+
+    /**
+     * @short The objects of the list by the trixel of the sky mesh their
+     * catalog coordinates are in. The index is rebuilt when it is out of
+     * date, on first use after the list changed.
+     */
+    const TrixelIndex &trixelIndex();
+
+    /**
+     * @short Mark the trixel index out of date, to be called when the
+     * catalog coordinates of the objects change.
+     */
+    void invalidateTrixelIndex() { m_TrixelIndexValid = false; }
+
+    /**
+     * @short objectNearest() over the trixel index, skipping the objects
+     * for which accept returns false.
+     */
+    SkyObject *indexedObjectNearest(SkyPoint *p, double &maxrad,
+                                    const std::function<bool(SkyObject *)> &accept = nullptr);
+
     QList<SkyObject *> m_ObjectList;
     QHash<QString, SkyObject *> m_ObjectHash;
+
+  private:
+    TrixelIndex m_TrixelIndex;
+    bool m_TrixelIndexValid { false };
+    /// Size and last object of the list when it was indexed, some subclasses change the list directly
+    int m_IndexedCount { 0 };
+    SkyObject *m_IndexedLast { nullptr };
 };
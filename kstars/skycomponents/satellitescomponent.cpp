@@ -64,6 +64,7 @@ void SatellitesComponent::loadData()
 
     objectNames(SkyObject::SATELLITE).clear();
     objectLists(SkyObject::SATELLITE).clear();
+    objectListsChanged(SkyObject::SATELLITE);
 
     foreach (SatelliteGroup *group, m_groups)
     {
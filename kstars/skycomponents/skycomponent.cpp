@@ -73,6 +73,12 @@ QHash<int, QVector<QPair<QString, const SkyObject *>>> &SkyComponent::getObjectL
     return parent()->objectLists();
 }
 
+void SkyComponent::changeObjectLists(int type)
+{
+    if (parent())
+        parent()->objectListsChanged(type);
+}
+
 void SkyComponent::removeFromNames(const SkyObject *obj)
 {
     QStringList &names = getObjectNames()[obj->type()];
@@ -97,4 +103,6 @@ void SkyComponent::removeFromLists(const SkyObject *obj)
     i = names.indexOf(QPair<QString, const SkyObject *>(obj->longname(), obj));
     if (i >= 0)
         names.removeAt(i);
+
+    objectListsChanged(obj->type());
 }
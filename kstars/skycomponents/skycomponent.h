@@ -196,12 +196,20 @@ class SkyComponent
 
     inline QVector<QPair<QString, const SkyObject *>> &objectLists(int type) { return getObjectLists()[type]; }
 
+    /**
+     * @short Tell the name index that names of a type were removed or replaced in objectLists().
+     * Appended names are found on their own, this is needed for any other change.
+     * @param type object type of the list that changed
+     */
+    inline void objectListsChanged(int type) { changeObjectLists(type); }
+
     void removeFromNames(const SkyObject *obj);
     void removeFromLists(const SkyObject *obj);
 
   private:
     virtual QHash<int, QStringList> &getObjectNames();
     virtual QHash<int, QVector<QPair<QString, const SkyObject *>>> &getObjectLists();
+    virtual void changeObjectLists(int type);
 
     // Disallow copying and assignment
     SkyComponent(const SkyComponent &);
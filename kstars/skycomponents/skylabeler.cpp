@@ -21,23 +21,32 @@
 
 #include <QPainter>
 #include <QPixmap>
+#include <QtMath>
 
 #include "Options.h"
 #include "kstarsdata.h" // MINZOOM
 #include "skymap.h"
 #include "projections/projector.h"
 
-//---------------------------------------------------------------------------//
-// A Little data container class
-//---------------------------------------------------------------------------//
+namespace
+{
+// Side of the square of screen pixels covered by one cell of the virtual screen
+constexpr int CELL_SIZE = 4;
+constexpr int WORD_BITS = 64;
 
-typedef struct LabelRun
+// Bits first to last of a word of the virtual screen
+inline quint64 bitMask(int first, int last)
 {
-    LabelRun(int s, int e) : start(s), end(e) {}
-    int start;
-    int end;
+    return (~quint64(0) >> (WORD_BITS - 1 - last)) & (~quint64(0) << first);
+}
 
-} LabelRun;
+// Bits of word w of a row that lie in the cell columns first to last
+inline quint64 wordMask(int w, int first, int last)
+{
+    return bitMask(w == first / WORD_BITS ? first % WORD_BITS : 0,
+                   w == last / WORD_BITS ? last % WORD_BITS : WORD_BITS - 1);
+}
+}
 
 //----- Now for the main event ----------------------------------------------//
 
@@ -110,14 +119,6 @@ SkyLabeler::SkyLabeler()
 
 SkyLabeler::~SkyLabeler()
 {
-    for (auto &row : screenRows)
-    {
-        for (auto &item : *row)
-        {
-            delete item;
-        }
-        delete row;
-    }
 }
 
 bool SkyLabeler::drawGuideLabel(QPointF &o, const QString &text, double angle)
@@ -171,27 +172,92 @@ bool SkyLabeler::drawGuideLabel(QPointF &o, const QString &text, double angle)
 
 bool SkyLabeler::drawNameLabel(SkyObject *obj, const QPointF &_p)
 {
-    QString sLabel = obj->labelString();
-    if (sLabel.isEmpty())
+    QString sLabel;
+    QPointF p;
+    const QFont font = nameLabelFont();
+    if (!placeNameLabel(obj, _p, QFontMetricsF(font), sLabel, p))
         return false;
 
-    double offset = obj->labelOffset();
-    QPointF p(_p.x() + offset, _p.y() + offset);
+    m_p.setFont(font);
+    m_p.drawText(p, sLabel);
+    return true;
+}
+
+void SkyLabeler::drawNameLabels(const LabelList &labels)
+{
+    if (labels.isEmpty())
+        return;
+
+    // Labels are measured with the font they are drawn with
+    const QFont font = nameLabelFont();
+    const QFontMetricsF metrics(font);
+    m_p.setFont(font);
 
-    if (!markText(p, sLabel))
+    QString sLabel;
+    QPointF p;
+    for (const auto &item : labels)
     {
-        return false;
+        if (placeNameLabel(item.obj, item.o, metrics, sLabel, p))
+            m_p.drawText(p, sLabel);
     }
-    else
+}
+
+bool SkyLabeler::placeNameLabel(SkyObject *obj, const QPointF &_p, const QFontMetricsF &metrics, QString &text,
+                                QPointF &position)
+{
+    const double offset = obj->labelOffset();
+    const qreal height  = metrics.height();
+    const qreal right   = _p.x() + offset;
+    const qreal left    = _p.x() - offset;
+
+    // Right of the object where SkyObject draws its labels too, then left of it, then right above and below that
+    const qreal baselines[] = { _p.y() + offset, _p.y() + offset, _p.y() + offset - height,
+                                _p.y() + offset + height
+                              };
+
+    // Building and measuring the text is the expensive part, and in a crowded field most labels fit nowhere.
+    // So first make sure that at least a label half as wide as high would fit somewhere.
+    const qreal stub   = height / 2.0;
+    QRectF regions[]   = { QRectF(right, baselines[0] - height, stub, height),
+                           QRectF(left - stub, baselines[1] - height, stub, height),
+                           QRectF(right, baselines[2] - height, stub, height),
+                           QRectF(right, baselines[3] - height, stub, height)
+                         };
+    const int count    = sizeof(regions) / sizeof(regions[0]);
+    bool fits          = false;
+    for (int i = 0; i < count && !fits; i++)
+        fits = isRegionFree(regions[i]);
+    if (!fits)
     {
-        double factor = log(Options::zoomFactor() / 750.0);
-        double newPointSize = qBound(12.0, factor*m_stdFont.pointSizeF(), 18.0);
-        QFont zoomFont(m_p.font());
-        zoomFont.setPointSizeF(newPointSize);
-        m_p.setFont(zoomFont);
-        m_p.drawText(p, sLabel);
-        return true;
+        m_misses++;
+        return false;
     }
+
+    text = obj->labelString();
+    if (text.isEmpty())
+        return false;
+
+    const qreal width = metrics.width(text);
+    regions[0].setWidth(width);
+    regions[1].setLeft(left - width);
+    regions[2].setWidth(width);
+    regions[3].setWidth(width);
+
+    const int index = markFirstFree(regions, count);
+    if (index < 0)
+        return false;
+
+    position = QPointF(regions[index].left(), baselines[index]);
+    return true;
+}
+
+QFont SkyLabeler::nameLabelFont() const
+{
+    double factor       = log(Options::zoomFactor() / 750.0);
+    double newPointSize = qBound(12.0, factor * m_stdFont.pointSizeF(), 18.0);
+    QFont zoomFont(m_p.font());
+    zoomFont.setPointSizeF(newPointSize);
+    return zoomFont;
 }
 
 void SkyLabeler::setFont(const QFont &font)
@@ -275,53 +341,12 @@ void SkyLabeler::reset(SkyMap *skyMap)
     setZoomFont();
     m_skyFont     = m_p.font();
     m_fontMetrics = QFontMetrics(m_skyFont);
-    m_minDeltaX   = (int)m_fontMetrics.width("MMMMM");
 
     // ----- Set up Zoom Dependent Offset -----
     m_offset = SkyLabeler::ZoomOffset();
 
     // ----- Prepare Virtual Screen -----
-    m_yScale = (m_fontMetrics.height() + 1.0);
-
-    int maxY = int(skyMap->height() / m_yScale);
-    if (maxY < 1)
-        maxY = 1; // prevents a crash below?
-
-    int m_maxX = skyMap->width();
-    m_size     = (maxY + 1) * m_maxX;
-
-    // Resize if needed:
-    if (maxY > m_maxY)
-    {
-        screenRows.resize(m_maxY);
-        for (int y = m_maxY; y <= maxY; y++)
-        {
-            screenRows.append(new LabelRow());
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
-    }
-
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++)
-    {
-        LabelRow *row = screenRows[y];
-
-        for (auto &item : *row)
-        {
-            delete item;
-        }
-        row->clear();
-    }
-
-    // never decrease m_maxY:
-    if (m_maxY < maxY)
-        m_maxY = maxY;
-
-    // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
+    resetGrid(skyMap->width(), skyMap->height());
 
     //----- Clear out labelList -----
     for (auto &item : labelList)
@@ -341,51 +366,11 @@ void SkyLabeler::reset()
     setZoomFont();
     m_skyFont     = m_drawFont;
     m_fontMetrics = QFontMetrics(m_skyFont);
-    m_minDeltaX   = (int)m_fontMetrics.width("MMMMM");
     // ----- Set up Zoom Dependent Offset -----
     m_offset = ZoomOffset();
 
     // ----- Prepare Virtual Screen -----
-    m_yScale = (m_fontMetrics.height() + 1.0);
-
-    int maxY = int(skyMap->height() / m_yScale);
-    if (maxY < 1)
-        maxY = 1; // prevents a crash below?
-
-    int m_maxX = skyMap->width();
-    m_size     = (maxY + 1) * m_maxX;
-
-    // Resize if needed:
-    if (maxY > m_maxY)
-    {
-        screenRows.resize(m_maxY);
-        for (int y = m_maxY; y <= maxY; y++)
-        {
-            screenRows.append(new LabelRow());
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
-    }
-
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++)
-    {
-        LabelRow *row = screenRows[y];
-        for (int i = 0; i < row->size(); i++)
-        {
-            delete row->at(i);
-        }
-        row->clear();
-    }
-
-    // never decrease m_maxY:
-    if (m_maxY < maxY)
-        m_maxY = maxY;
-
-    // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
+    resetGrid(skyMap->width(), skyMap->height());
 
     //----- Clear out labelList -----
     for (int i = 0; i < labelList.size(); i++)
@@ -395,6 +380,20 @@ void SkyLabeler::reset()
 }
 #endif
 
+void SkyLabeler::resetGrid(int width, int height)
+{
+    m_gridColumns = qMax(1, (width + CELL_SIZE - 1) / CELL_SIZE);
+    m_gridRows    = qMax(1, (height + CELL_SIZE - 1) / CELL_SIZE);
+    m_gridWords   = (m_gridColumns + WORD_BITS - 1) / WORD_BITS;
+    m_size        = m_gridColumns * m_gridRows;
+
+    // Resizes the grid only when the sky map did
+    m_grid.fill(0, m_gridRows * m_gridWords);
+
+    // reset the counters
+    m_marks = m_hits = m_misses = 0;
+}
+
 void SkyLabeler::draw(QPainter &p)
 {
     //FIXME: need a better soln. Apparently starting a painter
@@ -410,11 +409,6 @@ void SkyLabeler::draw(QPainter &p)
     //m_p.begin(&m_picture);
 }
 
-// We use Run Length Encoding to hold the information instead of an array of
-// chars.  This is both faster and smaller but the code is more complicated.
-//
-// This code is easy to break and hard to fix.
-
 bool SkyLabeler::markText(const QPointF &p, const QString &text)
 {
     qreal maxX = p.x() + m_fontMetrics.width(text);
@@ -424,154 +418,90 @@ bool SkyLabeler::markText(const QPointF &p, const QString &text)
 
 bool SkyLabeler::markRegion(qreal left, qreal right, qreal top, qreal bot)
 {
-    if (m_maxY < 1)
+    const QRectF region = QRectF(QPointF(left, top), QPointF(right, bot)).normalized();
+    return markFirstFree(&region, 1) >= 0;
+}
+
+int SkyLabeler::markFirstFree(const QRectF *regions, int count)
+{
+    if (m_gridRows < 1)
     {
         if (!m_errors++)
             qDebug() << QString("Someone forgot to reset the SkyLabeler!");
-        return true;
-    }
-
-    // setup x coordinates of rectangular region
-    int minX = int(left);
-    int maxX = int(right);
-    if (maxX < minX)
-    {
-        maxX = minX;
-        minX = int(right);
-    }
-
-    // setup y coordinates
-    int maxY = int(bot / m_yScale);
-    int minY = int(top / m_yScale);
-
-    if (maxY < 0)
-        maxY = 0;
-    if (maxY > m_maxY)
-        maxY = m_maxY;
-    if (minY < 0)
-        minY = 0;
-    if (minY > m_maxY)
-        minY = m_maxY;
-
-    if (maxY < minY)
-    {
-        int temp = maxY;
-        maxY     = minY;
-        minY     = temp;
+        return count > 0 ? 0 : -1;
     }
 
-    // check to see if we overlap any existing label
-    // We must check all rows before we start marking
-    for (int y = minY; y <= maxY; y++)
+    for (int i = 0; i < count; i++)
     {
-        LabelRow *row = screenRows[y];
-        int i;
-        for (i = 0; i < row->size(); i++)
+        QRect cells;
+        // Nothing to overlap off the screen
+        if (!regionCells(regions[i], cells))
         {
-            if (row->at(i)->end < minX)
-                continue; // skip past these
-            if (row->at(i)->start > maxX)
-                break;
-            m_misses++;
-            return false;
+            m_hits++;
+            return i;
         }
-    }
-
-    m_hits++;
-    m_marks += (maxX - minX + 1) * (maxY - minY + 1);
 
-    // Okay, there was no overlap so let's insert the current rectangle into
-    // screenRows.
-
-    for (int y = minY; y <= maxY; y++)
-    {
-        LabelRow *row = screenRows[y];
-
-        // Simplest case: an empty row
-        if (row->size() < 1)
-        {
-            row->append(new LabelRun(minX, maxX));
-            m_elements++;
+        if (!areCellsFree(cells))
             continue;
-        }
 
-        // Find out our place in the universe (or row).
-        // H'mm.  Maybe we could cache these numbers above.
-        int i;
-        for (i = 0; i < row->size(); i++)
-        {
-            if (row->at(i)->end >= minX)
-                break;
-        }
+        fillCells(cells);
+        m_hits++;
+        m_marks += cells.width() * cells.height();
+        return i;
+    }
 
-        // i now points to first label PAST ours
+    m_misses++;
+    return -1;
+}
 
-        // if we are first, append or merge at start of list
-        if (i == 0)
-        {
-            if (row->at(0)->start - maxX < m_minDeltaX)
-            {
-                row->at(0)->start = minX;
-            }
-            else
-            {
-                row->insert(0, new LabelRun(minX, maxX));
-                m_elements++;
-            }
-            continue;
-        }
+bool SkyLabeler::regionCells(const QRectF &region, QRect &cells) const
+{
+    const int minX = qFloor(region.left() / CELL_SIZE);
+    const int maxX = qFloor(region.right() / CELL_SIZE);
+    const int minY = qFloor(region.top() / CELL_SIZE);
+    const int maxY = qFloor(region.bottom() / CELL_SIZE);
 
-        // if we are past the last label, merge or append at end
-        else if (i == row->size())
-        {
-            if (minX - row->at(i - 1)->end < m_minDeltaX)
-            {
-                row->at(i - 1)->end = maxX;
-            }
-            else
-            {
-                row->append(new LabelRun(minX, maxX));
-                m_elements++;
-            }
-            continue;
-        }
+    if (maxX < 0 || maxY < 0 || minX >= m_gridColumns || minY >= m_gridRows)
+        return false;
 
-        // if we got here, we must insert or merge the new label
-        //  between [i-1] and [i]
+    cells.setCoords(qMax(minX, 0), qMax(minY, 0), qMin(maxX, m_gridColumns - 1), qMin(maxY, m_gridRows - 1));
+    return true;
+}
 
-        bool mergeHead = (minX - row->at(i - 1)->end < m_minDeltaX);
-        bool mergeTail = (row->at(i)->start - maxX < m_minDeltaX);
+bool SkyLabeler::isRegionFree(const QRectF &region) const
+{
+    QRect cells;
+    return m_gridRows < 1 || !regionCells(region, cells) || areCellsFree(cells);
+}
 
-        // double merge => combine all 3 into one
-        if (mergeHead && mergeTail)
-        {
-            row->at(i - 1)->end = row->at(i)->end;
-            delete row->at(i);
-            row->removeAt(i);
-            m_elements--;
-        }
+bool SkyLabeler::areCellsFree(const QRect &cells) const
+{
+    const int firstWord = cells.left() / WORD_BITS;
+    const int lastWord  = cells.right() / WORD_BITS;
 
-        // Merge label with [i-1]
-        else if (mergeHead)
+    for (int y = cells.top(); y <= cells.bottom(); y++)
+    {
+        const quint64 *row = m_grid.constData() + y * m_gridWords;
+        for (int w = firstWord; w <= lastWord; w++)
         {
-            row->at(i - 1)->end = maxX;
+            if (row[w] & wordMask(w, cells.left(), cells.right()))
+                return false;
         }
+    }
+    return true;
+}
 
-        // Merge label with [i]
-        else if (mergeTail)
-        {
-            row->at(i)->start = minX;
-        }
+void SkyLabeler::fillCells(const QRect &cells)
+{
+    const int firstWord = cells.left() / WORD_BITS;
+    const int lastWord  = cells.right() / WORD_BITS;
 
-        // insert between the two
-        else
-        {
-            row->insert(i, new LabelRun(minX, maxX));
-            m_elements++;
-        }
+    for (int y = cells.top(); y <= cells.bottom(); y++)
+    {
+        quint64 *row = m_grid.data() + y * m_gridWords;
+        for (int w = firstWord; w <= lastWord; w++)
+            row[w] |= wordMask(w, cells.left(), cells.right());
     }
-
-    return true;
 }
 
 void SkyLabeler::addLabel(SkyObject *obj, SkyLabeler::label_t type)
@@ -632,12 +562,7 @@ void SkyLabeler::drawQueuedLabels()
 
 void SkyLabeler::drawQueuedLabelsType(SkyLabeler::label_t type)
 {
-    LabelList list = labelList[type];
-
-    for (const auto &item : list)
-    {
-        drawNameLabel(item.obj, item.o);
-    }
+    drawNameLabels(labelList[type]);
 }
 
 //Rude name labels don't check for collisions with other labels,
@@ -685,10 +610,8 @@ void SkyLabeler::printInfo()
     printf("SkyLabeler:\n");
     printf("  fillRatio=%.1f%%\n", fillRatio());
     printf("  hits=%d  misses=%d  ratio=%.1f%%\n", m_hits, m_misses, hitRatio());
-    printf("  yScale=%.1f maxY=%d\n", m_yScale, m_maxY);
-
-    printf("  screenRows=%d elements=%d virtualSize=%.1f Kbytes\n", screenRows.size(), m_elements,
-           float(m_size) / 1024.0);
+    printf("  grid=%dx%d cells of %dx%d pixels, %.1f Kbytes\n", m_gridColumns, m_gridRows, CELL_SIZE, CELL_SIZE,
+           float(m_grid.size() * sizeof(quint64)) / 1024.0);
 
 //    static const char *labelName[NUM_LABEL_TYPES];
 //
@@ -705,29 +628,4 @@ void SkyLabeler::printInfo()
 //    {
 //        printf("  %20ss: %d\n", labelName[i], labelList[i].size());
 //    }
-//
-//    // Check for errors in the data structure
-//    for (int y = 0; y <= m_maxY; y++)
-//    {
-//        LabelRow *row = screenRows[y];
-//        int size      = row->size();
-//        if (size < 2)
-//            continue;
-//
-//        bool error = false;
-//        for (int i = 1; i < size; i++)
-//        {
-//            if (row->at(i - 1)->end > row->at(i)->start)
-//                error = true;
-//        }
-//        if (!error)
-//            continue;
-//
-//        printf("ERROR: %3d: ", y);
-//        for (int i = 0; i < row->size(); i++)
-//        {
-//            printf("(%d, %d) ", row->at(i)->start, row->at(i)->end);
-//        }
-//        printf("\n");
-//    }
 }
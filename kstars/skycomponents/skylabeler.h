@@ -28,17 +28,15 @@
 
 class QString;
 class QPointF;
+class QRect;
+class QRectF;
 class SkyMap;
 class Projector;
-struct LabelRun;
-
-typedef QList<LabelRun *> LabelRow;
-typedef QVector<LabelRow *> ScreenRows;
 
 /**
  *@class SkyLabeler
  * The purpose of this class is to prevent labels from overlapping.  We do this
- * by creating a virtual (lower Y-resolution) screen. Each "pixel" of this
+ * by creating a virtual (lower resolution) screen. Each "pixel" of this
  * screen essentially contains a boolean value telling us whether or not there
  * is an existing label covering at least part of that pixel.  Before you draw
  * a label, call mark( QPointF, QString ) of that label.  We will check to see
@@ -47,21 +45,19 @@ typedef QVector<LabelRow *> ScreenRows;
  * and return true.
  *
  * Since we need to check for overlap for every label every time it is
- * potentially drawn on the screen, efficiency is essential.  So instead of
- * having a 2-dimensional array of boolean values we use Run Length Encoding
- * and store the virtual array in a QVector of QLists.  Each element of the
- * vector, a LabelRow, corresponds to a horizontal strip of pixels on the actual
- * screen.  How many vertical pixels are in each strip is controlled by
- * m_yDensity.  The higher the density, the fewer vertical pixels per strip and
- * hence a larger number of strips are needed to cover the screen.  As
- * m_yDensity increases so does the density of the strips.
+ * potentially drawn on the screen, efficiency is essential.  The virtual
+ * screen is a grid of bits, one per square of a few screen pixels, packed
+ * row after row into 64 bit words.  Testing or marking a label only touches
+ * the one or two words of each row it covers, no matter how crowded the
+ * screen already is, and clearing the whole grid for a new frame is a single
+ * fill of a small buffer.
  *
- * The information in the X-dimension is completed run length encoded. A
- * consecutive run of pixels in one strip that are covered by one or more labels
- * is stored in a LabelRun object that merely stores the start pixel and the end
- * pixel.  A LabelRow is a list of LabelRun's stored in ascending order.  This
- * saves a lot of space over an explicit array and it also makes checking for
- * overlaps faster and even makes inserting new overlaps faster on average.
+ * Name labels are not limited to one position either.  If the usual spot
+ * right of an object is taken, drawNameLabel() tries left of it and then
+ * right above and below it, and only gives up if none of these is free.
+ * Since most labels of a dense star field fit nowhere, the candidates are
+ * first tested with a label just half as wide as high, before the text is
+ * even built and measured.
  *
  * Synopsis:
  *
@@ -241,6 +237,13 @@ class SkyLabeler
          */
     bool drawNameLabel(SkyObject *obj, const QPointF &_p);
 
+    /**
+         * @short Tries to draw the name labels of a batch of objects, like drawNameLabel()
+         * does for one of them but setting up the font only once.
+         * @param labels the objects and their positions, in order of priority
+         */
+    void drawNameLabels(const LabelList &labels);
+
     /**
          *@short draw the object's name label on the map, without checking for
          *overlap with other labels.
@@ -294,6 +297,15 @@ class SkyLabeler
          */
     bool markRegion(qreal left, qreal right, qreal top, qreal bot);
 
+    /**
+         * @short Tries the given regions one after the other and marks the
+         * first one that does not overlap any existing label.
+         * @param regions candidate regions, in order of preference
+         * @param count number of regions
+         * @return index of the region that was marked, or -1 if none fits.
+         */
+    int markFirstFree(const QRectF *regions, int count);
+
     //----- Diagnostics and Information -----//
 
     /**
@@ -332,18 +344,45 @@ class SkyLabeler
     int marks() { return m_marks; }
 
   private:
-    ScreenRows screenRows;
-    int m_maxX { 0 };
-    int m_maxY { 0 };
+    /**
+         * @short clears the virtual screen and resizes it to cover width x height pixels.
+         */
+    void resetGrid(int width, int height);
+
+    /**
+         * @short finds the cells of the virtual screen covered by region.
+         * @return false if the region is entirely off the virtual screen.
+         */
+    bool regionCells(const QRectF &region, QRect &cells) const;
+    bool isRegionFree(const QRectF &region) const;
+    bool areCellsFree(const QRect &cells) const;
+    void fillCells(const QRect &cells);
+
+    /**
+         * @short finds a free spot for the name label of obj, see drawNameLabel().
+         * @param metrics metrics of the font the label is drawn with
+         * @param text set to the text of the label
+         * @param position set to the left end of the baseline of the label
+         * @return true if the label was placed and marked.
+         */
+    bool placeNameLabel(SkyObject *obj, const QPointF &_p, const QFontMetricsF &metrics, QString &text,
+                        QPointF &position);
+
+    /**
+         * @return the zoom dependent font name labels are drawn with.
+         */
+    QFont nameLabelFont() const;
+
+    /// One bit per cell of the virtual screen, m_gridWords words per row
+    QVector<quint64> m_grid;
+    int m_gridColumns { 0 };
+    int m_gridRows { 0 };
+    int m_gridWords { 0 };
     int m_size { 0 };
-    /// When to merge two adjacent regions
-    int m_minDeltaX { 30 };
     int m_marks { 0 };
     int m_hits { 0 };
     int m_misses { 0 };
-    int m_elements { 0 };
     int m_errors { 0 };
-    qreal m_yScale { 0 };
     double m_offset { 0 };
     QFont m_stdFont, m_skyFont;
     QFontMetricsF m_fontMetrics;
@@ -41,6 +41,7 @@
 #include "milkyway.h"
 #include "satellitescomponent.h"
 #include "skylabeler.h"
+#include "skymapprofiler.h"
 #include "skypainter.h"
 #include "solarsystemcomposite.h"
 #include "starcomponent.h"
@@ -64,6 +65,33 @@
 
 #include <kstars_debug.h>
 
+namespace
+{
+// Order in which findByName() searches the object types, lower first
+int searchRank(int type)
+{
+    switch (type)
+    {
+        case SkyObject::PLANET:
+        case SkyObject::MOON:
+        case SkyObject::COMET:
+        case SkyObject::ASTEROID:
+            return 0;
+        case SkyObject::CONSTELLATION:
+            return 2;
+        case SkyObject::STAR:
+            return 3;
+        case SkyObject::SUPERNOVA:
+            return 4;
+        case SkyObject::SATELLITE:
+            return 5;
+        default:
+            // Deep sky objects and custom catalogs
+            return 1;
+    }
+}
+}
+
 SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m_reindexNum(J2000)
 {
     m_skyLabeler.reset(SkyLabeler::Instance());
@@ -184,13 +212,18 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
 
 void SkyMapComposite::update(KSNumbers *num)
 {
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    profiler->begin(SkyMapProfiler::UPDATE);
+
     //printf("updating SkyMapComposite\n");
     //1. Milky Way
     //m_MilkyWay->update( data, num );
     //2. Coordinate grid
     //m_EquatorialCoordinateGrid->update( num );
+    profiler->section("Horizontal grid");
     m_HorizontalCoordinateGrid->update(num);
 #ifndef KSTARS_LITE
+    profiler->section("Local meridian");
     m_LocalMeridianComponent->update(num);
 #endif
     //3. Constellation boundaries
@@ -198,6 +231,7 @@ void SkyMapComposite::update(KSNumbers *num)
     //4. Constellation lines
     //m_CLines->update( data, num );
     //5. Constellation names
+    profiler->section("Constellation names");
     if (m_CNames)
         m_CNames->update(num);
     //6. Equator
@@ -207,6 +241,7 @@ void SkyMapComposite::update(KSNumbers *num)
     //8. Deep sky
     //m_DeepSky->update( data, num );
     //9. Custom catalogs
+    profiler->section("Custom catalogs");
     m_CustomCatalogs->update(num);
     m_internetResolvedComponent->update(num);
     m_manualAdditionsComponent->update(num);
@@ -215,22 +250,33 @@ void SkyMapComposite::update(KSNumbers *num)
     //m_CLines->update( data, num );  // MUST follow stars.
 
     //12. Solar system
+    profiler->section("Solar system");
     m_SolarSystem->update(num);
     //13. Satellites
+    profiler->section("Satellites");
     m_Satellites->update(num);
     //14. Supernovae
+    profiler->section("Supernovae");
     m_Supernovae->update(num);
     //15. Horizon
+    profiler->section("Horizon");
     m_Horizon->update(num);
 #ifndef KSTARS_LITE
     //16. Flags
+    profiler->section("Flags");
     m_Flags->update(num);
 #endif
+
+    profiler->end();
 }
 
 void SkyMapComposite::updateSolarSystemBodies(KSNumbers *num)
 {
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    profiler->begin(SkyMapProfiler::UPDATE);
+    profiler->section("Solar system");
     m_SolarSystem->updateSolarSystemBodies(num);
+    profiler->end();
 }
 
 
@@ -276,6 +322,10 @@ void SkyMapComposite::draw(SkyPainter *skyp)
         return;
     }
 
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    profiler->begin(SkyMapProfiler::DRAW);
+    profiler->section("Sky mesh");
+
     m_skyMesh->inDraw(true);
     SkyPoint *focus = map->focus();
     m_skyMesh->aperture(focus, radius + 1.0, DRAW_BUF); // divide by 2 for testing
@@ -288,6 +338,7 @@ void SkyMapComposite::draw(SkyPainter *skyp)
     }
 
     // clear marks from old labels and prep fonts
+    profiler->section("Labels");
     m_skyLabeler->reset(map);
     m_skyLabeler->useStdFont();
 
@@ -311,47 +362,57 @@ void SkyMapComposite::draw(SkyPainter *skyp)
             }
     }
 
-    m_MilkyWay->draw(skyp);
-
-    // Draw HIPS after milky way but before everything else
-    m_HiPS->draw(skyp);
+    // Layers that barely change between frames come from the cache of the painter when it has one
+    profiler->section("Background");
+    if (!skyp->drawCachedLayer(SkyPainter::BACKGROUND_LAYER))
+        drawLayer(SkyPainter::BACKGROUND_LAYER, skyp);
 
+    profiler->section("Coordinate grids");
     m_EquatorialCoordinateGrid->draw(skyp);
     m_HorizontalCoordinateGrid->draw(skyp);
     m_LocalMeridianComponent->draw(skyp);
 
     //Draw constellation boundary lines only if we draw western constellations
+    profiler->section("Constellations");
     if (m_Cultures->current() == "Western")
-    {
         m_CBoundLines->draw(skyp);
-        m_ConstellationArt->draw(skyp);
-    }
-    else if (m_Cultures->current() == "Inuit")
-    {
-        m_ConstellationArt->draw(skyp);
-    }
+
+    if (!skyp->drawCachedLayer(SkyPainter::CONSTELLATION_ART_LAYER))
+        drawLayer(SkyPainter::CONSTELLATION_ART_LAYER, skyp);
 
     m_CLines->draw(skyp);
 
+    profiler->section("Equator and ecliptic");
     m_Equator->draw(skyp);
 
     m_Ecliptic->draw(skyp);
 
+    profiler->section("Deep sky");
     m_DeepSky->draw(skyp);
 
+    profiler->section("Custom catalogs");
     m_CustomCatalogs->draw(skyp);
     m_internetResolvedComponent->draw(skyp);
     m_manualAdditionsComponent->draw(skyp);
 
+    // Unnamed stars go below the named ones, which may carry labels
+    profiler->section("Faint stars");
+    if (!skyp->drawCachedLayer(SkyPainter::FAINT_STARS_LAYER))
+        drawLayer(SkyPainter::FAINT_STARS_LAYER, skyp);
+    profiler->section("Stars");
     m_Stars->draw(skyp);
 
+    profiler->section("Solar system");
     m_SolarSystem->drawTrails(skyp);
     m_SolarSystem->draw(skyp);
 
+    profiler->section("Satellites");
     m_Satellites->draw(skyp);
 
+    profiler->section("Supernovae");
     m_Supernovae->draw(skyp);
 
+    profiler->section("Labels");
     map->drawObjectLabels(labelObjects());
 
     m_skyLabeler->drawQueuedLabels();
@@ -359,20 +420,24 @@ void SkyMapComposite::draw(SkyPainter *skyp)
     m_Stars->drawLabels();
     m_DeepSky->drawLabels();
 
+    profiler->section("Observing list");
     m_ObservingList->pen = QPen(QColor(data->colorScheme()->colorNamed("ObsListColor")), 1.);
     m_ObservingList->list2 = KStarsData::Instance()->observingList()->sessionList();
     m_ObservingList->draw(skyp);
 
+    profiler->section("Flags");
     m_Flags->draw(skyp);
 
     m_StarHopRouteList->pen = QPen(QColor(data->colorScheme()->colorNamed("StarHopRouteColor")), 1.);
     m_StarHopRouteList->draw(skyp);
 
+    profiler->section("Horizon");
     m_ArtificialHorizon->draw(skyp);
 
     m_Horizon->draw(skyp);
 
     m_skyMesh->inDraw(false);
+    profiler->end();
 
     // DEBUG Edit. Keywords: Trixel boundaries. Currently works only in QPainter mode
     // -jbb uncomment these to see trixel outlines:
@@ -397,6 +462,35 @@ void SkyMapComposite::draw(SkyPainter *skyp)
 #endif
 }
 
+void SkyMapComposite::drawLayer(SkyPainter::CachedLayer layer, SkyPainter *skyp)
+{
+#ifndef KSTARS_LITE
+    switch (layer)
+    {
+        case SkyPainter::BACKGROUND_LAYER:
+            m_MilkyWay->draw(skyp);
+            // Draw HIPS after milky way but before everything else
+            m_HiPS->draw(skyp);
+            break;
+
+        case SkyPainter::CONSTELLATION_ART_LAYER:
+            if (m_Cultures->current() == "Western" || m_Cultures->current() == "Inuit")
+                m_ConstellationArt->draw(skyp);
+            break;
+
+        case SkyPainter::FAINT_STARS_LAYER:
+            m_Stars->drawDeepStars(skyp);
+            break;
+
+        default:
+            break;
+    }
+#else
+    Q_UNUSED(layer)
+    Q_UNUSED(skyp)
+#endif
+}
+
 //Select nearest object to the given skypoint, but give preference
 //to certain object types.
 //we multiply each object type's smallest angular distance by the
@@ -570,6 +664,11 @@ QHash<int, QVector<QPair<QString, const SkyObject *>>> &SkyMapComposite::getObje
     return m_ObjectLists;
 }
 
+void SkyMapComposite::changeObjectLists(int type)
+{
+    m_NameIndex.invalidate(type);
+}
+
 QList<SkyObject *> SkyMapComposite::findObjectsInArea(const SkyPoint &p1, const SkyPoint &p2)
 {
     const SkyRegion &region = m_skyMesh->skyRegion(p1, p2);
@@ -590,6 +689,17 @@ SkyObject *SkyMapComposite::findByName(const QString &name)
         return nullptr;
 #endif
 
+    //Most names are in the name index. If the same name belongs to
+    //objects of several types, prefer them in the order of the search below.
+    const SkyObject *indexed = nullptr;
+    for (const auto &match : m_NameIndex.find(name))
+    {
+        if (!indexed || searchRank(match.second->type()) < searchRank(indexed->type()))
+            indexed = match.second;
+    }
+    if (indexed)
+        return const_cast<SkyObject *>(indexed);
+
     //We search the children in an "intelligent" order (most-used
     //object types first), in order to avoid wasting too much time
     //looking for a match.  The most important part of this ordering
@@ -626,6 +736,12 @@ SkyObject *SkyMapComposite::findByName(const QString &name)
     return nullptr;
 }
 
+QVector<QPair<QString, const SkyObject *>> SkyMapComposite::findByNamePrefix(const QString &prefix,
+        const QList<int> &types, int limit)
+{
+    return m_NameIndex.findPrefix(prefix, types, limit);
+}
+
 SkyObject *SkyMapComposite::findStarByGenetiveName(const QString name)
 {
     return m_Stars->findStarByGenetiveName(name);
@@ -709,6 +825,7 @@ void SkyMapComposite::reloadCNames()
     //     SkyMapDrawAbstract::setDrawLock( false );
     objectNames(SkyObject::CONSTELLATION).clear();
     objectLists(SkyObject::CONSTELLATION).clear();
+    objectListsChanged(SkyObject::CONSTELLATION);
     removeComponent(m_CNames);
     delete m_CNames;
     addComponent(m_CNames = new ConstellationNamesComponent(this, m_Cultures.get()));
@@ -23,6 +23,8 @@
 #include "skylabeler.h"
 #include "skymesh.h"
 #include "skyobject.h"
+#include "skyobjectnameindex.h"
+#include "skypainter.h"
 
 #include <QList>
 
@@ -122,6 +124,14 @@ class SkyMapComposite : public QObject, public SkyComposite
      */
     void draw(SkyPainter *skyp) override;
 
+    /**
+     * @short Draw the components of a single layer, skipping any cache of the painter
+     * @p layer The layer to draw
+     * @p skyp The painter to draw the layer with
+     * @note Must be called from within a draw cycle, after the draw aperture has been prepared
+     */
+    void drawLayer(SkyPainter::CachedLayer layer, SkyPainter *skyp);
+
     /**
      * @return the object nearest a given point in the sky.
      * @param p The point to find an object near
@@ -146,14 +156,26 @@ class SkyMapComposite : public QObject, public SkyComposite
      *
      * The objects' primary, secondary and long-form names will
      * all be checked for a match.
-     * @note Overloaded from SkyComposite.  In this version, we search
-     * the most likely object classes first to be more efficient.
+     * @note Overloaded from SkyComposite.  In this version, we look the
+     * name up in the name index first, and only search the most likely
+     * object classes one after the other if it is not there.
      * @p name the name to be matched
      * @return a pointer to the SkyObject whose name matches
      * the argument, or a nullptr pointer if no match was found.
      */
     SkyObject *findByName(const QString &name) override;
 
+    /**
+     * @short Find the objects whose primary or long name starts with
+     * the argument, ignoring case.
+     * @p prefix the start of the names to be matched
+     * @p types the object types to search, all of them if empty
+     * @p limit the maximum number of names returned, or -1 for all of them
+     * @return the matching names and their objects, sorted by name
+     */
+    QVector<QPair<QString, const SkyObject *>> findByNamePrefix(const QString &prefix,
+            const QList<int> &types = QList<int>(), int limit = -1);
+
     /**
      * @return the list of objects in the region defined by skypoints
      * @param p1 first sky point (top-left vertex of rectangular region)
@@ -239,6 +261,7 @@ class SkyMapComposite : public QObject, public SkyComposite
   private:
     QHash<int, QStringList> &getObjectNames() override;
     QHash<int, QVector<QPair<QString, const SkyObject *>>> &getObjectLists() override;
+    void changeObjectLists(int type) override;
 
     std::unique_ptr<CultureList> m_Cultures;
     ConstellationBoundaryLines *m_CBoundLines { nullptr };
@@ -278,6 +301,7 @@ class SkyMapComposite : public QObject, public SkyComposite
     QList<SkyObject *> m_LabeledObjects;
     QHash<int, QStringList> m_ObjectNames;
     QHash<int, QVector<QPair<QString, const SkyObject *>>> m_ObjectLists;
+    SkyObjectNameIndex m_NameIndex { m_ObjectLists };
     QHash<QString, QString> m_ConstellationNames;
     QString m_internetResolvedCat; // Holds the name of the internet resolved catalog
     QString m_manualAdditionsCat;
@@ -0,0 +1,267 @@
+/*  Sky Map Profiler
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "skymapprofiler.h"
+
+#include "dms.h"
+#include "Options.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+// Frames kept for export, a bit more than ten seconds of a smoothly panning map
+constexpr int FRAME_HISTORY = 600;
+
+constexpr double NS_PER_MS = 1e6;
+}
+
+SkyMapProfiler *SkyMapProfiler::pInstance = nullptr;
+
+SkyMapProfiler *SkyMapProfiler::Instance()
+{
+    if (!pInstance)
+        pInstance = new SkyMapProfiler();
+    return pInstance;
+}
+
+SkyMapProfiler::SkyMapProfiler()
+{
+    m_Timer.start();
+}
+
+bool SkyMapProfiler::isEnabled() const
+{
+    return m_Enabled || Options::showFrameProfile();
+}
+
+void SkyMapProfiler::setEnabled(bool enabled)
+{
+    m_Enabled = enabled;
+}
+
+void SkyMapProfiler::begin(Phase phase)
+{
+    if (m_Running)
+        end();
+
+    // Counting trig calls costs an atomic increment in every one of them, so it only runs along with the profiler
+    const bool enabled = isEnabled();
+    if (dms::isTrigCounting() != enabled)
+        dms::setTrigCounting(enabled);
+    if (!enabled)
+        return;
+
+    m_Phase      = phase;
+    m_Running    = true;
+    m_FrameStart = m_Timer.nsecsElapsed();
+    if (phase == DRAW)
+        m_Draws.clear();
+}
+
+void SkyMapProfiler::section(const char *name)
+{
+    if (!m_Running)
+        return;
+
+    endSection();
+    m_Current          = &findSection(m_Phase == DRAW ? m_Draws : m_Updates, name);
+    m_SectionStart     = m_Timer.nsecsElapsed();
+    m_SectionTrigCalls = dms::trigCallCount();
+}
+
+void SkyMapProfiler::end()
+{
+    if (!m_Running)
+        return;
+
+    endSection();
+    m_Running = false;
+    if (m_Phase == UPDATE)
+        return;
+
+    const qint64 now = m_Timer.nsecsElapsed();
+    Frame frame;
+    frame.time     = QDateTime::currentMSecsSinceEpoch() - (now - m_FrameStart) / 1000000;
+    frame.drawTime = (now - m_FrameStart) / NS_PER_MS;
+
+    // Components in the order they are drawn, followed by the ones that were only updated
+    QVector<Section> updates = m_Updates;
+    for (const Section &draw : m_Draws)
+    {
+        Component component;
+        component.name        = QString::fromLatin1(draw.name);
+        component.drawTime    = draw.time / NS_PER_MS;
+        component.objects     = draw.objects;
+        component.trigCalls   = draw.trigCalls;
+        component.cacheHits   = draw.cacheHits;
+        component.cacheMisses = draw.cacheMisses;
+
+        for (Section &update : updates)
+        {
+            if (update.name && std::strcmp(update.name, draw.name) == 0)
+            {
+                component.updateTime = update.time / NS_PER_MS;
+                component.trigCalls += update.trigCalls;
+                component.cacheHits += update.cacheHits;
+                component.cacheMisses += update.cacheMisses;
+                update.name = nullptr;
+                break;
+            }
+        }
+        frame.components.append(component);
+    }
+    for (const Section &update : updates)
+    {
+        if (!update.name)
+            continue;
+        Component component;
+        component.name        = QString::fromLatin1(update.name);
+        component.updateTime  = update.time / NS_PER_MS;
+        component.trigCalls   = update.trigCalls;
+        component.cacheHits   = update.cacheHits;
+        component.cacheMisses = update.cacheMisses;
+        frame.components.append(component);
+    }
+    m_Updates.clear();
+    m_Draws.clear();
+
+    if (m_Frames.size() < FRAME_HISTORY)
+        m_Frames.append(frame);
+    else
+        m_Frames[m_NextFrame] = frame;
+    m_NextFrame = (m_NextFrame + 1) % FRAME_HISTORY;
+}
+
+void SkyMapProfiler::endSection()
+{
+    if (!m_Current)
+        return;
+
+    m_Current->time += m_Timer.nsecsElapsed() - m_SectionStart;
+    m_Current->trigCalls += dms::trigCallCount() - m_SectionTrigCalls;
+    m_Current = nullptr;
+}
+
+SkyMapProfiler::Section &SkyMapProfiler::findSection(QVector<Section> &sections, const char *name)
+{
+    // A component may be drawn in more than one section, like the stars and their labels
+    for (Section &section : sections)
+    {
+        if (section.name == name || std::strcmp(section.name, name) == 0)
+            return section;
+    }
+
+    Section section;
+    section.name = name;
+    sections.append(section);
+    return sections.last();
+}
+
+QVector<SkyMapProfiler::Frame> SkyMapProfiler::frames(int count) const
+{
+    if (count < 0 || count > m_Frames.size())
+        count = m_Frames.size();
+
+    QVector<Frame> result;
+    result.reserve(count);
+    // Once the buffer is full, the oldest frame is the one to be overwritten next
+    const int first = m_Frames.size() < FRAME_HISTORY ? 0 : m_NextFrame;
+    for (int i = m_Frames.size() - count; i < m_Frames.size(); ++i)
+        result.append(m_Frames.at((first + i) % m_Frames.size()));
+    return result;
+}
+
+SkyMapProfiler::Frame SkyMapProfiler::average(int count) const
+{
+    const QVector<Frame> last = frames(count);
+    Frame mean;
+    if (last.isEmpty())
+        return mean;
+
+    for (const Frame &frame : last)
+    {
+        mean.drawTime += frame.drawTime;
+        for (const Component &component : frame.components)
+        {
+            auto sum = std::find_if(mean.components.begin(), mean.components.end(),
+                                    [&component](const Component & c)
+            {
+                return c.name == component.name;
+            });
+            if (sum == mean.components.end())
+            {
+                Component added;
+                added.name = component.name;
+                mean.components.append(added);
+                sum = mean.components.end() - 1;
+            }
+            sum->updateTime += component.updateTime;
+            sum->drawTime += component.drawTime;
+            sum->objects += component.objects;
+            sum->trigCalls += component.trigCalls;
+            sum->cacheHits += component.cacheHits;
+            sum->cacheMisses += component.cacheMisses;
+        }
+    }
+
+    const int n = last.size();
+    mean.time = last.last().time;
+    mean.drawTime /= n;
+    for (Component &component : mean.components)
+    {
+        component.updateTime /= n;
+        component.drawTime /= n;
+        component.objects /= n;
+        component.trigCalls /= n;
+        component.cacheHits /= n;
+        component.cacheMisses /= n;
+    }
+    return mean;
+}
+
+void SkyMapProfiler::clear()
+{
+    m_Frames.clear();
+    m_NextFrame = 0;
+}
+
+QJsonObject SkyMapProfiler::toJson(int count) const
+{
+    QJsonArray frameArray;
+    for (const Frame &frame : frames(count))
+    {
+        QJsonArray componentArray;
+        for (const Component &component : frame.components)
+        {
+            componentArray.append(QJsonObject
+            {
+                { "name", component.name },
+                { "updateMs", component.updateTime },
+                { "drawMs", component.drawTime },
+                { "objects", static_cast<double>(component.objects) },
+                { "trigCalls", static_cast<double>(component.trigCalls) },
+                { "cacheHits", static_cast<double>(component.cacheHits) },
+                { "cacheMisses", static_cast<double>(component.cacheMisses) }
+            });
+        }
+
+        frameArray.append(QJsonObject
+        {
+            { "time", static_cast<double>(frame.time) },
+            { "drawMs", frame.drawTime },
+            { "components", componentArray }
+        });
+    }
+
+    return QJsonObject { { "enabled", isEnabled() }, { "frames", frameArray } };
+}
@@ -0,0 +1,132 @@
+/*  Sky Map Profiler
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class SkyMapProfiler
+ * Records at runtime where the time of the sky map goes. Every draw of SkyMapComposite becomes a frame
+ * holding, for each component, the time spent updating it since the previous frame and drawing it, the
+ * objects it drew, the trig functions computed and the hits and misses of its caches. The last frames
+ * are kept in a ring buffer, which can be exported as JSON over DBus or shown on top of the sky map.
+ *
+ * The components of an update or a draw are timed as consecutive sections, starting a section ends the
+ * previous one. Objects and cache lookups reported while a section runs are counted in that section.
+ * Unless profiling is enabled, nothing is recorded and every call returns right away.
+ */
+class SkyMapProfiler
+{
+    public:
+        enum Phase
+        {
+            UPDATE,
+            DRAW
+        };
+
+        struct Component
+        {
+            QString name;
+            /// Milliseconds spent in the updates since the previous frame, and in the draw of the frame
+            double updateTime { 0 };
+            double drawTime { 0 };
+            quint64 objects { 0 };
+            /// Trig functions of dms computed, by any thread, while the component was updated or drawn
+            quint64 trigCalls { 0 };
+            quint64 cacheHits { 0 };
+            quint64 cacheMisses { 0 };
+        };
+
+        struct Frame
+        {
+            /// Start of the draw, in milliseconds since the epoch
+            qint64 time { 0 };
+            /// Milliseconds spent in the draw of the frame
+            double drawTime { 0 };
+            QVector<Component> components;
+        };
+
+        static SkyMapProfiler *Instance();
+
+        /** @return true if profiling was enabled, or the profile is shown on the sky map. */
+        bool isEnabled() const;
+        void setEnabled(bool enabled);
+
+        /** Start timing an update or a draw of the sky map. */
+        void begin(Phase phase);
+        /** End the current section, if any, and start timing the component called @p name. */
+        void section(const char *name);
+        /** Stop timing. The end of a draw records the frame. */
+        void end();
+
+        /** Count objects drawn in the current section. */
+        inline void addObjects(quint64 count)
+        {
+            if (m_Current)
+                m_Current->objects += count;
+        }
+
+        /** Count cache lookups of the current section. */
+        inline void addCacheLookups(quint64 hits, quint64 misses)
+        {
+            if (m_Current)
+            {
+                m_Current->cacheHits += hits;
+                m_Current->cacheMisses += misses;
+            }
+        }
+
+        /** @return up to @p count of the last frames, oldest first, or all frames kept if @p count is negative. */
+        QVector<Frame> frames(int count = -1) const;
+
+        /** @return the mean of the components over the last @p count frames. */
+        Frame average(int count) const;
+
+        /** Drop the frames recorded so far. */
+        void clear();
+
+        /** @return the last @p count frames, or all frames kept if @p count is negative, as JSON. */
+        QJsonObject toJson(int count = -1) const;
+
+    private:
+        SkyMapProfiler();
+
+        struct Section
+        {
+            const char *name { nullptr };
+            qint64 time { 0 };
+            quint64 objects { 0 };
+            quint64 trigCalls { 0 };
+            quint64 cacheHits { 0 };
+            quint64 cacheMisses { 0 };
+        };
+
+        void endSection();
+        static Section &findSection(QVector<Section> &sections, const char *name);
+
+        bool m_Enabled { false };
+        Phase m_Phase { DRAW };
+        bool m_Running { false };
+        QElapsedTimer m_Timer;
+        qint64 m_FrameStart { 0 };
+        qint64 m_SectionStart { 0 };
+        quint64 m_SectionTrigCalls { 0 };
+        Section *m_Current { nullptr };
+        /// Sections of the updates since the last frame, and of the draw running
+        QVector<Section> m_Updates;
+        QVector<Section> m_Draws;
+        /// Ring buffer of the last frames
+        QVector<Frame> m_Frames;
+        int m_NextFrame { 0 };
+
+        static SkyMapProfiler *pInstance;
+};
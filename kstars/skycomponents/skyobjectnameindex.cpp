@@ -0,0 +1,136 @@
+/*  Sky Object Name Index
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "skyobjectnameindex.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+SkyObjectNameIndex::SkyObjectNameIndex(const QHash<int, NameList> &lists) : m_Lists(lists)
+{
+}
+
+SkyObjectNameIndex::NameList SkyObjectNameIndex::find(const QString &name)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    const QString key = name.toCaseFolded();
+    NameList matches;
+
+    for (auto list = m_Lists.constBegin(); list != m_Lists.constEnd(); ++list)
+    {
+        const Segment &segment = update(list.key(), list.value());
+        const QPair<int, int> found = range(segment, key);
+
+        // Equal keys come first among the ones starting with key
+        for (int i = found.first; i < found.second && segment.entries.at(i).key == key; i++)
+        {
+            const Name &match = list.value().at(segment.entries.at(i).position);
+            if (match.first == name)
+                matches.append(match);
+        }
+    }
+
+    return matches;
+}
+
+SkyObjectNameIndex::NameList SkyObjectNameIndex::findPrefix(const QString &prefix, const QList<int> &types, int limit)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    const QString key = prefix.toCaseFolded();
+    const QList<int> searched = types.isEmpty() ? m_Lists.keys() : types;
+    QVector<Entry> keys;
+    NameList matches;
+
+    for (int type : searched)
+    {
+        auto list = m_Lists.constFind(type);
+        if (list == m_Lists.constEnd())
+            continue;
+
+        const Segment &segment = update(type, list.value());
+        QPair<int, int> found = range(segment, key);
+        if (limit >= 0)
+            found.second = std::min(found.second, found.first + limit);
+
+        for (int i = found.first; i < found.second; i++)
+        {
+            // Positions refer to the merged result from here on
+            keys.append({ segment.entries.at(i).key, matches.size() });
+            matches.append(list.value().at(segment.entries.at(i).position));
+        }
+    }
+
+    // Every type is sorted already, bring them together
+    std::sort(keys.begin(), keys.end());
+    if (limit >= 0 && keys.size() > limit)
+        keys.resize(limit);
+
+    NameList sorted;
+    sorted.reserve(keys.size());
+    for (const Entry &entry : keys)
+        sorted.append(matches.at(entry.position));
+    return sorted;
+}
+
+void SkyObjectNameIndex::invalidate(int type)
+{
+    QMutexLocker locker(&m_Mutex);
+    m_Segments.remove(type);
+}
+
+SkyObjectNameIndex::Segment &SkyObjectNameIndex::update(int type, const NameList &names)
+{
+    Segment &segment = m_Segments[type];
+
+    // Changes other than appends are reported through invalidate(), a list shorter than indexed changed all the same
+    if (names.size() < segment.indexed)
+        segment = Segment();
+    if (names.size() == segment.indexed)
+        return segment;
+
+    QVector<Entry> added;
+    added.reserve(names.size() - segment.indexed);
+    for (int i = segment.indexed; i < names.size(); i++)
+        added.append({ names.at(i).first.toCaseFolded(), i });
+    std::sort(added.begin(), added.end());
+
+    if (segment.entries.isEmpty())
+    {
+        segment.entries = added;
+    }
+    else
+    {
+        QVector<Entry> merged(segment.entries.size() + added.size());
+        std::merge(segment.entries.constBegin(), segment.entries.constEnd(), added.constBegin(), added.constEnd(),
+                   merged.begin());
+        segment.entries.swap(merged);
+    }
+
+    segment.indexed = names.size();
+    return segment;
+}
+
+QPair<int, int> SkyObjectNameIndex::range(const Segment &segment, const QString &key) const
+{
+    const auto begin = segment.entries.constBegin();
+    const auto end   = segment.entries.constEnd();
+
+    auto first = std::lower_bound(begin, end, key, [](const Entry & entry, const QString & value)
+    {
+        return entry.key < value;
+    });
+    auto last = std::partition_point(first, end, [&key](const Entry & entry)
+    {
+        return entry.key.startsWith(key);
+    });
+
+    return qMakePair(int(first - begin), int(last - begin));
+}
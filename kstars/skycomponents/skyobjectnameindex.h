@@ -0,0 +1,91 @@
+/*  Sky Object Name Index
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class SkyObject;
+
+/**
+ * @class SkyObjectNameIndex
+ * Case insensitive index over the object name lists of SkyMapComposite, which hold the primary and long
+ * names of the stars, deep sky objects, custom catalogs, solar system bodies, satellites and supernovae.
+ *
+ * Each object type has its own array of case folded names sorted for binary search, so that looking up
+ * a name or all names starting with a prefix does not depend on how many objects are loaded. The index
+ * follows the lists lazily: names appended to a list since the last lookup are sorted and merged in.
+ * Owners removing or replacing names in a list report it with invalidate(), through
+ * SkyComponent::objectListsChanged(), and the array of that type is rebuilt on the next lookup.
+ */
+class SkyObjectNameIndex
+{
+    public:
+        typedef QPair<QString, const SkyObject *> Name;
+        typedef QVector<Name> NameList;
+
+        explicit SkyObjectNameIndex(const QHash<int, NameList> &lists);
+
+        /**
+         * @brief find Look up a name.
+         * @param name Name to look for, matched exactly.
+         * @return the names and objects matching, in no particular order.
+         */
+        NameList find(const QString &name);
+
+        /**
+         * @brief findPrefix Look up the names that start with a prefix, ignoring case.
+         * @param prefix Start of the names to look for.
+         * @param types Object types to search, all of them if empty.
+         * @param limit Maximum number of names returned, or -1 for all of them.
+         * @return the names and objects matching, sorted by name ignoring case.
+         */
+        NameList findPrefix(const QString &prefix, const QList<int> &types = QList<int>(), int limit = -1);
+
+        /**
+         * @brief invalidate Drop the index of a type whose names were removed or replaced, not only appended.
+         * @param type Object type of the list that changed.
+         */
+        void invalidate(int type);
+
+    private:
+        struct Entry
+        {
+            /// Case folded name
+            QString key;
+            /// Position of the name in its list
+            int position;
+
+            bool operator<(const Entry &other) const
+            {
+                return key < other.key || (key == other.key && position < other.position);
+            }
+        };
+
+        struct Segment
+        {
+            /// Sorted by key
+            QVector<Entry> entries;
+            /// Number of names of the list that are indexed
+            int indexed { 0 };
+        };
+
+        /** Bring the index of a type up to date with its list. */
+        Segment &update(int type, const NameList &names);
+
+        /** Range of entries of a segment whose keys start with key. */
+        QPair<int, int> range(const Segment &segment, const QString &key) const;
+
+        const QHash<int, NameList> &m_Lists;
+        QHash<int, Segment> m_Segments;
+        QMutex m_Mutex;
+};
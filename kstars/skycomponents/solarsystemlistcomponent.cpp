@@ -69,6 +69,9 @@ void SolarSystemListComponent::updateSolarSystemBodies(KSNumbers *num)
             if (p->hasTrail())
                 p->updateTrail(data->lst(), data->geo()->lat());
         }
+
+        // The bodies moved, their catalog coordinates with them
+        invalidateTrixelIndex();
     }
 }
 
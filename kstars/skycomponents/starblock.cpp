@@ -18,11 +18,14 @@
 #include <QDebug>
 
 #include "starblock.h"
+#include "ksnumbers.h"
 #include "skyobjects/starobject.h"
 #include "starcomponent.h"
 #include "skyobjects/stardata.h"
 #include "skyobjects/deepstardata.h"
 
+#include <cmath>
+
 #ifdef KSTARS_LITE
 #include "skymaplite.h"
 #include "kstarslite/skyitems/skynodes/pointsourcenode.h"
@@ -44,10 +47,11 @@ StarNode::~StarNode()
 StarBlock::StarBlock(int nstars)
     : faintMag(-5), brightMag(35), parent(nullptr), prev(nullptr), next(nullptr), drawID(0), nStars(0),
 #ifdef KSTARS_LITE
-      stars(nstars, StarNode())
+      stars(nstars, StarNode()),
 #else
-      stars(nstars, StarObject())
+      stars(nstars, StarObject()),
 #endif
+      m_X0(nstars), m_Y0(nstars), m_Z0(nstars), m_PMX(nstars), m_PMY(nstars), m_PMZ(nstars), m_PMRate(nstars)
 {
 }
 
@@ -62,15 +66,141 @@ void StarBlock::reset()
     nStars    = 0;
 }
 
+StarObject &StarBlock::starObject(int i)
+{
+#ifdef KSTARS_LITE
+    return stars[i].star;
+#else
+    return stars[i];
+#endif
+}
+
+void StarBlock::setCatalogData(int i, const StarObject &star)
+{
+    double sinRA, cosRA, sinDec, cosDec;
+    star.ra0().SinCos(sinRA, cosRA);
+    star.dec0().SinCos(sinDec, cosDec);
+
+    m_X0[i] = cosRA * cosDec;
+    m_Y0[i] = sinRA * cosDec;
+    m_Z0[i] = sinDec;
+
+    // The star moves along the great circle leaving its position with the bearing atan2(pmRA, pmDec), at the rate
+    // given by the magnitude of the proper motion, see StarObject::getIndexCoords()
+    const double norm = std::hypot(star.pmRA(), star.pmDec());
+    const double rate = star.pmMagnitude();
+    if (norm > 0 && std::isfinite(rate))
+    {
+        const double east  = star.pmRA() / norm;
+        const double north = star.pmDec() / norm;
+        m_PMX[i]    = -sinRA * east - sinDec * cosRA * north;
+        m_PMY[i]    = cosRA * east - sinDec * sinRA * north;
+        m_PMZ[i]    = cosDec * north;
+        m_PMRate[i] = rate;
+    }
+    else
+    {
+        m_PMX[i] = m_PMY[i] = m_PMZ[i] = 0;
+        m_PMRate[i] = 0;
+    }
+}
+
+void StarBlock::precessStars(const KSNumbers *num, int first, int last, double *x, double *y, double *z) const
+{
+    const Eigen::Matrix3d &p = num->p2();
+    const double p00 = p(0, 0), p01 = p(0, 1), p02 = p(0, 2);
+    const double p10 = p(1, 0), p11 = p(1, 1), p12 = p(1, 2);
+    const double p20 = p(2, 0), p21 = p(2, 1), p22 = p(2, 2);
+    const double millenia = num->julianMillenia();
+
+    const double *x0 = m_X0.constData(), *y0 = m_Y0.constData(), *z0 = m_Z0.constData();
+    const double *pmx = m_PMX.constData(), *pmy = m_PMY.constData(), *pmz = m_PMZ.constData();
+    const double *rate = m_PMRate.constData();
+
+    for (int i = first; i < last; ++i)
+    {
+        double sx = x0[i], sy = y0[i], sz = z0[i];
+
+        // Proper motion in arcseconds, ignored below one arcsecond like StarObject::getIndexCoords() does
+        const double pm = rate[i] * millenia;
+        if (pm * pm >= 1.)
+        {
+            const double distance = pm * M_PI / (180.0 * 3600.0);
+            const double sinDst = sin(distance), cosDst = cos(distance);
+            sx = sx * cosDst + pmx[i] * sinDst;
+            sy = sy * cosDst + pmy[i] * sinDst;
+            sz = sz * cosDst + pmz[i] * sinDst;
+        }
+
+        // Same rotation as SkyPoint::precess()
+        x[i - first] = p00 * sx + p01 * sy + p02 * sz;
+        y[i - first] = p10 * sx + p11 * sy + p12 * sz;
+        z[i - first] = p20 * sx + p21 * sy + p22 * sz;
+    }
+}
+
+void StarBlock::JITupdate(float maglim)
+{
+    const StarObject::JITContext context;
+
+    // Stars are sorted by magnitude, the first star fainter than the limit is the last one updated
+    int count = 0;
+    while (count < nStars)
+    {
+        if (starObject(count++).mag() > maglim)
+            break;
+    }
+
+    // Whether light bending applies is decided star by star, those updates are left to the stars
+    if (context.useRelativistic)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            StarObject &star = starObject(i);
+            if (star.updateID != context.updateID)
+                star.JITupdate(context);
+        }
+        return;
+    }
+
+    // Coordinates are recomputed once per solar minute, usually for all the stars of the block at once
+    int first = 0;
+    while (first < count &&
+           (starObject(first).updateID == context.updateID || !starObject(first).JITneedsPrecession(context)))
+        ++first;
+
+    QVector<double> x, y, z;
+    if (first < count)
+    {
+        x.resize(count - first);
+        y.resize(count - first);
+        z.resize(count - first);
+        precessStars(context.num, first, count, x.data(), y.data(), z.data());
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        StarObject &star = starObject(i);
+        if (star.updateID == context.updateID)
+            continue;
+
+        if (i >= first && star.JITneedsPrecession(context))
+            star.JITupdate(context, x[i - first], y[i - first], z[i - first]);
+        else
+            star.JITupdate(context);
+    }
+}
+
 #ifdef KSTARS_LITE
 StarNode *StarBlock::addStar(const StarData &data)
 {
     if (isFull())
         return 0;
-    StarNode &node   = stars[nStars++];
+    StarNode &node   = stars[nStars];
     StarObject &star = node.star;
 
     star.init(&data);
+    setCatalogData(nStars++, star);
     if (star.mag() > faintMag)
         faintMag = star.mag();
     if (star.mag() < brightMag)
@@ -82,10 +212,11 @@ StarNode *StarBlock::addStar(const DeepStarData &data)
 {
     if (isFull())
         return 0;
-    StarNode &node   = stars[nStars++];
+    StarNode &node   = stars[nStars];
     StarObject &star = node.star;
 
     star.init(&data);
+    setCatalogData(nStars++, star);
     if (star.mag() > faintMag)
         faintMag = star.mag();
     if (star.mag() < brightMag)
@@ -97,9 +228,10 @@ StarObject *StarBlock::addStar(const StarData &data)
 {
     if (isFull())
         return nullptr;
-    StarObject &star = stars[nStars++];
+    StarObject &star = stars[nStars];
 
     star.init(&data);
+    setCatalogData(nStars++, star);
     if (star.mag() > faintMag)
         faintMag = star.mag();
     if (star.mag() < brightMag)
@@ -111,9 +243,10 @@ StarObject *StarBlock::addStar(const DeepStarData &data)
 {
     if (isFull())
         return nullptr;
-    StarObject &star = stars[nStars++];
+    StarObject &star = stars[nStars];
 
     star.init(&data);
+    setCatalogData(nStars++, star);
     if (star.mag() > faintMag)
         faintMag = star.mag();
     if (star.mag() < brightMag)
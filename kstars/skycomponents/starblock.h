@@ -22,6 +22,7 @@
 
 #include <QVector>
 
+class KSNumbers;
 class StarObject;
 class StarBlockList;
 class PointSourceNode;
@@ -143,6 +144,31 @@ class StarBlock
     /** @short  Reset this StarBlock's data, for reuse of the StarBlock */
     void reset();
 
+    /**
+     * @short  Bring the stars of this block up to date for the current frame
+     *
+     * The per frame values are looked up once for the whole block. Stars are sorted by magnitude,
+     * so the update stops after the first star fainter than the limit. When the coordinates are due
+     * to be recomputed, proper motion and precession are applied to the block at once by precessStars(),
+     * the stars then finish the update with nutation, aberration and their horizontal coordinates.
+     *
+     * @param  maglim Magnitude limit of the stars to update
+     */
+    void JITupdate(float maglim);
+
+    /**
+     * @short  Apply proper motion and precession to the catalog positions of a range of stars
+     *
+     * This works on the catalog arrays of the block only, so that the loop runs over contiguous data
+     * and never touches the StarObjects.
+     *
+     * @param  num   Time dependent values of the epoch to precess to
+     * @param  first Index of the first star to precess
+     * @param  last  Index past the last star to precess
+     * @param  x, y, z Components of the unit vectors of the precessed positions, starting at index 0 for first
+     */
+    void precessStars(const KSNumbers *num, int first, int last, double *x, double *y, double *z) const;
+
     float faintMag { 0 };
     float brightMag { 0 };
     StarBlockList *parent;
@@ -155,8 +181,22 @@ class StarBlock
     StarBlock(const StarBlock &);
     StarBlock &operator=(const StarBlock &);
 
+    /** @return the i-th star, whichever the type of the entries */
+    StarObject &starObject(int i);
+
+    /** Fill the catalog arrays at the index of a star just initialized */
+    void setCatalogData(int i, const StarObject &star);
+
     /** Number of initialized stars in StarBlock. */
     int nStars { 0 };
     /** Array of stars. */
     QVector<StarBlockEntry> stars;
+
+    /**
+     * Catalog data of the stars as a structure of arrays, indexed like the stars. Positions are J2000 unit
+     * vectors, proper motions the unit vector along which the star moves on the sky and its rate in mas/yr.
+     */
+    QVector<double> m_X0, m_Y0, m_Z0;
+    QVector<double> m_PMX, m_PMY, m_PMZ;
+    QVector<double> m_PMRate;
 };
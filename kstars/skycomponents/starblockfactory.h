@@ -19,6 +19,8 @@
 
 #include "typedef.h"
 
+#include <QMutex>
+
 class StarBlock;
 
 /**
@@ -94,6 +96,14 @@ class StarBlockFactory
      */
     void printStructure() const;
 
+    /**
+     * @short  Lock serializing changes to the cache and to the StarBlockLists filled from it
+     *
+     * Blocks are recycled across trixels and catalogs, so anything reading or filling a
+     * dynamically loaded StarBlockList must hold this lock while a prefetch may be running.
+     */
+    inline QMutex *mutex() { return &m_Mutex; }
+
     quint32 drawID; // A number identifying the current draw cycle
 
   private:
@@ -114,6 +124,7 @@ class StarBlockFactory
     std::shared_ptr<StarBlock> first, last; // Pointers to the beginning and end of the linked list
     int nBlocks;             // Number of blocks we currently have in the cache
     int nCache;              // Number of blocks to start recycling cached blocks at
+    QMutex m_Mutex;
 
     static StarBlockFactory *pInstance;
 };
@@ -70,6 +70,11 @@ int StarBlockList::releaseBlock(StarBlock *block)
     return 0;
 }
 
+bool StarBlockList::isFilledToMag(float maglim) const
+{
+    return staticStars || faintMag >= maglim || nStars >= parent->getStarReader()->getRecordCount(trixel);
+}
+
 bool StarBlockList::fillToMag(float maglim)
 {
     // TODO: Remove staticity of BinFileHelper
@@ -89,7 +94,10 @@ bool StarBlockList::fillToMag(float maglim)
     if (faintMag >= maglim)
         return true;
 
-    if (!dataFile)
+    // A mapped catalog is decoded in place, otherwise records are read one by one from the file
+    const bool mapped = dSReader->isMapped();
+
+    if (!mapped && !dataFile)
     {
         qDebug() << "dataFile not opened!";
         return false;
@@ -103,7 +111,8 @@ bool StarBlockList::fillToMag(float maglim)
 
     Q_ASSERT(nBlocks == (unsigned int)blocks.size());
 
-    BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
+    if (!mapped)
+        BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
 
     /*
     qDebug() << "Reading trixel" << trixel << ", id on disk =" << trixelId << ", currently nStars =" << nStars
@@ -113,7 +122,7 @@ bool StarBlockList::fillToMag(float maglim)
 
     while (maglim >= faintMag && nStars < dSReader->getRecordCount(trixelId))
     {
-        int ret = 0;
+        bool ret = false;
 
         if (nBlocks == 0 || blocks[nBlocks - 1]->isFull())
         {
@@ -137,17 +146,23 @@ bool StarBlockList::fillToMag(float maglim)
         // TODO: Make this more general
         if (dSReader->guessRecordSize() == 32)
         {
-            ret = fread(&stardata, sizeof(StarData), 1, dataFile);
-            if (dSReader->getByteSwap())
+            if (mapped)
+                ret = parent->readMappedRecord(readOffset, &stardata);
+            else if ((ret = fread(&stardata, sizeof(StarData), 1, dataFile)) && dSReader->getByteSwap())
                 DeepStarComponent::byteSwap(&stardata);
+            if (!ret)
+                break;
             readOffset += sizeof(StarData);
             blocks[nBlocks - 1]->addStar(stardata);
         }
         else
         {
-            ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
-            if (dSReader->getByteSwap())
+            if (mapped)
+                ret = parent->readMappedRecord(readOffset, &deepstardata);
+            else if ((ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile)) && dSReader->getByteSwap())
                 DeepStarComponent::byteSwap(&deepstardata);
+            if (!ret)
+                break;
             readOffset += sizeof(DeepStarData);
             blocks[nBlocks - 1]->addStar(deepstardata);
         }
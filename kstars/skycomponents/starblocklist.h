@@ -48,6 +48,14 @@ class StarBlockList
      */
     bool fillToMag(float maglim);
 
+    /**
+     * @short Tells whether the list already holds all of its stars brighter than the given limit
+     *
+     * @param maglim Magnitude limit to check
+     * @return true if fillToMag( maglim ) would not need to read anything
+     */
+    bool isFilledToMag(float maglim) const;
+
     /**
      * @short Sets the first StarBlock in the list to point to the given StarBlock
      *
@@ -223,6 +223,14 @@ float StarComponent::faintMagnitude() const
     return faintmag;
 }
 
+float StarComponent::sizeMagnitudeLimit() const
+{
+    float sizeMagLim = zoomMagnitudeLimit();
+    if (sizeMagLim > faintMagnitude() * (1 - 1.5 / 16))
+        sizeMagLim = faintMagnitude() * (1 - 1.5 / 16);
+    return sizeMagLim;
+}
+
 float StarComponent::zoomMagnitudeLimit()
 {
     //adjust maglimit for ZoomLevel
@@ -265,7 +273,8 @@ void StarComponent::draw(SkyPainter *skyp)
     SkyMap *map           = SkyMap::Instance();
     const Projector *proj = map->projector();
     KStarsData *data      = KStarsData::Instance();
-    UpdateID updateID     = data->updateID();
+    // Per frame values for the JIT update of every star drawn below
+    const StarObject::JITContext jitContext;
 
     bool checkSlewing = (map->isSlewing() && Options::hideOnSlew());
     m_hideLabels      = checkSlewing || !(Options::showStarMagnitudes() || Options::showStarNames());
@@ -298,10 +307,7 @@ void StarComponent::draw(SkyPainter *skyp)
     // Not using this formula now.
     //    float sizeMagLim = 4.444 * ( lgz - lgmin ) + 5.0;
 
-    float sizeMagLim = zoomMagnitudeLimit();
-    if (sizeMagLim > faintMagnitude() * (1 - 1.5 / 16))
-        sizeMagLim = faintMagnitude() * (1 - 1.5 / 16);
-    skyp->setSizeMagLimit(sizeMagLim);
+    skyp->setSizeMagLimit(sizeMagnitudeLimit());
 
     //Loop for drawing star images
 
@@ -312,8 +318,6 @@ void StarComponent::draw(SkyPainter *skyp)
     if (hideFaintStars && maglim > hideStarsMag)
         maglim = hideStarsMag;
 
-    m_StarBlockFactory->drawID = m_skyMesh->drawID();
-
     int nTrixels = 0;
 
     while (region.hasNext())
@@ -333,8 +337,8 @@ void StarComponent::draw(SkyPainter *skyp)
             if (mag > maglim)
                 break;
 
-            if (star->updateID != updateID)
-                star->JITupdate();
+            if (star->updateID != jitContext.updateID)
+                star->JITupdate(jitContext);
 
             bool drawn = skyp->drawPointSource(star, mag, star->spchar());
 
@@ -347,13 +351,29 @@ void StarComponent::draw(SkyPainter *skyp)
     // Draw focusStar if not null
     if (focusStar)
     {
-        if (focusStar->updateID != updateID)
-            focusStar->JITupdate();
+        if (focusStar->updateID != jitContext.updateID)
+            focusStar->JITupdate(jitContext);
         float mag = focusStar->mag();
         skyp->drawPointSource(focusStar, mag, focusStar->spchar());
     }
+#else
+    Q_UNUSED(skyp)
+#endif
+}
+
+void StarComponent::drawDeepStars(SkyPainter *skyp)
+{
+#ifndef KSTARS_LITE
+    if (!selected())
+        return;
+
+    skyp->setSizeMagLimit(sizeMagnitudeLimit());
+
+    {
+        QMutexLocker locker(m_StarBlockFactory->mutex());
+        m_StarBlockFactory->drawID = m_skyMesh->drawID();
+    }
 
-    // Now draw each of our DeepStarComponents
     for (auto &component : m_DeepStarComponents)
     {
         component->draw(skyp);
@@ -391,10 +411,7 @@ void StarComponent::drawLabels()
     {
         LabelList *list = m_labelList[i];
 
-        for (const auto &item : *list)
-        {
-            labeler->drawNameLabel(item.obj, item.o);
-        }
+        labeler->drawNameLabels(*list);
         list->clear();
     }
 }
@@ -643,16 +660,21 @@ StarObject *StarComponent::findByHDIndex(int HDnum)
         ret = fread(&offset, 4, 1, hdidxFile);
         if (offset <= 0)
             return nullptr;
-        dataFile = m_DeepStarComponents.at(1)->getStarReader()->getFileHandle();
-        //KDE_fseek( dataFile, offset, SEEK_SET );
-        QT_FSEEK(dataFile, offset, SEEK_SET);
-        {
-            int rc = fread(&stardata, sizeof(StarData), 1, dataFile);
-            Q_UNUSED(rc)
-        }
-        if (m_DeepStarComponents.at(1)->getStarReader()->getByteSwap())
+        if (!m_DeepStarComponents.at(1)->readMappedRecord(offset, &stardata))
         {
-            byteSwap(&stardata);
+            // The catalog file is shared with the background prefetch of its blocks
+            QMutexLocker locker(m_StarBlockFactory->mutex());
+            dataFile = m_DeepStarComponents.at(1)->getStarReader()->getFileHandle();
+            //KDE_fseek( dataFile, offset, SEEK_SET );
+            QT_FSEEK(dataFile, offset, SEEK_SET);
+            {
+                int rc = fread(&stardata, sizeof(StarData), 1, dataFile);
+                Q_UNUSED(rc)
+            }
+            if (m_DeepStarComponents.at(1)->getStarReader()->getByteSwap())
+            {
+                byteSwap(&stardata);
+            }
         }
         m_starObject.init(&stardata);
         m_starObject.EquatorialToHorizontal(data->lst(), data->geo()->lat());
@@ -721,6 +743,14 @@ SkyObject *StarComponent::objectNearest(SkyPoint *p, double &maxrad)
     return oBest;
 }
 
+void StarComponent::setPrefetchTarget(const SkyPoint &target)
+{
+    for (auto &component : m_DeepStarComponents)
+    {
+        component->setPrefetchTarget(target);
+    }
+}
+
 void StarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoint &center, float radius, float maglim)
 {
     // Ensure that we have deprecessed the (RA, Dec) to (RA0, Dec0)
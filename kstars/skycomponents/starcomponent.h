@@ -80,8 +80,12 @@ class StarComponent : public ListComponent
 
     bool selected() override;
 
+    /** @short draw the named stars; the unnamed ones are drawn by drawDeepStars() */
     void draw(SkyPainter *skyp) override;
 
+    /** @short draw the stars of the deep star catalogs, which carry no labels */
+    void drawDeepStars(SkyPainter *skyp);
+
     /**
      * @short draw all the labels in the prioritized LabelLists and then clear the LabelLists.
      */
@@ -112,6 +116,12 @@ class StarComponent : public ListComponent
      */
     StarObject *findByHDIndex(int HDnum);
 
+    /**
+     * @short Start loading the unnamed stars around a point the view is about to move to
+     * @param target Point the sky map is expected to follow, like the target of a telescope slew
+     */
+    void setPrefetchTarget(const SkyPoint &target);
+
 
     /**
      * @short Append a star to the Object List. (including genetive name)
@@ -152,6 +162,9 @@ class StarComponent : public ListComponent
     /** @return the magnitude of the faintest star */
     float faintMagnitude() const;
 
+    /** @return the magnitude below which stars are all drawn with the smallest size */
+    float sizeMagnitudeLimit() const;
+
     /** true if all stars(not only high PM ones) were reindexed else false**/
     bool reindex(KSNumbers *num);
 
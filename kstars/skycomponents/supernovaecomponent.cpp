@@ -65,6 +65,7 @@ void SupernovaeComponent::loadData()
 
     objectNames(SkyObject::SUPERNOVA).clear();
     objectLists(SkyObject::SUPERNOVA).clear();
+    objectListsChanged(SkyObject::SUPERNOVA);
 
     QString name, type, host, date, ra, de;
     float z, mag;
@@ -146,21 +147,7 @@ SkyObject *SupernovaeComponent::objectNearest(SkyPoint *p, double &maxrad)
     if (!selected() || !m_DataLoaded)
         return nullptr;
 
-    SkyObject *oBest = nullptr;
-    double rBest     = maxrad;
-
-    for (auto so : m_ObjectList)
-    {
-        double r = so->angularDistanceTo(p).Degrees();
-        //qDebug()<<r;
-        if (r < rBest)
-        {
-            oBest = so;
-            rBest = r;
-        }
-    }
-    maxrad = rBest;
-    return oBest;
+    return indexedObjectNearest(p, maxrad);
 }
 
 float SupernovaeComponent::zoomMagnitudeLimit()
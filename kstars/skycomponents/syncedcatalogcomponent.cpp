@@ -150,6 +150,7 @@ bool SyncedCatalogComponent::removeObject(SkyObject &object)
     {
         objectNames()[object.type()].removeAll(name);
         objectLists()[object.type()].removeAll(QPair<QString, const SkyObject *>(name, &object));
+        objectListsChanged(object.type());
     } else {
         qWarning() << "Can't find SkyObject " << name << " in the synced catalog " << m_catName;
         return false;
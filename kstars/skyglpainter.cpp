@@ -30,6 +30,7 @@
 
 #include "skymap.h"
 #include "kstarsdata.h"
+#include "ksutils.h"
 #include "Options.h"
 
 #include "texturemanager.h"
@@ -148,6 +149,12 @@ bool SkyGLPainter::addItem(SkyPoint *p, int type, float width, char sp)
     if (!visible)
         return false;
 
+    addItem(vec, type, width, sp);
+    return true;
+}
+
+void SkyGLPainter::addItem(const Vector2f &vec, int type, float width, char sp)
+{
     // Prevent crash if type > UNKNOWN
     if (type > SkyObject::TYPE_UNKNOWN)
         type = SkyObject::TYPE_UNKNOWN;
@@ -244,7 +251,6 @@ bool SkyGLPainter::addItem(SkyPoint *p, int type, float width, char sp)
     }
 
     ++m_idx[type];
-    return true;
 }
 
 void SkyGLPainter::drawTexturedRectangle(const QImage &img, const Vector2f &pos, const float angle, const float sizeX,
@@ -413,6 +419,12 @@ bool SkyGLPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
     return addItem(loc, SkyObject::STAR, starWidth(mag), sp);
 }
 
+void SkyGLPainter::drawPointSources(const QVector<ProjectedPointSource> &sources)
+{
+    for (const auto &source : sources)
+        addItem(KSUtils::pointToVec(source.pos), SkyObject::STAR, starWidth(source.mag), source.sp);
+}
+
 void SkyGLPainter::drawSkyPolygon(LineList *list)
 {
     SkyList *points = list->points();
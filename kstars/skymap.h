@@ -66,6 +66,7 @@ class SkyMap : public QGraphicsView
 
         friend class SkyMapDrawAbstract; // FIXME: SkyMapDrawAbstract requires a lot of access to SkyMap
         friend class SkyMapQDraw;        // FIXME: SkyMapQDraw requires access to computeSkymap
+        friend class SkyMapLayerCache;   // Renders layers with the projector grown around the view
 
     protected:
         /**
@@ -40,6 +40,7 @@
 #include "skycomponents/constellationboundarylines.h"
 #include "skycomponents/skylabeler.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skymapprofiler.h"
 #include "skyqpainter.h"
 #include "projections/projector.h"
 #include "projections/lambertprojector.h"
@@ -102,6 +103,9 @@ void SkyMapDrawAbstract::drawOverlays(QPainter &p, bool drawFov)
         m_SkyMap->updateAngleRuler();
         drawAngleRuler(p);
     }
+
+    if (Options::showFrameProfile())
+        drawFrameProfile(p);
 }
 
 void SkyMapDrawAbstract::drawAngleRuler(QPainter &p)
@@ -115,6 +119,47 @@ void SkyMapDrawAbstract::drawAngleRuler(QPainter &p)
                                        1))); // FIXME: Again, AngularRuler should be something better -- maybe a class in itself. After all it's used for more than one thing after we integrate the StarHop feature.
 }
 
+void SkyMapDrawAbstract::drawFrameProfile(QPainter &psky)
+{
+    // About half a second of a smoothly moving map, long enough to read the numbers
+    const SkyMapProfiler::Frame frame = SkyMapProfiler::Instance()->average(30);
+    if (frame.components.isEmpty())
+        return;
+
+    QStringList lines;
+    lines << QString("Frame: %1 ms").arg(frame.drawTime, 0, 'f', 1);
+    for (const auto &component : frame.components)
+    {
+        QString line = QString("%1: %2 + %3 ms, %4 objects, %5 trig")
+                       .arg(component.name)
+                       .arg(component.updateTime, 0, 'f', 1)
+                       .arg(component.drawTime, 0, 'f', 1)
+                       .arg(component.objects)
+                       .arg(component.trigCalls);
+        if (component.cacheHits + component.cacheMisses > 0)
+            line += QString(", %1/%2 cached").arg(component.cacheHits).arg(component.cacheHits + component.cacheMisses);
+        lines << line;
+    }
+
+    psky.save();
+    QFont font = psky.font();
+    font.setStyleHint(QFont::Monospace);
+    font.setFamily("Monospace");
+    psky.setFont(font);
+
+    const QFontMetrics metrics(font);
+    const QString text = lines.join('\n');
+    QRect box = metrics.boundingRect(QRect(0, 0, m_SkyMap->width(), m_SkyMap->height()), Qt::AlignLeft, text);
+    box.moveBottomLeft(QPoint(10, m_SkyMap->height() - 10));
+
+    QColor background = m_KStarsData->colorScheme()->colorNamed("BoxBGColor");
+    background.setAlpha(192);
+    psky.fillRect(box.adjusted(-5, -5, 5, 5), background);
+    psky.setPen(m_KStarsData->colorScheme()->colorNamed("BoxTextColor"));
+    psky.drawText(box, Qt::AlignLeft, text);
+    psky.restore();
+}
+
 void SkyMapDrawAbstract::drawZoomBox(QPainter &p)
 {
     //draw the manual zoom-box, if it exists
@@ -91,6 +91,13 @@ class SkyMapDrawAbstract
         	*/
     void drawAngleRuler(QPainter &psky);
 
+    /**
+        	*@short Draw the time spent in each component of the sky map, averaged over the last frames profiled.
+        	*@param psky reference to the QPainter on which to draw (this should be the Sky pixmap).
+        	*@see SkyMapProfiler
+        	*/
+    void drawFrameProfile(QPainter &psky);
+
     /** @short Draw the current Sky map to a pixmap which is to be printed or exported to a file.
         	*
         	*@param pd pointer to the QPaintDevice on which to draw.
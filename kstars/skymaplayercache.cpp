@@ -0,0 +1,190 @@
+/*  Sky Map Layer Cache
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "skymaplayercache.h"
+
+#include "kstarsdata.h"
+#include "Options.h"
+#include "skymap.h"
+#include "skyqpainter.h"
+#include "projections/projector.h"
+#include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skymapprofiler.h"
+#include "skycomponents/starcomponent.h"
+
+#include <QPainterPath>
+
+namespace
+{
+// Upper bound of the margin rendered around the view, in pixels
+constexpr int MAX_MARGIN = 64;
+// How much the anchors of a layer may disagree on its offset before a translation no longer fits, in pixels
+constexpr double MAX_DISTORTION = 0.5;
+}
+
+SkyMapLayerCache::SkyMapLayerCache(SkyMap *map) : m_SkyMap(map)
+{
+}
+
+void SkyMapLayerCache::clear()
+{
+    for (Layer &cached : m_Layers)
+        cached = Layer();
+}
+
+bool SkyMapLayerCache::draw(SkyPainter::CachedLayer layer, QPainter *painter)
+{
+    if (m_SkyMap->width() <= 0 || m_SkyMap->height() <= 0)
+        return false;
+
+    Layer &cached = m_Layers[layer];
+    const QVariantList key = layerKey(layer);
+
+    QPoint offset;
+    if (!cached.complete || cached.key != key || !findOffset(cached, offset))
+    {
+        render(layer, cached);
+        cached.key = key;
+        offset     = QPoint();
+        SkyMapProfiler::Instance()->addCacheLookups(0, 1);
+    }
+    else
+        SkyMapProfiler::Instance()->addCacheLookups(1, 0);
+
+    painter->drawPixmap(offset - QPoint(cached.margin, cached.margin), cached.pixmap);
+    return true;
+}
+
+QVariantList SkyMapLayerCache::layerKey(SkyPainter::CachedLayer layer) const
+{
+    KStarsData *data = KStarsData::Instance();
+
+    // Where the sky is on screen is tracked by the anchors, everything else that shapes a layer goes here
+    QVariantList key;
+    key << m_SkyMap->size() << Options::projection() << Options::zoomFactor() << Options::useAltAz()
+        << Options::useRefraction() << Options::useAntialias() << m_SkyMap->isSlewing();
+
+    switch (layer)
+    {
+        case SkyPainter::BACKGROUND_LAYER:
+            key << Options::showMilkyWay() << Options::fillMilkyWay() << data->colorScheme()->colorNamed("MWColor")
+                << Options::showHIPS() << Options::hIPSSource() << Options::hIPSPanning() << Options::hIPSShowGrid()
+                << Options::hIPSBiLinearInterpolation() << data->colorScheme()->colorNamed("HIPSGridColor");
+            break;
+
+        case SkyPainter::CONSTELLATION_ART_LAYER:
+            key << Options::showConstellationArt() << data->skyComposite()->currentCulture();
+            break;
+
+        case SkyPainter::FAINT_STARS_LAYER:
+            key << Options::showStars() << StarComponent::zoomMagnitudeLimit() << Options::hideOnSlew()
+                << Options::hideStars() << Options::magLimitHideStar() << Options::starColorMode()
+                << Options::starColorIntensity();
+            break;
+
+        default:
+            break;
+    }
+
+    return key;
+}
+
+bool SkyMapLayerCache::findOffset(const Layer &cached, QPoint &offset) const
+{
+    if (cached.anchors.isEmpty())
+        return false;
+
+    KStarsData *data      = KStarsData::Instance();
+    const Projector *proj = m_SkyMap->projector();
+    QPointF shift;
+
+    for (int i = 0; i < cached.anchors.size(); ++i)
+    {
+        // The anchors keep their equatorial coordinates, the horizontal ones follow the clock
+        SkyPoint anchor = cached.anchors.at(i);
+        anchor.EquatorialToHorizontal(data->lst(), data->geo()->lat());
+
+        bool visible = false;
+        const QPointF position = proj->toScreen(&anchor, true, &visible);
+        if (!visible)
+            return false;
+
+        const QPointF moved = position - (cached.anchorPositions.at(i) - QPointF(cached.margin, cached.margin));
+        if (i == 0)
+            shift = moved;
+        // A rotation or a change of scale shows up as anchors moving apart
+        else if ((moved - shift).manhattanLength() > MAX_DISTORTION)
+            return false;
+    }
+
+    if (qAbs(shift.x()) > cached.margin || qAbs(shift.y()) > cached.margin)
+        return false;
+
+    offset = shift.toPoint();
+    return true;
+}
+
+void SkyMapLayerCache::render(SkyPainter::CachedLayer layer, Layer &cached)
+{
+    KStarsData *data = KStarsData::Instance();
+
+    // The draw aperture covers the view plus one degree, content past that would be missing from the margin
+    cached.margin = qBound(0, static_cast<int>(0.7 * Options::zoomFactor() * dms::DegToRad), MAX_MARGIN);
+    const QSize size(m_SkyMap->width() + 2 * cached.margin, m_SkyMap->height() + 2 * cached.margin);
+    if (cached.pixmap.size() != size)
+        cached.pixmap = QPixmap(size);
+    cached.pixmap.fill(Qt::transparent);
+
+    // Grow the view by the margin on every side. The ground is left out, it is drawn over the layers
+    // anyway while the horizon crosses the sky as time passes.
+    ViewParams p;
+    p.focus         = m_SkyMap->focus();
+    p.width         = size.width();
+    p.height        = size.height();
+    p.useAltAz      = Options::useAltAz();
+    p.useRefraction = Options::useRefraction();
+    p.zoomFactor    = Options::zoomFactor();
+    p.fillGround    = false;
+    m_SkyMap->m_proj->setViewParams(p);
+
+    const Projector *proj = m_SkyMap->projector();
+
+    SkyQPainter painter(&cached.pixmap, size);
+    painter.begin();
+    QPainterPath path;
+    path.addPolygon(proj->clipPoly());
+    painter.setClipPath(path);
+    painter.setClipping(true);
+    data->skyComposite()->drawLayer(layer, &painter);
+    painter.end();
+
+    // HiPS tiles that are still being fetched show up in one of the next frames
+    cached.complete = !(layer == SkyPainter::BACKGROUND_LAYER && !painter.isHipsComplete());
+
+    // Sample the sky at the center and a quarter of the view away on each axis
+    cached.anchors.clear();
+    cached.anchorPositions.clear();
+    const QPointF center(size.width() / 2.0, size.height() / 2.0);
+    const QPointF samples[] = { center, center + QPointF(m_SkyMap->width() / 4.0, 0),
+                                center + QPointF(0, m_SkyMap->height() / 4.0)
+                              };
+    for (const QPointF &sample : samples)
+    {
+        // Outside of the sky, e.g. past the edge of a zoomed out projection, a layer is not reused
+        if (proj->unusablePoint(sample))
+        {
+            cached.anchors.clear();
+            cached.anchorPositions.clear();
+            break;
+        }
+        cached.anchors.append(proj->fromScreen(sample, data->lst(), data->geo()->lat()));
+        cached.anchorPositions.append(sample);
+    }
+
+    m_SkyMap->setupProjector();
+}
@@ -0,0 +1,65 @@
+/*  Sky Map Layer Cache
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include "skypainter.h"
+#include "skyobjects/skypoint.h"
+
+#include <QPixmap>
+#include <QVariantList>
+#include <QVector>
+
+class QPainter;
+class SkyMap;
+
+/**
+ * @class SkyMapLayerCache
+ * Keeps the layers of the sky map that change slowly in their own pixmaps, so that a frame only renders
+ * the layers whose settings changed. Each layer is rendered with a margin around the view. As long as
+ * the sky has only shifted by less than that margin since, like after a small pan or a few seconds of
+ * a running clock, the layer is reused with a translation instead of being rendered again.
+ */
+class SkyMapLayerCache
+{
+    public:
+        explicit SkyMapLayerCache(SkyMap *map);
+
+        /** Drop every cached layer, e.g. after the sky map was resized. */
+        void clear();
+
+        /**
+         * @brief draw Draw a layer from the cache, rendering it first if it is out of date.
+         * @param layer Layer to draw.
+         * @param painter Painter of the sky map, in the middle of a draw cycle.
+         * @return false if nothing could be cached and the layer has to be drawn directly.
+         */
+        bool draw(SkyPainter::CachedLayer layer, QPainter *painter);
+
+    private:
+        struct Layer
+        {
+            QPixmap pixmap;
+            /// Settings the layer was rendered with
+            QVariantList key;
+            /// Pixels added on every side of the view
+            int margin { 0 };
+            /// Points of the sky and where they were rendered in the pixmap
+            QVector<SkyPoint> anchors;
+            QVector<QPointF> anchorPositions;
+            /// False if some content was still loading, like HiPS tiles
+            bool complete { false };
+        };
+
+        QVariantList layerKey(SkyPainter::CachedLayer layer) const;
+        bool findOffset(const Layer &cached, QPoint &offset) const;
+        void render(SkyPainter::CachedLayer layer, Layer &cached);
+
+        SkyMap *m_SkyMap { nullptr };
+        Layer m_Layers[SkyPainter::NUM_CACHED_LAYERS];
+};
@@ -23,7 +23,7 @@
 #include "kstars_debug.h"
 #include <QPainterPath>
 
-SkyMapQDraw::SkyMapQDraw(SkyMap *sm) : QWidget(sm), SkyMapDrawAbstract(sm)
+SkyMapQDraw::SkyMapQDraw(SkyMap *sm) : QWidget(sm), SkyMapDrawAbstract(sm), m_LayerCache(sm)
 {
     m_SkyPixmap = new QPixmap(width(), height());
 }
@@ -72,6 +72,8 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
     m_SkyMap->setupProjector();
 
     SkyQPainter psky(this, m_SkyPixmap);
+    // Slowly changing layers are only rendered again when their inputs change
+    psky.setLayerCache(&m_LayerCache);
     //FIXME: we may want to move this into the components.
     psky.begin();
 
@@ -110,4 +112,5 @@ void SkyMapQDraw::resizeEvent(QResizeEvent *e)
     Q_UNUSED(e)
     delete m_SkyPixmap;
     m_SkyPixmap = new QPixmap(width(), height());
+    m_LayerCache.clear();
 }
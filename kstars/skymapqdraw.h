@@ -19,6 +19,7 @@
 #define SKYMAPQDRAW_H_
 
 #include "skymapdrawabstract.h"
+#include "skymaplayercache.h"
 
 #include <QWidget>
 
@@ -50,6 +51,7 @@ class SkyMapQDraw : public QWidget, public SkyMapDrawAbstract
     void resizeEvent(QResizeEvent *e) override;
 
     QPixmap *m_SkyPixmap;
+    SkyMapLayerCache m_LayerCache;
 };
 
 #endif
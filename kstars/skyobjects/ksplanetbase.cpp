@@ -152,6 +152,17 @@ void KSPlanetBase::findPosition(const KSNumbers *num, const CachingDms *lat, con
     }
 }
 
+void KSPlanetBase::findPositionOnly(const KSNumbers *num, const CachingDms *lat, const CachingDms *LST,
+                                    const KSPlanetBase *Earth)
+{
+    lastPrecessJD = num->julianDay();
+
+    findGeocentricPosition(num, Earth); //private function, reimplemented in each subclass
+
+    if (lat && LST)
+        localizeCoords(num, lat, LST); //correct for figure-of-the-Earth
+}
+
 bool KSPlanetBase::isMajorPlanet() const
 {
     if (name() == i18n("Mercury") || name() == i18n("Venus") || name() == i18n("Mars") || name() == i18n("Jupiter") ||
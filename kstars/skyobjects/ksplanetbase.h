@@ -182,6 +182,18 @@ class KSPlanetBase : public TrailObject
     void findPosition(const KSNumbers *num, const CachingDms *lat = nullptr, const CachingDms *LST = nullptr,
                       const KSPlanetBase *Earth = nullptr);
 
+    /**
+     * @short Find position only, as findPosition() does, leaving phase, angular size, trail and magnitude alone.
+     * Those read the planets of the sky map and load textures, so this is the variant for a planet computed on
+     * its own, possibly on another thread.
+     * @param num KSNumbers pointer for the target date/time
+     * @param lat pointer to the geographic latitude; if nullptr, we skip localizeCoords()
+     * @param LST pointer to the local sidereal time; if nullptr, we skip localizeCoords()
+     * @param Earth pointer to the Earth (not used for the Moon)
+     */
+    void findPositionOnly(const KSNumbers *num, const CachingDms *lat = nullptr, const CachingDms *LST = nullptr,
+                          const KSPlanetBase *Earth = nullptr);
+
     /** @return the Planet's position angle. */
     double pa() const override { return PositionAngle; }
 
@@ -276,7 +288,7 @@ class KSPlanetBase : public TrailObject
      * @short correct the position for the fact that the location is not at the center of the Earth,
      * but a position on its surface.  This causes a small parallactic shift in a solar system
      * body's apparent position.  The effect is most significant for the Moon.
-     * This function is private, and should only be called from the public findPosition() function.
+     * This function is private, and should only be called from the public findPosition() and findPositionOnly() functions.
      * @param num pointer to a ksnumbers object for the target date/time
      * @param lat pointer to the geographic latitude of the location.
      * @param LST pointer to the local sidereal time.
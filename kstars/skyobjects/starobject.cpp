@@ -448,27 +448,69 @@ bool StarObject::getIndexCoords(const KSNumbers *num, double *ra, double *dec)
     return true;
 }
 
+StarObject::JITContext::JITContext()
+{
+    KStarsData *data = KStarsData::Instance();
+
+    num             = data->updateNum();
+    LST             = data->lst();
+    lat             = data->geo()->lat();
+    updateID        = data->updateID();
+    updateNumID     = data->updateNumID();
+    alwaysRecompute = Options::alwaysRecomputeCoordinates();
+    useRelativistic = Options::useRelativistic();
+}
+
 void StarObject::JITupdate()
 {
-    static KStarsData *data = KStarsData::Instance();
+    JITupdate(JITContext());
+}
 
-    if (updateNumID != data->updateNumID())
+void StarObject::JITupdate(const JITContext &context)
+{
+    if (updateNumID != context.updateNumID)
     {
         // TODO: This can be optimized and reorganized further in a better manner.
         // Maybe we should do this only for stars, since this is really a slow step only for stars
         Q_ASSERT(std::isfinite(lastPrecessJD));
 
-        if (Options::alwaysRecomputeCoordinates() || (Options::useRelativistic() && checkBendLight()) ||
-            std::abs(lastPrecessJD - data->updateNum()->getJD()) >= 0.00069444) // Update is once per solar minute
+        if (context.alwaysRecompute || (context.useRelativistic && checkBendLight()) ||
+            std::abs(lastPrecessJD - context.num->getJD()) >= 0.00069444) // Update is once per solar minute
         {
             // Short circuit right here, if recomputing coordinates is not required. NOTE: POTENTIALLY DANGEROUS
-            updateCoords(data->updateNum());
+            updateCoords(context.num);
         }
 
-        updateNumID = data->updateNumID();
+        updateNumID = context.updateNumID;
     }
-    EquatorialToHorizontal(data->lst(), data->geo()->lat());
-    updateID = data->updateID();
+    EquatorialToHorizontal(context.LST, context.lat);
+    updateID = context.updateID;
+}
+
+bool StarObject::JITneedsPrecession(const JITContext &context) const
+{
+    return updateNumID != context.updateNumID &&
+           (context.alwaysRecompute || std::abs(lastPrecessJD - context.num->getJD()) >= 0.00069444);
+}
+
+void StarObject::JITupdate(const JITContext &context, double x, double y, double z)
+{
+    // Same steps as updateCoords() once the position is precessed, see SkyPoint::precess()
+    CachingDms newRA, newDec;
+    newRA.setUsing_atan2(y, x);
+    newRA.reduceToRange(dms::ZERO_TO_2PI);
+    newDec.setUsing_asin(z);
+    setRA(newRA);
+    setDec(newDec);
+
+    nutate(context.num);
+    aberrate(context.num);
+    lastPrecessJD = context.num->getJD();
+    Q_ASSERT(std::isfinite(ra().Degrees()) && std::isfinite(dec().Degrees()));
+
+    updateNumID = context.updateNumID;
+    EquatorialToHorizontal(context.LST, context.lat);
+    updateID = context.updateID;
 }
 
 QString StarObject::sptype(void) const
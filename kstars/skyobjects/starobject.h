@@ -193,9 +193,46 @@ class StarObject : public SkyObject
     bool getIndexCoords(const KSNumbers *num, CachingDms &ra, CachingDms &dec);
     bool getIndexCoords(const KSNumbers *num, double *ra, double *dec);
 
+    /**
+     * @struct JITContext
+     * @short Per frame values shared by the JIT updates of a batch of stars.
+     * Collecting them once per batch keeps KStarsData and Options lookups out of the per star loop.
+     */
+    struct JITContext
+    {
+        /** Captures the current update number, sidereal time, location and coordinate options */
+        JITContext();
+
+        const KSNumbers *num { nullptr };
+        const CachingDms *LST { nullptr };
+        const CachingDms *lat { nullptr };
+        quint64 updateID { 0 };
+        quint64 updateNumID { 0 };
+        bool alwaysRecompute { false };
+        bool useRelativistic { false };
+    };
+
     /** @short added for JIT updates from both StarComponent and ConstellationLines */
     void JITupdate();
 
+    /** @short JIT update using per frame values collected once for a whole batch of stars */
+    void JITupdate(const JITContext &context);
+
+    /**
+     * @short JIT update from a position already corrected for proper motion and precessed, as
+     * StarBlock::precessStars() computes it for a whole block. Nutation and aberration are applied here.
+     * Only valid when JITneedsPrecession() is true, light bending is not considered.
+     *
+     * @param x, y, z unit vector of the precessed position
+     */
+    void JITupdate(const JITContext &context, double x, double y, double z);
+
+    /**
+     * @return true if the JIT update of the star for this context recomputes its coordinates, leaving out the
+     * check for light bending
+     */
+    bool JITneedsPrecession(const JITContext &context) const;
+
     /** @short returns the magnitude of the proper motion correction in milliarcsec/year */
     inline double pmMagnitude() const
     {
@@ -23,12 +23,15 @@
 #include "skymap.h"
 #include "Options.h"
 #include "kstarsdata.h"
+#include "ksutils.h"
+#include "projections/projector.h"
 #include "skycomponents/skiphashlist.h"
 #include "skycomponents/linelistlabel.h"
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/kscomet.h"
 #include "skyobjects/ksasteroid.h"
 #include "skyobjects/ksplanetbase.h"
+#include "skyobjects/starobject.h"
 #include "skyobjects/trailobject.h"
 #include "skyobjects/constellationsart.h"
 
@@ -42,6 +45,41 @@ void SkyPainter::setSizeMagLimit(float sizeMagLim)
     m_sizeMagLim = sizeMagLim;
 }
 
+void SkyPainter::projectPointSources(const Projector *projector, StarObject *stars, int count,
+                                     QVector<ProjectedPointSource> &sources)
+{
+    // Stars are projected in runs of this size, so that the scratch arrays stay on the stack
+    constexpr int batchSize = 256;
+    const SkyPoint *points[batchSize];
+    StarObject *candidates[batchSize];
+    Vector2f screen[batchSize];
+    bool visible[batchSize];
+
+    for (int first = 0; first < count;)
+    {
+        //Check if they are even visible before doing anything
+        int n = 0;
+        for (; first < count && n < batchSize; ++first)
+        {
+            if (projector->checkVisibility(&stars[first]))
+            {
+                candidates[n] = &stars[first];
+                points[n++]   = &stars[first];
+            }
+        }
+
+        projector->projectBatch(points, n, screen, visible);
+
+        for (int i = 0; i < n; ++i)
+        {
+            QPointF pos = KSUtils::vecToPoint(screen[i]);
+            // FIXME: onScreen here should use canvas size rather than SkyMap size, especially while printing in portrait mode!
+            if (visible[i] && projector->onScreen(pos))
+                sources.append({ pos, candidates[i]->mag(), candidates[i]->spchar() });
+        }
+    }
+}
+
 float SkyPainter::starWidth(float mag) const
 {
     //adjust maglimit for ZoomLevel
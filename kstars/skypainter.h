@@ -23,6 +23,7 @@
 #include "skycomponents/typedef.h"
 
 #include <QList>
+#include <QVector>
 #include <QPainter>
 
 class ConstellationsArt;
@@ -32,11 +33,13 @@ class KSPlanetBase;
 class KSEarthShadow;
 class LineList;
 class LineListLabel;
+class Projector;
 class Satellite;
 class SkipHashList;
 class SkyMap;
 class SkyObject;
 class SkyPoint;
+class StarObject;
 class Supernova;
 
 /**
@@ -47,6 +50,18 @@ class Supernova;
 class SkyPainter
 {
   public:
+    /**
+     * @short Layers of the sky map that change slowly enough to be reused across frames
+     * @see drawCachedLayer()
+     */
+    enum CachedLayer
+    {
+        BACKGROUND_LAYER,        ///< Milky Way and HiPS
+        CONSTELLATION_ART_LAYER, ///< Constellation images
+        FAINT_STARS_LAYER,       ///< Unnamed stars of the deep star catalogs
+        NUM_CACHED_LAYERS
+    };
+
     SkyPainter();
 
     virtual ~SkyPainter() = default;
@@ -128,6 +143,31 @@ class SkyPainter
      */
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') = 0;
 
+    /** @short A point source whose screen position is already known */
+    struct ProjectedPointSource
+    {
+        QPointF pos;
+        float mag;
+        char sp;
+    };
+
+    /**
+     * @short Project a run of stars in one batch and keep the ones that land on screen.
+     * This does not paint anything, so it may run on worker threads while the sky is being drawn.
+     * @param projector the projector of the sky map being drawn
+     * @param stars contiguous array of stars, with up to date horizontal coordinates
+     * @param count number of stars in the array
+     * @param sources the visible stars are appended to this list
+     */
+    static void projectPointSources(const Projector *projector, StarObject *stars, int count,
+                                    QVector<ProjectedPointSource> &sources);
+
+    /**
+     * @short Draw point sources that were projected with projectPointSources().
+     * @param sources the point sources to draw
+     */
+    virtual void drawPointSources(const QVector<ProjectedPointSource> &sources) = 0;
+
     /**
      * @short Draw a deep sky object
      * @param obj the object to draw
@@ -183,6 +223,17 @@ class SkyPainter
      */
     virtual bool drawHips() = 0;
 
+    /**
+     * @short Draw a layer as rendered in a previous frame, if the painter keeps a cache of them
+     * @param layer the layer to draw
+     * @return false if the layer has to be drawn object by object instead
+     */
+    virtual bool drawCachedLayer(CachedLayer layer)
+    {
+        Q_UNUSED(layer)
+        return false;
+    }
+
   protected:
     SkyMap *m_sm { nullptr };
 
@@ -22,8 +22,10 @@
 #include <QPointer>
 
 #include "kstarsdata.h"
+#include "ksutils.h"
 #include "Options.h"
 #include "skymap.h"
+#include "skymaplayercache.h"
 #include "projections/projector.h"
 #include "skycomponents/flagcomponent.h"
 #include "skycomponents/linelist.h"
@@ -31,6 +33,7 @@
 #include "skycomponents/satellitescomponent.h"
 #include "skycomponents/skiphashlist.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skymapprofiler.h"
 #include "skycomponents/solarsystemcomposite.h"
 #include "skycomponents/earthshadowcomponent.h"
 #include "skyobjects/constellationsart.h"
@@ -39,12 +42,26 @@
 #include "skyobjects/kscomet.h"
 #include "skyobjects/kssun.h"
 #include "skyobjects/satellite.h"
+#include "skyobjects/starobject.h"
 #include "skyobjects/supernova.h"
 #include "skyobjects/ksearthshadow.h"
 #include "hips/hipsrenderer.h"
 
 namespace
 {
+// Project all points of a line list in one batch
+void projectList(const Projector *proj, const SkyList *points, bool oRefract, QVector<Vector2f> &screen,
+                 QVector<bool> &visible)
+{
+    QVector<const SkyPoint *> list(points->size());
+    for (int i = 0; i < points->size(); ++i)
+        list[i] = points->at(i).get();
+
+    screen.resize(list.size());
+    visible.resize(list.size());
+    proj->projectBatch(list.constData(), list.size(), screen.data(), visible.data(), oRefract);
+}
+
 // Convert spectral class to numerical index.
 // If spectral class is invalid return index for white star (A class)
 int harvardToIndex(char c)
@@ -298,38 +315,33 @@ void SkyQPainter::drawSkyLine(SkyPoint *a, SkyPoint *b)
 void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineListLabel *label)
 {
     SkyList *points = list->points();
-    bool isVisible, isVisibleLast;
+    if (points->isEmpty())
+        return;
+
+    QVector<Vector2f> screen;
+    QVector<bool> visible;
+    projectList(m_proj, points, true, screen, visible);
 
-    QPointF oLast = m_proj->toScreen(points->first().get(), true, &isVisibleLast);
     // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(points->first().get());
-    QPointF oThis, oThis2;
+    bool isVisibleLast = visible[0] && m_proj->checkVisibility(points->first().get());
+    QPointF oLast      = KSUtils::vecToPoint(screen[0]);
+    //Temporary solution to avoid random lines in Gnomonic projection and draw lines up to horizon
+    const bool gnomonic = (SkyMap::Instance()->projector()->type() == Projector::Gnomonic);
 
     for (int j = 1; j < points->size(); j++)
     {
         SkyPoint *pThis = points->at(j).get();
 
-        oThis2 = oThis = m_proj->toScreen(pThis, true, &isVisible);
+        QPointF oThis = KSUtils::vecToPoint(screen[j]);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
-        bool doSkip = false;
+        bool isVisible = visible[j] && m_proj->checkVisibility(pThis);
+        bool doSkip    = false;
         if (skipList)
         {
             doSkip = skipList->skip(j);
         }
 
-        bool pointsVisible = false;
-        //Temporary solution to avoid random lines in Gnomonic projection and draw lines up to horizon
-        if (SkyMap::Instance()->projector()->type() == Projector::Gnomonic)
-        {
-            if (isVisible && isVisibleLast)
-                pointsVisible = true;
-        }
-        else
-        {
-            if (isVisible || isVisibleLast)
-                pointsVisible = true;
-        }
+        bool pointsVisible = gnomonic ? (isVisible && isVisibleLast) : (isVisible || isVisibleLast);
 
         if (!doSkip)
         {
@@ -341,23 +353,31 @@ void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineLi
             }
         }
 
-        oLast         = oThis2;
+        oLast         = oThis;
         isVisibleLast = isVisible;
     }
 }
 
 void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
 {
-    bool isVisible  = false, isVisibleLast;
     SkyList *points = list->points();
     QPolygonF polygon;
 
+    if (points->isEmpty())
+        return;
+
+    QVector<Vector2f> screen;
+    QVector<bool> visible;
+    // Unclipped polygons are projected without refraction
+    projectList(m_proj, points, forceClip, screen, visible);
+
     if (forceClip == false)
     {
-        for (const auto &point : *points)
+        bool isVisible = false;
+        for (int i = 0; i < points->size(); ++i)
         {
-            polygon << m_proj->toScreen(point.get(), false, &isVisibleLast);
-            isVisible |= isVisibleLast;
+            polygon << KSUtils::vecToPoint(screen[i]);
+            isVisible |= visible[i];
         }
 
         // If 1+ points are visible, draw it
@@ -368,16 +388,15 @@ void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
     }
 
     SkyPoint *pLast = points->last().get();
-    QPointF oLast   = m_proj->toScreen(pLast, true, &isVisibleLast);
     // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(pLast);
+    bool isVisibleLast = visible.last() && m_proj->checkVisibility(pLast);
 
-    for (const auto &point : *points)
+    for (int i = 0; i < points->size(); ++i)
     {
-        SkyPoint *pThis = point.get();
-        QPointF oThis   = m_proj->toScreen(pThis, true, &isVisible);
+        SkyPoint *pThis = points->at(i).get();
+        QPointF oThis   = KSUtils::vecToPoint(screen[i]);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
+        bool isVisible = visible[i] && m_proj->checkVisibility(pThis);
 
         if (isVisible && isVisibleLast)
         {
@@ -396,7 +415,6 @@ void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
         }
 
         pLast         = pThis;
-        oLast         = oThis;
         isVisibleLast = isVisible;
     }
 
@@ -468,6 +486,7 @@ bool SkyQPainter::drawPlanet(KSPlanetBase *planet)
             drawEllipse(pos, size * .5, size * .5);
         }
     }
+    SkyMapProfiler::Instance()->addObjects(1);
     return true;
 }
 
@@ -492,6 +511,7 @@ bool SkyQPainter::drawEarthShadow(KSEarthShadow *shadow)
     drawEllipse(pos, penumbra_size, penumbra_size);
     restore();
 
+    SkyMapProfiler::Instance()->addObjects(1);
     return true;
 }
 
@@ -549,6 +569,7 @@ bool SkyQPainter::drawComet(KSComet *com)
             restore();
         }
 
+        SkyMapProfiler::Instance()->addObjects(1);
         return true;
     }
     else
@@ -570,6 +591,7 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
                 pos)) // FIXME: onScreen here should use canvas size rather than SkyMap size, especially while printing in portrait mode!
     {
         drawPointSource(pos, starWidth(mag), sp);
+        SkyMapProfiler::Instance()->addObjects(1);
         return true;
     }
     else
@@ -578,6 +600,13 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
     }
 }
 
+void SkyQPainter::drawPointSources(const QVector<ProjectedPointSource> &sources)
+{
+    for (const auto &source : sources)
+        drawPointSource(source.pos, starWidth(source.mag), source.sp);
+    SkyMapProfiler::Instance()->addObjects(sources.size());
+}
+
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
@@ -660,6 +689,16 @@ bool SkyQPainter::drawHips()
     return rendered;
 }
 
+bool SkyQPainter::isHipsComplete() const
+{
+    return m_hipsRender->isComplete();
+}
+
+bool SkyQPainter::drawCachedLayer(CachedLayer layer)
+{
+    return m_layerCache && m_layerCache->draw(layer, this);
+}
+
 bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
 {
     if (!m_proj->checkVisibility(obj))
@@ -690,6 +729,7 @@ bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
     //Draw Symbol
     drawDeepSkySymbol(pos, obj->type(), size, obj->e(), positionAngle);
 
+    SkyMapProfiler::Instance()->addObjects(1);
     return true;
 }
 
@@ -1043,6 +1083,7 @@ bool SkyQPainter::drawSatellite(Satellite *sat)
         drawLine( QPoint( pos.x() - 0.5, pos.y() + 0.5 ), QPoint( pos.x() - 0.5, pos.y() - 0.5 ) );*/
     }
 
+    SkyMapProfiler::Instance()->addObjects(1);
     return true;
 
     //if ( Options::showSatellitesLabels() )
@@ -1068,5 +1109,6 @@ bool SkyQPainter::drawSupernova(Supernova *sup)
     //qDebug()<<"Here";
     drawLine(QPoint(pos.x() - 2.0, pos.y()), QPoint(pos.x() + 2.0, pos.y()));
     drawLine(QPoint(pos.x(), pos.y() - 2.0), QPoint(pos.x(), pos.y() + 2.0));
+    SkyMapProfiler::Instance()->addObjects(1);
     return true;
 }
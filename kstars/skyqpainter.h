@@ -30,6 +30,7 @@ class QSize;
 class QMessageBox;
 class HIPSRenderer;
 class KSEarthShadow;
+class SkyMapLayerCache;
 
 /**
  * @short The QPainter-based painting backend.
@@ -87,6 +88,7 @@ class SkyQPainter : public SkyPainter, public QPainter
                          LineListLabel *label = nullptr) override;
     void drawSkyPolygon(LineList *list, bool forceClip = true) override;
     bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') override;
+    void drawPointSources(const QVector<ProjectedPointSource> &sources) override;
     bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false) override;
     bool drawPlanet(KSPlanetBase *planet) override;
     bool drawEarthShadow(KSEarthShadow *shadow) override;
@@ -101,6 +103,16 @@ class SkyQPainter : public SkyPainter, public QPainter
     virtual void drawPointSource(const QPointF &pos, float size, char sp = 'A');
     bool drawConstellationArtImage(ConstellationsArt *obj) override;
     bool drawHips() override;
+    bool drawCachedLayer(CachedLayer layer) override;
+
+    /**
+     * @short Take cached layers from the given cache instead of drawing them
+     * @param cache the cache of the sky map widget, or nullptr to draw every layer
+     */
+    inline void setLayerCache(SkyMapLayerCache *cache) { m_layerCache = cache; }
+
+    /** @return false if the last HiPS drawn by this painter is missing tiles that are still being fetched */
+    bool isHipsComplete() const;
 
 private:
     virtual bool drawDeepSkyImage(const QPointF &pos, DeepSkyObject *obj, float positionAngle);
@@ -109,6 +121,7 @@ private:
     const Projector *m_proj { nullptr };
     bool m_vectorStars { false };
     HIPSRenderer *m_hipsRender { nullptr };
+    SkyMapLayerCache *m_layerCache { nullptr };
     QSize m_size;
     static int starColorMode;
     static QColor m_starColor;